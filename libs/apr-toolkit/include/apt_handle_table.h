@@ -0,0 +1,96 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_HANDLE_TABLE_H
+#define APT_HANDLE_TABLE_H
+
+/**
+ * @file apt_handle_table.h
+ * @brief Table of Opaque void* Objects Keyed by Integer Handles
+ */
+
+#include "apt_string.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default size (number of slots) of handle table */
+#define HANDLE_TABLE_DEFAULT_SIZE  64
+
+/** Number of hex digits the handle is encoded by at the beginning of identifier */
+#define HANDLE_ID_HEX_DIGIT_COUNT  8
+
+/** Opaque handle table declaration */
+typedef struct apt_handle_table_t apt_handle_table_t;
+
+/**
+ * Create handle table.
+ * @param size the initial number of slots (rounded up to a power of two)
+ * @param pool the pool to allocate memory from
+ * @return the created table
+ * @remark The table is an open-addressing array of slots with linear probing,
+ *         so lookup takes neither string hashing nor memory allocation.
+ *         The table doubles as it gets half full. The table is not thread-safe.
+ */
+APT_DECLARE(apt_handle_table_t*) apt_handle_table_create(apr_size_t size, apr_pool_t *pool);
+
+/**
+ * Add object to the table under a newly allocated handle.
+ * @param table the table to add object to
+ * @param obj the object to add
+ * @return the handle of the object, which is never 0
+ */
+APT_DECLARE(apr_uint32_t) apt_handle_table_add(apt_handle_table_t *table, void *obj);
+
+/**
+ * Set object under the specified handle.
+ * @param table the table to set object in
+ * @param handle the handle (not 0) to set object under
+ * @param obj the object to set, or NULL to remove the handle from the table
+ */
+APT_DECLARE(apt_bool_t) apt_handle_table_set(apt_handle_table_t *table, apr_uint32_t handle, void *obj);
+
+/**
+ * Get object by handle.
+ * @param table the table to get object from
+ * @param handle the handle to look up
+ * @return the object or NULL, if there is no such handle in the table
+ */
+APT_DECLARE(void*) apt_handle_table_get(const apt_handle_table_t *table, apr_uint32_t handle);
+
+/** Get the number of objects in the table */
+APT_DECLARE(apr_size_t) apt_handle_table_count(const apt_handle_table_t *table);
+
+/**
+ * Generate unique identifier (hex string) beginning with the handle.
+ * @param id the identifier to generate
+ * @param handle the handle to encode by the first HANDLE_ID_HEX_DIGIT_COUNT hex digits
+ * @param length the length of the identifier (the rest of the digits are random)
+ * @param pool the pool to allocate memory from
+ */
+APT_DECLARE(apt_bool_t) apt_handle_id_generate(apt_str_t *id, apr_uint32_t handle, apr_size_t length, apr_pool_t *pool);
+
+/**
+ * Parse the handle encoded at the beginning of identifier.
+ * @param id the identifier to parse
+ * @return the handle, or 0 if the identifier doesn't begin with HANDLE_ID_HEX_DIGIT_COUNT hex digits
+ * @remark Identifiers generated elsewhere may begin with hex digits too,
+ *         so an object found by the handle must be checked against the whole identifier.
+ */
+APT_DECLARE(apr_uint32_t) apt_handle_id_parse(const apt_str_t *id);
+
+APT_END_EXTERN_C
+
+#endif /* APT_HANDLE_TABLE_H */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_LOCKFREE_QUEUE_H
+#define APT_LOCKFREE_QUEUE_H
+
+/**
+ * @file apt_lockfree_queue.h
+ * @brief Lock-free Bounded FIFO Queue of Opaque void* Objects
+ */
+
+#include "apt.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default size (number of elements) of lock-free queue */
+#define LOCKFREE_QUEUE_DEFAULT_SIZE	1024
+
+/** Opaque lock-free queue declaration */
+typedef struct apt_lockfree_queue_t apt_lockfree_queue_t;
+
+/**
+ * Create lock-free queue.
+ * @param size the max number of elements in the queue (rounded up to a power of two)
+ * @param pool the pool to allocate memory from
+ * @return the created queue
+ * @remark Unlike apt_cyclic_queue_t, the queue never grows, and any number of
+ *         producer and consumer threads can access it without external locking.
+ */
+APT_DECLARE(apt_lockfree_queue_t*) apt_lockfree_queue_create(apr_size_t size, apr_pool_t *pool);
+
+/**
+ * Push object to the queue.
+ * @param queue the queue to push object to
+ * @param obj the object to push
+ * @return FALSE if the queue is full, otherwise TRUE
+ */
+APT_DECLARE(apt_bool_t) apt_lockfree_queue_push(apt_lockfree_queue_t *queue, void *obj);
+
+/**
+ * Pop object from the queue.
+ * @param queue the queue to pop object from
+ * @return the popped object or NULL, if the queue is empty
+ */
+APT_DECLARE(void*) apt_lockfree_queue_pop(apt_lockfree_queue_t *queue);
+
+/**
+ * Query whether the queue is empty.
+ * @param queue the queue to query
+ * @return TRUE if empty, otherwise FALSE
+ * @remark The result may be outdated by the time it is returned, if other threads access the queue.
+ */
+APT_DECLARE(apt_bool_t) apt_lockfree_queue_is_empty(const apt_lockfree_queue_t *queue);
+
+
+APT_END_EXTERN_C
+
+#endif /* APT_LOCKFREE_QUEUE_H */
@@ -32,6 +32,12 @@ APT_BEGIN_EXTERN_C
 #define MAX_LOG_FILE_SIZE (8 * 1024 * 1024)
 /** Default max number of log files used in rotation */
 #define MAX_LOG_FILE_COUNT 100
+/** Default number of ring buffers of log entries allocated at once in async mode */
+#define LOG_ASYNC_RING_COUNT 32
+/** Default size of the ring buffer of log entries per thread in async mode (64Kb) */
+#define LOG_ASYNC_RING_SIZE (64 * 1024)
+/** Default interval the async log writer checks ring buffers at (msec) */
+#define LOG_ASYNC_FLUSH_INTERVAL 10
 
 /** Opaque log source declaration */
 typedef struct apt_log_source_t apt_log_source_t;
@@ -218,6 +224,31 @@ APT_DECLARE(apt_bool_t) apt_syslog_open(const char *prefix, const char *config_f
  */
 APT_DECLARE(apt_bool_t) apt_syslog_close(void);
 
+/**
+ * Enable asynchronous logging.
+ * @param ring_count the number of ring buffers of log entries allocated at once
+ * @param ring_size the size of the ring buffer of log entries taken per logging thread
+ * @param flush_interval the interval the writer thread checks the ring buffers at (msec)
+ * @remark Log entries are formatted by the calling thread and placed into the lock-free
+ *         ring buffer of that thread, which is drained by a dedicated writer thread.
+ *         Entries which do not fit into the ring buffer are dropped and accounted.
+ *         Threads logging when all the ring buffers are taken write synchronously.
+ *         The ring buffers are kept and reused if the mode is enabled again.
+ */
+APT_DECLARE(apt_bool_t) apt_log_async_enable(apr_size_t ring_count, apr_size_t ring_size, apr_uint32_t flush_interval);
+
+/**
+ * Disable asynchronous logging, writing out pending log entries.
+ * @remark apt_log_file_close() suspends asynchronous logging, which is resumed
+ *         by the subsequent apt_log_file_open().
+ */
+APT_DECLARE(apt_bool_t) apt_log_async_disable(void);
+
+/**
+ * Get the number of log entries dropped in asynchronous mode due to overflow of ring buffers.
+ */
+APT_DECLARE(apr_uint32_t) apt_log_async_drop_count_get(void);
+
 /**
  * Set the logging output mode.
  * @param mode the mode to set
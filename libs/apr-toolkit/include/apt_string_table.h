@@ -38,6 +38,23 @@ struct apt_str_table_item_t {
 	apr_size_t key;
 };
 
+/** Perfect hash of string table declaration */
+typedef struct apt_str_table_hash_t apt_str_table_hash_t;
+
+/**
+ * Perfect hash of string table definition.
+ * Generated once for a given string table by strtablegen, so that
+ * each string of the table is hashed to a bucket of its own.
+ */
+struct apt_str_table_hash_t {
+	/** Seed of the hash function */
+	apr_uint32_t      seed;
+	/** Number of buckets - 1 (the number of buckets is a power of two) */
+	apr_uint32_t      mask;
+	/** Buckets holding (id + 1) of the string hashed to, or 0 */
+	const apr_byte_t *buckets;
+};
+
 
 /**
  * Get the string by a given id.
@@ -57,6 +74,23 @@ APT_DECLARE(const apt_str_t*) apt_string_table_str_get(const apt_str_table_item_
  */
 APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_t *value);
 
+/**
+ * Find the id associated with a given string using the perfect hash of the table.
+ * @param table the table to search for the id
+ * @param size the size of the table
+ * @param hash the perfect hash of the table (falls back to apt_string_table_id_find(), if NULL)
+ * @param value the string to search for
+ * @return the id associated with the string, or invalid id if string cannot be matched
+ */
+APT_DECLARE(apr_size_t) apt_string_table_hash_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_table_hash_t *hash, const apt_str_t *value);
+
+/**
+ * Calculate case-insensitive hash of a given string.
+ * @param value the string to calculate hash of
+ * @param seed the seed of the hash function
+ */
+APT_DECLARE(apr_uint32_t) apt_string_table_hash(const apt_str_t *value, apr_uint32_t seed);
+
 
 APT_END_EXTERN_C
 
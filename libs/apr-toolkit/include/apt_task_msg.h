@@ -44,10 +44,15 @@ typedef enum {
 	CORE_TASK_MSG_BRINGONLINE_COMPLETE, /**< bring-online-complete message */
 } apt_core_task_msg_type_e;
 
+/** Default number of messages preallocated by a static pool */
+#define TASK_MSG_POOL_DEFAULT_SIZE 64
+
 /** Opaque task message declaration */
 typedef struct apt_task_msg_t apt_task_msg_t;
 /** Opaque task message pool declaration */
 typedef struct apt_task_msg_pool_t apt_task_msg_pool_t;
+/** Task message pool statistics declaration */
+typedef struct apt_task_msg_pool_stat_t apt_task_msg_pool_stat_t;
 
 /** Task message is used for inter task communication */
 struct apt_task_msg_t {
@@ -61,11 +66,28 @@ struct apt_task_msg_t {
 	char                 data[1];
 };
 
+/** Task message pool statistics */
+struct apt_task_msg_pool_stat_t {
+	/** Number of acquired and not released yet messages */
+	apr_size_t outstanding;
+	/** Max number of outstanding messages */
+	apr_size_t peak;
+	/** Number of messages allocated by the pool */
+	apr_size_t allocated;
+};
+
 
 /** Create pool of task messages with dynamic allocation of messages (no actual pool is created) */
 APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_dynamic(apr_size_t msg_size, apr_pool_t *pool);
 
-/** Create pool of task messages with static allocation of messages */
+/**
+ * Create pool of task messages with static allocation of messages.
+ * @param msg_size the size of the context specific data of messages
+ * @param msg_pool_size the number of messages to preallocate, also used as the number of messages the pool grows by
+ * @param pool the pool to allocate memory from
+ * @remark Released messages are recycled via per-thread free lists, which overflow to and refill
+ *         from a shared list, so that the allocator is rarely involved and contended.
+ */
 APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_static(apr_size_t msg_size, apr_size_t msg_pool_size, apr_pool_t *pool);
 
 /** Destroy pool of task messages */
@@ -78,6 +100,9 @@ APT_DECLARE(apt_task_msg_t*) apt_task_msg_acquire(apt_task_msg_pool_t *task_msg_
 /** Realese task message */
 APT_DECLARE(void) apt_task_msg_release(apt_task_msg_t *task_msg);
 
+/** Get statistics of task message pool */
+APT_DECLARE(void) apt_task_msg_pool_stat_get(apt_task_msg_pool_t *task_msg_pool, apt_task_msg_pool_stat_t *stat);
+
 
 APT_END_EXTERN_C
 
@@ -48,6 +48,12 @@ typedef struct apt_message_generator_vtable_t apt_message_generator_vtable_t;
 /** Temporary context associated with message and used for its parsing or generation */
 typedef struct apt_message_context_t apt_message_context_t;
 
+/** Opaque reference counted buffer, messages are parsed over in zero-copy mode */
+typedef struct apt_message_buffer_t apt_message_buffer_t;
+
+/** Opaque references to the buffers a message parsed in zero-copy mode refers to */
+typedef struct apt_message_buffer_refs_t apt_message_buffer_refs_t;
+
 /** Create message parser */
 APT_DECLARE(apt_message_parser_t*) apt_message_parser_create(void *obj, const apt_message_parser_vtable_t *vtable, apr_pool_t *pool);
 
@@ -60,6 +66,42 @@ APT_DECLARE(void*) apt_message_parser_object_get(apt_message_parser_t *parser);
 /** Set verbose mode for the parser */
 APT_DECLARE(void) apt_message_parser_verbose_set(apt_message_parser_t *parser, apt_bool_t verbose);
 
+/**
+ * Set the buffer to parse messages over in zero-copy mode.
+ * @param parser the parser to set the buffer for
+ * @param buffer the buffer subsequent streams lie in, or NULL to copy parsed data (default)
+ * @remark In zero-copy mode, names and values of header fields and the body of parsed
+ *         messages refer to the buffer, which each message holds a reference to
+ *         (see apt_message_parser_buffer_refs_get()). The references left are released
+ *         as the pool of the parser is destroyed. Header fields are terminated
+ *         in place, the body is not. Parsed data must never be modified in place,
+ *         but rather replaced by a copy.
+ */
+APT_DECLARE(void) apt_message_parser_buffer_set(apt_message_parser_t *parser, apt_message_buffer_t *buffer);
+
+/**
+ * Get references to the buffers the message last parsed in zero-copy mode refers to.
+ * @param parser the parser to get the references from
+ * @return the references to be released once the message is freed, or NULL if none
+ */
+APT_DECLARE(apt_message_buffer_refs_t*) apt_message_parser_buffer_refs_get(const apt_message_parser_t *parser);
+
+/**
+ * Release references to the buffers a parsed message refers to.
+ * @param refs the references to release (may be released more than once, the first time counts)
+ * @remark The data of the message must not be accessed afterwards.
+ */
+APT_DECLARE(void) apt_message_buffer_refs_release(apt_message_buffer_refs_t *refs);
+
+/**
+ * Transfer references to the buffers a parsed message refers to to another pool.
+ * @param refs the references to transfer (left empty)
+ * @param pool the pool to allocate the references from, they are released as the pool is destroyed
+ * @return the references transferred, or NULL if none
+ * @remark Used to retain the buffers beyond the lifetime of the pool of the parser.
+ */
+APT_DECLARE(apt_message_buffer_refs_t*) apt_message_buffer_refs_transfer(apt_message_buffer_refs_t *refs, apr_pool_t *pool);
+
 
 /** Create message generator */
 APT_DECLARE(apt_message_generator_t*) apt_message_generator_create(void *obj, const apt_message_generator_vtable_t *vtable, apr_pool_t *pool);
@@ -74,6 +116,34 @@ APT_DECLARE(void*) apt_message_generator_object_get(apt_message_generator_t *gen
 APT_DECLARE(void) apt_message_generator_verbose_set(apt_message_generator_t *generator, apt_bool_t verbose);
 
 
+/** Create reference counted buffer of a given size (the reference count is set to 1) */
+APT_DECLARE(apt_message_buffer_t*) apt_message_buffer_create(apr_size_t size);
+
+/** Add reference to the buffer */
+APT_DECLARE(void) apt_message_buffer_ref(apt_message_buffer_t *buffer);
+
+/** Remove reference from the buffer and destroy the buffer, if no reference is left */
+APT_DECLARE(void) apt_message_buffer_unref(apt_message_buffer_t *buffer);
+
+/** Query whether the buffer is referenced by anyone else but the caller */
+APT_DECLARE(apt_bool_t) apt_message_buffer_is_shared(const apt_message_buffer_t *buffer);
+
+/** Get the data of the buffer (size + 1 bytes to reserve room for the terminating null) */
+APT_DECLARE(char*) apt_message_buffer_data_get(apt_message_buffer_t *buffer);
+
+/** Get the size of the buffer */
+APT_DECLARE(apr_size_t) apt_message_buffer_size_get(const apt_message_buffer_t *buffer);
+
+/**
+ * Scroll the stream lying in the buffer.
+ * @param buffer the buffer to scroll the stream in, replaced by a new buffer if the current one is shared
+ * @param stream the stream to scroll
+ * @remark Unlike apt_text_stream_scroll(), the remaining data is moved to a new buffer rather than
+ *         to the beginning of the current one, if parsed messages still refer to the current buffer.
+ */
+APT_DECLARE(apt_bool_t) apt_message_buffer_stream_scroll(apt_message_buffer_t **buffer, apt_text_stream_t *stream);
+
+
 /** Parse individual header field (name-value pair) */
 APT_DECLARE(apt_header_field_t*) apt_header_field_parse(apt_text_stream_t *stream, apr_pool_t *pool);
 
@@ -34,10 +34,25 @@ typedef struct apt_timer_queue_t apt_timer_queue_t;
 /** Prototype of timer callback */
 typedef void (*apt_timer_proc_f)(apt_timer_t *timer, void *obj);
 
+/** Implementation of timer queue */
+typedef enum {
+	APT_TIMER_QUEUE_SORTED_LIST, /**< list of timers sorted by time (O(n) insertion) */
+	APT_TIMER_QUEUE_WHEEL        /**< hierarchical timing wheel (O(1) insertion and removal) */
+} apt_timer_queue_type_e;
+
 
 /** Create timer queue */
 APT_DECLARE(apt_timer_queue_t*) apt_timer_queue_create(apr_pool_t *pool);
 
+/**
+ * Create timer queue of the specified implementation.
+ * @param type the implementation of the queue
+ * @param resolution the duration of the tick of the wheel in msec (ignored by the sorted list)
+ * @param pool the pool to allocate memory from
+ * @remark Timeouts of the wheel are rounded up to the whole number of ticks.
+ */
+APT_DECLARE(apt_timer_queue_t*) apt_timer_queue_create_ex(apt_timer_queue_type_e type, apr_uint32_t resolution, apr_pool_t *pool);
+
 /** Destroy timer queue */
 APT_DECLARE(void) apt_timer_queue_destroy(apt_timer_queue_t *timer_queue);
 
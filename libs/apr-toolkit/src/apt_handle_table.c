@@ -0,0 +1,232 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <apr_uuid.h>
+#include "apt_handle_table.h"
+
+/** Multiplier of Fibonacci hashing (2^32 divided by the golden ratio) */
+#define HANDLE_HASH_MULTIPLIER 2654435769U
+
+/** Slot of the table, the handle 0 marks an empty slot */
+typedef struct {
+	apr_uint32_t handle;
+	void        *obj;
+} apt_handle_slot_t;
+
+/** Open-addressing table with linear probing */
+struct apt_handle_table_t {
+	apt_handle_slot_t *slots;
+	apr_uint32_t       mask;
+	apr_uint32_t       shift;
+	apr_size_t         count;
+	apr_uint32_t       next_handle;
+	apr_pool_t        *pool;
+};
+
+/** Get the home slot of the handle */
+static APR_INLINE apr_uint32_t apt_handle_slot_home(const apt_handle_table_t *table, apr_uint32_t handle)
+{
+	/* the upper bits of the product are spread best, even for sequential handles */
+	return (apr_uint32_t)(handle * HANDLE_HASH_MULTIPLIER) >> table->shift;
+}
+
+/** Allocate the slots of the specified capacity (a power of two) */
+static void apt_handle_slots_alloc(apt_handle_table_t *table, apr_uint32_t capacity)
+{
+	apr_uint32_t bits = 0;
+	while((1U << bits) < capacity) {
+		bits++;
+	}
+	table->slots = apr_pcalloc(table->pool,sizeof(apt_handle_slot_t) * capacity);
+	table->mask = capacity - 1;
+	table->shift = 32 - bits;
+}
+
+/** Find the slot of the handle or the empty slot the handle belongs to */
+static APR_INLINE apr_uint32_t apt_handle_slot_find(const apt_handle_table_t *table, apr_uint32_t handle)
+{
+	apr_uint32_t index = apt_handle_slot_home(table,handle);
+	while(table->slots[index].handle && table->slots[index].handle != handle) {
+		index = (index + 1) & table->mask;
+	}
+	return index;
+}
+
+/** Double the capacity of the table, moving the objects to the new slots */
+static void apt_handle_table_grow(apt_handle_table_t *table)
+{
+	apt_handle_slot_t *slots = table->slots;
+	apr_uint32_t capacity = table->mask + 1;
+	apr_uint32_t i;
+	apr_uint32_t index;
+
+	/* the former slots remain allocated from the pool, which is bounded by the final capacity */
+	apt_handle_slots_alloc(table,capacity << 1);
+	for(i=0; i<capacity; i++) {
+		if(slots[i].handle) {
+			index = apt_handle_slot_find(table,slots[i].handle);
+			table->slots[index] = slots[i];
+		}
+	}
+}
+
+/** Remove the object from the slot, shifting the following slots of the cluster backward */
+static void apt_handle_slot_remove(apt_handle_table_t *table, apr_uint32_t index)
+{
+	apr_uint32_t next = index;
+	apr_uint32_t home;
+
+	for(;;) {
+		next = (next + 1) & table->mask;
+		if(!table->slots[next].handle) {
+			break;
+		}
+		home = apt_handle_slot_home(table,table->slots[next].handle);
+		/* move the handle to the vacant slot, unless its home lies cyclically in (index, next] */
+		if(index <= next ? (home <= index || home > next) : (home <= index && home > next)) {
+			table->slots[index] = table->slots[next];
+			index = next;
+		}
+	}
+	table->slots[index].handle = 0;
+	table->slots[index].obj = NULL;
+	table->count--;
+}
+
+APT_DECLARE(apt_handle_table_t*) apt_handle_table_create(apr_size_t size, apr_pool_t *pool)
+{
+	apr_uint32_t capacity = 2;
+	apt_handle_table_t *table = apr_palloc(pool,sizeof(apt_handle_table_t));
+	while(capacity < size && capacity < 0x40000000) {
+		capacity <<= 1;
+	}
+
+	table->pool = pool;
+	table->count = 0;
+	table->next_handle = 1;
+	apt_handle_slots_alloc(table,capacity);
+	return table;
+}
+
+APT_DECLARE(apr_uint32_t) apt_handle_table_add(apt_handle_table_t *table, void *obj)
+{
+	apr_uint32_t handle;
+	do {
+		handle = table->next_handle++;
+		/* skip 0 and the handles still in use, as the counter wraps around */
+	}
+	while(!handle || apt_handle_table_get(table,handle));
+
+	apt_handle_table_set(table,handle,obj);
+	return handle;
+}
+
+APT_DECLARE(apt_bool_t) apt_handle_table_set(apt_handle_table_t *table, apr_uint32_t handle, void *obj)
+{
+	apr_uint32_t index;
+	if(!handle) {
+		return FALSE;
+	}
+
+	index = apt_handle_slot_find(table,handle);
+	if(!obj) {
+		if(table->slots[index].handle) {
+			apt_handle_slot_remove(table,index);
+		}
+		return TRUE;
+	}
+
+	if(!table->slots[index].handle) {
+		if((table->count + 1) * 2 > (apr_size_t)table->mask + 1) {
+			apt_handle_table_grow(table);
+			index = apt_handle_slot_find(table,handle);
+		}
+		table->slots[index].handle = handle;
+		table->count++;
+	}
+	table->slots[index].obj = obj;
+	return TRUE;
+}
+
+APT_DECLARE(void*) apt_handle_table_get(const apt_handle_table_t *table, apr_uint32_t handle)
+{
+	if(!handle) {
+		return NULL;
+	}
+	return table->slots[apt_handle_slot_find(table,handle)].obj;
+}
+
+APT_DECLARE(apr_size_t) apt_handle_table_count(const apt_handle_table_t *table)
+{
+	return table->count;
+}
+
+APT_DECLARE(apt_bool_t) apt_handle_id_generate(apt_str_t *id, apr_uint32_t handle, apr_size_t length, apr_pool_t *pool)
+{
+	char *hex_str;
+	apr_size_t i;
+	apr_size_t count;
+	apr_uuid_t uuid;
+
+	if(length < HANDLE_ID_HEX_DIGIT_COUNT) {
+		length = HANDLE_ID_HEX_DIGIT_COUNT;
+	}
+	else if(length > HANDLE_ID_HEX_DIGIT_COUNT + sizeof(uuid.data) * 2) {
+		length = HANDLE_ID_HEX_DIGIT_COUNT + sizeof(uuid.data) * 2;
+	}
+	hex_str = apr_palloc(pool,length+2);
+	sprintf(hex_str,"%08x",handle);
+
+	/* fill the rest with random digits, so that identifiers are not predictable */
+	apr_uuid_get(&uuid);
+	count = (length - HANDLE_ID_HEX_DIGIT_COUNT + 1) / 2;
+	for(i=0; i<count; i++) {
+		sprintf(hex_str+HANDLE_ID_HEX_DIGIT_COUNT+i*2,"%02x",uuid.data[i]);
+	}
+	hex_str[length] = '\0';
+
+	id->buf = hex_str;
+	id->length = length;
+	return TRUE;
+}
+
+APT_DECLARE(apr_uint32_t) apt_handle_id_parse(const apt_str_t *id)
+{
+	apr_uint32_t handle = 0;
+	apr_size_t i;
+	char ch;
+
+	if(!id->buf || id->length < HANDLE_ID_HEX_DIGIT_COUNT) {
+		return 0;
+	}
+	for(i=0; i<HANDLE_ID_HEX_DIGIT_COUNT; i++) {
+		ch = id->buf[i];
+		if(ch >= '0' && ch <= '9') {
+			handle = (handle << 4) | (ch - '0');
+		}
+		else if(ch >= 'a' && ch <= 'f') {
+			handle = (handle << 4) | (ch - 'a' + 10);
+		}
+		else if(ch >= 'A' && ch <= 'F') {
+			handle = (handle << 4) | (ch - 'A' + 10);
+		}
+		else {
+			return 0;
+		}
+	}
+	return handle;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_atomic.h>
+#include "apt_lockfree_queue.h"
+
+/** Size of cache line used to keep producer and consumer positions apart */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Cell of the queue.
+ * The sequence number of the cell tells whether the cell is available
+ * for the producer (sequence == position) or for the consumer (sequence == position + 1).
+ */
+typedef struct {
+	volatile apr_uint32_t sequence;
+	void * volatile       obj;
+} apt_lockfree_cell_t;
+
+/**
+ * Bounded queue based on the array of sequenced cells.
+ * Producers and consumers claim positions by CAS and hand the cells over
+ * by updating their sequence numbers, so no thread ever blocks another one.
+ */
+struct apt_lockfree_queue_t {
+	apt_lockfree_cell_t  *cells;
+	apr_uint32_t          mask;
+	char                  pad0[CACHE_LINE_SIZE];
+	volatile apr_uint32_t push_pos;
+	char                  pad1[CACHE_LINE_SIZE];
+	volatile apr_uint32_t pop_pos;
+	char                  pad2[CACHE_LINE_SIZE];
+};
+
+
+APT_DECLARE(apt_lockfree_queue_t*) apt_lockfree_queue_create(apr_size_t size, apr_pool_t *pool)
+{
+	apr_uint32_t i;
+	apr_uint32_t capacity = 2;
+	apt_lockfree_queue_t *queue = apr_palloc(pool,sizeof(apt_lockfree_queue_t));
+	while(capacity < size && capacity < 0x80000000) {
+		capacity <<= 1;
+	}
+
+	queue->cells = apr_palloc(pool,sizeof(apt_lockfree_cell_t) * capacity);
+	for(i=0; i<capacity; i++) {
+		queue->cells[i].sequence = i;
+		queue->cells[i].obj = NULL;
+	}
+	queue->mask = capacity - 1;
+	queue->push_pos = 0;
+	queue->pop_pos = 0;
+	return queue;
+}
+
+APT_DECLARE(apt_bool_t) apt_lockfree_queue_push(apt_lockfree_queue_t *queue, void *obj)
+{
+	apt_lockfree_cell_t *cell;
+	apr_uint32_t sequence;
+	apr_uint32_t claimed;
+	apr_int32_t diff;
+	apr_uint32_t pos = apr_atomic_read32(&queue->push_pos);
+	for(;;) {
+		cell = &queue->cells[pos & queue->mask];
+		sequence = apr_atomic_read32(&cell->sequence);
+		diff = (apr_int32_t)(sequence - pos);
+		if(diff == 0) {
+			/* the cell is free, try to claim the position */
+			claimed = apr_atomic_cas32(&queue->push_pos,pos + 1,pos);
+			if(claimed == pos) {
+				break;
+			}
+			pos = claimed;
+		}
+		else if(diff < 0) {
+			/* the cell still holds an object pushed one round ago */
+			return FALSE;
+		}
+		else {
+			/* another producer has taken the position */
+			pos = apr_atomic_read32(&queue->push_pos);
+		}
+	}
+
+	cell->obj = obj;
+	/* publish the cell to consumers (full barrier) */
+	apr_atomic_xchg32(&cell->sequence,pos + 1);
+	return TRUE;
+}
+
+APT_DECLARE(void*) apt_lockfree_queue_pop(apt_lockfree_queue_t *queue)
+{
+	apt_lockfree_cell_t *cell;
+	apr_uint32_t sequence;
+	apr_uint32_t claimed;
+	apr_int32_t diff;
+	void *obj;
+	apr_uint32_t pos = apr_atomic_read32(&queue->pop_pos);
+	for(;;) {
+		cell = &queue->cells[pos & queue->mask];
+		sequence = apr_atomic_read32(&cell->sequence);
+		diff = (apr_int32_t)(sequence - (pos + 1));
+		if(diff == 0) {
+			/* the cell is published, try to claim the position */
+			claimed = apr_atomic_cas32(&queue->pop_pos,pos + 1,pos);
+			if(claimed == pos) {
+				break;
+			}
+			pos = claimed;
+		}
+		else if(diff < 0) {
+			/* nothing has been published yet */
+			return NULL;
+		}
+		else {
+			/* another consumer has taken the position */
+			pos = apr_atomic_read32(&queue->pop_pos);
+		}
+	}
+
+	obj = cell->obj;
+	/* release the cell to producers of the next round (full barrier) */
+	apr_atomic_xchg32(&cell->sequence,pos + queue->mask + 1);
+	return obj;
+}
+
+APT_DECLARE(apt_bool_t) apt_lockfree_queue_is_empty(const apt_lockfree_queue_t *queue)
+{
+	apr_uint32_t pos = queue->pop_pos;
+	apr_uint32_t sequence = queue->cells[pos & queue->mask].sequence;
+	return (sequence == pos + 1) ? FALSE : TRUE;
+}
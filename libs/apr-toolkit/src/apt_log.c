@@ -28,11 +28,14 @@
 #include <apr_portable.h>
 #include <apr_hash.h>
 #include <apr_xml.h>
+#include <apr_atomic.h>
+#include <apr_thread_proc.h>
 #include "apt_pool.h"
 #include "apt_log.h"
 
 #define MAX_LOG_ENTRY_SIZE 4096
 #define MAX_PRIORITY_NAME_LENGTH 9
+#define LOG_ASYNC_BATCH_SIZE (16 * 1024)
 
 static const char priority_snames[APT_PRIO_COUNT][MAX_PRIORITY_NAME_LENGTH+1] =
 {
@@ -50,6 +53,10 @@ typedef struct apt_log_file_data_t apt_log_file_data_t;
 typedef struct apt_log_file_settings_t apt_log_file_settings_t;
 typedef struct apt_log_file_entry_t apt_log_file_entry_t;
 typedef struct apt_syslog_settings_t apt_syslog_settings_t;
+typedef struct apt_log_async_settings_t apt_log_async_settings_t;
+typedef struct apt_log_record_t apt_log_record_t;
+typedef struct apt_log_ring_t apt_log_ring_t;
+typedef struct apt_log_async_t apt_log_async_t;
 
 struct apt_log_file_entry_t {
 	APR_RING_ENTRY(apt_log_file_entry_t) link;
@@ -62,6 +69,42 @@ struct apt_syslog_settings_t {
 	int                       facility;
 };
 
+struct apt_log_async_settings_t {
+	apt_bool_t                enable;
+	apr_size_t                ring_count;         /* number of ring buffers allocated at init */
+	apr_size_t                ring_size;          /* size of the ring buffer per thread in bytes */
+	apr_uint32_t              flush_interval;     /* interval to check the ring buffers at in msec */
+};
+
+/* header of the log entry placed into the ring buffer */
+struct apt_log_record_t {
+	apr_uint16_t              size;               /* size of the entry including terminating '\0' */
+	apr_uint16_t              data_offset;        /* offset of the message following the headers */
+	apr_uint32_t              priority;
+};
+
+/* ring buffer of log entries written by the owner thread and read by the writer thread */
+struct apt_log_ring_t {
+	char                     *buffer;
+	apr_uint32_t              size;               /* power of two */
+	volatile apr_uint32_t     head;               /* advanced by the owner thread */
+	volatile apr_uint32_t     tail;               /* advanced by the writer thread */
+	volatile apr_uint32_t     dropped;            /* number of entries not fit into the buffer */
+	volatile apr_uint32_t     owned;              /* whether the ring is owned by a thread */
+};
+
+struct apt_log_async_t {
+	apt_log_ring_t           *rings;              /* array of rings allocated once at init */
+	apr_size_t                ring_count;
+	apr_threadkey_t          *key;                /* key of the ring of the calling thread */
+	apr_thread_t             *thread;
+	volatile apr_uint32_t     running;
+	apr_uint32_t              ring_size;
+	apr_uint32_t              flush_interval;
+	apr_uint32_t              reported_drops;
+	char                     *batch;
+};
+
 struct apt_log_file_settings_t {
 	apt_bool_t                purge_existing;     
 	apr_size_t                max_age;            /* max age in seconds */
@@ -99,6 +142,10 @@ struct apt_logger_t {
 	apt_log_ext_handler_f     ext_handler;
 	apt_log_file_data_t      *file_data;
 	apt_bool_t                syslog;
+	apt_log_async_t          *async;              /* active async writer, NULL in sync mode */
+	apt_log_async_t          *async_data;         /* rings kept across disable and enable */
+	apt_bool_t                async_suspended;    /* async mode to be resumed on file reopen */
+	apr_pool_t               *pool;
 };
 
 static apt_logger_t *apt_logger = NULL;
@@ -115,6 +162,10 @@ static void apt_log_files_populate(apt_log_file_data_t *file_data);
 static void apt_log_file_entries_clear(apt_log_file_data_t *file_data);
 static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size);
 static apr_xml_doc* apt_log_doc_parse(const char *file_path, apr_pool_t *pool);
+static apr_size_t apt_log_entry_format(char *log_entry, const char *file, int line, apt_log_priority_e priority, apr_size_t *data_offset, const char *format, va_list arg_ptr);
+static void apt_log_entry_write(apt_log_priority_e priority, const char *log_entry, apr_size_t size, apr_size_t data_offset);
+static void apt_log_batch_write(const char *batch, apr_size_t size);
+static apt_bool_t apt_log_async_start(apt_log_async_t *async);
 
 static void apt_log_file_settings_init(apt_log_file_settings_t *settings)
 {
@@ -133,6 +184,10 @@ static apt_logger_t* apt_log_instance_alloc(apr_pool_t *pool)
 	logger->ext_handler = NULL;
 	logger->file_data = NULL;
 	logger->syslog = FALSE;
+	logger->async = NULL;
+	logger->async_data = NULL;
+	logger->async_suspended = FALSE;
+	logger->pool = pool;
 
 	/* Create hash for custom log sources */
 	logger->log_sources = apr_hash_make(pool);
@@ -199,6 +254,33 @@ static apt_bool_t apt_log_sources_load(const apr_xml_elem *sources_root, apr_poo
 	return TRUE;
 }
 
+static apt_bool_t apt_log_async_settings_load(apt_log_async_settings_t *settings, const apr_xml_elem *elem)
+{
+	const apr_xml_attr *attr;
+
+	for (attr = elem->attr; attr; attr = attr->next) {
+		if (strcasecmp(attr->name, "enable") == 0) {
+			if (strcasecmp(attr->value, "false") == 0) {
+				settings->enable = FALSE;
+			}
+			else if (strcasecmp(attr->value, "true") == 0) {
+				settings->enable = TRUE;
+			}
+		}
+		else if (strcasecmp(attr->name, "ring-count") == 0) {
+			settings->ring_count = atol(attr->value);
+		}
+		else if (strcasecmp(attr->name, "ring-size") == 0) {
+			settings->ring_size = atol(attr->value) * 1024;
+		}
+		else if (strcasecmp(attr->name, "flush-interval") == 0) {
+			settings->flush_interval = atol(attr->value);
+		}
+	}
+
+	return TRUE;
+}
+
 static apt_bool_t apt_log_file_settings_load(apt_log_file_settings_t *settings, const apr_xml_elem *elem, apr_pool_t *pool)
 {
 	const apr_xml_attr *attr;
@@ -235,12 +317,18 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 	const apr_xml_elem *elem;
 	const apr_xml_elem *root;
 	char *text;
+	apt_log_async_settings_t async_settings;
 
 	if(apt_logger) {
 		return FALSE;
 	}
 	apt_logger = apt_log_instance_alloc(pool);
 
+	async_settings.enable = FALSE;
+	async_settings.ring_count = LOG_ASYNC_RING_COUNT;
+	async_settings.ring_size = LOG_ASYNC_RING_SIZE;
+	async_settings.flush_interval = LOG_ASYNC_FLUSH_INTERVAL;
+
 	/* Parse XML document */
 	doc = apt_log_doc_parse(config_file,pool);
 	if(!doc) {
@@ -259,6 +347,11 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 
 	/* Navigate through document */
 	for(elem = root->first_child; elem; elem = elem->next) {
+		if(strcasecmp(elem->name,"async") == 0) {
+			apt_log_async_settings_load(&async_settings,elem);
+			continue;
+		}
+
 		if(!elem->first_cdata.first || !elem->first_cdata.first->text) 
 			continue;
 
@@ -284,6 +377,10 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 			/* Unknown element */
 		}
 	}
+
+	if(async_settings.enable == TRUE) {
+		apt_log_async_enable(async_settings.ring_count,async_settings.ring_size,async_settings.flush_interval);
+	}
 	return TRUE;
 }
 
@@ -293,10 +390,19 @@ APT_DECLARE(apt_bool_t) apt_log_instance_destroy()
 		return FALSE;
 	}
 
+	if(apt_logger->async) {
+		apt_log_async_disable();
+	}
+
 	if(apt_logger->file_data) {
 		apt_log_file_close();
 	}
 
+	if(apt_logger->async_data) {
+		apr_threadkey_private_delete(apt_logger->async_data->key);
+		apt_logger->async_data = NULL;
+	}
+
 	if (apt_logger->syslog == TRUE) {
 		apt_syslog_close();
 	}
@@ -449,6 +555,12 @@ static apt_bool_t apt_log_file_open_internal(const char *dir_path, const char *p
 	}
 
 	apt_logger->file_data = file_data;
+
+	if(apt_logger->async_suspended == TRUE) {
+		/* resume async mode suspended by apt_log_file_close() */
+		apt_logger->async_suspended = FALSE;
+		apt_log_async_start(apt_logger->async_data);
+	}
 	return TRUE;
 }
 
@@ -458,6 +570,12 @@ APT_DECLARE(apt_bool_t) apt_log_file_close()
 	if(!apt_logger || !apt_logger->file_data) {
 		return FALSE;
 	}
+	if(apt_logger->async) {
+		/* write out pending entries, the writer thread must not access the file being closed;
+		async mode is resumed once the file is reopened */
+		apt_log_async_disable();
+		apt_logger->async_suspended = TRUE;
+	}
 	file_data = apt_logger->file_data;
 	if(file_data->file) {
 		/* close log file */
@@ -837,12 +955,313 @@ static APR_INLINE unsigned long apt_thread_id_get(void)
 #endif
 }
 
+static void apt_log_ring_release(void *data)
+{
+	apt_log_ring_t *ring = data;
+	/* the owner thread exits, let another thread take the ring over */
+	apr_atomic_set32(&ring->owned,FALSE);
+}
+
+static apt_log_ring_t* apt_log_ring_get(apt_log_async_t *async)
+{
+	apr_size_t i;
+	void *data = NULL;
+	if(apr_threadkey_private_get(&data,async->key) == APR_SUCCESS && data) {
+		return data;
+	}
+
+	/* take over a free ring, either never used or released by an exited thread */
+	for(i = 0; i < async->ring_count; i++) {
+		if(apr_atomic_cas32(&async->rings[i].owned,TRUE,FALSE) == FALSE) {
+			apr_threadkey_private_set(&async->rings[i],async->key);
+			return &async->rings[i];
+		}
+	}
+	/* all the rings are in use, the caller logs synchronously */
+	return NULL;
+}
+
+static void apt_log_ring_write(apt_log_ring_t *ring, apr_uint32_t pos, const void *data, apr_size_t size)
+{
+	apr_size_t offset = pos & (ring->size - 1);
+	apr_size_t part = ring->size - offset;
+	if(part >= size) {
+		memcpy(ring->buffer + offset,data,size);
+	}
+	else {
+		memcpy(ring->buffer + offset,data,part);
+		memcpy(ring->buffer,(const char*)data + part,size - part);
+	}
+}
+
+static void apt_log_ring_read(const apt_log_ring_t *ring, apr_uint32_t pos, void *data, apr_size_t size)
+{
+	apr_size_t offset = pos & (ring->size - 1);
+	apr_size_t part = ring->size - offset;
+	if(part >= size) {
+		memcpy(data,ring->buffer + offset,size);
+	}
+	else {
+		memcpy(data,ring->buffer + offset,part);
+		memcpy((char*)data + part,ring->buffer,size - part);
+	}
+}
+
+static apt_bool_t apt_log_ring_push(apt_log_async_t *async, apt_log_priority_e priority, const char *log_entry, apr_size_t size, apr_size_t data_offset)
+{
+	apt_log_record_t record;
+	apr_uint32_t head;
+	apr_uint32_t tail;
+	apt_log_ring_t *ring = apt_log_ring_get(async);
+	if(!ring) {
+		apt_log_entry_write(priority,log_entry,size,data_offset);
+		return TRUE;
+	}
+
+	record.size = (apr_uint16_t)(size + 1);
+	record.data_offset = (apr_uint16_t)data_offset;
+	record.priority = priority;
+
+	head = ring->head;
+	tail = apr_atomic_read32(&ring->tail);
+	if(ring->size - (head - tail) < sizeof(record) + record.size) {
+		/* never block the calling thread, drop the entry instead */
+		apr_atomic_inc32(&ring->dropped);
+		return FALSE;
+	}
+
+	apt_log_ring_write(ring,head,&record,sizeof(record));
+	apt_log_ring_write(ring,head + sizeof(record),log_entry,record.size);
+	/* publish the entry to the writer thread (full barrier) */
+	apr_atomic_xchg32(&ring->head,head + sizeof(record) + record.size);
+	return TRUE;
+}
+
+static apr_size_t apt_log_entry_compose(char *log_entry, const char *file, int line, apt_log_priority_e priority, apr_size_t *data_offset, const char *format, ...)
+{
+	apr_size_t size;
+	va_list arg_ptr;
+	va_start(arg_ptr, format);
+	size = apt_log_entry_format(log_entry,file,line,priority,data_offset,format,arg_ptr);
+	va_end(arg_ptr);
+	return size;
+}
+
+static apr_size_t apt_log_async_drain(apt_log_async_t *async)
+{
+	char log_entry[MAX_LOG_ENTRY_SIZE];
+	apt_log_record_t record;
+	apt_log_ring_t *ring;
+	apr_uint32_t head;
+	apr_uint32_t tail;
+	apr_uint32_t dropped = 0;
+	apr_size_t batch_size = 0;
+	apr_size_t count = 0;
+	apr_size_t size;
+	apr_size_t data_offset;
+	apr_size_t i;
+
+	for(i = 0; i < async->ring_count; i++) {
+		ring = &async->rings[i];
+		head = apr_atomic_read32(&ring->head);
+		tail = ring->tail;
+		while(tail != head) {
+			apt_log_ring_read(ring,tail,&record,sizeof(record));
+			apt_log_ring_read(ring,tail + sizeof(record),log_entry,record.size);
+			tail += sizeof(record) + record.size;
+			count++;
+
+			/* write entries by batches, except for syslog taking them one by one */
+			size = record.size - 1;
+			if(batch_size + size > LOG_ASYNC_BATCH_SIZE) {
+				apt_log_batch_write(async->batch,batch_size);
+				batch_size = 0;
+			}
+			memcpy(async->batch + batch_size,log_entry,size);
+			batch_size += size;
+#ifndef WIN32
+			if((apt_logger->mode & APT_LOG_OUTPUT_SYSLOG) == APT_LOG_OUTPUT_SYSLOG) {
+				syslog(record.priority,"%s",log_entry + record.data_offset);
+			}
+#endif
+		}
+		/* hand the space over back to the owner thread (full barrier) */
+		apr_atomic_xchg32(&ring->tail,tail);
+		dropped += apr_atomic_read32(&ring->dropped);
+	}
+
+	if(batch_size) {
+		apt_log_batch_write(async->batch,batch_size);
+	}
+
+	if(dropped != async->reported_drops) {
+		size = apt_log_entry_compose(log_entry,__FILE__,__LINE__,APT_PRIO_WARNING,&data_offset,
+				"Dropped %u Log Entries on Ring Buffer Overflow",dropped - async->reported_drops);
+		apt_log_entry_write(APT_PRIO_WARNING,log_entry,size,data_offset);
+		async->reported_drops = dropped;
+	}
+	return count;
+}
+
+static void* APR_THREAD_FUNC apt_log_async_run(apr_thread_t *thread, void *data)
+{
+	apt_log_async_t *async = data;
+	apr_uint32_t running = TRUE;
+#if APR_HAS_SETTHREADNAME
+	apr_thread_name_set("Log Writer");
+#endif
+	while(running) {
+		/* check the flag prior to draining, so that no entry is left behind on exit */
+		running = apr_atomic_read32(&async->running);
+		if(!apt_log_async_drain(async) && running) {
+			apr_sleep(async->flush_interval * 1000);
+		}
+	}
+
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+static apt_bool_t apt_log_async_start(apt_log_async_t *async)
+{
+	async->running = TRUE;
+	if(apr_thread_create(&async->thread,NULL,apt_log_async_run,async,apt_logger->pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+	apt_logger->async = async;
+	return TRUE;
+}
+
+static apt_log_async_t* apt_log_async_create(apr_size_t ring_count, apr_uint32_t ring_size, apr_uint32_t flush_interval, apr_pool_t *pool)
+{
+	apr_size_t i;
+	apt_log_async_t *async = apr_palloc(pool,sizeof(apt_log_async_t));
+	async->ring_count = ring_count ? ring_count : LOG_ASYNC_RING_COUNT;
+	async->rings = apr_palloc(pool,sizeof(apt_log_ring_t) * async->ring_count);
+	async->key = NULL;
+	async->thread = NULL;
+	async->running = FALSE;
+	async->ring_size = ring_size;
+	async->flush_interval = flush_interval ? flush_interval : LOG_ASYNC_FLUSH_INTERVAL;
+	async->reported_drops = 0;
+	async->batch = apr_palloc(pool,LOG_ASYNC_BATCH_SIZE);
+
+	/* allocate all the rings at once, no allocation takes place on the logging path */
+	for(i = 0; i < async->ring_count; i++) {
+		async->rings[i].buffer = apr_palloc(pool,ring_size);
+		async->rings[i].size = ring_size;
+		async->rings[i].head = 0;
+		async->rings[i].tail = 0;
+		async->rings[i].dropped = 0;
+		async->rings[i].owned = FALSE;
+	}
+
+	if(apr_threadkey_private_create(&async->key,apt_log_ring_release,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	return async;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_async_enable(apr_size_t ring_count, apr_size_t ring_size, apr_uint32_t flush_interval)
+{
+	apt_log_async_t *async;
+	apr_uint32_t size = MAX_LOG_ENTRY_SIZE;
+	if(!apt_logger || apt_logger->async) {
+		return FALSE;
+	}
+
+	/* round up to a power of two, which fits at least a couple of entries of max size */
+	while((size < ring_size || size < 2 * (sizeof(apt_log_record_t) + MAX_LOG_ENTRY_SIZE)) && size < 0x10000000) {
+		size <<= 1;
+	}
+
+	async = apt_logger->async_data;
+	if(async && async->ring_size == size && (!ring_count || async->ring_count == ring_count)) {
+		/* reuse the rings allocated by the previous enable */
+		if(flush_interval) {
+			async->flush_interval = flush_interval;
+		}
+	}
+	else {
+		if(async) {
+			/* threads may still refer to the rings by the key, leave the old rings allocated */
+			apr_threadkey_private_delete(async->key);
+			apt_logger->async_data = NULL;
+		}
+		async = apt_log_async_create(ring_count,size,flush_interval,apt_logger->pool);
+		if(!async) {
+			return FALSE;
+		}
+		apt_logger->async_data = async;
+	}
+
+	apt_logger->async_suspended = FALSE;
+	return apt_log_async_start(async);
+}
+
+APT_DECLARE(apt_bool_t) apt_log_async_disable(void)
+{
+	apt_log_async_t *async;
+	apr_status_t rv;
+	if(!apt_logger) {
+		return FALSE;
+	}
+
+	apt_logger->async_suspended = FALSE;
+	if(!apt_logger->async) {
+		return FALSE;
+	}
+
+	async = apt_logger->async;
+	/* log synchronously from now on */
+	apt_logger->async = NULL;
+
+	apr_atomic_set32(&async->running,FALSE);
+	apr_thread_join(&rv,async->thread);
+	async->thread = NULL;
+
+	/* write out entries pushed by threads which picked the async writer up before
+	it was reset and completed the push after the last drain of the writer thread */
+	apt_log_async_drain(async);
+	return TRUE;
+}
+
+APT_DECLARE(apr_uint32_t) apt_log_async_drop_count_get(void)
+{
+	apt_log_async_t *async;
+	apr_uint32_t dropped = 0;
+	apr_size_t i;
+	if(!apt_logger || !apt_logger->async_data) {
+		return 0;
+	}
+
+	async = apt_logger->async_data;
+	for(i = 0; i < async->ring_count; i++) {
+		dropped += apr_atomic_read32(&async->rings[i].dropped);
+	}
+	return dropped;
+}
+
 static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int line, apt_log_priority_e priority, const char *format, va_list arg_ptr)
 {
 	char log_entry[MAX_LOG_ENTRY_SIZE];
+	apr_size_t size;
+	apr_size_t data_offset;
+	apt_log_async_t *async = apt_logger->async;
+
+	size = apt_log_entry_format(log_entry,file,line,priority,&data_offset,format,arg_ptr);
+	if(async) {
+		return apt_log_ring_push(async,priority,log_entry,size,data_offset);
+	}
+
+	apt_log_entry_write(priority,log_entry,size,data_offset);
+	return TRUE;
+}
+
+static apr_size_t apt_log_entry_format(char *log_entry, const char *file, int line, apt_log_priority_e priority, apr_size_t *data_offset, const char *format, va_list arg_ptr)
+{
 	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
 	apr_size_t offset = 0;
-	apr_size_t data_offset;
 	apr_time_exp_t result;
 	apr_time_t now = apr_time_now();
 	apr_time_exp_lt(&result,now);
@@ -871,24 +1290,33 @@ static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int
 		offset += MAX_PRIORITY_NAME_LENGTH;
 	}
 
-	data_offset = offset;
+	*data_offset = offset;
 	offset += apr_vsnprintf(log_entry+offset,max_size-offset,format,arg_ptr);
 	log_entry[offset++] = '\n';
 	log_entry[offset] = '\0';
-	if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
-		fwrite(log_entry,offset,1,stdout);
-	}
-	
-	if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
-		apt_log_file_dump(apt_logger->file_data,log_entry,offset);
-	}
+	return offset;
+}
+
+static void apt_log_entry_write(apt_log_priority_e priority, const char *log_entry, apr_size_t size, apr_size_t data_offset)
+{
+	apt_log_batch_write(log_entry,size);
 
 #ifndef WIN32
 	if((apt_logger->mode & APT_LOG_OUTPUT_SYSLOG) == APT_LOG_OUTPUT_SYSLOG) {
 		syslog(priority,"%s",log_entry + data_offset);
 	}
 #endif
-	return TRUE;
+}
+
+static void apt_log_batch_write(const char *batch, apr_size_t size)
+{
+	if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
+		fwrite(batch,size,1,stdout);
+	}
+	
+	if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
+		apt_log_file_dump(apt_logger->file_data,batch,size);
+	}
 }
 
 static apt_bool_t apt_log_file_create(apt_log_file_data_t *file_data)
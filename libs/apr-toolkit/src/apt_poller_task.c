@@ -21,6 +21,9 @@
 #include "apt_log.h"
 
 
+/** Resolution of the timers of the poller task in msec */
+#define POLLER_TIMER_RESOLUTION 10
+
 /** Poller task */
 struct apt_poller_task_t {
 	apr_pool_t         *pool;
@@ -89,7 +92,7 @@ APT_DECLARE(apt_poller_task_t*) apt_poller_task_create(
 	task->msg_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
 	apr_thread_mutex_create(&task->guard,APR_THREAD_MUTEX_UNNESTED,pool);
 
-	task->timer_queue = apt_timer_queue_create(pool);
+	task->timer_queue = apt_timer_queue_create_ex(APT_TIMER_QUEUE_WHEEL,POLLER_TIMER_RESOLUTION,pool);
 	task->desc_arr = NULL;
 	task->desc_count = 0;
 	task->desc_index = 0;
@@ -64,3 +64,36 @@ APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t tabl
 	/* no match found, return invalid id */
 	return size;
 }
+
+/* Find the id associated with a given string using the perfect hash of the table */
+APT_DECLARE(apr_size_t) apt_string_table_hash_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_table_hash_t *hash, const apt_str_t *value)
+{
+	apr_size_t id;
+	if(!hash) {
+		return apt_string_table_id_find(table,size,value);
+	}
+
+	/* the only candidate is the item the bucket refers to, compare whole strings once */
+	id = hash->buckets[apt_string_table_hash(value,hash->seed) & hash->mask];
+	if(id && id <= size && apt_string_compare(&table[id-1].value,value) == TRUE) {
+		return id - 1;
+	}
+
+	/* no match found, return invalid id */
+	return size;
+}
+
+/* Calculate case-insensitive hash of a given string (seeded FNV-1a) */
+APT_DECLARE(apr_uint32_t) apt_string_table_hash(const apt_str_t *value, apr_uint32_t seed)
+{
+	apr_uint32_t hash = 2166136261U ^ seed;
+	const unsigned char *pos = (const unsigned char*)value->buf;
+	const unsigned char *end = pos + value->length;
+	for(; pos < end; pos++) {
+		/* fold the case of letters, other characters may only collide, but never mismatch */
+		hash ^= *pos | 0x20;
+		hash *= 16777619U;
+	}
+	hash ^= hash >> 16;
+	return hash;
+}
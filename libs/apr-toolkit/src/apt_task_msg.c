@@ -15,7 +15,17 @@
  */
 
 #include <stdlib.h>
+#include <apr_general.h>
+#include <apr_atomic.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
 #include "apt_task_msg.h"
+#include "apt_pool.h"
+
+/** Max number of messages cached per thread */
+#define MSG_CACHE_SIZE   32
+/** Number of messages moved between the thread cache and the shared list at once */
+#define MSG_CACHE_BATCH  (MSG_CACHE_SIZE / 2)
 
 /** Abstract pool of task messages to allocate task messages from */
 struct apt_task_msg_pool_t {
@@ -26,6 +36,11 @@ struct apt_task_msg_pool_t {
 
 	void       *obj;
 	apr_pool_t *pool;
+
+	/** Number of acquired and not released yet messages */
+	volatile apr_uint32_t outstanding;
+	/** Max number of outstanding messages */
+	volatile apr_uint32_t peak;
 };
 
 
@@ -69,14 +84,229 @@ APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_dynamic(apr_size_t ms
 	task_msg_pool->acquire_msg = dynamic_pool_acquire_msg;
 	task_msg_pool->release_msg = dynamic_pool_release_msg;
 	task_msg_pool->destroy = dynamic_pool_destroy;
+	task_msg_pool->outstanding = 0;
+	task_msg_pool->peak = 0;
 	return task_msg_pool;
 }
 
 
-/** Static allocation of messages from message pool (not implemented yet) */
+/** Static allocation of messages from message pool */
+typedef struct apt_msg_pool_static_t apt_msg_pool_static_t;
+typedef struct apt_msg_slot_t apt_msg_slot_t;
+typedef struct apt_msg_cache_t apt_msg_cache_t;
+
+/** Slot holding a message, which is linked to a free list while not acquired */
+struct apt_msg_slot_t {
+	apt_msg_slot_t *next;
+	apt_task_msg_t  msg;
+};
+
+/** Free list of messages owned by a thread */
+struct apt_msg_cache_t {
+	apt_msg_pool_static_t *static_pool;
+	apt_msg_cache_t       *next;
+	apt_msg_slot_t        *head;
+	apr_size_t             count;
+};
+
+struct apt_msg_pool_static_t {
+	apt_task_msg_pool_t *task_msg_pool;
+	/** Size of the slot */
+	apr_size_t           size;
+	/** Number of messages allocated at once, when the pool is exhausted */
+	apr_size_t           grow_count;
+	/** Key of the cache of the calling thread */
+	apr_threadkey_t     *key;
+	/** Guards the shared list and allocations from the pool */
+	apr_thread_mutex_t  *guard;
+	/** Shared list of messages overflowed thread caches */
+	apt_msg_slot_t      *head;
+	/** Caches released by exited threads */
+	apt_msg_cache_t     *free_caches;
+	/** Total number of allocated messages */
+	apr_size_t           allocated;
+	/** Pool messages are allocated from */
+	apr_pool_t          *pool;
+};
+
+#define APT_MSG_SLOT(task_msg) ((apt_msg_slot_t*)((char*)(task_msg) - APR_OFFSETOF(apt_msg_slot_t,msg)))
+
+/** Allocate messages linking them to the shared list (guard must be locked) */
+static void static_pool_grow(apt_msg_pool_static_t *static_pool, apr_size_t count)
+{
+	apr_size_t i;
+	apt_msg_slot_t *slot;
+	char *block = apr_palloc(static_pool->pool,static_pool->size * count);
+	for(i=0; i<count; i++) {
+		slot = (apt_msg_slot_t*)(block + i * static_pool->size);
+		slot->msg.msg_pool = static_pool->task_msg_pool;
+		slot->next = static_pool->head;
+		static_pool->head = slot;
+	}
+	static_pool->allocated += count;
+}
+
+static void static_pool_cache_release(void *data)
+{
+	apt_msg_cache_t *cache = data;
+	apt_msg_pool_static_t *static_pool = cache->static_pool;
+	apt_msg_slot_t *slot;
+
+	/* the thread exits, return the cached messages and the cache itself */
+	apr_thread_mutex_lock(static_pool->guard);
+	while(cache->head) {
+		slot = cache->head;
+		cache->head = slot->next;
+		slot->next = static_pool->head;
+		static_pool->head = slot;
+	}
+	cache->count = 0;
+	cache->next = static_pool->free_caches;
+	static_pool->free_caches = cache;
+	apr_thread_mutex_unlock(static_pool->guard);
+}
+
+static apt_msg_cache_t* static_pool_cache_get(apt_msg_pool_static_t *static_pool)
+{
+	apt_msg_cache_t *cache = NULL;
+	void *data = NULL;
+	if(apr_threadkey_private_get(&data,static_pool->key) == APR_SUCCESS && data) {
+		return data;
+	}
+
+	apr_thread_mutex_lock(static_pool->guard);
+	if(static_pool->free_caches) {
+		cache = static_pool->free_caches;
+		static_pool->free_caches = cache->next;
+	}
+	else {
+		cache = apr_palloc(static_pool->pool,sizeof(apt_msg_cache_t));
+	}
+	apr_thread_mutex_unlock(static_pool->guard);
+
+	cache->static_pool = static_pool;
+	cache->next = NULL;
+	cache->head = NULL;
+	cache->count = 0;
+	apr_threadkey_private_set(cache,static_pool->key);
+	return cache;
+}
+
+static apt_task_msg_t* static_pool_acquire_msg(apt_task_msg_pool_t *task_msg_pool)
+{
+	apt_msg_pool_static_t *static_pool = task_msg_pool->obj;
+	apt_msg_cache_t *cache = static_pool_cache_get(static_pool);
+	apt_msg_slot_t *slot;
+	if(!cache->head) {
+		/* refill the cache from the shared list, allocating more messages if needed */
+		apr_thread_mutex_lock(static_pool->guard);
+		while(cache->count < MSG_CACHE_BATCH) {
+			if(!static_pool->head) {
+				static_pool_grow(static_pool,static_pool->grow_count);
+			}
+			slot = static_pool->head;
+			static_pool->head = slot->next;
+			slot->next = cache->head;
+			cache->head = slot;
+			cache->count++;
+		}
+		apr_thread_mutex_unlock(static_pool->guard);
+	}
+
+	slot = cache->head;
+	cache->head = slot->next;
+	cache->count--;
+
+	slot->msg.type = TASK_MSG_USER;
+	slot->msg.sub_type = 0;
+	return &slot->msg;
+}
+
+static void static_pool_release_msg(apt_task_msg_t *task_msg)
+{
+	apt_msg_pool_static_t *static_pool = task_msg->msg_pool->obj;
+	apt_msg_cache_t *cache = static_pool_cache_get(static_pool);
+	apt_msg_slot_t *slot = APT_MSG_SLOT(task_msg);
+	apt_msg_slot_t *first;
+	apr_size_t i;
+
+	slot->next = cache->head;
+	cache->head = slot;
+	cache->count++;
+	if(cache->count > MSG_CACHE_SIZE) {
+		/* the thread releases more than acquires, move a batch to the shared list */
+		first = cache->head;
+		for(i=1; i<MSG_CACHE_BATCH; i++) {
+			slot = slot->next;
+		}
+		cache->head = slot->next;
+		cache->count -= MSG_CACHE_BATCH;
+
+		apr_thread_mutex_lock(static_pool->guard);
+		slot->next = static_pool->head;
+		static_pool->head = first;
+		apr_thread_mutex_unlock(static_pool->guard);
+	}
+}
+
+static void static_pool_destroy(apt_task_msg_pool_t *task_msg_pool)
+{
+	apt_msg_pool_static_t *static_pool = task_msg_pool->obj;
+	if(static_pool->key) {
+		apr_threadkey_private_delete(static_pool->key);
+		static_pool->key = NULL;
+	}
+	if(static_pool->guard) {
+		apr_thread_mutex_destroy(static_pool->guard);
+		static_pool->guard = NULL;
+	}
+}
+
+static apr_status_t static_pool_cleanup(void *data)
+{
+	/* the key must not outlive the pool, thread exit would otherwise access freed caches */
+	static_pool_destroy(data);
+	return APR_SUCCESS;
+}
+
 APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_static(apr_size_t msg_size, apr_size_t pool_size, apr_pool_t *pool)
 {
-	return NULL;
+	apt_task_msg_pool_t *task_msg_pool = apr_palloc(pool,sizeof(apt_task_msg_pool_t));
+	apt_msg_pool_static_t *static_pool = apr_palloc(pool,sizeof(apt_msg_pool_static_t));
+	apr_size_t size = APR_OFFSETOF(apt_msg_slot_t,msg) + sizeof(apt_task_msg_t) - 1 + msg_size;
+
+	static_pool->task_msg_pool = task_msg_pool;
+	static_pool->size = APR_ALIGN_DEFAULT(size);
+	static_pool->grow_count = pool_size > MSG_CACHE_BATCH ? pool_size : MSG_CACHE_BATCH;
+	static_pool->key = NULL;
+	static_pool->guard = NULL;
+	static_pool->head = NULL;
+	static_pool->free_caches = NULL;
+	static_pool->allocated = 0;
+	/* messages are allocated by arbitrary threads, never touch the parent pool */
+	static_pool->pool = apt_subpool_create(pool);
+
+	task_msg_pool->pool = pool;
+	task_msg_pool->obj = static_pool;
+	task_msg_pool->acquire_msg = static_pool_acquire_msg;
+	task_msg_pool->release_msg = static_pool_release_msg;
+	task_msg_pool->destroy = static_pool_destroy;
+	task_msg_pool->outstanding = 0;
+	task_msg_pool->peak = 0;
+
+	if(apr_thread_mutex_create(&static_pool->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_threadkey_private_create(&static_pool->key,static_pool_cache_release,pool) != APR_SUCCESS) {
+		apr_thread_mutex_destroy(static_pool->guard);
+		return NULL;
+	}
+	apr_pool_cleanup_register(static_pool->pool,task_msg_pool,static_pool_cleanup,apr_pool_cleanup_null);
+
+	if(pool_size) {
+		static_pool_grow(static_pool,pool_size);
+	}
+	return task_msg_pool;
 }
 
 
@@ -90,14 +320,41 @@ APT_DECLARE(void) apt_task_msg_pool_destroy(apt_task_msg_pool_t *msg_pool)
 
 APT_DECLARE(apt_task_msg_t*) apt_task_msg_acquire(apt_task_msg_pool_t *task_msg_pool)
 {
+	apr_uint32_t outstanding;
+	apr_uint32_t peak;
 	if(!task_msg_pool->acquire_msg)
 		return NULL;
+
+	outstanding = apr_atomic_inc32(&task_msg_pool->outstanding) + 1;
+	peak = apr_atomic_read32(&task_msg_pool->peak);
+	while(outstanding > peak) {
+		peak = apr_atomic_cas32(&task_msg_pool->peak,outstanding,peak);
+	}
 	return task_msg_pool->acquire_msg(task_msg_pool);
 }
 
 APT_DECLARE(void) apt_task_msg_release(apt_task_msg_t *task_msg)
 {
 	apt_task_msg_pool_t *task_msg_pool = task_msg->msg_pool;
-	if(task_msg_pool->release_msg)
+	if(task_msg_pool->release_msg) {
 		task_msg_pool->release_msg(task_msg);
+		apr_atomic_dec32(&task_msg_pool->outstanding);
+	}
+}
+
+APT_DECLARE(void) apt_task_msg_pool_stat_get(apt_task_msg_pool_t *task_msg_pool, apt_task_msg_pool_stat_t *stat)
+{
+	stat->outstanding = apr_atomic_read32(&task_msg_pool->outstanding);
+	stat->peak = apr_atomic_read32(&task_msg_pool->peak);
+	stat->allocated = 0;
+	if(task_msg_pool->destroy == static_pool_destroy) {
+		apt_msg_pool_static_t *static_pool = task_msg_pool->obj;
+		apr_thread_mutex_lock(static_pool->guard);
+		stat->allocated = static_pool->allocated;
+		apr_thread_mutex_unlock(static_pool->guard);
+	}
+	else {
+		/* every outstanding message is allocated individually */
+		stat->allocated = stat->outstanding;
+	}
 }
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <apr_atomic.h>
 #include "apt_text_message.h"
 #include "apt_log.h"
 
@@ -25,6 +27,26 @@ typedef enum {
 } apt_message_stage_e;
 
 
+/** Reference counted buffer */
+struct apt_message_buffer_t {
+	volatile apr_uint32_t ref_count;
+	apr_size_t            size;
+	char                 *data;
+};
+
+typedef struct apt_message_buffer_ref_t apt_message_buffer_ref_t;
+
+/** Reference to a buffer held by a parsed message */
+struct apt_message_buffer_ref_t {
+	apt_message_buffer_t     *buffer;
+	apt_message_buffer_ref_t *next;
+};
+
+/** References to the buffers a parsed message refers to */
+struct apt_message_buffer_refs_t {
+	apt_message_buffer_ref_t * volatile head;
+};
+
 /** Text message parser */
 struct apt_message_parser_t {
 	const apt_message_parser_vtable_t *vtable;
@@ -35,6 +57,12 @@ struct apt_message_parser_t {
 	apt_message_stage_e                stage;
 	apt_bool_t                         skip_lf;
 	apt_bool_t                         verbose;
+	/** Buffer streams lie in (zero-copy mode) */
+	apt_message_buffer_t              *buffer;
+	/** Buffer already referenced by the message being parsed */
+	apt_message_buffer_t              *referenced_buffer;
+	/** References held by the message being parsed */
+	apt_message_buffer_refs_t         *refs;
 };
 
 /** Text message generator */
@@ -48,8 +76,8 @@ struct apt_message_generator_t {
 	apt_bool_t                            verbose;
 };
 
-/** Parse individual header field (name-value pair) */
-APT_DECLARE(apt_header_field_t*) apt_header_field_parse(apt_text_stream_t *stream, apr_pool_t *pool)
+/** Parse individual header field (name-value pair), optionally referring to the stream */
+static apt_header_field_t* apt_header_field_parse_internal(apt_text_stream_t *stream, apt_bool_t zero_copy, apr_pool_t *pool)
 {
 	apr_size_t folding_length = 0;
 	apr_array_header_t *folded_lines = NULL;
@@ -86,6 +114,13 @@ APT_DECLARE(apt_header_field_t*) apt_header_field_parse(apt_text_stream_t *strea
 	}
 
 	header_field = apt_header_field_alloc(pool);
+	if(zero_copy == TRUE && !folding_length) {
+		/* refer to the stream, the name and value are terminated once the entire section is read */
+		header_field->name = pair.name;
+		header_field->value = pair.value;
+		return header_field;
+	}
+
 	/* copy parsed name of the header field */
 	header_field->name.length = pair.name.length;
 	header_field->name.buf = apr_palloc(pool, pair.name.length + 1);
@@ -117,20 +152,26 @@ APT_DECLARE(apt_header_field_t*) apt_header_field_parse(apt_text_stream_t *strea
 	return header_field;
 }
 
+/** Parse individual header field (name-value pair) */
+APT_DECLARE(apt_header_field_t*) apt_header_field_parse(apt_text_stream_t *stream, apr_pool_t *pool)
+{
+	return apt_header_field_parse_internal(stream,FALSE,pool);
+}
+
 /** Generate individual header field (name-value pair) */
 APT_DECLARE(apt_bool_t) apt_header_field_generate(const apt_header_field_t *header_field, apt_text_stream_t *stream)
 {
 	return apt_text_name_value_insert(stream,&header_field->name,&header_field->value);
 }
 
-/** Parse header section */
-APT_DECLARE(apt_bool_t) apt_header_section_parse(apt_header_section_t *header, apt_text_stream_t *stream, apr_pool_t *pool)
+/** Parse header section, optionally referring to the stream */
+static apt_bool_t apt_header_section_parse_internal(apt_header_section_t *header, apt_text_stream_t *stream, apt_bool_t zero_copy, apr_pool_t *pool)
 {
 	apt_header_field_t *header_field;
 	apt_bool_t result = FALSE;
 
 	do {
-		header_field = apt_header_field_parse(stream,pool);
+		header_field = apt_header_field_parse_internal(stream,zero_copy,pool);
 		if(header_field) {
 			if(apt_string_is_empty(&header_field->name) == FALSE) {
 				/* normal header */
@@ -151,6 +192,28 @@ APT_DECLARE(apt_bool_t) apt_header_section_parse(apt_header_section_t *header, a
 	return result;
 }
 
+/** Parse header section */
+APT_DECLARE(apt_bool_t) apt_header_section_parse(apt_header_section_t *header, apt_text_stream_t *stream, apr_pool_t *pool)
+{
+	return apt_header_section_parse_internal(header,stream,FALSE,pool);
+}
+
+/** Terminate names and values of header fields referring to the stream */
+static void apt_header_section_terminate(apt_header_section_t *header)
+{
+	apt_header_field_t *header_field;
+	for(header_field = APR_RING_FIRST(&header->ring);
+			header_field != APR_RING_SENTINEL(&header->ring, apt_header_field_t, link);
+				header_field = APR_RING_NEXT(header_field, link)) {
+		/* the name is followed by ':' and the value by <CR> or <LF>, which are already consumed */
+		header_field->name.buf[header_field->name.length] = '\0';
+		if(!header_field->value.buf) {
+			header_field->value.buf = header_field->name.buf + header_field->name.length;
+		}
+		header_field->value.buf[header_field->value.length] = '\0';
+	}
+}
+
 /** Generate header section */
 APT_DECLARE(apt_bool_t) apt_header_section_generate(const apt_header_section_t *header, apt_text_stream_t *stream)
 {
@@ -238,9 +301,38 @@ APT_DECLARE(apt_message_parser_t*) apt_message_parser_create(void *obj, const ap
 	parser->stage = APT_MESSAGE_STAGE_START_LINE;
 	parser->skip_lf = FALSE;
 	parser->verbose = FALSE;
+	parser->buffer = NULL;
+	parser->referenced_buffer = NULL;
+	parser->refs = NULL;
 	return parser;
 }
 
+static apr_status_t apt_message_buffer_refs_cleanup(void *data)
+{
+	apt_message_buffer_refs_release(data);
+	return APR_SUCCESS;
+}
+
+/** Make the message being parsed hold a reference to the current buffer */
+static void apt_message_parser_buffer_reference(apt_message_parser_t *parser)
+{
+	apt_message_buffer_ref_t *ref;
+	if(parser->buffer && parser->buffer != parser->referenced_buffer) {
+		if(!parser->refs) {
+			/* references left by the time the pool is destroyed are released then */
+			parser->refs = apr_palloc(parser->pool,sizeof(apt_message_buffer_refs_t));
+			parser->refs->head = NULL;
+			apr_pool_cleanup_register(parser->pool,parser->refs,apt_message_buffer_refs_cleanup,apr_pool_cleanup_null);
+		}
+		ref = apr_palloc(parser->pool,sizeof(apt_message_buffer_ref_t));
+		ref->buffer = parser->buffer;
+		ref->next = parser->refs->head;
+		apt_message_buffer_ref(ref->buffer);
+		parser->refs->head = ref;
+		parser->referenced_buffer = parser->buffer;
+	}
+}
+
 static APR_INLINE void apt_crlf_segmentation_test(apt_message_parser_t *parser, apt_text_stream_t *stream)
 {
 	/* in the worst case message segmentation may occur between <CR> and <LF> */
@@ -267,6 +359,8 @@ APT_DECLARE(apt_message_status_e) apt_message_parser_run(apt_message_parser_t *p
 	do {
 		pos = stream->pos;
 		if(parser->stage == APT_MESSAGE_STAGE_START_LINE) {
+			parser->referenced_buffer = NULL;
+			parser->refs = NULL;
 			if(parser->vtable->on_start(parser,&parser->context,stream,parser->pool) == FALSE) {
 				if(apt_text_is_eos(stream) == FALSE) {
 					status = APT_MESSAGE_STATUS_INVALID;
@@ -281,7 +375,14 @@ APT_DECLARE(apt_message_status_e) apt_message_parser_run(apt_message_parser_t *p
 
 		if(parser->stage == APT_MESSAGE_STAGE_HEADER) {
 			/* read header section */
-			apt_bool_t res = apt_header_section_parse(parser->context.header,stream,parser->pool);
+			apt_bool_t res;
+			if(parser->buffer) {
+				apt_message_parser_buffer_reference(parser);
+				res = apt_header_section_parse_internal(parser->context.header,stream,TRUE,parser->pool);
+			}
+			else {
+				res = apt_header_section_parse(parser->context.header,stream,parser->pool);
+			}
 			if(parser->verbose == TRUE) {
 				apr_size_t length = stream->pos - pos;
 				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Parsed Message Header [%"APR_SIZE_T_FMT" bytes]\n%.*s",
@@ -294,6 +395,10 @@ APT_DECLARE(apt_message_status_e) apt_message_parser_run(apt_message_parser_t *p
 				break;
 			}
 
+			if(parser->buffer) {
+				apt_header_section_terminate(parser->context.header);
+			}
+
 			if(parser->vtable->on_header_complete) {
 				if(parser->vtable->on_header_complete(parser,&parser->context) == FALSE) {
 					status = APT_MESSAGE_STATUS_INVALID;
@@ -301,7 +406,31 @@ APT_DECLARE(apt_message_status_e) apt_message_parser_run(apt_message_parser_t *p
 				}
 			}
 			
-			if(parser->context.body && parser->context.body->length) {
+			if(parser->context.body && parser->context.body->length && parser->buffer &&
+				parser->context.body->length <= (apr_size_t)(stream->end - stream->pos)) {
+				/* entire body is available, refer to the stream */
+				apt_str_t *body = parser->context.body;
+				apt_message_parser_buffer_reference(parser);
+				body->buf = stream->pos;
+				stream->pos += body->length;
+				if(parser->verbose == TRUE) {
+					apr_size_t length = body->length;
+					const char *masked_data = apt_log_data_mask(body->buf,&length,parser->pool);
+					apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Parsed Message Body [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+							body->length, length, masked_data);
+				}
+
+				if(parser->vtable->on_body_complete) {
+					parser->vtable->on_body_complete(parser,&parser->context);
+				}
+				status = APT_MESSAGE_STATUS_COMPLETE;
+				if(message) {
+					*message = parser->context.message;
+				}
+				parser->stage = APT_MESSAGE_STAGE_START_LINE;
+				break;
+			}
+			else if(parser->context.body && parser->context.body->length) {
 				apt_str_t *body = parser->context.body;
 				parser->content_length = body->length;
 				body->buf = apr_palloc(parser->pool,parser->content_length+1);
@@ -352,6 +481,144 @@ APT_DECLARE(void) apt_message_parser_verbose_set(apt_message_parser_t *parser, a
 	parser->verbose = verbose;
 }
 
+/** Set the buffer to parse messages over in zero-copy mode */
+APT_DECLARE(void) apt_message_parser_buffer_set(apt_message_parser_t *parser, apt_message_buffer_t *buffer)
+{
+	parser->buffer = buffer;
+}
+
+
+/** Get references to the buffers the message last parsed refers to */
+APT_DECLARE(apt_message_buffer_refs_t*) apt_message_parser_buffer_refs_get(const apt_message_parser_t *parser)
+{
+	return parser->refs;
+}
+
+/** Release references to the buffers a parsed message refers to */
+APT_DECLARE(void) apt_message_buffer_refs_release(apt_message_buffer_refs_t *refs)
+{
+	apt_message_buffer_ref_t *ref;
+	if(!refs) {
+		return;
+	}
+
+	/* take the references over at once, so that they are released only once */
+	ref = apr_atomic_xchgptr((volatile void**)&refs->head,NULL);
+	while(ref) {
+		apt_message_buffer_unref(ref->buffer);
+		ref = ref->next;
+	}
+}
+
+/** Transfer references to the buffers a parsed message refers to to another pool */
+APT_DECLARE(apt_message_buffer_refs_t*) apt_message_buffer_refs_transfer(apt_message_buffer_refs_t *refs, apr_pool_t *pool)
+{
+	apt_message_buffer_refs_t *transferred_refs;
+	apt_message_buffer_ref_t *transferred_ref;
+	apt_message_buffer_ref_t *ref;
+	if(!refs) {
+		return NULL;
+	}
+
+	/* take the references over at once, the ones of the parser pool are left empty */
+	ref = apr_atomic_xchgptr((volatile void**)&refs->head,NULL);
+	if(!ref) {
+		return NULL;
+	}
+
+	transferred_refs = apr_palloc(pool,sizeof(apt_message_buffer_refs_t));
+	transferred_refs->head = NULL;
+	/* nodes are copied, since the ones taken over are allocated from the pool of the parser */
+	for(; ref; ref = ref->next) {
+		transferred_ref = apr_palloc(pool,sizeof(apt_message_buffer_ref_t));
+		transferred_ref->buffer = ref->buffer;
+		transferred_ref->next = transferred_refs->head;
+		transferred_refs->head = transferred_ref;
+	}
+	apr_pool_cleanup_register(pool,transferred_refs,apt_message_buffer_refs_cleanup,apr_pool_cleanup_null);
+	return transferred_refs;
+}
+
+/** Create reference counted buffer */
+APT_DECLARE(apt_message_buffer_t*) apt_message_buffer_create(apr_size_t size)
+{
+	/* the buffer is not allocated from a pool, since it may outlive the creator */
+	apt_message_buffer_t *buffer = malloc(sizeof(apt_message_buffer_t) + size + 1);
+	if(!buffer) {
+		return NULL;
+	}
+	buffer->ref_count = 1;
+	buffer->size = size;
+	buffer->data = (char*)(buffer + 1);
+	buffer->data[0] = '\0';
+	return buffer;
+}
+
+/** Add reference to the buffer */
+APT_DECLARE(void) apt_message_buffer_ref(apt_message_buffer_t *buffer)
+{
+	apr_atomic_inc32(&buffer->ref_count);
+}
+
+/** Remove reference from the buffer */
+APT_DECLARE(void) apt_message_buffer_unref(apt_message_buffer_t *buffer)
+{
+	if(apr_atomic_dec32(&buffer->ref_count) == 0) {
+		free(buffer);
+	}
+}
+
+/** Query whether the buffer is referenced by anyone else but the caller */
+APT_DECLARE(apt_bool_t) apt_message_buffer_is_shared(const apt_message_buffer_t *buffer)
+{
+	return apr_atomic_read32((volatile apr_uint32_t*)&buffer->ref_count) > 1 ? TRUE : FALSE;
+}
+
+/** Get the data of the buffer */
+APT_DECLARE(char*) apt_message_buffer_data_get(apt_message_buffer_t *buffer)
+{
+	return buffer->data;
+}
+
+/** Get the size of the buffer */
+APT_DECLARE(apr_size_t) apt_message_buffer_size_get(const apt_message_buffer_t *buffer)
+{
+	return buffer->size;
+}
+
+/** Scroll the stream lying in the buffer */
+APT_DECLARE(apt_bool_t) apt_message_buffer_stream_scroll(apt_message_buffer_t **buffer, apt_text_stream_t *stream)
+{
+	apt_message_buffer_t *new_buffer;
+	apr_size_t remaining_length = 0;
+	if(stream->pos != stream->end) {
+		remaining_length = stream->text.buf + stream->text.length - stream->pos;
+	}
+
+	if(apt_message_buffer_is_shared(*buffer) == FALSE || remaining_length == stream->text.length) {
+		/* nothing refers to the buffer or nothing has been consumed yet, scroll in place */
+		return apt_text_stream_scroll(stream);
+	}
+
+	new_buffer = apt_message_buffer_create((*buffer)->size);
+	if(!new_buffer) {
+		return FALSE;
+	}
+	if(remaining_length) {
+		memcpy(new_buffer->data,stream->pos,remaining_length);
+	}
+	stream->text.buf = new_buffer->data;
+	stream->text.length = remaining_length;
+	stream->pos = stream->text.buf + remaining_length;
+	stream->end = stream->pos;
+	*stream->pos = '\0';
+
+	/* parsed messages hold their own references to the previous buffer */
+	apt_message_buffer_unref(*buffer);
+	*buffer = new_buffer;
+	return TRUE;
+}
+
 
 /** Create message generator */
 APT_DECLARE(apt_message_generator_t*) apt_message_generator_create(void *obj, const apt_message_generator_vtable_t *vtable, apr_pool_t *pool)
@@ -21,15 +21,44 @@
 #include "apt_timer_queue.h"
 #include "apt_log.h"
 
+/** Number of levels of the timing wheel */
+#define TIMER_WHEEL_LEVELS     4
+/** Number of bits of the tick number mapped to a level */
+#define TIMER_WHEEL_SLOT_BITS  6
+/** Number of slots per level */
+#define TIMER_WHEEL_SLOTS      (1 << TIMER_WHEEL_SLOT_BITS)
+/** Mask of the slot index */
+#define TIMER_WHEEL_SLOT_MASK  (TIMER_WHEEL_SLOTS - 1)
+/** Max number of ticks covered by the wheel, longer timers are recascaded */
+#define TIMER_WHEEL_MAX_TICKS  ((apr_uint32_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS))
+
+/** Ring of timers */
+APR_RING_HEAD(apt_timer_head_t, apt_timer_t);
+
 /** Timer queue */
 struct apt_timer_queue_t {
-	/** Ring head */
-	APR_RING_HEAD(apt_timer_head_t, apt_timer_t) head;
+	/** Ring head (sorted list) */
+	struct apt_timer_head_t head;
 
 	/** Elapsed time */
 	apr_uint32_t  elapsed_time;
 	/** Whether elapsed_time is reset or not */
 	apt_bool_t    reset;
+
+	/** Implementation of the queue */
+	apt_timer_queue_type_e   type;
+	/** Slots of all the levels of the wheel */
+	struct apt_timer_head_t *slots;
+	/** Bitmask of non-empty slots per level */
+	apr_uint64_t             occupancy[TIMER_WHEEL_LEVELS];
+	/** Current tick of the wheel */
+	apr_uint32_t             tick;
+	/** Duration of the tick in msec */
+	apr_uint32_t             resolution;
+	/** Number of timers set in the wheel */
+	apr_size_t               count;
+	/** Whether elapsed timers are being processed */
+	apt_bool_t               advancing;
 };
 
 /** Timer */
@@ -39,8 +68,12 @@ struct apt_timer_t {
 
 	/** Back pointer to queue */
 	apt_timer_queue_t   *queue;
-	/** Time next report is scheduled at */
+	/** Time next report is scheduled at (0 if not set) */
 	apr_uint32_t         scheduled_time;
+	/** Tick the timer expires at (wheel only) */
+	apr_uint32_t         expires;
+	/** Index of the slot the timer is linked to (wheel only) */
+	apr_size_t           slot;
 
 	/** Timer proc */
 	apt_timer_proc_f     proc;
@@ -52,13 +85,40 @@ static apt_bool_t apt_timer_insert(apt_timer_queue_t *timer_queue, apt_timer_t *
 static apt_bool_t apt_timer_remove(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
 static void apt_timers_reschedule(apt_timer_queue_t *timer_queue);
 
+static void apt_timer_wheel_insert(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
+static void apt_timer_wheel_remove(apt_timer_queue_t *timer_queue, apt_timer_t *timer);
+static void apt_timer_wheel_advance(apt_timer_queue_t *timer_queue, apr_uint32_t elapsed_time);
+static apt_bool_t apt_timer_wheel_timeout_get(apt_timer_queue_t *timer_queue, apr_uint32_t *timeout);
+
 /** Create timer queue */
 APT_DECLARE(apt_timer_queue_t*) apt_timer_queue_create(apr_pool_t *pool)
 {
+	return apt_timer_queue_create_ex(APT_TIMER_QUEUE_SORTED_LIST,0,pool);
+}
+
+/** Create timer queue of the specified implementation */
+APT_DECLARE(apt_timer_queue_t*) apt_timer_queue_create_ex(apt_timer_queue_type_e type, apr_uint32_t resolution, apr_pool_t *pool)
+{
+	apr_size_t i;
 	apt_timer_queue_t *timer_queue = apr_palloc(pool,sizeof(apt_timer_queue_t));
 	APR_RING_INIT(&timer_queue->head, apt_timer_t, link);
 	timer_queue->elapsed_time = 0;
 	timer_queue->reset = FALSE;
+	timer_queue->type = type;
+	timer_queue->slots = NULL;
+	timer_queue->tick = 0;
+	timer_queue->resolution = resolution ? resolution : 1;
+	timer_queue->count = 0;
+	timer_queue->advancing = FALSE;
+	if(type == APT_TIMER_QUEUE_WHEEL) {
+		timer_queue->slots = apr_palloc(pool,sizeof(struct apt_timer_head_t) * TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS);
+		for(i=0; i<TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++) {
+			APR_RING_INIT(&timer_queue->slots[i], apt_timer_t, link);
+		}
+		for(i=0; i<TIMER_WHEEL_LEVELS; i++) {
+			timer_queue->occupancy[i] = 0;
+		}
+	}
 	return timer_queue;
 }
 
@@ -73,6 +133,11 @@ APT_DECLARE(void) apt_timer_queue_advance(apt_timer_queue_t *timer_queue, apr_ui
 {
 	apt_timer_t *timer;
 
+	if(timer_queue->type == APT_TIMER_QUEUE_WHEEL) {
+		apt_timer_wheel_advance(timer_queue,elapsed_time);
+		return;
+	}
+
 	if(APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link)) {
 		/* just return, nothing to do */
 		return;
@@ -117,6 +182,9 @@ APT_DECLARE(void) apt_timer_queue_advance(apt_timer_queue_t *timer_queue, apr_ui
 /** Is timer queue empty */
 APT_DECLARE(apt_bool_t) apt_timer_queue_is_empty(const apt_timer_queue_t *timer_queue)
 {
+	if(timer_queue->type == APT_TIMER_QUEUE_WHEEL) {
+		return timer_queue->count ? FALSE : TRUE;
+	}
 	return APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link) ? TRUE : FALSE;
 }
 
@@ -130,6 +198,10 @@ APT_DECLARE(apt_bool_t) apt_timer_queue_timeout_get(apt_timer_queue_t *timer_que
 		timer_queue->reset = FALSE;
 	}
 
+	if(timer_queue->type == APT_TIMER_QUEUE_WHEEL) {
+		return apt_timer_wheel_timeout_get(timer_queue,timeout);
+	}
+
 	/* is queue empty */
 	if(APR_RING_EMPTY(&timer_queue->head, apt_timer_t, link)) {
 		return FALSE;
@@ -152,6 +224,8 @@ APT_DECLARE(apt_timer_t*) apt_timer_create(apt_timer_queue_t *timer_queue, apt_t
 	APR_RING_ELEM_INIT(timer,link);
 	timer->queue = timer_queue;
 	timer->scheduled_time = 0;
+	timer->expires = 0;
+	timer->slot = 0;
 	timer->proc = proc;
 	timer->obj = obj;
 	return timer;
@@ -166,6 +240,24 @@ APT_DECLARE(apt_bool_t) apt_timer_set(apt_timer_t *timer, apr_uint32_t timeout)
 		return FALSE;
 	}
 
+	if(queue->type == APT_TIMER_QUEUE_WHEEL) {
+		if(timer->scheduled_time) {
+			apt_timer_wheel_remove(queue,timer);
+		}
+		else if(!queue->count && queue->advancing == FALSE) {
+			/* the first timer is set to the idle queue, count the time from now on
+			and skip the next advance, since it may cover the time before the timer was set;
+			a timer rearmed from its own proc keeps counting from the current tick instead */
+			queue->elapsed_time = 0;
+			queue->reset = TRUE;
+		}
+		/* round up to the whole number of ticks, so that the timer never elapses earlier */
+		timer->scheduled_time = timeout;
+		timer->expires = queue->tick + (timeout + queue->resolution - 1) / queue->resolution;
+		apt_timer_wheel_insert(queue,timer);
+		return TRUE;
+	}
+
 	if(timer->scheduled_time) {
 		/* remove timer first */
 		apt_timer_remove(queue,timer);
@@ -195,6 +287,10 @@ APT_DECLARE(apt_bool_t) apt_timer_kill(apt_timer_t *timer)
 #ifdef APT_TIMER_DEBUG
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Kill Timer 0x%x [%u]",timer,timer->scheduled_time);
 #endif
+	if(timer->queue->type == APT_TIMER_QUEUE_WHEEL) {
+		apt_timer_wheel_remove(timer->queue,timer);
+		return TRUE;
+	}
 	return apt_timer_remove(timer->queue,timer);
 }
 
@@ -242,3 +338,158 @@ static void apt_timers_reschedule(apt_timer_queue_t *timer_queue)
 	}
 	timer_queue->elapsed_time = 0;
 }
+
+/** Link timer to the slot of the level matching the number of ticks left */
+static void apt_timer_wheel_insert(apt_timer_queue_t *timer_queue, apt_timer_t *timer)
+{
+	apr_size_t level = 0;
+	apr_uint32_t expires = timer->expires;
+	apr_uint32_t delta = expires - timer_queue->tick;
+	apr_size_t index;
+
+	if(delta >= TIMER_WHEEL_MAX_TICKS) {
+		/* park at the farthest slot, the timer is recascaded from there */
+		expires = timer_queue->tick + TIMER_WHEEL_MAX_TICKS - 1;
+		delta = TIMER_WHEEL_MAX_TICKS - 1;
+	}
+	while(delta >= TIMER_WHEEL_SLOTS) {
+		delta >>= TIMER_WHEEL_SLOT_BITS;
+		level++;
+	}
+
+	index = (expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+	timer->slot = level * TIMER_WHEEL_SLOTS + index;
+	APR_RING_INSERT_TAIL(&timer_queue->slots[timer->slot],timer,apt_timer_t,link);
+	timer_queue->occupancy[level] |= (apr_uint64_t)1 << index;
+	timer_queue->count++;
+}
+
+/** Unlink timer from its slot */
+static void apt_timer_wheel_remove(apt_timer_queue_t *timer_queue, apt_timer_t *timer)
+{
+	APR_RING_REMOVE(timer,link);
+	timer->scheduled_time = 0;
+	if(APR_RING_EMPTY(&timer_queue->slots[timer->slot], apt_timer_t, link)) {
+		timer_queue->occupancy[timer->slot / TIMER_WHEEL_SLOTS] &= 
+			~((apr_uint64_t)1 << (timer->slot & TIMER_WHEEL_SLOT_MASK));
+	}
+	timer_queue->count--;
+}
+
+/** Move timers of the slot to the lower levels */
+static void apt_timer_wheel_cascade(apt_timer_queue_t *timer_queue, apr_size_t level)
+{
+	apt_timer_t *timer;
+	apt_timer_t *next;
+	apt_timer_t *last;
+	apt_bool_t done;
+	apr_size_t index = (timer_queue->tick >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+	struct apt_timer_head_t *slot = &timer_queue->slots[level * TIMER_WHEEL_SLOTS + index];
+	if(APR_RING_EMPTY(slot, apt_timer_t, link)) {
+		return;
+	}
+
+	/* detach the chain of timers from the slot first, since parked timers may be linked back to it;
+	the chain is walked by the links of the timers only, without a ring head on the stack */
+	timer = APR_RING_FIRST(slot);
+	last = APR_RING_LAST(slot);
+	APR_RING_INIT(slot, apt_timer_t, link);
+	timer_queue->occupancy[level] &= ~((apr_uint64_t)1 << index);
+	do {
+		next = APR_RING_NEXT(timer,link);
+		done = (timer == last) ? TRUE : FALSE;
+		timer_queue->count--;
+		apt_timer_wheel_insert(timer_queue,timer);
+		timer = next;
+	}
+	while(done == FALSE);
+}
+
+/** Advance the wheel by one tick and process elapsed timers */
+static void apt_timer_wheel_tick(apt_timer_queue_t *timer_queue)
+{
+	apt_timer_t *timer;
+	apr_size_t level;
+	apr_size_t index;
+	struct apt_timer_head_t *slot;
+
+	timer_queue->tick++;
+	for(level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		if(timer_queue->tick & ((1 << (level * TIMER_WHEEL_SLOT_BITS)) - 1)) {
+			break;
+		}
+		/* the lower level has wrapped around */
+		apt_timer_wheel_cascade(timer_queue,level);
+	}
+
+	index = timer_queue->tick & TIMER_WHEEL_SLOT_MASK;
+	slot = &timer_queue->slots[index];
+	while(!APR_RING_EMPTY(slot, apt_timer_t, link)) {
+		timer = APR_RING_FIRST(slot);
+#ifdef APT_TIMER_DEBUG
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Timer Elapsed 0x%x [%u]",timer,timer->expires);
+#endif
+		apt_timer_wheel_remove(timer_queue,timer);
+		/* process the elapsed timer, which may set timers again */
+		timer->proc(timer,timer->obj);
+	}
+}
+
+static void apt_timer_wheel_advance(apt_timer_queue_t *timer_queue, apr_uint32_t elapsed_time)
+{
+	apr_uint32_t ticks;
+	apr_uint32_t idle_ticks;
+	if(!timer_queue->count) {
+		/* just return, nothing to do */
+		return;
+	}
+
+	if(timer_queue->reset == TRUE) {
+		/* elapsed_time has just been reset, skip the advance once,
+		since it may cover the time before the timers were set */
+		timer_queue->reset = FALSE;
+		return;
+	}
+
+	/* elapsed_time keeps the remainder of the tick */
+	timer_queue->elapsed_time += elapsed_time;
+	ticks = timer_queue->elapsed_time / timer_queue->resolution;
+	timer_queue->elapsed_time -= ticks * timer_queue->resolution;
+	timer_queue->advancing = TRUE;
+	while(ticks && timer_queue->count) {
+		if(!timer_queue->occupancy[0]) {
+			/* skip idle ticks up to the next cascade */
+			idle_ticks = TIMER_WHEEL_SLOTS - 1 - (timer_queue->tick & TIMER_WHEEL_SLOT_MASK);
+			if(idle_ticks >= ticks) {
+				timer_queue->tick += ticks;
+				break;
+			}
+			timer_queue->tick += idle_ticks;
+			ticks -= idle_ticks;
+		}
+		apt_timer_wheel_tick(timer_queue);
+		ticks--;
+	}
+	timer_queue->advancing = FALSE;
+}
+
+static apt_bool_t apt_timer_wheel_timeout_get(apt_timer_queue_t *timer_queue, apr_uint32_t *timeout)
+{
+	apr_uint32_t i;
+	apr_uint32_t ticks;
+	apr_uint32_t index = timer_queue->tick & TIMER_WHEEL_SLOT_MASK;
+	if(!timer_queue->count) {
+		return FALSE;
+	}
+
+	/* ticks till the next non-empty slot of the first level or till the next cascade */
+	ticks = TIMER_WHEEL_SLOTS - index;
+	for(i = 1; index + i < TIMER_WHEEL_SLOTS; i++) {
+		if(timer_queue->occupancy[0] & ((apr_uint64_t)1 << (index + i))) {
+			ticks = i;
+			break;
+		}
+	}
+	*timeout = ticks * timer_queue->resolution - timer_queue->elapsed_time;
+	return TRUE;
+}
@@ -22,6 +22,7 @@
  * @brief MPF Voice Activity Detector
  */ 
 
+#include <apr_tables.h>
 #include "mpf_frame.h"
 #include "mpf_codec_descriptor.h"
 
@@ -38,6 +39,12 @@ typedef enum {
 	MPF_DETECTOR_EVENT_NOINPUT     /**< noinput event occurred */
 } mpf_detector_event_e;
 
+/** Modes (algorithms) of activity detector */
+typedef enum {
+	MPF_DETECTOR_MODE_LEVEL,        /**< mean amplitude against the level threshold (default) */
+	MPF_DETECTOR_MODE_ENERGY_RATIO  /**< band-limited energy against the tracked noise floor, gated by the level threshold */
+} mpf_detector_mode_e;
+
 
 /** Create activity detector */
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool);
@@ -60,9 +67,34 @@ MPF_DECLARE(void) mpf_activity_detector_silence_timeout_set(mpf_activity_detecto
 /** Set frame duration in ms */
 MPF_DECLARE(void) mpf_activity_frame_duration_set(mpf_activity_detector_t *detector, apr_size_t frame_duration);
 
+/** Set mode (algorithm) of activity detection */
+MPF_DECLARE(void) mpf_activity_detector_mode_set(mpf_activity_detector_t *detector, mpf_detector_mode_e mode);
+
+/** Set ratio of band-limited energy to the noise floor (in dB) required to detect activity in energy ratio mode */
+MPF_DECLARE(void) mpf_activity_detector_snr_threshold_set(mpf_activity_detector_t *detector, apr_size_t snr_threshold);
+
+/**
+ * Configure activity detector by name/value params.
+ * @param detector the detector to configure
+ * @param params the table of params (may be NULL): "vad-mode" ("level" or "energy-ratio") and "vad-snr-threshold" (in dB)
+ */
+MPF_DECLARE(void) mpf_activity_detector_params_set(mpf_activity_detector_t *detector, const apr_table_t *params);
+
 /** Process current frame, return detected event if any */
 MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame);
 
+/** Calculate mean absolute amplitude of linear samples */
+MPF_DECLARE(apr_size_t) mpf_activity_level_calculate(const apr_int16_t *samples, apr_size_t count);
+
+/**
+ * Calculate mean energy of linear samples band-limited by y[n] = (x[n] - x[n-2]) / 2,
+ * which rejects DC, mains hum and content close to the Nyquist frequency.
+ * @param samples the samples to calculate energy of
+ * @param count the number of samples
+ * @param history the last two samples of the previous block, updated on return
+ */
+MPF_DECLARE(apr_uint32_t) mpf_activity_band_energy_calculate(const apr_int16_t *samples, apr_size_t count, apr_int16_t history[2]);
+
 
 APT_END_EXTERN_C
 
@@ -26,20 +26,62 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Default size of a slot in bytes (20 msec of 16 kHz linear PCM) */
+#define MPF_BUFFER_DEFAULT_SLOT_SIZE   640
+/** Default number of preallocated slots */
+#define MPF_BUFFER_DEFAULT_SLOT_COUNT  50
+
 /** Opaque media buffer declaration */
 typedef struct mpf_buffer_t mpf_buffer_t;
+/** Media buffer statistics declaration */
+typedef struct mpf_buffer_stat_t mpf_buffer_stat_t;
+
+/** Fill-level statistics of media buffer */
+struct mpf_buffer_stat_t {
+	/** Number of bytes buffered */
+	apr_size_t size;
+	/** Max number of bytes ever buffered */
+	apr_size_t peak_size;
+	/** Number of slots in use */
+	apr_size_t used_slots;
+	/** Number of slots allocated (preallocated and overflow ones in use) */
+	apr_size_t allocated_slots;
+	/** Max number of slots (0 - unlimited) */
+	apr_size_t max_slots;
+	/** Size of a slot in bytes */
+	apr_size_t slot_size;
+	/** Number of writes rejected since the max number of slots has been reached */
+	apr_size_t overflow_count;
+};
 
 
-/** Create buffer */
+/** Create buffer with default settings and unlimited overflow */
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool);
 
+/**
+ * Create buffer of preallocated slots.
+ * @param slot_size the size of a slot in bytes
+ * @param slot_count the number of slots to preallocate
+ * @param max_slot_count the max number of slots including overflow ones allocated on demand
+ *                       (0 - unlimited, slot_count - no overflow)
+ * @param pool the pool to allocate memory from
+ * @remark Preallocated slots are recycled as soon as they are read, while overflow
+ *         slots are freed, so the memory follows the fill level of the buffer
+ *         and shrinks back to the preallocated slots once the buffer is drained.
+ *         Overflow slots still queued are freed by mpf_buffer_destroy() or along with the pool.
+ */
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t slot_size, apr_size_t slot_count, apr_size_t max_slot_count, apr_pool_t *pool);
+
 /** Destroy buffer */
 void mpf_buffer_destroy(mpf_buffer_t *buffer);
 
 /** Restart buffer */
 apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer);
 
-/** Write audio chunk to buffer */
+/**
+ * Write audio chunk to buffer.
+ * @return FALSE, if the chunk does not fit into the max number of slots, otherwise TRUE
+ */
 apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size);
 
 /** Write event to buffer */
@@ -51,6 +93,9 @@ apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame)
 /** Get size of buffer **/
 apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer);
 
+/** Get fill-level statistics of buffer, which engines may use to throttle writes */
+void mpf_buffer_stat_get(mpf_buffer_t *buffer, mpf_buffer_stat_t *stat);
+
 APT_END_EXTERN_C
 
 #endif /* MPF_BUFFER_H */
@@ -74,6 +74,9 @@ struct mpf_codec_vtable_t {
 
 	/** Virtual format matching method */
 	mpf_codec_format_match_f match_formats;
+
+	/** Virtual lost frame concealment method (decoder-side PLC) */
+	apt_bool_t (*conceal)(mpf_codec_t *codec, mpf_codec_frame_t *frame_out);
 };
 
 /**
@@ -228,6 +231,16 @@ static APR_INLINE apt_bool_t mpf_codec_fill(mpf_codec_t *codec, mpf_codec_frame_
 	return rv;
 }
 
+/** Conceal lost codec frame by producing decoded (linear PCM) frame in its place */
+static APR_INLINE apt_bool_t mpf_codec_conceal(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
+{
+	apt_bool_t rv = FALSE;
+	if(codec->vtable->conceal) {
+		rv = codec->vtable->conceal(codec,frame_out);
+	}
+	return rv;
+}
+
 APT_END_EXTERN_C
 
 #endif /* MPF_CODEC_H */
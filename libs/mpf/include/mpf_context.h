@@ -44,6 +44,20 @@ MPF_DECLARE(void) mpf_context_factory_destroy(mpf_context_factory_t *factory);
  */
 MPF_DECLARE(apt_bool_t) mpf_context_factory_process(mpf_context_factory_t *factory);
 
+/**
+ * Get the load of the factory (the number of created and not yet released contexts).
+ * @param factory the factory to get the load of
+ * @remark The load is maintained atomically and can be retrieved from any thread.
+ */
+MPF_DECLARE(apr_size_t) mpf_context_factory_load_get(mpf_context_factory_t *factory);
+
+/**
+ * Get the number of contexts, in which any stream produced data in the last tick processed.
+ * @param factory the factory to get the number of active contexts of
+ * @remark Must be called from the thread processing the factory.
+ */
+MPF_DECLARE(apr_size_t) mpf_context_factory_active_count_get(const mpf_context_factory_t *factory);
+
 /**
  * Create MPF context.
  * @param factory the factory context belongs to
@@ -71,6 +85,12 @@ MPF_DECLARE(apt_bool_t) mpf_context_destroy(mpf_context_t *context);
  */
 MPF_DECLARE(void*) mpf_context_object_get(const mpf_context_t *context);
 
+/**
+ * Get factory MPF context belongs to.
+ * @param context the context to get factory of
+ */
+MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_get(const mpf_context_t *context);
+
 /**
  * Add termination to context.
  * @param context the context to add termination to
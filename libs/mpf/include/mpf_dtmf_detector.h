@@ -98,6 +98,11 @@ MPF_DECLARE(apr_size_t) mpf_dtmf_detector_digits_lost(const struct mpf_dtmf_dete
 /**
  * Empty the buffer and reset detection states.
  * @param detector  The detector.
+ * @remark Unlike mpf_dtmf_detector_digit_get(), which may be called from another
+ *         thread than the one frames are detected on, the reset is not synchronized
+ *         with either side. Call it from the thread which passes frames to the detector
+ *         (the media processing thread), while no other thread takes digits from it,
+ *         e.g. before the stream is opened or from the stream_write() callback.
  */
 MPF_DECLARE(void) mpf_dtmf_detector_reset(struct mpf_dtmf_detector_t *detector);
 
@@ -111,8 +116,12 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 								const struct mpf_frame_t *frame);
 
 /**
- * Free all resources associated with the detector.
+ * Stop detection and drop the digits detected so far.
  * @param detector  The detector.
+ * @remark The detector is allocated from the pool passed on creation and holds no
+ *         other resources, its memory is freed along with the pool. Subsequent
+ *         frames are ignored and no digits are returned. The same threading
+ *         rules as of mpf_dtmf_detector_reset() apply.
  */
 MPF_DECLARE(void) mpf_dtmf_detector_destroy(struct mpf_dtmf_detector_t *detector);
 
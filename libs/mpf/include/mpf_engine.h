@@ -24,6 +24,7 @@
 
 #include "apt_task.h"
 #include "mpf_message.h"
+#include "mpf_rtp_poller.h"
 
 APT_BEGIN_EXTERN_C
 
@@ -50,6 +51,38 @@ MPF_DECLARE(mpf_codec_manager_t*) mpf_engine_codec_manager_create(apr_pool_t *po
  */
 MPF_DECLARE(apt_bool_t) mpf_engine_codec_manager_register(mpf_engine_t *engine, const mpf_codec_manager_t *codec_manager);
 
+/**
+ * Set the number of workers to process media contexts with.
+ * @param engine the engine to set the number of workers for
+ * @param worker_count the number of workers (1 by default)
+ * @remark Each worker processes its own shard of media contexts in a dedicated thread,
+ *         while all the workers are driven by the same scheduler clock. A context is
+ *         assigned to the least loaded worker on creation. The number of workers can
+ *         only be set before the engine is started, FALSE is returned afterwards.
+ */
+MPF_DECLARE(apt_bool_t) mpf_engine_worker_count_set(mpf_engine_t *engine, apr_size_t worker_count);
+
+/**
+ * Get the number of workers.
+ * @param engine the engine to get the number of workers of
+ */
+MPF_DECLARE(apr_size_t) mpf_engine_worker_count_get(const mpf_engine_t *engine);
+
+/**
+ * Get the load of the engine (the number of media contexts over all the workers).
+ * @param engine the engine to get the load of
+ * @remark The load can be retrieved from any thread.
+ */
+MPF_DECLARE(apr_size_t) mpf_engine_load_get(const mpf_engine_t *engine);
+
+/**
+ * Get RTP receive statistics accumulated over all the workers.
+ * @param engine the engine to get statistics of
+ * @param stat the statistics to fill
+ * @remark The number of system calls per tick is syscalls / ticks.
+ */
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_stat_get(const mpf_engine_t *engine, mpf_rtp_poller_stat_t *stat);
+
 /**
  * Create MPF context.
  * @param engine the engine to create context for
@@ -151,6 +184,18 @@ MPF_DECLARE(apt_bool_t) mpf_engine_message_send(mpf_engine_t *engine, mpf_task_m
  */
 MPF_DECLARE(apt_bool_t) mpf_engine_scheduler_rate_set(mpf_engine_t *engine, unsigned long rate);
 
+/**
+ * Set free-running mode, intended for offline processing.
+ * @param engine the engine to set mode for
+ * @param free_running whether to process ticks back-to-back while any stream produces data
+ * @remark Media and timers advance by a virtual clock as fast as the terminations consume
+ *         audio, therefore all the terminations must be paced by the engine itself
+ *         (e.g. file-based streams). RTP terminations, paced by a peer in real time,
+ *         are rejected. A tick, in which no stream produced data, is followed by a sleep
+ *         for the period of a tick, rather than by the next tick right away.
+ */
+MPF_DECLARE(apt_bool_t) mpf_engine_free_running_set(mpf_engine_t *engine, apt_bool_t free_running);
+
 /**
  * Get the identifier of the engine .
  * @param engine the engine to get name of
@@ -38,6 +38,15 @@ MPF_DECLARE(apt_bool_t) mpf_engine_factory_is_empty(const mpf_engine_factory_t *
 /** Select next available media engine. */
 MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_engine_select(mpf_engine_factory_t *mpf_factory);
 
+/** Select the least loaded media engine (see mpf_engine_load_get()). */
+MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_least_loaded_engine_select(mpf_engine_factory_t *mpf_factory);
+
+/** Get the number of media engines in factory. */
+MPF_DECLARE(apr_size_t) mpf_engine_factory_engine_count_get(const mpf_engine_factory_t *mpf_factory);
+
+/** Get media engine by index. */
+MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_engine_get(const mpf_engine_factory_t *mpf_factory, apr_size_t index);
+
 /** Associate media engines with RTP termination factory. */
 MPF_DECLARE(apt_bool_t) mpf_engine_factory_rtp_factory_assign(mpf_engine_factory_t *mpf_factory, mpf_termination_factory_t *rtp_factory);
 
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_FILE_IO_H
+#define MPF_FILE_IO_H
+
+/**
+ * @file mpf_file_io.h
+ * @brief MPF Asynchronous File I/O
+ */
+
+#include <apr_tables.h>
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default number of files open at a time */
+#define MPF_FILE_IO_DEFAULT_MAX_FILES   256
+/** Default size of each of the two buffers of a file */
+#define MPF_FILE_IO_DEFAULT_BUFFER_SIZE 32000
+
+/** Opaque file I/O agent (a dedicated I/O thread serving asynchronous files) */
+typedef struct mpf_file_io_t mpf_file_io_t;
+
+/** Opaque asynchronous file (sink or source) */
+typedef struct mpf_async_file_t mpf_async_file_t;
+
+/** Statistics of asynchronous file */
+typedef struct mpf_async_file_stat_t mpf_async_file_stat_t;
+
+/** Statistics of asynchronous file */
+struct mpf_async_file_stat_t {
+	/** Number of bytes written to (or read from) the file */
+	apr_size_t transferred;
+	/** Number of writes dropped, since both buffers were waiting for the I/O thread */
+	apr_size_t dropped;
+	/** Number of bytes dropped */
+	apr_size_t dropped_bytes;
+	/** Number of reads not served, since the next buffer was not filled by the I/O thread yet */
+	apr_size_t late;
+};
+
+/**
+ * Get the max number of files open at a time to serve the given number of channels.
+ * @param channel_count the max number of channels (0 if unlimited)
+ * @param params the optional params to take the "max-open-files" override from
+ * @remark Each channel may have a file open, while its previous file is still being
+ *         flushed by the I/O thread, so 2 * channel_count files are reserved by default.
+ *         MPF_FILE_IO_DEFAULT_MAX_FILES is used, if the number of channels is unlimited.
+ */
+MPF_DECLARE(apr_size_t) mpf_file_io_max_files_get(apr_size_t channel_count, const apr_table_t *params);
+
+/**
+ * Create file I/O agent.
+ * @param max_files the max number of files open at a time
+ * @param buffer_size the size of each of the two buffers of a file
+ * @param pool the pool to allocate memory from
+ * @remark The memory used by the agent is bounded by 2 * max_files * buffer_size,
+ *         allocated on demand as files are opened.
+ */
+MPF_DECLARE(mpf_file_io_t*) mpf_file_io_create(apr_size_t max_files, apr_size_t buffer_size, apr_pool_t *pool);
+
+/** Start the I/O thread of the agent */
+MPF_DECLARE(apt_bool_t) mpf_file_io_start(mpf_file_io_t *file_io);
+
+/** Terminate the I/O thread of the agent, flushing and closing files closed so far */
+MPF_DECLARE(apt_bool_t) mpf_file_io_terminate(mpf_file_io_t *file_io);
+
+/**
+ * Open file to write to asynchronously (file sink).
+ * @param file_io the file I/O agent
+ * @param file_path the path to the file
+ * @return the file or NULL on failure
+ * @remark Must not be called from the media processing thread, since the file is opened synchronously.
+ */
+MPF_DECLARE(mpf_async_file_t*) mpf_async_file_sink_open(mpf_file_io_t *file_io, const char *file_path);
+
+/**
+ * Open file to read from asynchronously (file source).
+ * @param file_io the file I/O agent
+ * @param file_path the path to the file
+ * @return the file or NULL on failure
+ * @remark Must not be called from the media processing thread, since the file is opened
+ *         and both buffers are filled synchronously.
+ */
+MPF_DECLARE(mpf_async_file_t*) mpf_async_file_source_open(mpf_file_io_t *file_io, const char *file_path);
+
+/**
+ * Write data to the file sink without blocking.
+ * @param file the file to write to
+ * @param data the data to write
+ * @param size the size of the data
+ * @return FALSE if the data is dropped, since the I/O thread lags behind
+ */
+MPF_DECLARE(apt_bool_t) mpf_async_file_write(mpf_async_file_t *file, const void *data, apr_size_t size);
+
+/**
+ * Read data from the file source without blocking.
+ * @param file the file to read from
+ * @param data the buffer to read to
+ * @param size the size of the data to read
+ * @return TRUE if the whole size is read, FALSE if the data is late or the end of file is reached
+ * @see mpf_async_file_eof
+ */
+MPF_DECLARE(apt_bool_t) mpf_async_file_read(mpf_async_file_t *file, void *data, apr_size_t size);
+
+/** Query whether the end of the file source is reached */
+MPF_DECLARE(apt_bool_t) mpf_async_file_eof(const mpf_async_file_t *file);
+
+/** Get statistics of the file */
+MPF_DECLARE(void) mpf_async_file_stat_get(const mpf_async_file_t *file, mpf_async_file_stat_t *stat);
+
+/**
+ * Close the file without blocking.
+ * @param file the file to close
+ * @remark The remaining data of the file sink is flushed and the file is closed by the I/O thread.
+ *         The file must not be accessed afterwards.
+ */
+MPF_DECLARE(void) mpf_async_file_close(mpf_async_file_t *file);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_FILE_IO_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_G711_KERNEL_H
+#define MPF_G711_KERNEL_H
+
+/**
+ * @file mpf_g711_kernel.h
+ * @brief G.711 (u-law and A-law) Block Kernels
+ */
+
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** G.711 kernels */
+typedef enum {
+	MPF_G711_KERNEL_GENERIC, /**< per-sample computation */
+	MPF_G711_KERNEL_TABLE,   /**< lookup tables */
+	MPF_G711_KERNEL_SSE41,   /**< SSE4.1 encoder, lookup table decoder */
+	MPF_G711_KERNEL_AVX2,    /**< AVX2 encoder, lookup table decoder */
+	MPF_G711_KERNEL_NEON,    /**< NEON encoder, lookup table decoder */
+
+	MPF_G711_KERNEL_COUNT    /**< number of kernels */
+} mpf_g711_kernel_e;
+
+/**
+ * Initialize G.711 kernels.
+ * @remark Lookup tables are built and the fastest kernel supported by the CPU
+ *         is selected. The function is called on creation of G.711 codecs.
+ */
+MPF_DECLARE(void) mpf_g711_init(void);
+
+/**
+ * Select G.711 kernel.
+ * @param kernel the kernel to select
+ * @return FALSE if the kernel is not supported by either the build or the CPU
+ */
+MPF_DECLARE(apt_bool_t) mpf_g711_kernel_set(mpf_g711_kernel_e kernel);
+
+/** Get selected G.711 kernel */
+MPF_DECLARE(mpf_g711_kernel_e) mpf_g711_kernel_get(void);
+
+/** Get name of G.711 kernel */
+MPF_DECLARE(const char*) mpf_g711_kernel_name_get(mpf_g711_kernel_e kernel);
+
+/** Encode linear samples to u-law */
+MPF_DECLARE(void) mpf_g711u_encode(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count);
+
+/** Decode u-law samples to linear ones */
+MPF_DECLARE(void) mpf_g711u_decode(const apr_byte_t *ulaw, apr_int16_t *linear, apr_size_t count);
+
+/** Encode linear samples to A-law */
+MPF_DECLARE(void) mpf_g711a_encode(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count);
+
+/** Decode A-law samples to linear ones */
+MPF_DECLARE(void) mpf_g711a_decode(const apr_byte_t *alaw, apr_int16_t *linear, apr_size_t count);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_G711_KERNEL_H */
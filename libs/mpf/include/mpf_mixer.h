@@ -26,6 +26,9 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Unity gain of audio source (gains are in Q12 fixed-point format) */
+#define MPF_MIXER_GAIN_UNITY 4096
+
 /**
  * Create audio stream mixer.
  * @param source_arr the array of audio sources
@@ -43,6 +46,28 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 								const char *name,
 								apr_pool_t *pool);
 
+/**
+ * Set the gain of audio source of the mixer.
+ * @param object the mixer object
+ * @param index the index of the audio source as passed on creation
+ * @param gain the gain in Q12 format (MPF_MIXER_GAIN_UNITY for unity gain)
+ */
+MPF_DECLARE(apt_bool_t) mpf_mixer_source_gain_set(mpf_object_t *object, apr_size_t index, apr_int16_t gain);
+
+/**
+ * Mix linear samples of audio sources with saturation.
+ * @param mix_buf the buffer to store the mixed samples to
+ * @param buf_arr the array of buffers of the audio sources
+ * @param gain_arr the array of gains of the audio sources or NULL for unity gains
+ * @param count the number of audio sources
+ * @param samples the number of samples in each buffer
+ */
+MPF_DECLARE(void) mpf_mixer_samples_mix(
+								apr_int16_t *mix_buf,
+								const apr_int16_t * const *buf_arr,
+								const apr_int16_t *gain_arr,
+								apr_size_t count,
+								apr_size_t samples);
 
 APT_END_EXTERN_C
 
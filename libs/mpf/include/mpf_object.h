@@ -33,6 +33,8 @@ typedef struct mpf_object_t mpf_object_t;
 struct mpf_object_t {
 	/** Informative name used for debugging */
 	const char *name;
+	/** Indicates whether the last frame processed carried any media */
+	apt_bool_t  active;
 	/** Virtual destroy */
 	apt_bool_t (*destroy)(mpf_object_t *object);
 	/** Virtual process */
@@ -45,6 +47,7 @@ struct mpf_object_t {
 static APR_INLINE void mpf_object_init(mpf_object_t *object, const char *name)
 {
 	object->name = name;
+	object->active = FALSE;
 	object->destroy = NULL;
 	object->process = NULL;
 	object->trace = NULL;
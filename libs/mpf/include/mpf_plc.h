@@ -0,0 +1,76 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_PLC_H
+#define MPF_PLC_H
+
+/**
+ * @file mpf_plc.h
+ * @brief Packet Loss Concealment (PLC)
+ */
+
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Max duration of concealment in msec, the output fades out to silence by then */
+#define MPF_PLC_MAX_DURATION 60
+
+/** Opaque packet loss concealment declaration */
+typedef struct mpf_plc_t mpf_plc_t;
+
+/**
+ * Create packet loss concealment.
+ * @param sampling_rate the sampling rate of (mono) linear PCM
+ * @param frame_samples the number of samples in a frame
+ * @param pool the pool to allocate memory from
+ * @remark The lost frames are synthesized by repeating the last pitch period of
+ *         the received signal with overlap-add at the edges of the loss and
+ *         gradual attenuation of longer losses (G.711 Appendix I style).
+ */
+MPF_DECLARE(mpf_plc_t*) mpf_plc_create(apr_uint32_t sampling_rate, apr_size_t frame_samples, apr_pool_t *pool);
+
+/** Reset packet loss concealment (start of new stream) */
+MPF_DECLARE(void) mpf_plc_reset(mpf_plc_t *plc);
+
+/**
+ * Process received frame.
+ * @param plc the packet loss concealment
+ * @param samples the samples of the frame to add to the history
+ * @return TRUE if the samples have been modified to smoothly follow the concealed frames
+ */
+MPF_DECLARE(apt_bool_t) mpf_plc_good_frame(mpf_plc_t *plc, apr_int16_t *samples);
+
+/**
+ * Synthesize lost frame.
+ * @param plc the packet loss concealment
+ * @param samples the samples of the frame to synthesize
+ * @return FALSE if the max duration of concealment has been reached (silence synthesized)
+ */
+MPF_DECLARE(apt_bool_t) mpf_plc_lost_frame(mpf_plc_t *plc, apr_int16_t *samples);
+
+/**
+ * Skip frame (time-scale compression).
+ * @param plc the packet loss concealment
+ * @remark The next received frame is overlap-added with the continuation of
+ *         the history, so that it smoothly follows the history in place of
+ *         the skipped frame.
+ */
+MPF_DECLARE(void) mpf_plc_skipped_frame(mpf_plc_t *plc);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_PLC_H */
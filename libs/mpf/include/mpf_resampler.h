@@ -31,6 +31,8 @@ APT_BEGIN_EXTERN_C
  * @param source the source stream to resample
  * @param sink the sink stream to resample to
  * @param pool the pool to allocate memory from
+ * @remark Polyphase FIR resampling of mono linear PCM between any of
+ *         the supported sampling rates (8, 16, 32 and 48 kHz) is implemented.
  */
 MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool);
 
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_RTP_POLLER_H
+#define MPF_RTP_POLLER_H
+
+/**
+ * @file mpf_rtp_poller.h
+ * @brief MPF RTP Poller (Event-driven Receive of RTP Packets)
+ */
+
+#include <apr_network_io.h>
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Opaque RTP poller declaration */
+typedef struct mpf_rtp_poller_t mpf_rtp_poller_t;
+
+/** Opaque RTP socket registered in the poller */
+typedef struct mpf_rtp_poller_socket_t mpf_rtp_poller_socket_t;
+
+/** RTP poller statistics */
+typedef struct mpf_rtp_poller_stat_t mpf_rtp_poller_stat_t;
+
+/** Prototype of the handler of received packets */
+typedef void (*mpf_rtp_poller_handler_f)(void *obj, void *buffer, apr_size_t size);
+
+/** RTP poller statistics */
+struct mpf_rtp_poller_stat_t {
+	/** number of processed ticks */
+	apr_uint32_t ticks;
+	/** number of system calls made in all the ticks */
+	apr_uint32_t syscalls;
+	/** number of system calls made in the last tick */
+	apr_uint32_t last_syscalls;
+	/** max number of system calls made in a single tick */
+	apr_uint32_t max_syscalls;
+	/** number of received packets */
+	apr_uint32_t packets;
+	/** number of currently registered sockets */
+	apr_uint32_t sockets;
+};
+
+/**
+ * Create RTP poller.
+ * @param size the max number of sockets to poll
+ * @param pool the pool to allocate memory from
+ * @return the created poller or NULL, if the pollset is not available
+ */
+MPF_DECLARE(mpf_rtp_poller_t*) mpf_rtp_poller_create(apr_uint32_t size, apr_pool_t *pool);
+
+/**
+ * Destroy RTP poller.
+ * @param poller the poller to destroy
+ */
+MPF_DECLARE(void) mpf_rtp_poller_destroy(mpf_rtp_poller_t *poller);
+
+/**
+ * Add socket to the poller.
+ * @param poller the poller to add the socket to
+ * @param socket the non-blocking socket to receive packets from
+ * @param handler the handler to pass received packets to
+ * @param obj the external object to pass to the handler
+ * @return the registered socket or NULL, if the socket cannot be polled
+ */
+MPF_DECLARE(mpf_rtp_poller_socket_t*) mpf_rtp_poller_socket_add(
+											mpf_rtp_poller_t *poller,
+											apr_socket_t *socket,
+											mpf_rtp_poller_handler_f handler,
+											void *obj);
+
+/**
+ * Remove socket from the poller.
+ * @param poller the poller to remove the socket from
+ * @param poller_socket the socket to remove
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_socket_remove(mpf_rtp_poller_t *poller, mpf_rtp_poller_socket_t *poller_socket);
+
+/**
+ * Receive pending packets from readable sockets and pass them to the handlers.
+ * @param poller the poller to process
+ * @remark Expected to be called once per tick prior to processing of media contexts.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_process(mpf_rtp_poller_t *poller);
+
+/**
+ * Get RTP poller statistics.
+ * @param poller the poller to get statistics of
+ * @param stat the statistics to fill
+ * @remark The statistics may be read from any thread, each counter is read atomically.
+ */
+MPF_DECLARE(void) mpf_rtp_poller_stat_get(const mpf_rtp_poller_t *poller, mpf_rtp_poller_stat_t *stat);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_RTP_POLLER_H */
@@ -49,6 +49,8 @@ struct rtp_rx_stat_t {
 
 	/** number of lost in network packets */
 	apr_uint32_t lost_packets;
+	/** number of lost frames concealed by jitter buffer or decoder (PLC) */
+	apr_uint32_t concealed_frames;
 
 	/** number of restarts */
 	apr_byte_t   restarts;
@@ -34,6 +34,12 @@ MPF_DECLARE(mpf_termination_factory_t*) mpf_rtp_termination_factory_create(
 										mpf_rtp_config_t *rtp_config,
 										apr_pool_t *pool);
 
+/**
+ * Check whether the termination is created by an RTP termination factory.
+ * @param termination the termination to check
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_termination_check(const mpf_termination_t *termination);
+
 
 APT_END_EXTERN_C
 
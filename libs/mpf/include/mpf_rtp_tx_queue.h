@@ -0,0 +1,86 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_RTP_TX_QUEUE_H
+#define MPF_RTP_TX_QUEUE_H
+
+/**
+ * @file mpf_rtp_tx_queue.h
+ * @brief MPF RTP Transmit Queue (Batched Send of RTP Packets)
+ */
+
+#include <apr_network_io.h>
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Opaque RTP transmit queue declaration */
+typedef struct mpf_rtp_tx_queue_t mpf_rtp_tx_queue_t;
+
+/** RTP transmit queue statistics */
+typedef struct mpf_rtp_tx_queue_stat_t mpf_rtp_tx_queue_stat_t;
+
+/** RTP transmit queue statistics */
+struct mpf_rtp_tx_queue_stat_t {
+	/** number of flushes (ticks) */
+	apr_uint32_t flushes;
+	/** number of system calls made */
+	apr_uint32_t syscalls;
+	/** number of sent packets */
+	apr_uint32_t sent_packets;
+	/** number of packets failed to be sent */
+	apr_uint32_t failed_packets;
+};
+
+/**
+ * Create RTP transmit queue.
+ * @param capacity the max number of packets queued before the queue is implicitly flushed
+ * @param pool the pool to allocate memory from
+ */
+MPF_DECLARE(mpf_rtp_tx_queue_t*) mpf_rtp_tx_queue_create(apr_size_t capacity, apr_pool_t *pool);
+
+/**
+ * Queue RTP packet to be sent on the next flush.
+ * @param queue the queue to push the packet to
+ * @param socket the socket to send the packet from
+ * @param sockaddr the destination address, which must remain valid until the flush
+ * @param data the packet data to copy
+ * @param size the size of the packet
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_tx_queue_push(
+							mpf_rtp_tx_queue_t *queue,
+							apr_socket_t *socket,
+							apr_sockaddr_t *sockaddr,
+							const void *data,
+							apr_size_t size);
+
+/**
+ * Send queued packets grouping them per socket.
+ * @param queue the queue to flush
+ * @remark Expected to be called at the end of every tick after processing of media contexts.
+ */
+MPF_DECLARE(apt_bool_t) mpf_rtp_tx_queue_flush(mpf_rtp_tx_queue_t *queue);
+
+/**
+ * Get RTP transmit queue statistics.
+ * @param queue the queue to get statistics of
+ * @param stat the statistics to fill
+ */
+MPF_DECLARE(void) mpf_rtp_tx_queue_stat_get(const mpf_rtp_tx_queue_t *queue, mpf_rtp_tx_queue_stat_t *stat);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_RTP_TX_QUEUE_H */
@@ -49,11 +49,36 @@ MPF_DECLARE(apt_bool_t) mpf_scheduler_timer_clock_set(
 								mpf_scheduler_proc_f proc,
 								void *obj);
 
-/** Set scheduler rate (n times faster than real-time) */
+/**
+ * Set scheduler rate (n times faster than real-time).
+ * @remark The timer clock is counted in the media time of ticks processed, thus it keeps
+ *         the pace of the media clock at any rate.
+ */
 MPF_DECLARE(apt_bool_t) mpf_scheduler_rate_set(
 								mpf_scheduler_t *scheduler,
 								unsigned long rate);
 
+/**
+ * Set free-running mode of scheduler.
+ * @param scheduler the scheduler to set mode for
+ * @param free_running whether to process ticks back-to-back, without sleeping in between
+ * @remark The clocks are driven by the number of ticks processed rather than the wall clock,
+ *         so that media and timers advance as fast as the callbacks are done. While idle
+ *         (e.g. no stream produced data in the last tick), the scheduler sleeps for the period
+ *         of a tick instead of spinning. Not supported by the multimedia timers.
+ */
+MPF_DECLARE(apt_bool_t) mpf_scheduler_free_running_set(
+								mpf_scheduler_t *scheduler,
+								apt_bool_t free_running);
+
+/**
+ * Indicate whether there was nothing to process in the last tick in free-running mode.
+ * @param scheduler the scheduler to set the state for
+ * @param idle whether to sleep for the period of a tick before the next one
+ * @remark Called from within the media clock callback.
+ */
+MPF_DECLARE(void) mpf_scheduler_idle_set(mpf_scheduler_t *scheduler, apt_bool_t idle);
+
 /** Start scheduler */
 MPF_DECLARE(apt_bool_t) mpf_scheduler_start(mpf_scheduler_t *scheduler);
 
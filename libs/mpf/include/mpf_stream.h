@@ -55,6 +55,12 @@ struct mpf_audio_stream_t {
 	mpf_codec_descriptor_t          *tx_descriptor;
 	/** Tx event descriptor */
 	mpf_codec_descriptor_t          *tx_event_descriptor;
+
+	/**
+	 * Read frame view method (optional), the frame may refer to the buffer of the stream.
+	 * @remark Kept out of the virtual table, the layout of which is fixed for plugins.
+	 */
+	apt_bool_t (*read_frame_view)(mpf_audio_stream_t *stream, mpf_frame_t *frame);
 };
 
 /** Video stream */
@@ -137,6 +143,19 @@ static APR_INLINE apt_bool_t mpf_audio_stream_frame_read(mpf_audio_stream_t *str
 	return TRUE;
 }
 
+/**
+ * Read frame as a borrowed view.
+ * @remark The stream may point the codec frame to its own buffer instead of copying data
+ *         to the provided one. The view is read-only and valid until the stream is processed
+ *         again, therefore the caller restores its buffer before every read.
+ */
+static APR_INLINE apt_bool_t mpf_audio_stream_frame_view_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	if(stream->read_frame_view)
+		return stream->read_frame_view(stream,frame);
+	return mpf_audio_stream_frame_read(stream,frame);
+}
+
 /** Open audio stream transmitter */
 static APR_INLINE apt_bool_t mpf_audio_stream_tx_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
 {
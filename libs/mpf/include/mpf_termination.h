@@ -24,6 +24,8 @@
 
 #include "mpf_types.h"
 #include "apt_timer_queue.h"
+#include "mpf_rtp_poller.h"
+#include "mpf_rtp_tx_queue.h"
 
 APT_BEGIN_EXTERN_C
 
@@ -63,6 +65,10 @@ struct mpf_termination_t {
 	const mpf_codec_manager_t      *codec_manager;
 	/** Timer queue */
 	apt_timer_queue_t              *timer_queue;
+	/** RTP poller of the worker processing the termination */
+	mpf_rtp_poller_t               *rtp_poller;
+	/** RTP transmit queue of the worker processing the termination */
+	mpf_rtp_tx_queue_t             *rtp_tx_queue;
 	/** Termination factory entire termination created by */
 	mpf_termination_factory_t      *termination_factory;
 	/** Table of virtual methods */
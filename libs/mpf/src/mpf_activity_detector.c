@@ -14,9 +14,32 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <math.h>
 #include "mpf_activity_detector.h"
 #include "apt_log.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MPF_DETECTOR_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MPF_DETECTOR_NEON
+#endif
+
+/** Max number of samples accumulated in 32-bit lanes before widening */
+#define DETECTOR_LEVEL_BLOCK_SAMPLES  65536
+/** Default ratio of band-limited energy to the noise floor in dB */
+#define DETECTOR_SNR_THRESHOLD        9
+/** The noise floor follows decreasing energy with the step of 1/4 ... */
+#define DETECTOR_NOISE_FLOOR_FALL     4
+/** ... and increasing energy with the step of 1/64 (time constant of 1.28 s at 20 msec frames) ... */
+#define DETECTOR_NOISE_FLOOR_RISE     64
+/** ... or 1/512 while active, so that sustained speech does not raise the floor above itself */
+#define DETECTOR_NOISE_FLOOR_RISE_ACTIVE 512
+/** Lower bound of the noise floor, which keeps digital silence from making any noise active */
+#define DETECTOR_NOISE_FLOOR_MIN      1.0
+
 /** Detector states */
 typedef enum {
 	DETECTOR_STATE_INACTIVITY,           /**< inactivity detected */
@@ -27,8 +50,12 @@ typedef enum {
 
 /** Activity detector */
 struct mpf_activity_detector_t {
+	/* mode (algorithm) of activity detection */
+	mpf_detector_mode_e  mode;
 	/* voice activity (silence) level threshold */
 	apr_size_t           level_threshold;
+	/* ratio of band-limited energy to the noise floor required for activity */
+	double               snr_ratio;
 
 	/* period of activity required to complete transition to active state */
 	apr_size_t           speech_timeout;
@@ -43,19 +70,29 @@ struct mpf_activity_detector_t {
 	apr_size_t           duration;
 	/* frame duration  */
 	apr_size_t           frame_duration;
+
+	/* tracked band-limited energy of noise (negative until the first audio frame) */
+	double               noise_floor;
+	/* last samples of the previous frame for the band-limiting filter */
+	apr_int16_t          history[2];
 };
 
 /** Create activity detector */
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool)
 {
 	mpf_activity_detector_t *detector = apr_palloc(pool,sizeof(mpf_activity_detector_t));
+	detector->mode = MPF_DETECTOR_MODE_LEVEL;
 	detector->level_threshold = 2; /* 0 .. 255 */
+	detector->snr_ratio = pow(10.0,DETECTOR_SNR_THRESHOLD / 10.0);
 	detector->speech_timeout = 300; /* 0.3 s */
 	detector->silence_timeout = 300; /* 0.3 s */
 	detector->noinput_timeout = 5000; /* 5 s */
 	detector->duration = 0;
 	detector->frame_duration = CODEC_FRAME_TIME_BASE;
 	detector->state = DETECTOR_STATE_INACTIVITY;
+	detector->noise_floor = -1.0;
+	detector->history[0] = 0;
+	detector->history[1] = 0;
 	return detector;
 }
 
@@ -64,6 +101,10 @@ MPF_DECLARE(void) mpf_activity_detector_reset(mpf_activity_detector_t *detector)
 {
 	detector->duration = 0;
 	detector->state = DETECTOR_STATE_INACTIVITY;
+	/* the noise floor is tracked anew for a new stream */
+	detector->noise_floor = -1.0;
+	detector->history[0] = 0;
+	detector->history[1] = 0;
 }
 
 /** Set threshold of voice activity (silence) level */
@@ -95,6 +136,44 @@ MPF_DECLARE(void) mpf_activity_frame_duration_set(mpf_activity_detector_t *detec
 	detector->frame_duration = frame_duration;
 }
 
+/** Set mode (algorithm) of activity detection */
+MPF_DECLARE(void) mpf_activity_detector_mode_set(mpf_activity_detector_t *detector, mpf_detector_mode_e mode)
+{
+	detector->mode = mode;
+}
+
+/** Set ratio of band-limited energy to the noise floor (in dB) required to detect activity in energy ratio mode */
+MPF_DECLARE(void) mpf_activity_detector_snr_threshold_set(mpf_activity_detector_t *detector, apr_size_t snr_threshold)
+{
+	detector->snr_ratio = pow(10.0,snr_threshold / 10.0);
+}
+
+/** Configure activity detector by name/value params */
+MPF_DECLARE(void) mpf_activity_detector_params_set(mpf_activity_detector_t *detector, const apr_table_t *params)
+{
+	const char *value;
+	if(!params) {
+		return;
+	}
+
+	value = apr_table_get(params,"vad-mode");
+	if(value) {
+		if(strcasecmp(value,"energy-ratio") == 0) {
+			detector->mode = MPF_DETECTOR_MODE_ENERGY_RATIO;
+		}
+		else if(strcasecmp(value,"level") == 0) {
+			detector->mode = MPF_DETECTOR_MODE_LEVEL;
+		}
+		else {
+			apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Unknown VAD Mode [%s]",value);
+		}
+	}
+	value = apr_table_get(params,"vad-snr-threshold");
+	if(value) {
+		mpf_activity_detector_snr_threshold_set(detector,atol(value));
+	}
+}
+
 
 static APR_INLINE void mpf_activity_detector_state_change(mpf_activity_detector_t *detector, mpf_detector_state_e state)
 {
@@ -102,40 +181,180 @@ static APR_INLINE void mpf_activity_detector_state_change(mpf_activity_detector_
 	detector->state = state;
 }
 
-static apr_size_t mpf_activity_detector_level_calculate(const mpf_frame_t *frame)
+/** Calculate mean absolute amplitude of linear samples */
+MPF_DECLARE(apr_size_t) mpf_activity_level_calculate(const apr_int16_t *samples, apr_size_t count)
 {
-	apr_size_t sum = 0;
-	apr_size_t count = frame->codec_frame.size/2;
-	const apr_int16_t *cur = frame->codec_frame.buffer;
-	const apr_int16_t *end = cur + count;
+	apr_uint64_t sum = 0;
+	apr_size_t i = 0;
+	apr_size_t block_end;
 
-	for(; cur < end; cur++) {
-		if(*cur < 0) {
-			sum -= *cur;
+	if(!count) {
+		return 0;
+	}
+
+	for(block_end = 0; i < count; ) {
+		block_end += DETECTOR_LEVEL_BLOCK_SAMPLES;
+		if(block_end > count) {
+			block_end = count;
 		}
-		else {
-			sum += *cur;
+#if defined(MPF_DETECTOR_SSE2)
+		{
+			apr_uint32_t lanes[4];
+			__m128i zero = _mm_setzero_si128();
+			__m128i acc = zero;
+			for(; i + 8 <= block_end; i += 8) {
+				__m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+				__m128i sign = _mm_srai_epi16(x,15);
+				/* |x| as unsigned 16-bit, so that |-32768| is 32768 */
+				__m128i a = _mm_sub_epi16(_mm_xor_si128(x,sign),sign);
+				acc = _mm_add_epi32(acc,_mm_add_epi32(_mm_unpacklo_epi16(a,zero),_mm_unpackhi_epi16(a,zero)));
+			}
+			_mm_storeu_si128((__m128i*)lanes,acc);
+			sum += (apr_uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+		}
+#elif defined(MPF_DETECTOR_NEON)
+		{
+			uint32x4_t acc = vdupq_n_u32(0);
+			for(; i + 8 <= block_end; i += 8) {
+				/* |x| as unsigned 16-bit, so that |-32768| is 32768 */
+				uint16x8_t a = vreinterpretq_u16_s16(vabsq_s16(vld1q_s16(samples + i)));
+				acc = vpadalq_u16(acc,a);
+			}
+			sum += (apr_uint64_t)vgetq_lane_u32(acc,0) + vgetq_lane_u32(acc,1) +
+				vgetq_lane_u32(acc,2) + vgetq_lane_u32(acc,3);
+		}
+#endif
+		for(; i < block_end; i++) {
+			if(samples[i] < 0) {
+				sum -= samples[i];
+			}
+			else {
+				sum += samples[i];
+			}
 		}
 	}
 
-	return sum / count;
+	return (apr_size_t)(sum / count);
 }
 
-/** Process current frame */
-MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+/** Calculate mean energy of band-limited linear samples */
+MPF_DECLARE(apr_uint32_t) mpf_activity_band_energy_calculate(const apr_int16_t *samples, apr_size_t count, apr_int16_t history[2])
 {
-	mpf_detector_event_e det_event = MPF_DETECTOR_EVENT_NONE;
-	apr_size_t level = 0;
-	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		/* first, calculate current activity level of processed frame */
-		level = mpf_activity_detector_level_calculate(frame);
+	apr_uint64_t sum = 0;
+	apr_int32_t y;
+	apr_size_t i;
+
+	if(!count) {
+		return 0;
+	}
+
+	/* the first two samples depend on the previous block */
+	y = (samples[0] >> 1) - (history[0] >> 1);
+	sum += (apr_uint32_t)(y * y);
+	if(count > 1) {
+		y = (samples[1] >> 1) - (history[1] >> 1);
+		sum += (apr_uint32_t)(y * y);
+	}
+
+	i = 2;
+#if defined(MPF_DETECTOR_SSE2)
+	{
+		apr_uint64_t lanes[2];
+		__m128i zero = _mm_setzero_si128();
+		__m128i acc = zero;
+		for(; i + 8 <= count; i += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+			__m128i x2 = _mm_loadu_si128((const __m128i*)(samples + i - 2));
+			__m128i d = _mm_sub_epi16(_mm_srai_epi16(x,1),_mm_srai_epi16(x2,1));
+			/* pairwise sums of squares never exceed 2 * 32767^2 */
+			__m128i m = _mm_madd_epi16(d,d);
+			acc = _mm_add_epi64(acc,_mm_unpacklo_epi32(m,zero));
+			acc = _mm_add_epi64(acc,_mm_unpackhi_epi32(m,zero));
+		}
+		_mm_storeu_si128((__m128i*)lanes,acc);
+		sum += lanes[0] + lanes[1];
+	}
+#elif defined(MPF_DETECTOR_NEON)
+	{
+		uint64x2_t acc = vdupq_n_u64(0);
+		for(; i + 8 <= count; i += 8) {
+			int16x8_t x = vld1q_s16(samples + i);
+			int16x8_t x2 = vld1q_s16(samples + i - 2);
+			int16x8_t d = vsubq_s16(vshrq_n_s16(x,1),vshrq_n_s16(x2,1));
+			acc = vpadalq_u32(acc,vreinterpretq_u32_s32(vmull_s16(vget_low_s16(d),vget_low_s16(d))));
+			acc = vpadalq_u32(acc,vreinterpretq_u32_s32(vmull_s16(vget_high_s16(d),vget_high_s16(d))));
+		}
+		sum += vgetq_lane_u64(acc,0) + vgetq_lane_u64(acc,1);
+	}
+#endif
+	for(; i < count; i++) {
+		y = (samples[i] >> 1) - (samples[i-2] >> 1);
+		sum += (apr_uint32_t)(y * y);
+	}
+
+	if(count > 1) {
+		history[0] = samples[count-2];
+		history[1] = samples[count-1];
+	}
+	else {
+		history[0] = history[1];
+		history[1] = samples[0];
+	}
+	return (apr_uint32_t)(sum / count);
+}
+
+/** Classify current frame as active or inactive */
+static apt_bool_t mpf_activity_detector_frame_classify(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+{
+	const apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t count = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_size_t level;
+	double energy;
+	apt_bool_t active;
+
+	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) != MEDIA_FRAME_TYPE_AUDIO || !count) {
+		return FALSE;
+	}
+
+	/* first, calculate current activity level of processed frame */
+	level = mpf_activity_level_calculate(samples,count);
 #if 0
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"]",level);
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"]",level);
 #endif
+	if(detector->mode != MPF_DETECTOR_MODE_ENERGY_RATIO) {
+		return level >= detector->level_threshold ? TRUE : FALSE;
+	}
+
+	energy = mpf_activity_band_energy_calculate(samples,count,detector->history);
+	if(detector->noise_floor < 0) {
+		/* start tracking from the energy of the first frame */
+		detector->noise_floor = energy;
+	}
+	if(detector->noise_floor < DETECTOR_NOISE_FLOOR_MIN) {
+		detector->noise_floor = DETECTOR_NOISE_FLOOR_MIN;
+	}
+
+	active = (level >= detector->level_threshold && energy > detector->noise_floor * detector->snr_ratio) ? TRUE : FALSE;
+
+	/* follow the minimum of energy: quickly downwards, slowly upwards */
+	if(energy < detector->noise_floor) {
+		detector->noise_floor += (energy - detector->noise_floor) / DETECTOR_NOISE_FLOOR_FALL;
+	}
+	else {
+		detector->noise_floor += (energy - detector->noise_floor) /
+			(active == TRUE ? DETECTOR_NOISE_FLOOR_RISE_ACTIVE : DETECTOR_NOISE_FLOOR_RISE);
 	}
+	return active;
+}
+
+/** Process current frame */
+MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+{
+	mpf_detector_event_e det_event = MPF_DETECTOR_EVENT_NONE;
+	apt_bool_t active = mpf_activity_detector_frame_classify(detector,frame);
 
 	if(detector->state == DETECTOR_STATE_INACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			/* start to detect activity */
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY_TRANSITION);
 		}
@@ -148,7 +367,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			detector->duration += detector->frame_duration;
 			if(detector->duration >= detector->speech_timeout) {
 				/* finally detected activity */
@@ -162,7 +381,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			detector->duration += detector->frame_duration;
 		}
 		else {
@@ -171,7 +390,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_INACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(active == TRUE) {
 			/* fallback to activity */
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY);
 		}
@@ -35,6 +35,8 @@ struct mpf_bridge_t {
 	mpf_codec_t        *codec;
 	/** Media frame used to read data from source and write it to sink */
 	mpf_frame_t         frame;
+	/** Buffer of the media frame, unless the source lends its own one (null bridge) */
+	void               *buffer;
 	/** Number of ticks in a frame (frame_duration/CODEC_FRAME_TIME_BASE) */
 	apr_byte_t          base_ticks;
 	/** Number of ticks incremented on every CODEC_FRAME_TIME_BASE */
@@ -61,6 +63,7 @@ static apt_bool_t mpf_bridge_process(mpf_object_t *object)
 	bridge->frame.type = MEDIA_FRAME_TYPE_NONE;
 	bridge->frame.marker = MPF_MARKER_NONE;
 	bridge->source->vtable->read_frame(bridge->source,&bridge->frame);
+	object->active = bridge->frame.type != MEDIA_FRAME_TYPE_NONE ? TRUE : FALSE;
 	
 	if((bridge->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		memset(	bridge->frame.codec_frame.buffer,
@@ -79,10 +82,14 @@ static apt_bool_t mpf_null_bridge_process(mpf_object_t *object)
 		return TRUE;
 	bridge->frame.type = MEDIA_FRAME_TYPE_NONE;
 	bridge->frame.marker = MPF_MARKER_NONE;
-	bridge->source->vtable->read_frame(bridge->source,&bridge->frame);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
+	/* pass the encoded frame from the buffer of the source to the sink, if lent */
+	mpf_audio_stream_frame_view_read(bridge->source,&bridge->frame);
+	object->active = bridge->frame.type != MEDIA_FRAME_TYPE_NONE ? TRUE : FALSE;
 
 	if((bridge->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		/* generate silence frame */
+		bridge->frame.codec_frame.buffer = bridge->buffer;
 		mpf_codec_fill(bridge->codec,&bridge->frame.codec_frame);
 	}
 
@@ -132,6 +139,7 @@ static mpf_bridge_t* mpf_bridge_base_create(mpf_audio_stream_t *source, mpf_audi
 	bridge->source = source;
 	bridge->sink = sink;
 	bridge->codec = NULL;
+	bridge->buffer = NULL;
 	bridge->base_ticks = base_ticks;
 	bridge->cur_ticks = 0;
 	mpf_object_init(&bridge->base,name);
@@ -196,7 +204,8 @@ static mpf_object_t* mpf_null_bridge_create(mpf_audio_stream_t *source, mpf_audi
 		codec->attribs->bits_per_sample);
 	bridge->codec = codec;
 	bridge->frame.codec_frame.size = frame_size;
-	bridge->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	bridge->buffer = apr_palloc(pool,frame_size);
+	bridge->frame.codec_frame.buffer = bridge->buffer;
 
 	if(mpf_audio_stream_rx_open(source,codec) == FALSE) {
 		return NULL;
@@ -17,154 +17,309 @@
 #ifdef WIN32
 #pragma warning(disable: 4127)
 #endif
+#include <stdlib.h>
 #include <apr_ring.h>
 #include "mpf_buffer.h"
 
-typedef struct mpf_chunk_t mpf_chunk_t;
+typedef struct mpf_slot_t mpf_slot_t;
 
-struct mpf_chunk_t {
-	APR_RING_ENTRY(mpf_chunk_t) link;
-	mpf_frame_t                 frame;
+/** Slot holding either a piece of audio or an event */
+struct mpf_slot_t {
+	APR_RING_ENTRY(mpf_slot_t) link;
+	/** Type of the frame (audio and/or event) */
+	int                        type;
+	/** Buffer of slot_size */
+	char                      *data;
+	/** Number of bytes written */
+	apr_size_t                 size;
+	/** Number of bytes already read */
+	apr_size_t                 offset;
+	/** Whether the slot is allocated on the heap on overflow and freed once read */
+	apt_bool_t                 overflow;
 };
 
 struct mpf_buffer_t {
-	APR_RING_HEAD(mpf_chunk_head_t, mpf_chunk_t) head;
-	mpf_chunk_t                                 *cur_chunk;
-	apr_size_t                                   remaining_chunk_size;
+	/** Ring of slots in use */
+	APR_RING_HEAD(mpf_slot_head_t, mpf_slot_t)  head;
+	/** Ring of slots available for reuse */
+	APR_RING_HEAD(mpf_slot_free_head_t, mpf_slot_t) free_list;
+	apr_size_t                                   slot_size;
+	apr_size_t                                   max_slot_count;
+	apr_size_t                                   allocated_slot_count;
+	apr_size_t                                   used_slot_count;
+	apr_size_t                                   overflow_count;
 	apr_thread_mutex_t                          *guard;
 	apr_pool_t                                  *pool;
 	apr_size_t                                   size; /* total size */
+	apr_size_t                                   peak_size;
 };
 
+static mpf_slot_t* mpf_buffer_slot_alloc(mpf_buffer_t *buffer)
+{
+	mpf_slot_t *slot = apr_palloc(buffer->pool,sizeof(mpf_slot_t));
+	slot->data = apr_palloc(buffer->pool,buffer->slot_size);
+	slot->overflow = FALSE;
+	APR_RING_ELEM_INIT(slot,link);
+	buffer->allocated_slot_count++;
+	return slot;
+}
+
+static mpf_slot_t* mpf_buffer_overflow_slot_alloc(mpf_buffer_t *buffer)
+{
+	/* allocate the slot and its data at once, so that it can be freed once read */
+	mpf_slot_t *slot = malloc(sizeof(mpf_slot_t) + buffer->slot_size);
+	if(!slot) {
+		return NULL;
+	}
+	slot->data = (char*)(slot + 1);
+	slot->overflow = TRUE;
+	APR_RING_ELEM_INIT(slot,link);
+	buffer->allocated_slot_count++;
+	return slot;
+}
+
+/** Free the overflow slots still queued, as they are not owned by the pool */
+static apr_status_t mpf_buffer_cleanup(void *data)
+{
+	mpf_buffer_t *buffer = data;
+	mpf_slot_t *slot;
+	mpf_slot_t *next;
+	slot = APR_RING_FIRST(&buffer->head);
+	while(slot != APR_RING_SENTINEL(&buffer->head,mpf_slot_t,link)) {
+		next = APR_RING_NEXT(slot,link);
+		if(slot->overflow == TRUE) {
+			APR_RING_REMOVE(slot,link);
+			buffer->used_slot_count--;
+			buffer->allocated_slot_count--;
+			free(slot);
+		}
+		slot = next;
+	}
+	return APR_SUCCESS;
+}
+
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool)
 {
+	return mpf_buffer_create_ex(MPF_BUFFER_DEFAULT_SLOT_SIZE,MPF_BUFFER_DEFAULT_SLOT_COUNT,0,pool);
+}
+
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t slot_size, apr_size_t slot_count, apr_size_t max_slot_count, apr_pool_t *pool)
+{
+	apr_size_t i;
+	mpf_slot_t *slot;
 	mpf_buffer_t *buffer = apr_palloc(pool,sizeof(mpf_buffer_t));
+	if(!slot_size) {
+		slot_size = MPF_BUFFER_DEFAULT_SLOT_SIZE;
+	}
+	if(max_slot_count && max_slot_count < slot_count) {
+		max_slot_count = slot_count;
+	}
 	buffer->pool = pool;
-	buffer->cur_chunk = NULL;
-	buffer->remaining_chunk_size = 0;
+	buffer->slot_size = slot_size;
+	buffer->max_slot_count = max_slot_count;
+	buffer->allocated_slot_count = 0;
+	buffer->used_slot_count = 0;
+	buffer->overflow_count = 0;
 	buffer->size = 0;
-	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
+	buffer->peak_size = 0;
+	APR_RING_INIT(&buffer->head, mpf_slot_t, link);
+	APR_RING_INIT(&buffer->free_list, mpf_slot_t, link);
+	for(i=0; i<slot_count; i++) {
+		slot = mpf_buffer_slot_alloc(buffer);
+		APR_RING_INSERT_TAIL(&buffer->free_list,slot,mpf_slot_t,link);
+	}
 	apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	/* registered after the mutex, so that it is run before the mutex is destroyed along with the pool */
+	apr_pool_cleanup_register(pool,buffer,mpf_buffer_cleanup,apr_pool_cleanup_null);
 	return buffer;
 }
 
 void mpf_buffer_destroy(mpf_buffer_t *buffer)
 {
+	apr_pool_cleanup_kill(buffer->pool,buffer,mpf_buffer_cleanup);
+	mpf_buffer_restart(buffer);
 	if(buffer->guard) {
 		apr_thread_mutex_destroy(buffer->guard);
 		buffer->guard = NULL;
 	}
 }
 
+static APR_INLINE void mpf_buffer_slot_recycle(mpf_buffer_t *buffer, mpf_slot_t *slot)
+{
+	buffer->used_slot_count--;
+	if(slot->overflow == TRUE) {
+		/* give the memory of the overflow slot back, preallocated slots are kept */
+		buffer->allocated_slot_count--;
+		free(slot);
+		return;
+	}
+	APR_RING_INSERT_HEAD(&buffer->free_list,slot,mpf_slot_t,link);
+}
+
+static APR_INLINE void mpf_buffer_slot_release(mpf_buffer_t *buffer, mpf_slot_t *slot)
+{
+	APR_RING_REMOVE(slot,link);
+	mpf_buffer_slot_recycle(buffer,slot);
+}
+
 apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer)
 {
+	mpf_slot_t *slot;
+	mpf_slot_t *next;
 	apr_thread_mutex_lock(buffer->guard);
-	buffer->cur_chunk = NULL;
-	buffer->remaining_chunk_size = 0;
+	/* walk the chain by next pointers, the slots may be freed on the way */
+	slot = APR_RING_FIRST(&buffer->head);
+	while(slot != APR_RING_SENTINEL(&buffer->head,mpf_slot_t,link)) {
+		next = APR_RING_NEXT(slot,link);
+		mpf_buffer_slot_recycle(buffer,slot);
+		slot = next;
+	}
+	APR_RING_INIT(&buffer->head,mpf_slot_t,link);
 	buffer->size = 0;
-	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
 	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
 }
 
-static APR_INLINE apt_bool_t mpf_buffer_chunk_write(mpf_buffer_t *buffer, mpf_chunk_t *chunk)
+/** Take a slot from the free list or allocate an overflow one and append it to the ring */
+static mpf_slot_t* mpf_buffer_slot_write(mpf_buffer_t *buffer, int type)
 {
-	APR_RING_INSERT_TAIL(&buffer->head,chunk,mpf_chunk_t,link);
-	return TRUE;
+	mpf_slot_t *slot;
+	if(!APR_RING_EMPTY(&buffer->free_list,mpf_slot_t,link)) {
+		slot = APR_RING_FIRST(&buffer->free_list);
+		APR_RING_REMOVE(slot,link);
+	}
+	else if(!buffer->max_slot_count || buffer->allocated_slot_count < buffer->max_slot_count) {
+		slot = mpf_buffer_overflow_slot_alloc(buffer);
+	}
+	else {
+		slot = NULL;
+	}
+	if(!slot) {
+		return NULL;
+	}
+
+	slot->type = type;
+	slot->size = 0;
+	slot->offset = 0;
+	APR_RING_INSERT_TAIL(&buffer->head,slot,mpf_slot_t,link);
+	buffer->used_slot_count++;
+	return slot;
 }
 
-static APR_INLINE mpf_chunk_t* mpf_buffer_chunk_read(mpf_buffer_t *buffer)
+/** Get the number of bytes which can be written without exceeding the max number of slots */
+static apr_size_t mpf_buffer_room_get(const mpf_buffer_t *buffer)
 {
-	mpf_chunk_t *chunk = NULL;
-	if(!APR_RING_EMPTY(&buffer->head,mpf_chunk_t,link)) {
-		chunk = APR_RING_FIRST(&buffer->head);
-		APR_RING_REMOVE(chunk,link);
+	apr_size_t room;
+	if(!buffer->max_slot_count) {
+		return (apr_size_t)-1;
 	}
-	return chunk;
+
+	room = (buffer->max_slot_count - buffer->used_slot_count) * buffer->slot_size;
+	if(!APR_RING_EMPTY(&buffer->head,mpf_slot_t,link)) {
+		const mpf_slot_t *slot = APR_RING_LAST(&buffer->head);
+		if(slot->type == MEDIA_FRAME_TYPE_AUDIO) {
+			room += buffer->slot_size - slot->size;
+		}
+	}
+	return room;
 }
 
 apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size)
 {
-	mpf_chunk_t *chunk;
-	apt_bool_t status;
+	mpf_slot_t *slot = NULL;
+	apr_size_t length;
+	const char *pos = data;
 	apr_thread_mutex_lock(buffer->guard);
 
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = apr_palloc(buffer->pool,size);
-	memcpy(chunk->frame.codec_frame.buffer,data,size);
-	chunk->frame.codec_frame.size = size;
-	chunk->frame.type = MEDIA_FRAME_TYPE_AUDIO;
-	status = mpf_buffer_chunk_write(buffer,chunk);
-	
+	if(size > mpf_buffer_room_get(buffer)) {
+		buffer->overflow_count++;
+		apr_thread_mutex_unlock(buffer->guard);
+		return FALSE;
+	}
+
+	/* keep filling up the last slot, if it holds audio only */
+	if(!APR_RING_EMPTY(&buffer->head,mpf_slot_t,link)) {
+		slot = APR_RING_LAST(&buffer->head);
+		if(slot->type != MEDIA_FRAME_TYPE_AUDIO) {
+			slot = NULL;
+		}
+	}
+
 	buffer->size += size;
+	while(size) {
+		if(!slot || slot->size == buffer->slot_size) {
+			slot = mpf_buffer_slot_write(buffer,MEDIA_FRAME_TYPE_AUDIO);
+			if(!slot) {
+				/* out of memory, the rest of the chunk is lost */
+				buffer->size -= size;
+				buffer->overflow_count++;
+				break;
+			}
+		}
+		length = buffer->slot_size - slot->size;
+		if(length > size) {
+			length = size;
+		}
+		memcpy(slot->data + slot->size,pos,length);
+		slot->size += length;
+		pos += length;
+		size -= length;
+	}
+
+	if(buffer->size > buffer->peak_size) {
+		buffer->peak_size = buffer->size;
+	}
 	apr_thread_mutex_unlock(buffer->guard);
-	return status;
+	return size ? FALSE : TRUE;
 }
 
 apt_bool_t mpf_buffer_event_write(mpf_buffer_t *buffer, mpf_frame_type_e event_type)
 {
-	mpf_chunk_t *chunk;
-	apt_bool_t status;
+	mpf_slot_t *slot;
 	apr_thread_mutex_lock(buffer->guard);
-
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = NULL;
-	chunk->frame.codec_frame.size = 0;
-	chunk->frame.type = event_type;
-	status = mpf_buffer_chunk_write(buffer,chunk);
-	
+	slot = mpf_buffer_slot_write(buffer,event_type);
+	if(!slot) {
+		buffer->overflow_count++;
+	}
 	apr_thread_mutex_unlock(buffer->guard);
-	return status;
+	return slot ? TRUE : FALSE;
 }
 
 apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame)
 {
-	mpf_codec_frame_t *dest;
-	mpf_codec_frame_t *src;
+	mpf_slot_t *slot;
+	apr_size_t length;
+	char *dest = media_frame->codec_frame.buffer;
 	apr_size_t remaining_frame_size = media_frame->codec_frame.size;
 	apr_thread_mutex_lock(buffer->guard);
 	do {
-		if(!buffer->cur_chunk) {
-			buffer->cur_chunk = mpf_buffer_chunk_read(buffer);
-			if(!buffer->cur_chunk) {
-				/* buffer is empty */
-				break;
-			}
-			buffer->remaining_chunk_size = buffer->cur_chunk->frame.codec_frame.size;
+		if(APR_RING_EMPTY(&buffer->head,mpf_slot_t,link)) {
+			/* buffer is empty */
+			break;
 		}
 
-		dest = &media_frame->codec_frame;
-		src = &buffer->cur_chunk->frame.codec_frame;
-		media_frame->type |= buffer->cur_chunk->frame.type;
-		if(remaining_frame_size < buffer->remaining_chunk_size) {
+		slot = APR_RING_FIRST(&buffer->head);
+		media_frame->type |= slot->type;
+		length = slot->size - slot->offset;
+		if(remaining_frame_size < length) {
 			/* copy remaining_frame_size */
-			memcpy(
-				(char*)dest->buffer + dest->size - remaining_frame_size,
-				(char*)src->buffer + src->size - buffer->remaining_chunk_size,
-				remaining_frame_size);
-			buffer->remaining_chunk_size -= remaining_frame_size;
-			buffer->size -= remaining_frame_size;
-			remaining_frame_size = 0;
+			length = remaining_frame_size;
 		}
-		else {
-			/* copy remaining_chunk_size and proceed to the next chunk */
-			memcpy(
-				(char*)dest->buffer + dest->size - remaining_frame_size,
-				(char*)src->buffer + src->size - buffer->remaining_chunk_size,
-				buffer->remaining_chunk_size);
-			remaining_frame_size -= buffer->remaining_chunk_size;
-			buffer->size -= buffer->remaining_chunk_size;
-			buffer->remaining_chunk_size = 0;
-			buffer->cur_chunk = NULL;
+		memcpy(dest,slot->data + slot->offset,length);
+		dest += length;
+		slot->offset += length;
+		buffer->size -= length;
+		remaining_frame_size -= length;
+
+		if(slot->offset == slot->size) {
+			/* recycle the slot and proceed to the next one */
+			mpf_buffer_slot_release(buffer,slot);
 		}
 	}
 	while(remaining_frame_size);
 
 	if(remaining_frame_size) {
-		apr_size_t offset = media_frame->codec_frame.size - remaining_frame_size;
-		memset((char*)media_frame->codec_frame.buffer + offset, 0, remaining_frame_size);
+		memset(dest, 0, remaining_frame_size);
 	}
 	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
@@ -174,3 +329,16 @@ apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer)
 {
 	return buffer->size;
 }
+
+void mpf_buffer_stat_get(mpf_buffer_t *buffer, mpf_buffer_stat_t *stat)
+{
+	apr_thread_mutex_lock(buffer->guard);
+	stat->size = buffer->size;
+	stat->peak_size = buffer->peak_size;
+	stat->used_slots = buffer->used_slot_count;
+	stat->allocated_slots = buffer->allocated_slot_count;
+	stat->max_slots = buffer->max_slot_count;
+	stat->slot_size = buffer->slot_size;
+	stat->overflow_count = buffer->overflow_count;
+	apr_thread_mutex_unlock(buffer->guard);
+}
@@ -35,6 +35,7 @@
 #define AMR_WB_CODEC_NAME_LENGTH (sizeof(AMR_WB_CODEC_NAME)-1)
 
 #define AMR_WB_SID  9
+#define AMR_WB_NO_DATA  15
 #define DEFAULT_AMR_WB_MODE  8
 
 /* AMR-WB frame lengths in bytes */
@@ -187,6 +188,20 @@ static apt_bool_t mpf_amr_wb_decode(mpf_codec_t *codec, const mpf_codec_frame_t
 	return TRUE;
 }
 
+static apt_bool_t mpf_amr_wb_conceal(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
+{
+	/* TOC of a frame with no data, the decoder substitutes the lost speech by its own error concealment */
+	unsigned char toc = (AMR_WB_NO_DATA << 3) | 0x04;
+	mpf_amr_wb_decoder_t *decoder = codec->decoder_obj;
+	if (!decoder)
+		return FALSE;
+
+	AMR_TRACE("AMR-WB Conceal frame\n");
+	D_IF_decode(decoder->state, &toc, frame_out->buffer, 0);
+	frame_out->size = 640; /* 16000 * 20 / 1000 * 2 */
+	return TRUE;
+}
+
 static apt_bool_t mpf_amr_wb_pack(mpf_codec_t *codec, const mpf_codec_frame_t frames[], apr_uint16_t frame_count, apr_size_t *size)
 {
 	if(!frame_count)
@@ -397,7 +412,8 @@ static const mpf_codec_vtable_t mpf_amr_wb_vtable = {
 	mpf_amr_wb_pack,
 	mpf_amr_wb_dissect,
 	mpf_amr_wb_fill,
-	mpf_amr_wb_format_match
+	mpf_amr_wb_format_match,
+	mpf_amr_wb_conceal
 };
 
 static const mpf_codec_attribs_t mpf_amr_wb_attribs = {
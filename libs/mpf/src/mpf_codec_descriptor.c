@@ -54,6 +54,24 @@ static APR_INLINE apt_bool_t mpf_sampling_rate_check(apr_uint16_t sampling_rate,
 	return (mpf_sample_rate_mask_get(sampling_rate) & mask) ? TRUE : FALSE;
 }
 
+/** Get the sampling rate from the mask closest to the specified one (prefer upsampling to downsampling) */
+static apr_uint16_t mpf_sampling_rate_closest_get(apr_uint16_t sampling_rate, int mask)
+{
+	static const apr_uint16_t sampling_rates[] = {8000, 16000, 32000, 48000};
+	apr_uint16_t closest = 0;
+	apr_size_t i;
+	for(i=0; i<sizeof(sampling_rates)/sizeof(sampling_rates[0]); i++) {
+		if(mpf_sampling_rate_check(sampling_rates[i],mask) == FALSE) {
+			continue;
+		}
+		closest = sampling_rates[i];
+		if(closest >= sampling_rate) {
+			break;
+		}
+	}
+	return closest;
+}
+
 MPF_DECLARE(mpf_codec_descriptor_t*) mpf_codec_lpcm_descriptor_create(apr_uint16_t sampling_rate, apr_byte_t channel_count, apr_uint16_t frame_duration, apr_pool_t *pool)
 {
 	mpf_codec_descriptor_t *descriptor = mpf_codec_descriptor_create(pool);
@@ -70,8 +88,18 @@ MPF_DECLARE(mpf_codec_descriptor_t*) mpf_codec_descriptor_create_by_capabilities
 {
 	mpf_codec_descriptor_t *descriptor;
 	mpf_codec_attribs_t *attribs = NULL;
+	apr_uint16_t sampling_rate = 0;
 	if(capabilities && peer) {
 		attribs = mpf_codec_capabilities_attribs_find(capabilities,peer);
+		if(!attribs && capabilities->attrib_arr->nelts) {
+			/* no match by sampling rate, use the closest one supported, 
+			the sampling rate is to be converted by resampler then */
+			attribs = &APR_ARRAY_IDX(capabilities->attrib_arr,0,mpf_codec_attribs_t);
+			sampling_rate = mpf_sampling_rate_closest_get(peer->sampling_rate,attribs->sample_rates);
+			if(!sampling_rate) {
+				attribs = NULL;
+			}
+		}
 	}
 	
 	if(!attribs) {
@@ -80,7 +108,12 @@ MPF_DECLARE(mpf_codec_descriptor_t*) mpf_codec_descriptor_create_by_capabilities
 
 	descriptor = mpf_codec_descriptor_create(pool);
 	*descriptor = *peer;
-	if(apt_string_compare(&peer->name,&attribs->name) == FALSE) {
+	if(sampling_rate) {
+		mpf_codec_sampling_rate_set(descriptor,sampling_rate);
+		descriptor->payload_type = RTP_PT_UNKNOWN;
+		descriptor->name = attribs->name;
+	}
+	else if(apt_string_compare(&peer->name,&attribs->name) == FALSE) {
 		descriptor->payload_type = RTP_PT_UNKNOWN;
 		descriptor->name = attribs->name;
 	}
@@ -185,16 +218,28 @@ MPF_DECLARE(apt_bool_t) mpf_codec_list_match(mpf_codec_list_t *codec_list, const
 	int i;
 	mpf_codec_descriptor_t *descriptor;
 	apt_bool_t status = FALSE;
+	apt_bool_t resampling;
 	if(!capabilities) {
 		return FALSE;
 	}
 
+	/* fall back to resampling only if no codec matches the capabilities as is */
+	resampling = capabilities->attrib_arr->nelts ? TRUE : FALSE;
+	for(i=0; i<codec_list->descriptor_arr->nelts; i++) {
+		descriptor = &APR_ARRAY_IDX(codec_list->descriptor_arr,i,mpf_codec_descriptor_t);
+		if(descriptor->enabled == TRUE && mpf_codec_capabilities_attribs_find(capabilities,descriptor)) {
+			resampling = FALSE;
+			break;
+		}
+	}
+
 	for(i=0; i<codec_list->descriptor_arr->nelts; i++) {
 		descriptor = &APR_ARRAY_IDX(codec_list->descriptor_arr,i,mpf_codec_descriptor_t);
 		if(descriptor->enabled == FALSE) continue;
 
 		/* match capabilities */
-		if(mpf_codec_capabilities_attribs_find(capabilities,descriptor)) {
+		if(mpf_codec_capabilities_attribs_find(capabilities,descriptor) ||
+			(resampling == TRUE && mpf_sample_rate_mask_get(descriptor->sampling_rate) != MPF_SAMPLE_RATE_NONE)) {
 			/* at least one codec descriptor matches */
 			status = TRUE;
 		}
@@ -16,6 +16,7 @@
 
 #include "mpf_codec.h"
 #include "mpf_rtp_pt.h"
+#include "mpf_plc.h"
 #include "g722/g722.h"
 
 #define G722_CODEC_NAME        "G722"
@@ -32,6 +33,8 @@ struct mpf_g722_encoder_t {
 
 struct mpf_g722_decoder_t {
 	g722_decode_state_t   state;
+	mpf_plc_t            *plc;
+	apr_size_t            frame_samples;
 };
 
 static apt_bool_t mpf_g722_encoder_open(mpf_codec_t *codec, mpf_codec_descriptor_t *descriptor)
@@ -59,6 +62,14 @@ static apt_bool_t mpf_g722_decoder_open(mpf_codec_t *codec, mpf_codec_descriptor
 {
 	mpf_g722_decoder_t *decoder = (mpf_g722_decoder_t*)apr_palloc(codec->pool, sizeof(mpf_g722_decoder_t));
 	g722_decode_init(&decoder->state, 64000, 0);
+	decoder->plc = NULL;
+	decoder->frame_samples = 0;
+	if (descriptor && descriptor->channel_count == 1) {
+		/* conceal lost frames by repeating the decoded waveform */
+		decoder->frame_samples = mpf_codec_frame_samples_calculate(
+			descriptor->sampling_rate, descriptor->channel_count, descriptor->frame_duration);
+		decoder->plc = mpf_plc_create(descriptor->sampling_rate, decoder->frame_samples, codec->pool);
+	}
 
 	codec->decoder_obj = decoder;
 	return TRUE;
@@ -97,6 +108,23 @@ static apt_bool_t mpf_g722_decode(mpf_codec_t *codec, const mpf_codec_frame_t *f
 	decode_buf = frame_out->buffer;
 	size = g722_decode(&decoder->state, decode_buf, frame_in->buffer, (int) frame_in->size);
 	frame_out->size = size * sizeof(apr_int16_t);
+	if (decoder->plc && (apr_size_t) size == decoder->frame_samples) {
+		mpf_plc_good_frame(decoder->plc, decode_buf);
+	}
+	return TRUE;
+}
+
+static apt_bool_t mpf_g722_conceal(mpf_codec_t *codec, mpf_codec_frame_t *frame_out)
+{
+	mpf_g722_decoder_t *decoder = codec->decoder_obj;
+	if (!decoder || !decoder->plc)
+		return FALSE;
+
+	/* the ADPCM state is left intact, it adapts to the received signal shortly */
+	if (mpf_plc_lost_frame(decoder->plc, frame_out->buffer) == FALSE)
+		return FALSE;
+
+	frame_out->size = decoder->frame_samples * sizeof(apr_int16_t);
 	return TRUE;
 }
 
@@ -127,7 +155,8 @@ static const mpf_codec_vtable_t g722_vtable = {
 	NULL,
 	NULL,
 	mpf_g722_fill,
-	NULL
+	NULL,
+	mpf_g722_conceal
 };
 
 static const mpf_codec_descriptor_t g722_descriptor = {
@@ -65,6 +65,7 @@ static const mpf_codec_vtable_t l16_vtable = {
 	NULL,
 	NULL,
 	NULL,
+	NULL,
 	NULL
 };
 
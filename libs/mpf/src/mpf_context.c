@@ -18,6 +18,7 @@
 #pragma warning(disable: 4127)
 #endif
 #include <apr_ring.h> 
+#include <apr_atomic.h>
 #include "mpf_context.h"
 #include "mpf_termination.h"
 #include "mpf_stream.h"
@@ -50,6 +51,8 @@ struct mpf_context_t {
 	const char                   *name;
 	/** External object */
 	void                         *obj;
+	/** Whether the context is accounted in the load of the factory */
+	apt_bool_t                    attached;
 
 	/** Max number of terminations in the context */
 	apr_size_t                    capacity;
@@ -69,6 +72,10 @@ struct mpf_context_t {
 struct mpf_context_factory_t {
 	/** Ring head */
 	APR_RING_HEAD(mpf_context_head_t, mpf_context_t) head;
+	/** Number of contexts either being processed or pending to be processed */
+	volatile apr_uint32_t context_count;
+	/** Number of contexts, in which any stream produced data in the last tick */
+	apr_size_t            active_count;
 };
 
 
@@ -82,6 +89,8 @@ MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_create(apr_pool_t *pool)
 {
 	mpf_context_factory_t *factory = apr_palloc(pool, sizeof(mpf_context_factory_t));
 	APR_RING_INIT(&factory->head, mpf_context_t, link);
+	factory->context_count = 0;
+	factory->active_count = 0;
 	return factory;
 }
 
@@ -98,16 +107,52 @@ MPF_DECLARE(void) mpf_context_factory_destroy(mpf_context_factory_t *factory)
 MPF_DECLARE(apt_bool_t) mpf_context_factory_process(mpf_context_factory_t *factory)
 {
 	mpf_context_t *context;
+	int i;
+	mpf_object_t *object;
+	factory->active_count = 0;
 	for(context = APR_RING_FIRST(&factory->head);
 			context != APR_RING_SENTINEL(&factory->head, mpf_context_t, link);
 				context = APR_RING_NEXT(context, link)) {
 		
 		mpf_context_process(context);
+
+		for(i=0; i<context->mpf_objects->nelts; i++) {
+			object = APR_ARRAY_IDX(context->mpf_objects,i,mpf_object_t*);
+			if(object && object->active == TRUE) {
+				factory->active_count++;
+				break;
+			}
+		}
 	}
 
 	return TRUE;
 }
 
+MPF_DECLARE(apr_size_t) mpf_context_factory_load_get(mpf_context_factory_t *factory)
+{
+	return apr_atomic_read32(&factory->context_count);
+}
+
+MPF_DECLARE(apr_size_t) mpf_context_factory_active_count_get(const mpf_context_factory_t *factory)
+{
+	return factory->active_count;
+}
+
+static APR_INLINE void mpf_context_attach(mpf_context_t *context)
+{
+	if(context->attached == FALSE) {
+		context->attached = TRUE;
+		apr_atomic_inc32(&context->factory->context_count);
+	}
+}
+
+static APR_INLINE void mpf_context_detach(mpf_context_t *context)
+{
+	if(context->attached == TRUE) {
+		context->attached = FALSE;
+		apr_atomic_dec32(&context->factory->context_count);
+	}
+}
  
 MPF_DECLARE(mpf_context_t*) mpf_context_create(
 								mpf_context_factory_t *factory,
@@ -145,6 +190,10 @@ MPF_DECLARE(mpf_context_t*) mpf_context_create(
 		}
 	}
 
+	/* account the context in the load of the factory until it is either destroyed or
+	left without terminations */
+	context->attached = FALSE;
+	mpf_context_attach(context);
 	return context;
 }
 
@@ -159,6 +208,7 @@ MPF_DECLARE(apt_bool_t) mpf_context_destroy(mpf_context_t *context)
 			mpf_termination_subtract(termination);
 		}
 	}
+	mpf_context_detach(context);
 	return TRUE;
 }
 
@@ -167,6 +217,11 @@ MPF_DECLARE(void*) mpf_context_object_get(const mpf_context_t *context)
 	return context->obj;
 }
 
+MPF_DECLARE(mpf_context_factory_t*) mpf_context_factory_get(const mpf_context_t *context)
+{
+	return context->factory;
+}
+
 MPF_DECLARE(apt_bool_t) mpf_context_termination_add(mpf_context_t *context, mpf_termination_t *termination)
 {
 	apr_size_t i;
@@ -179,6 +234,7 @@ MPF_DECLARE(apt_bool_t) mpf_context_termination_add(mpf_context_t *context, mpf_
 		if(!context->count) {
 			apt_log(MPF_LOG_MARK,APT_PRIO_DEBUG,"Add Media Context %s",context->name);
 			APR_RING_INSERT_TAIL(&context->factory->head,context,mpf_context_t,link);
+			mpf_context_attach(context);
 		}
 
 		header_item->termination = termination;
@@ -235,6 +291,7 @@ MPF_DECLARE(apt_bool_t) mpf_context_termination_subtract(mpf_context_t *context,
 	if(!context->count) {
 		apt_log(MPF_LOG_MARK,APT_PRIO_DEBUG,"Remove Media Context %s",context->name);
 		APR_RING_REMOVE(context,link);
+		mpf_context_detach(context);
 	}
 	return TRUE;
 }
@@ -24,6 +24,8 @@ struct mpf_decoder_t {
 	mpf_audio_stream_t *source;
 	mpf_codec_t        *codec;
 	mpf_frame_t         frame_in;
+	/* buffer of the input frame, unless the source lends its own one */
+	void               *buffer_in;
 };
 
 static apt_bool_t mpf_decoder_destroy(mpf_audio_stream_t *stream)
@@ -57,7 +59,9 @@ static apt_bool_t mpf_decoder_process(mpf_audio_stream_t *stream, mpf_frame_t *f
 	mpf_decoder_t *decoder = stream->obj;
 	decoder->frame_in.type = MEDIA_FRAME_TYPE_NONE;
 	decoder->frame_in.marker = MPF_MARKER_NONE;
-	if(mpf_audio_stream_frame_read(decoder->source,&decoder->frame_in) != TRUE) {
+	decoder->frame_in.codec_frame.buffer = decoder->buffer_in;
+	/* decode right from the buffer of the source (the slot of the jitter buffer), if lent */
+	if(mpf_audio_stream_frame_view_read(decoder->source,&decoder->frame_in) != TRUE) {
 		return FALSE;
 	}
 
@@ -69,6 +73,13 @@ static apt_bool_t mpf_decoder_process(mpf_audio_stream_t *stream, mpf_frame_t *f
 	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
 		mpf_codec_decode(decoder->codec,&decoder->frame_in.codec_frame,&frame->codec_frame);
 	}
+	else if((frame->type & MEDIA_FRAME_TYPE_LOST) == MEDIA_FRAME_TYPE_LOST) {
+		/* let the codec conceal the lost frame */
+		frame->type &= ~MEDIA_FRAME_TYPE_LOST;
+		if(mpf_codec_conceal(decoder->codec,&frame->codec_frame) == TRUE) {
+			frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+		}
+	}
 	return TRUE;
 }
 
@@ -132,6 +143,7 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_decoder_create(mpf_audio_stream_t *source,
 		source->rx_descriptor->frame_duration,
 		codec->attribs->bits_per_sample);
 	decoder->frame_in.codec_frame.size = frame_size;
-	decoder->frame_in.codec_frame.buffer = apr_palloc(pool,frame_size);
+	decoder->buffer_in = apr_palloc(pool,frame_size);
+	decoder->frame_in.codec_frame.buffer = decoder->buffer_in;
 	return decoder->base;
 }
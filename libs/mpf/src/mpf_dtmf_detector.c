@@ -15,16 +15,24 @@
  */
 
 #include "mpf_dtmf_detector.h"
-#include "apr_thread_mutex.h"
+#include "apr_atomic.h"
 #include "apt_log.h"
 #include "mpf_named_event.h"
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MPF_DTMFDET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MPF_DTMFDET_NEON
+#endif
+
 #ifndef M_PI
 #	define M_PI 3.141592653589793238462643
 #endif
 
-/** Max detected DTMF digits buffer length */
+/** Max detected DTMF digits buffer length (power of 2) */
 #define MPF_DTMFDET_BUFFER_LEN  32
 
 /** Number of DTMF frequencies */
@@ -44,15 +52,19 @@
  *
  * Then energy of frequency f in the signal is:
  * X(f)X'(f) = s(t-2)^2 + s(t-1)^2 - coef*s(t-2)*s(t-1)
+ *
+ * The filters of all the DTMF frequencies are run as a bank of 16-bit lanes,
+ * one lane per frequency, with coef in Q14 and the input scaled down by
+ * a power of 2, so that coef*s(t-1) stays within 16 bits over a window.
  */
-typedef struct goertzel_state_t {
-	/** coef = cos(2*pi*f_tone/f_sampling) */
-	double coef;
-	/** s(t-2) or resulting energy @see goertzel_state_t */
-	double s1;
-	/** s(t-1) @see goertzel_state_t */
-	double s2;
-} goertzel_state_t;
+typedef struct goertzel_bank_t {
+	/** coef = 2*cos(2*pi*f_tone/f_sampling) in Q14 */
+	apr_int16_t coef[DTMF_FREQUENCIES];
+	/** s(t-2) @see goertzel_bank_t */
+	apr_int16_t s1[DTMF_FREQUENCIES];
+	/** s(t-1) @see goertzel_bank_t */
+	apr_int16_t s2[DTMF_FREQUENCIES];
+} goertzel_bank_t;
 
 /** DTMF frequencies */
 static const double dtmf_freqs[DTMF_FREQUENCIES] = {
@@ -68,20 +80,24 @@ static const char freq2digits[DTMF_FREQUENCIES/2][DTMF_FREQUENCIES/2] =
 
 /** Media Processing Framework's Dual Tone Multiple Frequncy detector */
 struct mpf_dtmf_detector_t {
-	/** Mutex to guard the buffer */
-	struct apr_thread_mutex_t     *mutex;
 	/** Recognizer band */
 	enum mpf_dtmf_detector_band_e  band;
-	/** Detected digits buffer */
-	char                           buf[MPF_DTMFDET_BUFFER_LEN+1];
-	/** Number of digits in the buffer */
-	apr_size_t                     digits;
+	/** Detected digits ring, written by the media processing thread only */
+	char                           buf[MPF_DTMFDET_BUFFER_LEN];
+	/** Number of digits ever put into the ring (advanced by the writer) */
+	volatile apr_uint32_t          write_pos;
+	/** Number of digits ever taken from the ring (advanced by the reader) */
+	volatile apr_uint32_t          read_pos;
 	/** Number of lost digits due to full buffer */
 	apr_size_t                     lost_digits;
 	/** Frequency analyzators */
-	struct goertzel_state_t        energies[DTMF_FREQUENCIES];
+	struct goertzel_bank_t         bank;
+	/** Right shift of input samples of the bank */
+	int                            shift;
+	/** Scale of the energies of the bank to the energy of input samples */
+	double                         energy_scale;
 	/** Total energy of signal */
-	double                         totenergy;
+	apr_uint64_t                   totenergy;
 	/** Number of samples in a window */
 	apr_size_t                     wsamples;
 	/** Number of samples processed */
@@ -96,7 +112,6 @@ MPF_DECLARE(struct mpf_dtmf_detector_t *) mpf_dtmf_detector_create_ex(
 								enum mpf_dtmf_detector_band_e band,
 								struct apr_pool_t *pool)
 {
-	apr_status_t status;
 	struct mpf_dtmf_detector_t *det;
 	int flg_band = band;
 
@@ -109,24 +124,31 @@ MPF_DECLARE(struct mpf_dtmf_detector_t *) mpf_dtmf_detector_create_ex(
 
 	det = apr_palloc(pool, sizeof(mpf_dtmf_detector_t));
 	if (!det) return NULL;
-	status = apr_thread_mutex_create(&det->mutex, APR_THREAD_MUTEX_DEFAULT, pool);
-	if (status != APR_SUCCESS) return NULL;
 
 	det->band = (enum mpf_dtmf_detector_band_e) flg_band;
-	det->buf[0] = 0;
-	det->digits = 0;
+	det->write_pos = 0;
+	det->read_pos = 0;
 	det->lost_digits = 0;
 
 	if (det->band & MPF_DTMF_DETECTOR_INBAND) {
 		apr_size_t i;
+		double rate = stream->tx_descriptor->sampling_rate;
+		double growth;
 		for (i = 0; i < DTMF_FREQUENCIES; i++) {
-			det->energies[i].coef = 2 * cos(2 * M_PI * dtmf_freqs[i] /
-				stream->tx_descriptor->sampling_rate);
-			det->energies[i].s1 = 0;
-			det->energies[i].s2 = 0;
+			det->bank.coef[i] = (apr_int16_t)floor(16384 * 2 * cos(2 * M_PI * dtmf_freqs[i] / rate) + 0.5);
+			det->bank.s1[i] = 0;
+			det->bank.s2[i] = 0;
 		}
 		det->nsamples = 0;
 		det->wsamples = GOERTZEL_SAMPLES_8K * (stream->tx_descriptor->sampling_rate / 8000);
+
+		/* a tone at the lowest frequency grows the state by up to 1/(2*sin(w)) of its amplitude per sample,
+		and coef*s(t-1) is up to twice the state */
+		growth = det->wsamples / sin(2 * M_PI * dtmf_freqs[0] / rate);
+		det->shift = 0;
+		while (det->shift < 15 && 32768.0 / (1 << det->shift) * growth > 32767)
+			det->shift++;
+		det->energy_scale = (double)(1 << det->shift) * (1 << det->shift);
 		det->last1 = det->last2 = det->curr = 0;
 		det->totenergy = 0;
 	}
@@ -137,13 +159,12 @@ MPF_DECLARE(struct mpf_dtmf_detector_t *) mpf_dtmf_detector_create_ex(
 MPF_DECLARE(char) mpf_dtmf_detector_digit_get(struct mpf_dtmf_detector_t *detector)
 {
 	char digit;
-	apr_thread_mutex_lock(detector->mutex);
-	digit = detector->buf[0];
-	if (digit) {
-		memmove(detector->buf, detector->buf + 1, strlen(detector->buf));
-		detector->digits--;
-	}
-	apr_thread_mutex_unlock(detector->mutex);
+	apr_uint32_t pos = detector->read_pos;
+	if (pos == apr_atomic_read32(&detector->write_pos))
+		return 0;
+	digit = detector->buf[pos & (MPF_DTMFDET_BUFFER_LEN - 1)];
+	/* release the slot to the writer */
+	apr_atomic_xchg32(&detector->read_pos, pos + 1);
 	return digit;
 }
 
@@ -154,43 +175,102 @@ MPF_DECLARE(apr_size_t) mpf_dtmf_detector_digits_lost(const struct mpf_dtmf_dete
 
 MPF_DECLARE(void) mpf_dtmf_detector_reset(struct mpf_dtmf_detector_t *detector)
 {
-	apr_thread_mutex_lock(detector->mutex);
-	detector->buf[0] = 0;
+	apr_size_t i;
+	/* drop pending digits as the reader does */
+	apr_atomic_xchg32(&detector->read_pos, apr_atomic_read32(&detector->write_pos));
 	detector->lost_digits = 0;
-	detector->digits = 0;
 	detector->curr = detector->last1 = detector->last2 = 0;
 	detector->nsamples = 0;
 	detector->totenergy = 0;
-	apr_thread_mutex_unlock(detector->mutex);
+	for (i = 0; i < DTMF_FREQUENCIES; i++) {
+		detector->bank.s1[i] = 0;
+		detector->bank.s2[i] = 0;
+	}
 }
 
 static APR_INLINE void mpf_dtmf_detector_add_digit(
 								struct mpf_dtmf_detector_t *detector,
 								char digit)
 {
+	apr_uint32_t pos = detector->write_pos;
 	if (!digit) return;
-	apr_thread_mutex_lock(detector->mutex);
-	if (detector->digits < MPF_DTMFDET_BUFFER_LEN) {
-		detector->buf[detector->digits++] = digit;
-		detector->buf[detector->digits] = 0;
+	if (pos - apr_atomic_read32(&detector->read_pos) < MPF_DTMFDET_BUFFER_LEN) {
+		detector->buf[pos & (MPF_DTMFDET_BUFFER_LEN - 1)] = digit;
+		/* publish the digit to the reader */
+		apr_atomic_xchg32(&detector->write_pos, pos + 1);
 	} else
 		detector->lost_digits++;
-	apr_thread_mutex_unlock(detector->mutex);
 }
 
-static APR_INLINE void goertzel_sample(
-								struct mpf_dtmf_detector_t *detector,
-								apr_int16_t sample)
+static APR_INLINE apr_int16_t goertzel_saturate(apr_int32_t value)
 {
+	if (value > 32767) return 32767;
+	if (value < -32768) return -32768;
+	return (apr_int16_t)value;
+}
+
+/** Run the bank over a block of samples, which doesn't cross the window boundary */
+static void goertzel_block(
+						struct mpf_dtmf_detector_t *detector,
+						const apr_int16_t *samples,
+						apr_size_t count)
+{
+	goertzel_bank_t *bank = &detector->bank;
+	apr_uint64_t totenergy = 0;
+	int shift = detector->shift;
 	apr_size_t i;
-	double s;
-	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		s = detector->energies[i].s1;
-		detector->energies[i].s1 = detector->energies[i].s2;
-		detector->energies[i].s2 = sample +
-			detector->energies[i].coef * detector->energies[i].s1 - s;
+#if defined(MPF_DTMFDET_SSE2)
+	__m128i coef = _mm_loadu_si128((const __m128i*)bank->coef);
+	__m128i s1 = _mm_loadu_si128((const __m128i*)bank->s1);
+	__m128i s2 = _mm_loadu_si128((const __m128i*)bank->s2);
+	__m128i x, t, s;
+	for (i = 0; i < count; i++) {
+		x = _mm_set1_epi16((short)(samples[i] >> shift));
+		/* coef * s(t-1) = (coef * s(t-1)) >> 14, composed of the high and low halves of the product */
+		t = _mm_or_si128(
+				_mm_slli_epi16(_mm_mulhi_epi16(s2, coef), 2),
+				_mm_srli_epi16(_mm_mullo_epi16(s2, coef), 14));
+		s = _mm_adds_epi16(_mm_subs_epi16(x, s1), t);
+		s1 = s2;
+		s2 = s;
+		totenergy += (apr_uint32_t)(samples[i] * samples[i]);
+	}
+	_mm_storeu_si128((__m128i*)bank->s1, s1);
+	_mm_storeu_si128((__m128i*)bank->s2, s2);
+#elif defined(MPF_DTMFDET_NEON)
+	int16x8_t coef = vld1q_s16(bank->coef);
+	int16x8_t s1 = vld1q_s16(bank->s1);
+	int16x8_t s2 = vld1q_s16(bank->s2);
+	int16x8_t x, t, s;
+	for (i = 0; i < count; i++) {
+		x = vdupq_n_s16((int16_t)(samples[i] >> shift));
+		/* coef * s(t-1) = (coef * s(t-1)) >> 14 */
+		t = vcombine_s16(
+				vshrn_n_s32(vmull_s16(vget_low_s16(s2), vget_low_s16(coef)), 14),
+				vshrn_n_s32(vmull_s16(vget_high_s16(s2), vget_high_s16(coef)), 14));
+		s = vqaddq_s16(vqsubq_s16(x, s1), t);
+		s1 = s2;
+		s2 = s;
+		totenergy += (apr_uint32_t)(samples[i] * samples[i]);
 	}
-	detector->totenergy += sample * sample;
+	vst1q_s16(bank->s1, s1);
+	vst1q_s16(bank->s2, s2);
+#else
+	apr_size_t j;
+	apr_int16_t x, t, s;
+	for (i = 0; i < count; i++) {
+		x = (apr_int16_t)(samples[i] >> shift);
+		for (j = 0; j < DTMF_FREQUENCIES; j++) {
+			/* coef * s(t-1) = (coef * s(t-1)) >> 14 */
+			t = (apr_int16_t)((bank->s2[j] * bank->coef[j]) >> 14);
+			s = goertzel_saturate(goertzel_saturate(x - bank->s1[j]) + t);
+			bank->s1[j] = bank->s2[j];
+			bank->s2[j] = s;
+		}
+		totenergy += (apr_uint32_t)(samples[i] * samples[i]);
+	}
+#endif
+	detector->totenergy += totenergy;
 }
 
 static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
@@ -201,9 +281,10 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Calculate energies and maxims */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		double eng = detector->energies[i].s1 * detector->energies[i].s1 +
-			detector->energies[i].s2 * detector->energies[i].s2 -
-			detector->energies[i].coef * detector->energies[i].s1 * detector->energies[i].s2;
+		apr_int32_t s1 = detector->bank.s1[i];
+		apr_int32_t s2 = detector->bank.s2[i];
+		double eng = detector->energy_scale * (double)((apr_int64_t)s1 * s1 + (apr_int64_t)s2 * s2 -
+			(((apr_int64_t)s1 * s2 * detector->bank.coef[i]) >> 14));
 		if (i < DTMF_FREQUENCIES/2) {
 			if (eng > reng) {
 				rmax = i;
@@ -233,7 +314,7 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 		 */
 	} else if ((ceng < reng) && (ceng < reng * 0.158)) {  /* twist > 8db, error */
 		/* Reverse twist check failed */
-	} else if (0.25 * detector->totenergy > (reng + ceng)) {  /* 16db */
+	} else if (0.25 * (double)detector->totenergy > (reng + ceng)) {  /* 16db */
 		/* Signal energy to total energy ratio test failed */
 	} else {
 		if (cmax >= DTMF_FREQUENCIES/2 && cmax < DTMF_FREQUENCIES)
@@ -254,8 +335,8 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Reset Goertzel's detectors */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		detector->energies[i].s1 = 0;
-		detector->energies[i].s2 = 0;
+		detector->bank.s1[i] = 0;
+		detector->bank.s2[i] = 0;
 	}
 	detector->totenergy = 0;
 }
@@ -280,12 +361,19 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 	}
 
 	if ((detector->band & MPF_DTMF_DETECTOR_INBAND) && (frame->type & MEDIA_FRAME_TYPE_AUDIO)) {
-		apr_int16_t *samples = frame->codec_frame.buffer;
-		apr_size_t i;
+		const apr_int16_t *samples = frame->codec_frame.buffer;
+		apr_size_t count = frame->codec_frame.size / 2;
+		apr_size_t block;
 
-		for (i = 0; i < frame->codec_frame.size / 2; i++) {
-			goertzel_sample(detector, samples[i]);
-			if (++detector->nsamples >= detector->wsamples) {
+		while (count) {
+			block = detector->wsamples - detector->nsamples;
+			if (block > count)
+				block = count;
+			goertzel_block(detector, samples, block);
+			samples += block;
+			count -= block;
+			detector->nsamples += block;
+			if (detector->nsamples >= detector->wsamples) {
 				goertzel_energies_digit(detector);
 				detector->nsamples = 0;
 			}
@@ -295,6 +383,7 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 
 MPF_DECLARE(void) mpf_dtmf_detector_destroy(struct mpf_dtmf_detector_t *detector)
 {
-	apr_thread_mutex_destroy(detector->mutex);
-	detector->mutex = NULL;
+	/* neither band is detected any more */
+	detector->band = 0;
+	mpf_dtmf_detector_reset(detector);
 }
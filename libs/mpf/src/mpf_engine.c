@@ -14,29 +14,82 @@
  * limitations under the License.
  */
 
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
+#include <apr_atomic.h>
 #include "mpf_engine.h"
 #include "mpf_context.h"
 #include "mpf_termination.h"
 #include "mpf_stream.h"
 #include "mpf_scheduler.h"
+#include "mpf_rtp_poller.h"
+#include "mpf_rtp_tx_queue.h"
+#include "mpf_rtp_termination_factory.h"
 #include "mpf_codec_descriptor.h"
 #include "mpf_codec_manager.h"
 #include "apt_obj_list.h"
+#include "apt_lockfree_queue.h"
 #include "apt_cyclic_queue.h"
 #include "apt_log.h"
 
 #define MPF_TIMER_RESOLUTION 100 /* 100 ms */
+#define MAX_MPF_WORKER_COUNT 64
+#define MPF_RTP_POLLER_SIZE  4096 /* max number of RTP sockets polled at once per worker */
+#define MPF_RTP_TX_QUEUE_SIZE 256 /* max number of RTP packets queued per worker before implicit flush */
+
+/** Media engine worker, which processes a shard of media contexts */
+typedef struct mpf_engine_worker_t mpf_engine_worker_t;
+
+struct mpf_engine_worker_t {
+	/** Back pointer to the engine */
+	mpf_engine_t              *engine;
+	/** Factory of media contexts assigned to the worker */
+	mpf_context_factory_t     *context_factory;
+	/** Poller of RTP sockets of the media contexts assigned to the worker */
+	mpf_rtp_poller_t          *rtp_poller;
+	/** Queue of RTP packets sent by the media contexts assigned to the worker */
+	mpf_rtp_tx_queue_t        *rtp_tx_queue;
+	/** Worker thread (NULL for the first worker processed by the scheduler itself) */
+	apr_thread_t              *thread;
+	/** Guard of the tick counter */
+	apr_thread_mutex_t        *guard;
+	/** Wakeup object signaled on every tick */
+	apr_thread_cond_t         *wakeup;
+	/** Number of ticks requested to be processed */
+	apr_uint32_t               tick;
+	/** Indicates whether the worker is running */
+	apt_bool_t                 running;
+};
 
 struct mpf_engine_t {
 	apr_pool_t                *pool;
 	apt_task_t                *task;
 	apt_task_msg_type_e        task_msg_type;
-	apr_thread_mutex_t        *request_queue_guard;
-	apt_cyclic_queue_t        *request_queue;
-	mpf_context_factory_t     *context_factory;
+	apt_lockfree_queue_t      *request_queue;
+	/** Unbounded queue of requests not fit into the lock-free queue */
+	apt_cyclic_queue_t        *overflow_queue;
+	/** Guard of the overflow queue */
+	apr_thread_mutex_t        *overflow_guard;
+	/** Number of requests in the overflow queue */
+	volatile apr_uint32_t      overflow_count;
 	mpf_scheduler_t           *scheduler;
 	apt_timer_queue_t         *timer_queue;
 	const mpf_codec_manager_t *codec_manager;
+
+	/** Array of workers, the first one is processed by the scheduler */
+	mpf_engine_worker_t       *workers;
+	/** Number of workers */
+	apr_size_t                 worker_count;
+	/** Guard of the number of workers still processing the current tick */
+	apr_thread_mutex_t        *barrier_guard;
+	/** Condition signaled once all the workers complete the current tick */
+	apr_thread_cond_t         *barrier_cond;
+	/** Number of workers still processing the current tick */
+	apr_size_t                 busy_count;
+	/** Indicates whether the engine is started (workers can no longer be set) */
+	apt_bool_t                 started;
+	/** Indicates whether ticks are processed back-to-back (RTP terminations are not allowed) */
+	apt_bool_t                 free_running;
 };
 
 static void mpf_engine_main(mpf_scheduler_t *scheduler, void *obj);
@@ -46,6 +99,11 @@ static apt_bool_t mpf_engine_start(apt_task_t *task);
 static apt_bool_t mpf_engine_terminate(apt_task_t *task);
 static apt_bool_t mpf_engine_msg_signal(apt_task_t *task, apt_task_msg_t *msg);
 static apt_bool_t mpf_engine_msg_process(apt_task_t *task, apt_task_msg_t *msg);
+static apt_bool_t mpf_engine_workers_start(mpf_engine_t *engine);
+static void mpf_engine_worker_process(mpf_engine_worker_t *worker);
+static mpf_engine_worker_t* mpf_engine_worker_get(mpf_engine_t *engine, mpf_context_t *context);
+static void mpf_engine_rtp_stat_log(mpf_engine_t *engine, apr_size_t i);
+static void mpf_engine_workers_stop(mpf_engine_t *engine);
 
 mpf_codec_t* mpf_codec_l16_create(apr_pool_t *pool);
 mpf_codec_t* mpf_codec_g711u_create(apr_pool_t *pool);
@@ -64,8 +122,15 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 	mpf_engine_t *engine = apr_palloc(pool,sizeof(mpf_engine_t));
 	engine->pool = pool;
 	engine->request_queue = NULL;
-	engine->context_factory = NULL;
+	engine->overflow_queue = NULL;
+	engine->overflow_guard = NULL;
+	engine->overflow_count = 0;
 	engine->codec_manager = NULL;
+	engine->workers = NULL;
+	engine->worker_count = 0;
+	engine->busy_count = 0;
+	engine->started = FALSE;
+	engine->free_running = FALSE;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mpf_message_container_t),pool);
 
@@ -88,18 +153,115 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 
 	engine->task_msg_type = TASK_MSG_USER;
 
-	engine->context_factory = mpf_context_factory_create(engine->pool);
-	engine->request_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
-	apr_thread_mutex_create(&engine->request_queue_guard,APR_THREAD_MUTEX_UNNESTED,engine->pool);
+	mpf_engine_worker_count_set(engine,1);
+	apr_thread_mutex_create(&engine->barrier_guard,APR_THREAD_MUTEX_UNNESTED,engine->pool);
+	apr_thread_cond_create(&engine->barrier_cond,engine->pool);
+
+	/* requests are passed to the scheduler thread lock-free, so that it never blocks on the sender */
+	engine->request_queue = apt_lockfree_queue_create(LOCKFREE_QUEUE_DEFAULT_SIZE,engine->pool);
+	engine->overflow_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
+	apr_thread_mutex_create(&engine->overflow_guard,APR_THREAD_MUTEX_UNNESTED,engine->pool);
 
 	engine->scheduler = mpf_scheduler_create(engine->pool);
 	mpf_scheduler_media_clock_set(engine->scheduler,CODEC_FRAME_TIME_BASE,mpf_engine_main,engine);
 
-	engine->timer_queue = apt_timer_queue_create(engine->pool);
+	engine->timer_queue = apt_timer_queue_create_ex(APT_TIMER_QUEUE_WHEEL,MPF_TIMER_RESOLUTION,engine->pool);
 	mpf_scheduler_timer_clock_set(engine->scheduler,MPF_TIMER_RESOLUTION,mpf_engine_timer_proc,engine);
 	return engine;
 }
 
+MPF_DECLARE(apt_bool_t) mpf_engine_worker_count_set(mpf_engine_t *engine, apr_size_t worker_count)
+{
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
+	mpf_engine_worker_t *workers;
+	if(worker_count == 0 || worker_count > MAX_MPF_WORKER_COUNT) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Invalid Worker Count [%"APR_SIZE_T_FMT"] [%s]",
+			worker_count,
+			mpf_engine_id_get(engine));
+		return FALSE;
+	}
+	if(worker_count == engine->worker_count) {
+		return TRUE;
+	}
+	if(engine->started == TRUE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Cannot Set Worker Count [%"APR_SIZE_T_FMT"] of Started Engine [%s]",
+			worker_count,
+			mpf_engine_id_get(engine));
+		return FALSE;
+	}
+
+	workers = apr_palloc(engine->pool,sizeof(mpf_engine_worker_t) * worker_count);
+	for(i=0; i<worker_count; i++) {
+		worker = &workers[i];
+		if(i < engine->worker_count) {
+			/* retain already created workers along with their contexts */
+			*worker = engine->workers[i];
+			continue;
+		}
+
+		worker->engine = engine;
+		worker->context_factory = mpf_context_factory_create(engine->pool);
+		worker->rtp_poller = mpf_rtp_poller_create(MPF_RTP_POLLER_SIZE,engine->pool);
+		worker->rtp_tx_queue = mpf_rtp_tx_queue_create(MPF_RTP_TX_QUEUE_SIZE,engine->pool);
+		worker->thread = NULL;
+		worker->guard = NULL;
+		worker->wakeup = NULL;
+		worker->tick = 0;
+		worker->running = FALSE;
+	}
+
+	if(worker_count > 1) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Set Worker Count [%"APR_SIZE_T_FMT"] [%s]",
+			worker_count,
+			mpf_engine_id_get(engine));
+	}
+	engine->workers = workers;
+	engine->worker_count = worker_count;
+	return TRUE;
+}
+
+MPF_DECLARE(apr_size_t) mpf_engine_worker_count_get(const mpf_engine_t *engine)
+{
+	return engine->worker_count;
+}
+
+MPF_DECLARE(apr_size_t) mpf_engine_load_get(const mpf_engine_t *engine)
+{
+	apr_size_t i;
+	apr_size_t load = 0;
+	for(i=0; i<engine->worker_count; i++) {
+		load += mpf_context_factory_load_get(engine->workers[i].context_factory);
+	}
+	return load;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_engine_rtp_stat_get(const mpf_engine_t *engine, mpf_rtp_poller_stat_t *stat)
+{
+	apr_size_t i;
+	mpf_rtp_poller_stat_t worker_stat;
+	apt_bool_t status = FALSE;
+	memset(stat,0,sizeof(mpf_rtp_poller_stat_t));
+	for(i=0; i<engine->worker_count; i++) {
+		if(!engine->workers[i].rtp_poller) {
+			continue;
+		}
+		mpf_rtp_poller_stat_get(engine->workers[i].rtp_poller,&worker_stat);
+		/* workers process the same ticks in parallel */
+		if(worker_stat.ticks > stat->ticks) {
+			stat->ticks = worker_stat.ticks;
+		}
+		stat->syscalls += worker_stat.syscalls;
+		stat->last_syscalls += worker_stat.last_syscalls;
+		/* upper bound, since the maxima of workers may belong to different ticks */
+		stat->max_syscalls += worker_stat.max_syscalls;
+		stat->packets += worker_stat.packets;
+		stat->sockets += worker_stat.sockets;
+		status = TRUE;
+	}
+	return status;
+}
+
 MPF_DECLARE(mpf_context_t*) mpf_engine_context_create(
 								mpf_engine_t *engine,
 								const char *name,
@@ -107,7 +269,20 @@ MPF_DECLARE(mpf_context_t*) mpf_engine_context_create(
 								apr_size_t max_termination_count,
 								apr_pool_t *pool)
 {
-	return mpf_context_create(engine->context_factory,name,obj,max_termination_count,pool);
+	apr_size_t i;
+	apr_size_t load;
+	mpf_engine_worker_t *worker = &engine->workers[0];
+	apr_size_t min_load = mpf_context_factory_load_get(worker->context_factory);
+
+	/* assign the context to the least loaded worker */
+	for(i=1; i<engine->worker_count && min_load; i++) {
+		load = mpf_context_factory_load_get(engine->workers[i].context_factory);
+		if(load < min_load) {
+			min_load = load;
+			worker = &engine->workers[i];
+		}
+	}
+	return mpf_context_create(worker->context_factory,name,obj,max_termination_count,pool);
 }
 
 MPF_DECLARE(apt_bool_t) mpf_engine_context_destroy(mpf_context_t *context)
@@ -228,13 +403,22 @@ MPF_DECLARE(apt_bool_t) mpf_engine_message_send(mpf_engine_t *engine, mpf_task_m
 
 static apt_bool_t mpf_engine_destroy(apt_task_t *task)
 {
+	apr_size_t i;
 	mpf_engine_t *engine = apt_task_object_get(task);
 
 	apt_timer_queue_destroy(engine->timer_queue);
 	mpf_scheduler_destroy(engine->scheduler);
-	mpf_context_factory_destroy(engine->context_factory);
-	apt_cyclic_queue_destroy(engine->request_queue);
-	apr_thread_mutex_destroy(engine->request_queue_guard);
+	for(i=0; i<engine->worker_count; i++) {
+		mpf_context_factory_destroy(engine->workers[i].context_factory);
+		mpf_engine_rtp_stat_log(engine,i);
+		if(engine->workers[i].rtp_poller) {
+			mpf_rtp_poller_destroy(engine->workers[i].rtp_poller);
+		}
+	}
+	apr_thread_cond_destroy(engine->barrier_cond);
+	apr_thread_mutex_destroy(engine->barrier_guard);
+	apt_cyclic_queue_destroy(engine->overflow_queue);
+	apr_thread_mutex_destroy(engine->overflow_guard);
 	return TRUE;
 }
 
@@ -242,6 +426,8 @@ static apt_bool_t mpf_engine_start(apt_task_t *task)
 {
 	mpf_engine_t *engine = apt_task_object_get(task);
 
+	engine->started = TRUE;
+	mpf_engine_workers_start(engine);
 	mpf_scheduler_start(engine->scheduler);
 	apt_task_start_request_process(task);
 	return TRUE;
@@ -252,10 +438,198 @@ static apt_bool_t mpf_engine_terminate(apt_task_t *task)
 	mpf_engine_t *engine = apt_task_object_get(task);
 
 	mpf_scheduler_stop(engine->scheduler);
+	mpf_engine_workers_stop(engine);
 	apt_task_terminate_request_process(task);
 	return TRUE;
 }
 
+static void mpf_engine_worker_process(mpf_engine_worker_t *worker)
+{
+	/* drain readable RTP sockets into the jitter buffers first */
+	if(worker->rtp_poller) {
+		mpf_rtp_poller_process(worker->rtp_poller);
+	}
+	mpf_context_factory_process(worker->context_factory);
+	/* send out RTP packets produced during the tick */
+	mpf_rtp_tx_queue_flush(worker->rtp_tx_queue);
+}
+
+static mpf_engine_worker_t* mpf_engine_worker_get(mpf_engine_t *engine, mpf_context_t *context)
+{
+	apr_size_t i;
+	mpf_context_factory_t *factory = mpf_context_factory_get(context);
+	for(i=0; i<engine->worker_count; i++) {
+		if(engine->workers[i].context_factory == factory) {
+			return &engine->workers[i];
+		}
+	}
+	return NULL;
+}
+
+static void mpf_engine_rtp_stat_log(mpf_engine_t *engine, apr_size_t i)
+{
+	mpf_rtp_poller_stat_t rx_stat;
+	mpf_rtp_tx_queue_stat_t tx_stat;
+	mpf_engine_worker_t *worker = &engine->workers[i];
+	if(worker->rtp_poller) {
+		mpf_rtp_poller_stat_get(worker->rtp_poller,&rx_stat);
+		if(rx_stat.ticks) {
+			apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"RTP Receive Stat [%s] worker [%"APR_SIZE_T_FMT"] [ticks:%u syscalls:%u per-tick:%.2f max:%u packets:%u]",
+				mpf_engine_id_get(engine),
+				i,
+				rx_stat.ticks,
+				rx_stat.syscalls,
+				(double)rx_stat.syscalls / rx_stat.ticks,
+				rx_stat.max_syscalls,
+				rx_stat.packets);
+		}
+	}
+
+	mpf_rtp_tx_queue_stat_get(worker->rtp_tx_queue,&tx_stat);
+	if(tx_stat.flushes) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"RTP Transmit Stat [%s] worker [%"APR_SIZE_T_FMT"] [flushes:%u syscalls:%u per-flush:%.2f sent:%u failed:%u]",
+			mpf_engine_id_get(engine),
+			i,
+			tx_stat.flushes,
+			tx_stat.syscalls,
+			(double)tx_stat.syscalls / tx_stat.flushes,
+			tx_stat.sent_packets,
+			tx_stat.failed_packets);
+	}
+}
+
+static void* APR_THREAD_FUNC mpf_engine_worker_run(apr_thread_t *thread, void *data)
+{
+	mpf_engine_worker_t *worker = data;
+	mpf_engine_t *engine = worker->engine;
+	apr_uint32_t tick = 0;
+
+#if APR_HAS_SETTHREADNAME
+	apr_thread_name_set("MPF Worker");
+#endif
+	apr_thread_mutex_lock(worker->guard);
+	while(worker->running == TRUE) {
+		if(worker->tick == tick) {
+			apr_thread_cond_wait(worker->wakeup,worker->guard);
+			continue;
+		}
+		tick = worker->tick;
+		apr_thread_mutex_unlock(worker->guard);
+
+		/* process the shard of media contexts */
+		mpf_engine_worker_process(worker);
+
+		apr_thread_mutex_lock(engine->barrier_guard);
+		engine->busy_count--;
+		if(!engine->busy_count) {
+			apr_thread_cond_signal(engine->barrier_cond);
+		}
+		apr_thread_mutex_unlock(engine->barrier_guard);
+
+		apr_thread_mutex_lock(worker->guard);
+	}
+	apr_thread_mutex_unlock(worker->guard);
+
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+static apt_bool_t mpf_engine_workers_start(mpf_engine_t *engine)
+{
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
+	apt_bool_t status = TRUE;
+	/* the first worker is processed by the scheduler itself */
+	for(i=1; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		apr_thread_mutex_create(&worker->guard,APR_THREAD_MUTEX_UNNESTED,engine->pool);
+		apr_thread_cond_create(&worker->wakeup,engine->pool);
+		worker->tick = 0;
+		worker->running = TRUE;
+		if(apr_thread_create(&worker->thread,NULL,mpf_engine_worker_run,worker,engine->pool) != APR_SUCCESS) {
+			apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Start Worker [%"APR_SIZE_T_FMT"] [%s]",
+				i,
+				mpf_engine_id_get(engine));
+			worker->running = FALSE;
+			worker->thread = NULL;
+			status = FALSE;
+		}
+	}
+	return status;
+}
+
+static void mpf_engine_workers_stop(mpf_engine_t *engine)
+{
+	apr_size_t i;
+	apr_status_t status;
+	mpf_engine_worker_t *worker;
+	for(i=1; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		if(!worker->guard) {
+			continue;
+		}
+
+		apr_thread_mutex_lock(worker->guard);
+		worker->running = FALSE;
+		apr_thread_cond_signal(worker->wakeup);
+		apr_thread_mutex_unlock(worker->guard);
+
+		if(worker->thread) {
+			apr_thread_join(&status,worker->thread);
+			worker->thread = NULL;
+		}
+		apr_thread_cond_destroy(worker->wakeup);
+		worker->wakeup = NULL;
+		apr_thread_mutex_destroy(worker->guard);
+		worker->guard = NULL;
+	}
+}
+
+static void mpf_engine_workers_process(mpf_engine_t *engine)
+{
+	apr_size_t i;
+	mpf_engine_worker_t *worker;
+	apr_size_t busy_count = 0;
+
+	/* kick off the workers running in dedicated threads */
+	apr_thread_mutex_lock(engine->barrier_guard);
+	for(i=1; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		if(worker->running == TRUE) {
+			busy_count++;
+		}
+	}
+	engine->busy_count = busy_count;
+	apr_thread_mutex_unlock(engine->barrier_guard);
+
+	for(i=1; i<engine->worker_count; i++) {
+		worker = &engine->workers[i];
+		if(worker->running == TRUE) {
+			apr_thread_mutex_lock(worker->guard);
+			worker->tick++;
+			apr_thread_cond_signal(worker->wakeup);
+			apr_thread_mutex_unlock(worker->guard);
+		}
+		else {
+			/* worker thread is not available, process its shard in place */
+			mpf_engine_worker_process(worker);
+		}
+	}
+
+	/* process the own shard of media contexts */
+	mpf_engine_worker_process(&engine->workers[0]);
+
+	/* wait for the workers to complete the tick, so that the request queue and 
+	timers are always processed while no media context is being processed */
+	if(busy_count) {
+		apr_thread_mutex_lock(engine->barrier_guard);
+		while(engine->busy_count) {
+			apr_thread_cond_wait(engine->barrier_cond,engine->barrier_guard);
+		}
+		apr_thread_mutex_unlock(engine->barrier_guard);
+	}
+}
+
 static apt_bool_t mpf_engine_event_raise(mpf_termination_t *termination, int event_id, void *descriptor)
 {
 	apt_task_msg_t *task_msg;
@@ -289,12 +663,20 @@ static apt_bool_t mpf_engine_event_raise(mpf_termination_t *termination, int eve
 static apt_bool_t mpf_engine_msg_signal(apt_task_t *task, apt_task_msg_t *msg)
 {
 	mpf_engine_t *engine = apt_task_object_get(task);
-	
-	apr_thread_mutex_lock(engine->request_queue_guard);
-	if(apt_cyclic_queue_push(engine->request_queue,msg) == FALSE) {
-		apt_log(MPF_LOG_MARK,APT_PRIO_ERROR,"MPF Request Queue is Full [%s]",apt_task_name_get(task));
+
+	/* keep using the overflow queue until it is drained, so that requests are processed in order */
+	if(apr_atomic_read32(&engine->overflow_count) == 0 &&
+		apt_lockfree_queue_push(engine->request_queue,msg) == TRUE) {
+		return TRUE;
+	}
+
+	apr_thread_mutex_lock(engine->overflow_guard);
+	if(engine->overflow_count == 0) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"MPF Request Queue is Full, Use Overflow Queue [%s]",apt_task_name_get(task));
 	}
-	apr_thread_mutex_unlock(engine->request_queue_guard);
+	apt_cyclic_queue_push(engine->overflow_queue,msg);
+	apr_atomic_inc32(&engine->overflow_count);
+	apr_thread_mutex_unlock(engine->overflow_guard);
 	return TRUE;
 }
 
@@ -307,6 +689,7 @@ static apt_bool_t mpf_engine_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 	mpf_message_t *mpf_response;
 	mpf_context_t *context;
 	mpf_termination_t *termination;
+	mpf_engine_worker_t *worker;
 	const mpf_message_t *mpf_request;
 	const mpf_message_container_t *request = (const mpf_message_container_t*) msg->data;
 
@@ -333,10 +716,22 @@ static apt_bool_t mpf_engine_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 		switch(mpf_request->command_id) {
 			case MPF_ADD_TERMINATION:
 			{
+				if(engine->free_running == TRUE && mpf_rtp_termination_check(termination) == TRUE) {
+					/* RTP is paced by the peer in real time, while the media clock runs ahead of it */
+					apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"RTP Termination is not Allowed in Free-Running Mode [%s]",
+						mpf_engine_id_get(engine));
+					mpf_response->status_code = MPF_STATUS_CODE_FAILURE;
+					break;
+				}
 				termination->media_engine = engine;
 				termination->event_handler = mpf_engine_event_raise;
 				termination->codec_manager = engine->codec_manager;
 				termination->timer_queue = engine->timer_queue;
+				worker = mpf_engine_worker_get(engine,context);
+				if(worker) {
+					termination->rtp_poller = worker->rtp_poller;
+					termination->rtp_tx_queue = worker->rtp_tx_queue;
+				}
 
 				mpf_termination_add(termination,mpf_request->descriptor);
 				if(mpf_context_termination_add(context,termination) == FALSE) {
@@ -401,18 +796,36 @@ static void mpf_engine_main(mpf_scheduler_t *scheduler, void *obj)
 	apt_task_msg_t *msg;
 
 	/* process request queue */
-	apr_thread_mutex_lock(engine->request_queue_guard);
-	msg = apt_cyclic_queue_pop(engine->request_queue);
-	while(msg) {
-		apr_thread_mutex_unlock(engine->request_queue_guard);
+	while((msg = apt_lockfree_queue_pop(engine->request_queue)) != NULL) {
 		apt_task_msg_process(engine->task,msg);
-		apr_thread_mutex_lock(engine->request_queue_guard);
-		msg = apt_cyclic_queue_pop(engine->request_queue);
 	}
-	apr_thread_mutex_unlock(engine->request_queue_guard);
+	/* then requests queued behind them, once the lock-free queue has been full */
+	if(apr_atomic_read32(&engine->overflow_count)) {
+		apr_thread_mutex_lock(engine->overflow_guard);
+		while((msg = apt_cyclic_queue_pop(engine->overflow_queue)) != NULL) {
+			apt_task_msg_process(engine->task,msg);
+		}
+		apr_atomic_set32(&engine->overflow_count,0);
+		apr_thread_mutex_unlock(engine->overflow_guard);
+	}
+
+	/* process factories of media contexts */
+	if(engine->worker_count > 1) {
+		mpf_engine_workers_process(engine);
+	}
+	else {
+		mpf_engine_worker_process(&engine->workers[0]);
+	}
 
-	/* process factory of media contexts */
-	mpf_context_factory_process(engine->context_factory);
+	if(engine->free_running == TRUE) {
+		/* in free-running mode, ticks follow each other right away as long as any stream produces data */
+		apr_size_t i;
+		apr_size_t active_count = 0;
+		for(i=0; i<engine->worker_count; i++) {
+			active_count += mpf_context_factory_active_count_get(engine->workers[i].context_factory);
+		}
+		mpf_scheduler_idle_set(scheduler,active_count ? FALSE : TRUE);
+	}
 }
 
 static void mpf_engine_timer_proc(mpf_scheduler_t *scheduler, void *obj)
@@ -458,6 +871,19 @@ MPF_DECLARE(apt_bool_t) mpf_engine_scheduler_rate_set(mpf_engine_t *engine, unsi
 	return mpf_scheduler_rate_set(engine->scheduler,rate);
 }
 
+MPF_DECLARE(apt_bool_t) mpf_engine_free_running_set(mpf_engine_t *engine, apt_bool_t free_running)
+{
+	if(mpf_scheduler_free_running_set(engine->scheduler,free_running) == FALSE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Free-Running Mode is not Supported [%s]",mpf_engine_id_get(engine));
+		return FALSE;
+	}
+	engine->free_running = free_running;
+	if(free_running == TRUE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Run Media Engine in Free-Running Mode [%s]",mpf_engine_id_get(engine));
+	}
+	return TRUE;
+}
+
 MPF_DECLARE(const char*) mpf_engine_id_get(const mpf_engine_t *engine)
 {
 	return apt_task_name_get(engine->task);
@@ -16,6 +16,7 @@
 
 #include <apr_tables.h>
 #include "mpf_engine_factory.h"
+#include "mpf_engine.h"
 #include "mpf_termination_factory.h"
 
 /** Factory of media engines */
@@ -63,6 +64,47 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_engine_select(mpf_engine_factory_t
 	return media_engine;
 }
 
+/** Select the least loaded media engine. */
+MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_least_loaded_engine_select(mpf_engine_factory_t *mpf_factory)
+{
+	int i;
+	int index = mpf_factory->index;
+	apr_size_t load;
+	apr_size_t min_load = 0;
+	mpf_engine_t *media_engine;
+	mpf_engine_t *selected_engine = NULL;
+	/* start from the current index, so that equally loaded engines are selected in turn */
+	for(i=0; i<mpf_factory->engines_arr->nelts; i++) {
+		media_engine = APR_ARRAY_IDX(mpf_factory->engines_arr, index, mpf_engine_t*);
+		load = mpf_engine_load_get(media_engine);
+		if(!selected_engine || load < min_load) {
+			selected_engine = media_engine;
+			min_load = load;
+		}
+		if(++index == mpf_factory->engines_arr->nelts) {
+			index = 0;
+		}
+	}
+	if(++mpf_factory->index >= mpf_factory->engines_arr->nelts) {
+		mpf_factory->index = 0;
+	}
+	return selected_engine;
+}
+
+/** Get the number of media engines in factory. */
+MPF_DECLARE(apr_size_t) mpf_engine_factory_engine_count_get(const mpf_engine_factory_t *mpf_factory)
+{
+	return mpf_factory->engines_arr->nelts;
+}
+
+/** Get media engine by index. */
+MPF_DECLARE(mpf_engine_t*) mpf_engine_factory_engine_get(const mpf_engine_factory_t *mpf_factory, apr_size_t index)
+{
+	if(index >= (apr_size_t)mpf_factory->engines_arr->nelts)
+		return NULL;
+	return APR_ARRAY_IDX(mpf_factory->engines_arr, index, mpf_engine_t*);
+}
+
 /** Associate media engines with RTP termination factory. */
 MPF_DECLARE(apt_bool_t) mpf_engine_factory_rtp_factory_assign(mpf_engine_factory_t *mpf_factory, mpf_termination_factory_t *rtp_factory)
 {
@@ -0,0 +1,415 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <apr_atomic.h>
+#include <apr_time.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include "mpf_file_io.h"
+#include "apt_lockfree_queue.h"
+
+/** Interval in msec the I/O thread sleeps for, when there is nothing to serve */
+#define FILE_IO_IDLE_INTERVAL  5
+
+/** Buffer is owned by the media processing thread (writable sink buffer or filled source buffer) */
+#define BUFFER_OWNER_MEDIA     0
+/** Buffer is owned by the I/O thread (sink buffer to flush or source buffer to fill) */
+#define BUFFER_OWNER_IO        1
+
+/** Asynchronous file */
+struct mpf_async_file_t {
+	/* file I/O agent */
+	mpf_file_io_t          *file_io;
+	/* underlying file */
+	FILE                   *fp;
+	/* indicates whether the file is a sink or a source */
+	apt_bool_t              sink;
+
+	/* double buffer */
+	char                   *buffers[2];
+	/* number of bytes in each buffer */
+	apr_size_t              lengths[2];
+	/* indicates the end of file is reached in each (source) buffer */
+	apt_bool_t              eofs[2];
+	/* owner of each buffer */
+	volatile apr_uint32_t   owners[2];
+
+	/* current buffer of the media processing thread */
+	apr_size_t              cur;
+	/* read position in the current (source) buffer */
+	apr_size_t              pos;
+	/* indicates the end of file is read */
+	apt_bool_t              eof;
+	/* next buffer to serve by the I/O thread */
+	apr_size_t              io_cur;
+
+	/* indicates whether the file is pending service of the I/O thread */
+	volatile apr_uint32_t   queued;
+	/* indicates whether the file is closed by the user */
+	volatile apr_uint32_t   closing;
+
+	/* statistics */
+	mpf_async_file_stat_t   stat;
+};
+
+/** File I/O agent */
+struct mpf_file_io_t {
+	/* max number of files */
+	apr_size_t              max_files;
+	/* size of each buffer of a file */
+	apr_size_t              buffer_size;
+	/* number of files allocated so far */
+	apr_size_t              file_count;
+	/* guards allocation of files from the pool */
+	apr_thread_mutex_t     *guard;
+	/* files released by the I/O thread for reuse */
+	apt_lockfree_queue_t   *free_files;
+	/* files pending service of the I/O thread */
+	apt_lockfree_queue_t   *pending_files;
+	/* I/O thread */
+	apr_thread_t           *thread;
+	/* indicates whether the I/O thread is running */
+	volatile apr_uint32_t   running;
+	/* pool to allocate memory from */
+	apr_pool_t             *pool;
+};
+
+MPF_DECLARE(apr_size_t) mpf_file_io_max_files_get(apr_size_t channel_count, const apr_table_t *params)
+{
+	const char *value = params ? apr_table_get(params,"max-open-files") : NULL;
+	if(value && atol(value) > 0) {
+		return (apr_size_t)atol(value);
+	}
+	if(!channel_count) {
+		return MPF_FILE_IO_DEFAULT_MAX_FILES;
+	}
+	return 2 * channel_count;
+}
+
+MPF_DECLARE(mpf_file_io_t*) mpf_file_io_create(apr_size_t max_files, apr_size_t buffer_size, apr_pool_t *pool)
+{
+	mpf_file_io_t *file_io = apr_palloc(pool,sizeof(mpf_file_io_t));
+	file_io->max_files = max_files ? max_files : MPF_FILE_IO_DEFAULT_MAX_FILES;
+	file_io->buffer_size = buffer_size ? buffer_size : MPF_FILE_IO_DEFAULT_BUFFER_SIZE;
+	file_io->file_count = 0;
+	file_io->guard = NULL;
+	file_io->thread = NULL;
+	file_io->running = FALSE;
+	file_io->pool = pool;
+	if(apr_thread_mutex_create(&file_io->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	/* each file is pending at most once, so the queues never overflow */
+	file_io->free_files = apt_lockfree_queue_create(file_io->max_files,pool);
+	file_io->pending_files = apt_lockfree_queue_create(file_io->max_files,pool);
+	return file_io;
+}
+
+/** Put the file to the queue of the I/O thread, unless it is already there */
+static void mpf_async_file_queue(mpf_async_file_t *file)
+{
+	if(apr_atomic_cas32(&file->queued,TRUE,FALSE) == FALSE) {
+		apt_lockfree_queue_push(file->file_io->pending_files,file);
+	}
+}
+
+/** Hand the buffer over to the I/O thread */
+static void mpf_async_file_buffer_release(mpf_async_file_t *file, apr_size_t index)
+{
+	apr_atomic_xchg32(&file->owners[index],BUFFER_OWNER_IO);
+	mpf_async_file_queue(file);
+}
+
+/** Fill the source buffer by the I/O thread */
+static void mpf_async_file_buffer_fill(mpf_async_file_t *file, apr_size_t index)
+{
+	apr_size_t size = file->file_io->buffer_size;
+	file->lengths[index] = fread(file->buffers[index],1,size,file->fp);
+	file->eofs[index] = file->lengths[index] < size ? TRUE : FALSE;
+}
+
+/** Serve the file by the I/O thread */
+static void mpf_async_file_serve(mpf_async_file_t *file)
+{
+	/* check the flag first, so that the buffers handed over prior to closing are served */
+	apr_uint32_t closing = apr_atomic_read32(&file->closing);
+	apr_size_t length;
+
+	if(file->sink == TRUE) {
+		while(apr_atomic_read32(&file->owners[file->io_cur]) == BUFFER_OWNER_IO) {
+			length = file->lengths[file->io_cur];
+			if(length && fwrite(file->buffers[file->io_cur],1,length,file->fp) != length) {
+				apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Write %"APR_SIZE_T_FMT" bytes to File",length);
+			}
+			file->lengths[file->io_cur] = 0;
+			apr_atomic_xchg32(&file->owners[file->io_cur],BUFFER_OWNER_MEDIA);
+			file->io_cur ^= 1;
+		}
+	}
+	else if(!closing) {
+		while(apr_atomic_read32(&file->owners[file->io_cur]) == BUFFER_OWNER_IO) {
+			mpf_async_file_buffer_fill(file,file->io_cur);
+			apr_atomic_xchg32(&file->owners[file->io_cur],BUFFER_OWNER_MEDIA);
+			file->io_cur ^= 1;
+		}
+	}
+
+	if(closing) {
+		/* if closing has queued the file again since it was popped, leave it to that entry, */
+		/* otherwise keep the file marked queued, so that it is never released while pending */
+		if(apr_atomic_cas32(&file->queued,TRUE,FALSE) != FALSE) {
+			return;
+		}
+		fclose(file->fp);
+		file->fp = NULL;
+		apt_lockfree_queue_push(file->file_io->free_files,file);
+	}
+}
+
+/** Serve pending files, return the number of files served */
+static apr_size_t mpf_file_io_drain(mpf_file_io_t *file_io)
+{
+	mpf_async_file_t *file;
+	apr_size_t count = 0;
+	while((file = apt_lockfree_queue_pop(file_io->pending_files)) != NULL) {
+		/* clear the flag prior to serving, so that buffers released meanwhile queue the file again */
+		apr_atomic_xchg32(&file->queued,FALSE);
+		mpf_async_file_serve(file);
+		count++;
+	}
+	return count;
+}
+
+static void* APR_THREAD_FUNC mpf_file_io_run(apr_thread_t *thread, void *data)
+{
+	mpf_file_io_t *file_io = data;
+	apr_uint32_t running = TRUE;
+#if APR_HAS_SETTHREADNAME
+	apr_thread_name_set("MPF File I/O");
+#endif
+	while(running) {
+		/* check the flag prior to draining, so that no file is left behind on exit */
+		running = apr_atomic_read32(&file_io->running);
+		if(!mpf_file_io_drain(file_io) && running) {
+			apr_sleep(FILE_IO_IDLE_INTERVAL * 1000);
+		}
+	}
+
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_file_io_start(mpf_file_io_t *file_io)
+{
+	if(file_io->thread) {
+		return FALSE;
+	}
+	file_io->running = TRUE;
+	if(apr_thread_create(&file_io->thread,NULL,mpf_file_io_run,file_io,file_io->pool) != APR_SUCCESS) {
+		file_io->thread = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_file_io_terminate(mpf_file_io_t *file_io)
+{
+	apr_status_t rv;
+	if(!file_io->thread) {
+		return FALSE;
+	}
+	apr_atomic_set32(&file_io->running,FALSE);
+	apr_thread_join(&rv,file_io->thread);
+	file_io->thread = NULL;
+	return TRUE;
+}
+
+/** Get a released file or allocate a new one */
+static mpf_async_file_t* mpf_async_file_get(mpf_file_io_t *file_io)
+{
+	mpf_async_file_t *file = apt_lockfree_queue_pop(file_io->free_files);
+	if(file) {
+		return file;
+	}
+
+	apr_thread_mutex_lock(file_io->guard);
+	if(file_io->file_count < file_io->max_files) {
+		file = apr_palloc(file_io->pool,sizeof(mpf_async_file_t));
+		file->file_io = file_io;
+		file->buffers[0] = apr_palloc(file_io->pool,file_io->buffer_size);
+		file->buffers[1] = apr_palloc(file_io->pool,file_io->buffer_size);
+		file_io->file_count++;
+	}
+	apr_thread_mutex_unlock(file_io->guard);
+
+	if(!file) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"No Asynchronous File Available [%"APR_SIZE_T_FMT"]",file_io->max_files);
+	}
+	return file;
+}
+
+static mpf_async_file_t* mpf_async_file_open(mpf_file_io_t *file_io, const char *file_path, apt_bool_t sink)
+{
+	mpf_async_file_t *file = mpf_async_file_get(file_io);
+	if(!file) {
+		return NULL;
+	}
+
+	file->fp = fopen(file_path,sink == TRUE ? "wb" : "rb");
+	if(!file->fp) {
+		apt_lockfree_queue_push(file_io->free_files,file);
+		return NULL;
+	}
+
+	file->sink = sink;
+	file->lengths[0] = file->lengths[1] = 0;
+	file->eofs[0] = file->eofs[1] = FALSE;
+	file->owners[0] = file->owners[1] = BUFFER_OWNER_MEDIA;
+	file->cur = 0;
+	file->pos = 0;
+	file->eof = FALSE;
+	file->io_cur = 0;
+	file->queued = FALSE;
+	file->closing = FALSE;
+	memset(&file->stat,0,sizeof(file->stat));
+
+	if(sink == FALSE) {
+		/* fill both buffers up front, so that the first reads are never late */
+		mpf_async_file_buffer_fill(file,0);
+		if(file->eofs[0] == FALSE) {
+			mpf_async_file_buffer_fill(file,1);
+		}
+	}
+	return file;
+}
+
+MPF_DECLARE(mpf_async_file_t*) mpf_async_file_sink_open(mpf_file_io_t *file_io, const char *file_path)
+{
+	return mpf_async_file_open(file_io,file_path,TRUE);
+}
+
+MPF_DECLARE(mpf_async_file_t*) mpf_async_file_source_open(mpf_file_io_t *file_io, const char *file_path)
+{
+	return mpf_async_file_open(file_io,file_path,FALSE);
+}
+
+MPF_DECLARE(apt_bool_t) mpf_async_file_write(mpf_async_file_t *file, const void *data, apr_size_t size)
+{
+	const char *src = data;
+	apr_size_t buffer_size = file->file_io->buffer_size;
+	apr_size_t length;
+
+	while(size) {
+		if(apr_atomic_read32(&file->owners[file->cur]) != BUFFER_OWNER_MEDIA) {
+			/* both buffers are pending flush */
+			file->stat.dropped++;
+			file->stat.dropped_bytes += size;
+			return FALSE;
+		}
+
+		length = buffer_size - file->lengths[file->cur];
+		if(length > size) {
+			length = size;
+		}
+		memcpy(file->buffers[file->cur] + file->lengths[file->cur],src,length);
+		file->lengths[file->cur] += length;
+		file->stat.transferred += length;
+		src += length;
+		size -= length;
+
+		if(file->lengths[file->cur] == buffer_size) {
+			mpf_async_file_buffer_release(file,file->cur);
+			file->cur ^= 1;
+		}
+	}
+	return TRUE;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_async_file_read(mpf_async_file_t *file, void *data, apr_size_t size)
+{
+	char *dst = data;
+	apr_size_t next = file->cur ^ 1;
+	apt_bool_t cur_ready;
+	apt_bool_t next_ready;
+	apr_size_t available = 0;
+	apr_size_t length;
+
+	if(file->eof == TRUE) {
+		return FALSE;
+	}
+
+	cur_ready = apr_atomic_read32(&file->owners[file->cur]) == BUFFER_OWNER_MEDIA ? TRUE : FALSE;
+	next_ready = apr_atomic_read32(&file->owners[next]) == BUFFER_OWNER_MEDIA ? TRUE : FALSE;
+	if(cur_ready == TRUE) {
+		available = file->lengths[file->cur] - file->pos;
+		if(available < size && file->eofs[file->cur] == FALSE && next_ready == TRUE) {
+			available += file->lengths[next];
+		}
+	}
+
+	if(available < size) {
+		if(cur_ready == TRUE && (file->eofs[file->cur] == TRUE || (next_ready == TRUE && file->eofs[next] == TRUE))) {
+			file->eof = TRUE;
+		}
+		else {
+			file->stat.late++;
+		}
+		return FALSE;
+	}
+
+	while(size) {
+		length = file->lengths[file->cur] - file->pos;
+		if(length > size) {
+			length = size;
+		}
+		memcpy(dst,file->buffers[file->cur] + file->pos,length);
+		file->pos += length;
+		file->stat.transferred += length;
+		dst += length;
+		size -= length;
+
+		if(file->pos == file->lengths[file->cur] && file->eofs[file->cur] == FALSE) {
+			/* refill the consumed buffer and proceed to the next one */
+			mpf_async_file_buffer_release(file,file->cur);
+			file->cur ^= 1;
+			file->pos = 0;
+		}
+	}
+	return TRUE;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_async_file_eof(const mpf_async_file_t *file)
+{
+	return file->eof;
+}
+
+MPF_DECLARE(void) mpf_async_file_stat_get(const mpf_async_file_t *file, mpf_async_file_stat_t *stat)
+{
+	*stat = file->stat;
+}
+
+MPF_DECLARE(void) mpf_async_file_close(mpf_async_file_t *file)
+{
+	if(file->sink == TRUE && apr_atomic_read32(&file->owners[file->cur]) == BUFFER_OWNER_MEDIA &&
+		file->lengths[file->cur]) {
+		/* flush the partially filled buffer */
+		apr_atomic_xchg32(&file->owners[file->cur],BUFFER_OWNER_IO);
+	}
+	apr_atomic_xchg32(&file->closing,TRUE);
+	mpf_async_file_queue(file);
+}
@@ -0,0 +1,496 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mpf_g711_kernel.h"
+#include "g711/g711.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MPF_G711_X86
+#define MPF_G711_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define MPF_G711_X86
+#define MPF_G711_TARGET(isa)
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MPF_G711_NEON
+#endif
+
+typedef void (*mpf_g711_encode_f)(const apr_int16_t *linear, apr_byte_t *code, apr_size_t count);
+typedef void (*mpf_g711_decode_f)(const apr_byte_t *code, apr_int16_t *linear, apr_size_t count);
+
+/** G.711 kernel */
+typedef struct mpf_g711_kernel_t mpf_g711_kernel_t;
+struct mpf_g711_kernel_t {
+	/** Name of the kernel */
+	const char        *name;
+	/** u-law encoder */
+	mpf_g711_encode_f  ulaw_encode;
+	/** u-law decoder */
+	mpf_g711_decode_f  ulaw_decode;
+	/** A-law encoder */
+	mpf_g711_encode_f  alaw_encode;
+	/** A-law decoder */
+	mpf_g711_decode_f  alaw_decode;
+};
+
+/* encoder tables indexed by 16-bit linear samples (64K each) */
+static apr_byte_t  ulaw_encode_table[65536];
+static apr_byte_t  alaw_encode_table[65536];
+/* decoder tables indexed by code words */
+static apr_int16_t ulaw_decode_table[256];
+static apr_int16_t alaw_decode_table[256];
+
+static apt_bool_t g711_initialized = FALSE;
+static const mpf_g711_kernel_t *g711_kernel = NULL;
+
+
+static void g711u_encode_generic(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		ulaw[i] = linear_to_ulaw(linear[i]);
+	}
+}
+
+static void g711u_decode_generic(const apr_byte_t *ulaw, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = ulaw_to_linear(ulaw[i]);
+	}
+}
+
+static void g711a_encode_generic(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		alaw[i] = linear_to_alaw(linear[i]);
+	}
+}
+
+static void g711a_decode_generic(const apr_byte_t *alaw, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = alaw_to_linear(alaw[i]);
+	}
+}
+
+static void g711u_encode_table(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		ulaw[i] = ulaw_encode_table[(apr_uint16_t)linear[i]];
+	}
+}
+
+static void g711u_decode_table(const apr_byte_t *ulaw, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = ulaw_decode_table[ulaw[i]];
+	}
+}
+
+static void g711a_encode_table(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		alaw[i] = alaw_encode_table[(apr_uint16_t)linear[i]];
+	}
+}
+
+static void g711a_decode_table(const apr_byte_t *alaw, apr_int16_t *linear, apr_size_t count)
+{
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		linear[i] = alaw_decode_table[alaw[i]];
+	}
+}
+
+/*
+ * The vectorized encoders follow the generic ones, operating on 16-bit lanes:
+ * - the magnitude is computed as (x ^ sign), which equals to -x-1 for negative samples,
+ * - the segment is the number of the thresholds (0x100 << i) - 1 the magnitude exceeds,
+ * - the quantization bits (magnitude >> shift) are extracted by the high half of
+ *   the product of the magnitude and 2^(16-shift), looked up by the segment.
+ */
+
+/* 2^(16-shift) per segment as little-endian 16-bit words */
+#define G711U_SCALE_BYTES \
+	0x00,0x20, 0x00,0x10, 0x00,0x08, 0x00,0x04, 0x00,0x02, 0x00,0x01, 0x80,0x00, 0x40,0x00
+#define G711A_SCALE_BYTES \
+	0x00,0x10, 0x00,0x10, 0x00,0x08, 0x00,0x04, 0x00,0x02, 0x00,0x01, 0x80,0x00, 0x40,0x00
+
+#ifdef MPF_G711_X86
+/** Get indexes of the bytes of 16-bit words by the segment */
+MPF_G711_TARGET("sse4.1")
+static APR_INLINE __m128i g711_scale_index_sse41(__m128i seg)
+{
+	return _mm_add_epi16(_mm_mullo_epi16(seg,_mm_set1_epi16(0x0202)),_mm_set1_epi16(0x0100));
+}
+
+MPF_G711_TARGET("sse4.1")
+static APR_INLINE __m128i g711u_encode_vector_sse41(__m128i x)
+{
+	__m128i sign = _mm_srai_epi16(x,15);
+	__m128i seg = _mm_setzero_si128();
+	__m128i scale;
+	__m128i mask;
+	__m128i m;
+	int i;
+
+	/* biased magnitude, clipped to the top of the last segment */
+	m = _mm_add_epi16(_mm_xor_si128(x,sign),_mm_set1_epi16(ULAW_BIAS));
+	m = _mm_min_epu16(m,_mm_set1_epi16(0x7FFF));
+	for(i=0; i<7; i++) {
+		seg = _mm_sub_epi16(seg,_mm_cmpgt_epi16(m,_mm_set1_epi16((short)((0x100 << i) - 1))));
+	}
+	scale = _mm_shuffle_epi8(_mm_setr_epi8(G711U_SCALE_BYTES),g711_scale_index_sse41(seg));
+	m = _mm_and_si128(_mm_mulhi_epu16(m,scale),_mm_set1_epi16(0x0F));
+	m = _mm_or_si128(_mm_slli_epi16(seg,4),m);
+	/* complement the code word, keeping the sign bit of negative samples cleared */
+	mask = _mm_xor_si128(_mm_set1_epi16(0xFF),_mm_and_si128(sign,_mm_set1_epi16(0x80)));
+	return _mm_xor_si128(m,mask);
+}
+
+MPF_G711_TARGET("sse4.1")
+static APR_INLINE __m128i g711a_encode_vector_sse41(__m128i x)
+{
+	__m128i sign = _mm_srai_epi16(x,15);
+	__m128i m = _mm_xor_si128(x,sign);
+	__m128i seg = _mm_setzero_si128();
+	__m128i scale;
+	__m128i mask;
+	int i;
+
+	for(i=0; i<7; i++) {
+		seg = _mm_sub_epi16(seg,_mm_cmpgt_epi16(m,_mm_set1_epi16((short)((0x100 << i) - 1))));
+	}
+	scale = _mm_shuffle_epi8(_mm_setr_epi8(G711A_SCALE_BYTES),g711_scale_index_sse41(seg));
+	m = _mm_and_si128(_mm_mulhi_epu16(m,scale),_mm_set1_epi16(0x0F));
+	m = _mm_or_si128(_mm_slli_epi16(seg,4),m);
+	/* invert even bits, setting the sign bit of positive samples */
+	mask = _mm_xor_si128(_mm_set1_epi16(ALAW_AMI_MASK | 0x80),_mm_and_si128(sign,_mm_set1_epi16(0x80)));
+	return _mm_xor_si128(m,mask);
+}
+
+MPF_G711_TARGET("sse4.1")
+static void g711u_encode_sse41(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	__m128i lo;
+	__m128i hi;
+	apr_size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		lo = g711u_encode_vector_sse41(_mm_loadu_si128((const __m128i*)(linear + i)));
+		hi = g711u_encode_vector_sse41(_mm_loadu_si128((const __m128i*)(linear + i + 8)));
+		_mm_storeu_si128((__m128i*)(ulaw + i),_mm_packus_epi16(lo,hi));
+	}
+	g711u_encode_table(linear + i,ulaw + i,count - i);
+}
+
+MPF_G711_TARGET("sse4.1")
+static void g711a_encode_sse41(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	__m128i lo;
+	__m128i hi;
+	apr_size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		lo = g711a_encode_vector_sse41(_mm_loadu_si128((const __m128i*)(linear + i)));
+		hi = g711a_encode_vector_sse41(_mm_loadu_si128((const __m128i*)(linear + i + 8)));
+		_mm_storeu_si128((__m128i*)(alaw + i),_mm_packus_epi16(lo,hi));
+	}
+	g711a_encode_table(linear + i,alaw + i,count - i);
+}
+
+MPF_G711_TARGET("avx2")
+static APR_INLINE __m256i g711_scale_index_avx2(__m256i seg)
+{
+	return _mm256_add_epi16(_mm256_mullo_epi16(seg,_mm256_set1_epi16(0x0202)),_mm256_set1_epi16(0x0100));
+}
+
+MPF_G711_TARGET("avx2")
+static APR_INLINE __m256i g711u_encode_vector_avx2(__m256i x)
+{
+	__m256i sign = _mm256_srai_epi16(x,15);
+	__m256i seg = _mm256_setzero_si256();
+	__m256i scale;
+	__m256i mask;
+	__m256i m;
+	int i;
+
+	m = _mm256_add_epi16(_mm256_xor_si256(x,sign),_mm256_set1_epi16(ULAW_BIAS));
+	m = _mm256_min_epu16(m,_mm256_set1_epi16(0x7FFF));
+	for(i=0; i<7; i++) {
+		seg = _mm256_sub_epi16(seg,_mm256_cmpgt_epi16(m,_mm256_set1_epi16((short)((0x100 << i) - 1))));
+	}
+	scale = _mm256_shuffle_epi8(_mm256_setr_epi8(G711U_SCALE_BYTES,G711U_SCALE_BYTES),g711_scale_index_avx2(seg));
+	m = _mm256_and_si256(_mm256_mulhi_epu16(m,scale),_mm256_set1_epi16(0x0F));
+	m = _mm256_or_si256(_mm256_slli_epi16(seg,4),m);
+	mask = _mm256_xor_si256(_mm256_set1_epi16(0xFF),_mm256_and_si256(sign,_mm256_set1_epi16(0x80)));
+	return _mm256_xor_si256(m,mask);
+}
+
+MPF_G711_TARGET("avx2")
+static APR_INLINE __m256i g711a_encode_vector_avx2(__m256i x)
+{
+	__m256i sign = _mm256_srai_epi16(x,15);
+	__m256i m = _mm256_xor_si256(x,sign);
+	__m256i seg = _mm256_setzero_si256();
+	__m256i scale;
+	__m256i mask;
+	int i;
+
+	for(i=0; i<7; i++) {
+		seg = _mm256_sub_epi16(seg,_mm256_cmpgt_epi16(m,_mm256_set1_epi16((short)((0x100 << i) - 1))));
+	}
+	scale = _mm256_shuffle_epi8(_mm256_setr_epi8(G711A_SCALE_BYTES,G711A_SCALE_BYTES),g711_scale_index_avx2(seg));
+	m = _mm256_and_si256(_mm256_mulhi_epu16(m,scale),_mm256_set1_epi16(0x0F));
+	m = _mm256_or_si256(_mm256_slli_epi16(seg,4),m);
+	mask = _mm256_xor_si256(_mm256_set1_epi16(ALAW_AMI_MASK | 0x80),_mm256_and_si256(sign,_mm256_set1_epi16(0x80)));
+	return _mm256_xor_si256(m,mask);
+}
+
+MPF_G711_TARGET("avx2")
+static void g711u_encode_avx2(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	__m256i lo;
+	__m256i hi;
+	apr_size_t i = 0;
+	for(; i + 32 <= count; i += 32) {
+		lo = g711u_encode_vector_avx2(_mm256_loadu_si256((const __m256i*)(linear + i)));
+		hi = g711u_encode_vector_avx2(_mm256_loadu_si256((const __m256i*)(linear + i + 16)));
+		/* packing interleaves 128-bit lanes, restore the order */
+		_mm256_storeu_si256((__m256i*)(ulaw + i),_mm256_permute4x64_epi64(_mm256_packus_epi16(lo,hi),0xD8));
+	}
+	g711u_encode_table(linear + i,ulaw + i,count - i);
+}
+
+MPF_G711_TARGET("avx2")
+static void g711a_encode_avx2(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	__m256i lo;
+	__m256i hi;
+	apr_size_t i = 0;
+	for(; i + 32 <= count; i += 32) {
+		lo = g711a_encode_vector_avx2(_mm256_loadu_si256((const __m256i*)(linear + i)));
+		hi = g711a_encode_vector_avx2(_mm256_loadu_si256((const __m256i*)(linear + i + 16)));
+		_mm256_storeu_si256((__m256i*)(alaw + i),_mm256_permute4x64_epi64(_mm256_packus_epi16(lo,hi),0xD8));
+	}
+	g711a_encode_table(linear + i,alaw + i,count - i);
+}
+
+#if defined(_MSC_VER)
+static apt_bool_t g711_cpu_sse41_supported(void)
+{
+	int info[4];
+	__cpuid(info,1);
+	return (info[2] & (1 << 19)) ? TRUE : FALSE;
+}
+
+static apt_bool_t g711_cpu_avx2_supported(void)
+{
+	int info[4];
+	__cpuid(info,1);
+	/* the OS must save the state of YMM registers */
+	if(!(info[2] & (1 << 27)) || (_xgetbv(0) & 0x6) != 0x6) {
+		return FALSE;
+	}
+	__cpuidex(info,7,0);
+	return (info[1] & (1 << 5)) ? TRUE : FALSE;
+}
+#else
+static apt_bool_t g711_cpu_sse41_supported(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.1") ? TRUE : FALSE;
+}
+
+static apt_bool_t g711_cpu_avx2_supported(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+}
+#endif
+#endif /* MPF_G711_X86 */
+
+#ifdef MPF_G711_NEON
+static APR_INLINE uint8x8_t g711u_encode_vector_neon(int16x8_t x)
+{
+	int16x8_t sign = vshrq_n_s16(x,15);
+	uint16x8_t mask = vandq_u16(vreinterpretq_u16_s16(sign),vdupq_n_u16(0x80));
+	uint16x8_t m = vreinterpretq_u16_s16(veorq_s16(x,sign));
+	int16x8_t seg;
+
+	m = vminq_u16(vaddq_u16(m,vdupq_n_u16(ULAW_BIAS)),vdupq_n_u16(0x7FFF));
+	/* the segment is 8 minus the number of leading zeros of (m | 0xFF) */
+	seg = vsubq_s16(vdupq_n_s16(8),vreinterpretq_s16_u16(vclzq_u16(vorrq_u16(m,vdupq_n_u16(0xFF)))));
+	m = vandq_u16(vshlq_u16(m,vnegq_s16(vaddq_s16(seg,vdupq_n_s16(3)))),vdupq_n_u16(0x0F));
+	m = vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(seg),4),m);
+	mask = veorq_u16(vdupq_n_u16(0xFF),mask);
+	return vmovn_u16(veorq_u16(m,mask));
+}
+
+static APR_INLINE uint8x8_t g711a_encode_vector_neon(int16x8_t x)
+{
+	int16x8_t sign = vshrq_n_s16(x,15);
+	uint16x8_t mask = vandq_u16(vreinterpretq_u16_s16(sign),vdupq_n_u16(0x80));
+	uint16x8_t m = vreinterpretq_u16_s16(veorq_s16(x,sign));
+	int16x8_t seg;
+	int16x8_t shift;
+
+	seg = vsubq_s16(vdupq_n_s16(8),vreinterpretq_s16_u16(vclzq_u16(vorrq_u16(m,vdupq_n_u16(0xFF)))));
+	/* the first two segments share the same shift */
+	shift = vaddq_s16(vmaxq_s16(seg,vdupq_n_s16(1)),vdupq_n_s16(3));
+	m = vandq_u16(vshlq_u16(m,vnegq_s16(shift)),vdupq_n_u16(0x0F));
+	m = vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(seg),4),m);
+	mask = veorq_u16(vdupq_n_u16(ALAW_AMI_MASK | 0x80),mask);
+	return vmovn_u16(veorq_u16(m,mask));
+}
+
+static void g711u_encode_neon(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	apr_size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		vst1q_u8(ulaw + i,vcombine_u8(
+			g711u_encode_vector_neon(vld1q_s16(linear + i)),
+			g711u_encode_vector_neon(vld1q_s16(linear + i + 8))));
+	}
+	g711u_encode_table(linear + i,ulaw + i,count - i);
+}
+
+static void g711a_encode_neon(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	apr_size_t i = 0;
+	for(; i + 16 <= count; i += 16) {
+		vst1q_u8(alaw + i,vcombine_u8(
+			g711a_encode_vector_neon(vld1q_s16(linear + i)),
+			g711a_encode_vector_neon(vld1q_s16(linear + i + 8))));
+	}
+	g711a_encode_table(linear + i,alaw + i,count - i);
+}
+#endif /* MPF_G711_NEON */
+
+static const mpf_g711_kernel_t g711_kernels[MPF_G711_KERNEL_COUNT] = {
+	{"generic", g711u_encode_generic, g711u_decode_generic, g711a_encode_generic, g711a_decode_generic},
+	{"table",   g711u_encode_table,   g711u_decode_table,   g711a_encode_table,   g711a_decode_table},
+#ifdef MPF_G711_X86
+	{"sse4.1",  g711u_encode_sse41,   g711u_decode_table,   g711a_encode_sse41,   g711a_decode_table},
+	{"avx2",    g711u_encode_avx2,    g711u_decode_table,   g711a_encode_avx2,    g711a_decode_table},
+#else
+	{"sse4.1",  NULL, NULL, NULL, NULL},
+	{"avx2",    NULL, NULL, NULL, NULL},
+#endif
+#ifdef MPF_G711_NEON
+	{"neon",    g711u_encode_neon,    g711u_decode_table,   g711a_encode_neon,    g711a_decode_table}
+#else
+	{"neon",    NULL, NULL, NULL, NULL}
+#endif
+};
+
+static apt_bool_t mpf_g711_kernel_supported(mpf_g711_kernel_e kernel)
+{
+	if(kernel >= MPF_G711_KERNEL_COUNT || !g711_kernels[kernel].ulaw_encode) {
+		return FALSE;
+	}
+#ifdef MPF_G711_X86
+	if(kernel == MPF_G711_KERNEL_SSE41) {
+		return g711_cpu_sse41_supported();
+	}
+	if(kernel == MPF_G711_KERNEL_AVX2) {
+		return g711_cpu_avx2_supported();
+	}
+#endif
+	return TRUE;
+}
+
+MPF_DECLARE(void) mpf_g711_init(void)
+{
+	apr_size_t i;
+	int kernel;
+	if(g711_initialized == TRUE) {
+		return;
+	}
+
+	for(i=0; i<65536; i++) {
+		ulaw_encode_table[i] = linear_to_ulaw((apr_int16_t)i);
+		alaw_encode_table[i] = linear_to_alaw((apr_int16_t)i);
+	}
+	for(i=0; i<256; i++) {
+		ulaw_decode_table[i] = ulaw_to_linear((apr_byte_t)i);
+		alaw_decode_table[i] = alaw_to_linear((apr_byte_t)i);
+	}
+
+	/* select the fastest kernel supported, vector encoders are preferred
+	over the table as they have no cache footprint */
+	g711_kernel = &g711_kernels[MPF_G711_KERNEL_TABLE];
+	for(kernel = MPF_G711_KERNEL_COUNT - 1; kernel > MPF_G711_KERNEL_TABLE; kernel--) {
+		if(mpf_g711_kernel_supported((mpf_g711_kernel_e)kernel) == TRUE) {
+			g711_kernel = &g711_kernels[kernel];
+			break;
+		}
+	}
+	g711_initialized = TRUE;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_g711_kernel_set(mpf_g711_kernel_e kernel)
+{
+	mpf_g711_init();
+	if(mpf_g711_kernel_supported(kernel) == FALSE) {
+		return FALSE;
+	}
+	g711_kernel = &g711_kernels[kernel];
+	return TRUE;
+}
+
+MPF_DECLARE(mpf_g711_kernel_e) mpf_g711_kernel_get(void)
+{
+	mpf_g711_init();
+	return (mpf_g711_kernel_e)(g711_kernel - g711_kernels);
+}
+
+MPF_DECLARE(const char*) mpf_g711_kernel_name_get(mpf_g711_kernel_e kernel)
+{
+	if(kernel >= MPF_G711_KERNEL_COUNT) {
+		return NULL;
+	}
+	return g711_kernels[kernel].name;
+}
+
+MPF_DECLARE(void) mpf_g711u_encode(const apr_int16_t *linear, apr_byte_t *ulaw, apr_size_t count)
+{
+	g711_kernel->ulaw_encode(linear,ulaw,count);
+}
+
+MPF_DECLARE(void) mpf_g711u_decode(const apr_byte_t *ulaw, apr_int16_t *linear, apr_size_t count)
+{
+	g711_kernel->ulaw_decode(ulaw,linear,count);
+}
+
+MPF_DECLARE(void) mpf_g711a_encode(const apr_int16_t *linear, apr_byte_t *alaw, apr_size_t count)
+{
+	g711_kernel->alaw_encode(linear,alaw,count);
+}
+
+MPF_DECLARE(void) mpf_g711a_decode(const apr_byte_t *alaw, apr_int16_t *linear, apr_size_t count)
+{
+	g711_kernel->alaw_decode(alaw,linear,count);
+}
@@ -15,10 +15,20 @@
  */
 
 #include "mpf_jitter_buffer.h"
+#include "mpf_plc.h"
 #include "mpf_trace.h"
 
 #define MAX_FRAMES_PER_PACKET 16
 
+/* target playout delay as a multiple of the interarrival jitter */
+#define JB_JITTER_FACTOR       4
+/* time to collect the jitter statistics before the playout delay is adapted, in msec */
+#define JB_ADAPT_WARMUP_TIME   1000
+/* time to hold on the playout delay once grown due to a late packet, in msec */
+#define JB_ADAPT_HOLD_TIME     2000
+/* min interval between consecutive adaptations of the playout delay, in msec */
+#define JB_ADAPT_INTERVAL      100
+
 #if ENABLE_JB_TRACE == 1
 #define JB_TRACE printf
 #elif ENABLE_JB_TRACE == 2
@@ -53,6 +63,8 @@ struct mpf_jitter_buffer_t {
 	apr_uint32_t     playout_delay_ts;
 	/* max playout delay in timetsamp units */
 	apr_uint32_t     max_playout_delay_ts;
+	/* min playout delay in timetsamp units */
+	apr_uint32_t     min_playout_delay_ts;
 
 	/* write should be synchronized (offset calculated) */
 	apr_byte_t       write_sync;
@@ -71,12 +83,40 @@ struct mpf_jitter_buffer_t {
 	/* number of statistical measurements made */
 	apr_uint32_t     measurment_count;
 
+	/* clock advanced on every read, packet arrival is measured by in timestamp units */
+	apr_uint32_t     clock_ts;
+	/* transit time of the last packet in timestamp units */
+	apr_int32_t      transit_ts;
+	/* transit time should be synchronized (the first packet of the stream) */
+	apr_byte_t       transit_sync;
+	/* interarrival jitter in timestamp units scaled by 16 (RFC 3550) */
+	apr_uint32_t     jitter;
+	/* number of reads the playout delay is not adapted for */
+	apr_uint32_t     adapt_hold;
+
 	/* timestamp event starts at */
 	apr_uint32_t                   event_write_base_ts;
 	/* the first (base) frame of the event */
 	mpf_named_event_frame_t        event_write_base;
 	/* the last received update for the event */
 	const mpf_named_event_frame_t *event_write_update;
+
+	/* waveform PLC of the decoded frames (codecs with no decoder state and no native PLC) */
+	mpf_plc_t         *plc;
+	/* decoded (linear PCM) frame the waveform PLC operates on */
+	mpf_codec_frame_t  plc_frame;
+	/* size of the decoded frame in bytes */
+	apr_size_t         plc_frame_size;
+	/* lost frames are to be concealed by the decoder (native PLC) */
+	apt_bool_t         plc_native;
+	/* whether the talkspurt is in progress, so that missing frames are considered lost */
+	apt_bool_t         plc_talkspurt;
+	/* number of frames concealed in a row */
+	apr_size_t         plc_count;
+	/* max number of frames to conceal in a row */
+	apr_size_t         plc_max_count;
+	/* total number of concealed frames */
+	apr_uint32_t       concealed_frames;
 };
 
 
@@ -125,6 +165,7 @@ mpf_jitter_buffer_t* mpf_jitter_buffer_create(mpf_jb_config_t *jb_config, mpf_co
 	/* calculate playout delay in timestamp units */
 	jb->playout_delay_ts = jb->frame_ts * jb->config->initial_playout_delay / jb->frame_duration;
 	jb->max_playout_delay_ts = jb->frame_ts * jb->config->max_playout_delay / jb->frame_duration;
+	jb->min_playout_delay_ts = jb->frame_ts * jb->config->min_playout_delay / jb->frame_duration;
 
 	jb->write_sync = 1;
 	jb->write_ts_offset = 0;
@@ -133,10 +174,45 @@ mpf_jitter_buffer_t* mpf_jitter_buffer_create(mpf_jb_config_t *jb_config, mpf_co
 	jb->min_length_ts = jb->max_length_ts = 0;
 	jb->measurment_count = 0;
 
+	jb->clock_ts = 0;
+	jb->transit_ts = 0;
+	jb->transit_sync = 1;
+	jb->jitter = 0;
+	jb->adapt_hold = JB_ADAPT_WARMUP_TIME / jb->frame_duration;
+
 	jb->event_write_base_ts = 0;
 	memset(&jb->event_write_base,0,sizeof(mpf_named_event_frame_t));
 	jb->event_write_update = NULL;
 
+	jb->plc = NULL;
+	jb->plc_frame.buffer = NULL;
+	jb->plc_frame.size = 0;
+	jb->plc_frame_size = 0;
+	jb->plc_native = FALSE;
+	jb->plc_talkspurt = FALSE;
+	jb->plc_count = 0;
+	jb->plc_max_count = MPF_PLC_MAX_DURATION / jb->frame_duration;
+	jb->concealed_frames = 0;
+	if(jb->config->plc && codec->vtable->conceal) {
+		/* the decoder conceals lost frames on its own */
+		jb->plc_native = TRUE;
+	}
+	else if((jb->config->plc || jb->config->adaptive) &&
+			!codec->vtable->open_decoder && codec->vtable->decode && codec->vtable->encode &&
+			descriptor->channel_count == 1) {
+		/* the decoder has no state, so frames can be decoded and either concealed
+		or time-scaled right here (G.711, L16) */
+		jb->plc_frame_size = mpf_codec_linear_frame_size_calculate(
+									descriptor->sampling_rate,
+									descriptor->channel_count,
+									descriptor->frame_duration);
+		jb->plc_frame.buffer = apr_palloc(pool,jb->plc_frame_size);
+		jb->plc = mpf_plc_create(
+						descriptor->sampling_rate,
+						jb->plc_frame_size / sizeof(apr_int16_t),
+						pool);
+	}
+
 	return jb;
 }
 
@@ -158,6 +234,17 @@ apt_bool_t mpf_jitter_buffer_restart(mpf_jitter_buffer_t *jb)
 		jb->playout_delay_ts = jb->frame_ts * jb->config->initial_playout_delay / jb->frame_duration;
 	}
 
+	jb->transit_sync = 1;
+	jb->jitter = 0;
+	jb->adapt_hold = JB_ADAPT_WARMUP_TIME / jb->frame_duration;
+
+	if(jb->plc) {
+		mpf_plc_reset(jb->plc);
+	}
+	jb->plc_talkspurt = FALSE;
+	jb->plc_count = 0;
+	jb->concealed_frames = 0;
+
 	JB_TRACE("JB restart\n");
 	return TRUE;
 }
@@ -195,6 +282,49 @@ static APR_INLINE void mpf_jitter_buffer_stat_update(mpf_jitter_buffer_t *jb)
 	jb->measurment_count++;
 }
 
+static APR_INLINE void mpf_jitter_buffer_jitter_update(mpf_jitter_buffer_t *jb, apr_uint32_t ts)
+{
+	/* transit time relative to the clock, which advances in real time */
+	apr_int32_t transit_ts = (apr_int32_t)(jb->clock_ts - ts);
+	apr_int32_t deviation;
+
+	if(jb->transit_sync) {
+		jb->transit_ts = transit_ts;
+		jb->transit_sync = 0;
+		return;
+	}
+
+	deviation = transit_ts - jb->transit_ts;
+	jb->transit_ts = transit_ts;
+	if(deviation < 0) {
+		deviation = -deviation;
+	}
+
+	if((apr_uint32_t)deviation > jb->max_playout_delay_ts) {
+		/* timestamp discontinuity, not a jitter */
+		return;
+	}
+
+	jb->jitter += deviation - ((jb->jitter + 8) >> 4);
+}
+
+static APR_INLINE apr_uint32_t mpf_jitter_buffer_target_delay_get(const mpf_jitter_buffer_t *jb)
+{
+	/* the lowest delay most of the packets arrive in time with, alligned with frame_ts */
+	apr_uint32_t target_ts = JB_JITTER_FACTOR * (jb->jitter >> 4);
+	if(target_ts % jb->frame_ts != 0) {
+		target_ts += jb->frame_ts - target_ts % jb->frame_ts;
+	}
+
+	if(target_ts < jb->min_playout_delay_ts) {
+		target_ts = jb->min_playout_delay_ts;
+	}
+	else if(target_ts > jb->max_playout_delay_ts) {
+		target_ts = jb->max_playout_delay_ts;
+	}
+	return target_ts;
+}
+
 static APR_INLINE void mpf_jitter_buffer_frame_allign(mpf_jitter_buffer_t *jb, apr_uint32_t *ts)
 {
 	if(*ts % jb->frame_ts != 0) 
@@ -252,6 +382,11 @@ jb_result_t mpf_jitter_buffer_write(mpf_jitter_buffer_t *jb, void *buffer, apr_s
 		return result;
 	}
 
+	if(jb->config->adaptive) {
+		/* estimate interarrival jitter the playout delay is adapted to */
+		mpf_jitter_buffer_jitter_update(jb,ts);
+	}
+
 	if(write_ts >= jb->read_ts) {
 		if(write_ts >= jb->write_ts) {
 			/* normal order */
@@ -322,6 +457,8 @@ jb_result_t mpf_jitter_buffer_write(mpf_jitter_buffer_t *jb, void *buffer, apr_s
 			/* adjust the playout delay */
 			jb->playout_delay_ts += delta_ts;
 			write_ts += delta_ts;
+			/* do not shrink the playout delay right away */
+			jb->adapt_hold = JB_ADAPT_HOLD_TIME / jb->frame_duration;
 			JB_TRACE("JB adjust playout delay=%u delta=%u\n",jb->playout_delay_ts,delta_ts);
 
 			if(jb->config->time_skew_detection) {
@@ -443,6 +580,7 @@ jb_result_t mpf_jitter_buffer_event_write(mpf_jitter_buffer_t *jb, const mpf_nam
 		/* adjust the playout delay */
 		jb->playout_delay_ts += delta_ts;
 		write_ts += delta_ts;
+		jb->adapt_hold = JB_ADAPT_HOLD_TIME / jb->frame_duration;
 		if(marker) {
 			jb->event_write_base_ts = write_ts;
 		}
@@ -476,9 +614,154 @@ jb_result_t mpf_jitter_buffer_event_write(mpf_jitter_buffer_t *jb, const mpf_nam
 	return result;
 }
 
-apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+static void mpf_jitter_buffer_plc_process(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+{
+	if(media_frame->type & MEDIA_FRAME_TYPE_AUDIO) {
+		if(jb->plc) {
+			/* keep the history of the decoded signal, smoothing the transition from concealed frames if any */
+			jb->plc_frame.size = jb->plc_frame_size;
+			mpf_codec_decode(jb->codec,&media_frame->codec_frame,&jb->plc_frame);
+			if(jb->plc_frame.size == jb->plc_frame_size &&
+				mpf_plc_good_frame(jb->plc,jb->plc_frame.buffer) == TRUE) {
+				mpf_codec_encode(jb->codec,&jb->plc_frame,&media_frame->codec_frame);
+			}
+		}
+		jb->plc_talkspurt = TRUE;
+		jb->plc_count = 0;
+		return;
+	}
+
+	if(media_frame->type != MEDIA_FRAME_TYPE_NONE || jb->plc_talkspurt == FALSE || !jb->config->plc) {
+		/* either a named event or no talkspurt, nothing is lost, or nothing to be concealed */
+		jb->plc_talkspurt = FALSE;
+		return;
+	}
+
+	if(jb->plc_count >= jb->plc_max_count) {
+		/* the loss is too long to be concealed, consider the talkspurt over */
+		JB_TRACE("JB read ts=%u concealment is over\n", jb->read_ts);
+		jb->plc_talkspurt = FALSE;
+		return;
+	}
+
+	JB_TRACE("JB read ts=%u conceal lost frame\n", jb->read_ts);
+	if(jb->plc_native) {
+		/* ask the decoder to conceal the lost frame */
+		media_frame->type = MEDIA_FRAME_TYPE_LOST;
+	}
+	else {
+		mpf_plc_lost_frame(jb->plc,jb->plc_frame.buffer);
+		jb->plc_frame.size = jb->plc_frame_size;
+		mpf_codec_encode(jb->codec,&jb->plc_frame,&media_frame->codec_frame);
+		media_frame->type = MEDIA_FRAME_TYPE_AUDIO;
+	}
+	jb->plc_count++;
+	jb->concealed_frames++;
+}
+
+static APR_INLINE void mpf_jitter_buffer_playout_delay_adjust(mpf_jitter_buffer_t *jb, apr_int32_t delta_ts)
+{
+	jb->playout_delay_ts += delta_ts;
+	if(jb->config->time_skew_detection) {
+		/* adjust the statistics */
+		jb->min_length_ts += delta_ts;
+		jb->max_length_ts += delta_ts;
+	}
+	jb->adapt_hold = JB_ADAPT_INTERVAL / jb->frame_duration;
+}
+
+static apt_bool_t mpf_jitter_buffer_playout_adapt(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
 {
-	mpf_frame_t *src_media_frame = mpf_jitter_buffer_frame_get(jb,jb->read_ts);
+	mpf_frame_t *src_media_frame;
+	apr_uint32_t target_ts;
+
+	if(jb->adapt_hold) {
+		jb->adapt_hold--;
+		return FALSE;
+	}
+	if(jb->write_sync) {
+		/* nothing received yet */
+		return FALSE;
+	}
+
+	target_ts = mpf_jitter_buffer_target_delay_get(jb);
+	src_media_frame = mpf_jitter_buffer_frame_get(jb,jb->read_ts);
+	if(jb->playout_delay_ts >= target_ts + jb->frame_ts) {
+		/* shrink the playout delay by skipping the frame */
+		if(jb->write_ts <= jb->read_ts + jb->frame_ts) {
+			/* nothing to read after the frame */
+			return FALSE;
+		}
+
+		if(src_media_frame->type == MEDIA_FRAME_TYPE_NONE) {
+			/* silence or lost frame */
+		}
+		else if(src_media_frame->type == MEDIA_FRAME_TYPE_AUDIO && jb->plc && jb->plc_talkspurt == TRUE) {
+			/* speech, which can be time-scaled */
+		}
+		else {
+			/* either a named event, or speech which cannot be time-scaled */
+			return FALSE;
+		}
+
+		if(jb->plc && jb->plc_talkspurt == TRUE) {
+			/* smoothly join the next frame to the previous one */
+			mpf_plc_skipped_frame(jb->plc);
+		}
+
+		JB_TRACE("JB read ts=%u skip frame playout delay=%u target=%u\n",
+			jb->read_ts,jb->playout_delay_ts,target_ts);
+		src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
+		src_media_frame->marker = MPF_MARKER_NONE;
+		/* advance read pos keeping the write pos of subsequent packets */
+		jb->read_ts += jb->frame_ts;
+		jb->write_ts_offset -= jb->frame_ts;
+		mpf_jitter_buffer_playout_delay_adjust(jb,-(apr_int32_t)jb->frame_ts);
+		return FALSE;
+	}
+
+	if(jb->playout_delay_ts < target_ts) {
+		/* grow the playout delay by inserting a frame */
+		if(jb->plc && jb->plc_talkspurt == TRUE && jb->plc_count == 0 &&
+			(src_media_frame->type & MEDIA_FRAME_TYPE_EVENT) == 0) {
+			/* speech, stretch it by repeating the last pitch period */
+			mpf_plc_lost_frame(jb->plc,jb->plc_frame.buffer);
+			jb->plc_frame.size = jb->plc_frame_size;
+			mpf_codec_encode(jb->codec,&jb->plc_frame,&media_frame->codec_frame);
+			media_frame->type = MEDIA_FRAME_TYPE_AUDIO;
+		}
+		else if(src_media_frame->type == MEDIA_FRAME_TYPE_NONE && jb->plc_talkspurt == FALSE) {
+			/* silence, prolong it */
+			media_frame->type = MEDIA_FRAME_TYPE_NONE;
+		}
+		else {
+			return FALSE;
+		}
+
+		JB_TRACE("JB read ts=%u insert frame playout delay=%u target=%u\n",
+			jb->read_ts,jb->playout_delay_ts,target_ts);
+		media_frame->marker = MPF_MARKER_NONE;
+		/* keep read pos and the write pos of subsequent packets, which are then read a frame later */
+		jb->write_ts_offset += jb->frame_ts;
+		mpf_jitter_buffer_playout_delay_adjust(jb,jb->frame_ts);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static APR_INLINE apt_bool_t mpf_jitter_buffer_frame_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame, apt_bool_t view)
+{
+	mpf_frame_t *src_media_frame;
+
+	/* advance the clock the packet arrival is measured by */
+	jb->clock_ts += jb->frame_ts;
+
+	if(jb->config->adaptive && mpf_jitter_buffer_playout_adapt(jb,media_frame) == TRUE) {
+		/* the frame has been inserted */
+		return TRUE;
+	}
+
+	src_media_frame = mpf_jitter_buffer_frame_get(jb,jb->read_ts);
 	if(jb->write_ts > jb->read_ts) {
 		/* normal read */
 		JB_TRACE("JB read ts=%u\n",	jb->read_ts);
@@ -486,7 +769,13 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 		media_frame->marker = src_media_frame->marker;
 		if(media_frame->type & MEDIA_FRAME_TYPE_AUDIO) {
 			media_frame->codec_frame.size = src_media_frame->codec_frame.size;
-			memcpy(media_frame->codec_frame.buffer,src_media_frame->codec_frame.buffer,media_frame->codec_frame.size);
+			if(view == TRUE) {
+				/* lend the slot, which is vacated by the read, but not written until the next packet */
+				media_frame->codec_frame.buffer = src_media_frame->codec_frame.buffer;
+			}
+			else {
+				memcpy(media_frame->codec_frame.buffer,src_media_frame->codec_frame.buffer,media_frame->codec_frame.size);
+			}
 		}
 		if(media_frame->type & MEDIA_FRAME_TYPE_EVENT) {
 			media_frame->event_frame = src_media_frame->event_frame;
@@ -498,6 +787,10 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 		media_frame->type = MEDIA_FRAME_TYPE_NONE;
 		media_frame->marker = MPF_MARKER_NONE;
 	}
+	if(jb->plc || jb->plc_native) {
+		/* conceal the frame either missing in the talkspurt or arrived too late */
+		mpf_jitter_buffer_plc_process(jb,media_frame);
+	}
 	src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
 	src_media_frame->marker = MPF_MARKER_NONE;
 	/* advance read pos */
@@ -510,6 +803,16 @@ apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_fr
 	return TRUE;
 }
 
+apt_bool_t mpf_jitter_buffer_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+{
+	return mpf_jitter_buffer_frame_read(jb,media_frame,FALSE);
+}
+
+apt_bool_t mpf_jitter_buffer_view_read(mpf_jitter_buffer_t *jb, mpf_frame_t *media_frame)
+{
+	return mpf_jitter_buffer_frame_read(jb,media_frame,TRUE);
+}
+
 apr_uint32_t mpf_jitter_buffer_playout_delay_get(const mpf_jitter_buffer_t *jb)
 {
 	if(jb->config->adaptive == 0) {
@@ -518,3 +821,8 @@ apr_uint32_t mpf_jitter_buffer_playout_delay_get(const mpf_jitter_buffer_t *jb)
 
 	return jb->playout_delay_ts * jb->frame_duration / jb->frame_ts;
 }
+
+apr_uint32_t mpf_jitter_buffer_concealed_frames_get(const mpf_jitter_buffer_t *jb)
+{
+	return jb->concealed_frames;
+}
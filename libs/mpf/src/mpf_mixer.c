@@ -21,6 +21,17 @@
 #include "mpf_codec_manager.h"
 #include "apt_log.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MPF_MIXER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MPF_MIXER_NEON
+#endif
+
+/** Number of fractional bits of gains */
+#define MPF_MIXER_GAIN_SHIFT 12
+
 typedef struct mpf_mixer_t mpf_mixer_t;
 
 /** MPF mixer derived from MPF object */
@@ -31,55 +42,218 @@ struct mpf_mixer_t {
 	mpf_audio_stream_t **source_arr;
 	/** Number of audio sources */
 	apr_size_t           source_count;
+	/** Array of gains of audio sources */
+	apr_int16_t         *gain_arr;
 	/** Audio sink */
 	mpf_audio_stream_t  *sink;
 
-	/** Frame to read from audio source */
-	mpf_frame_t          frame;
+	/** Array of frames to read from audio sources */
+	mpf_frame_t         *frame_arr;
+	/** Buffers of audio frames to mix in the current pass */
+	const apr_int16_t  **mix_buf_arr;
+	/** Gains of audio frames to mix in the current pass */
+	apr_int16_t         *mix_gain_arr;
 	/** Mixed frame to write to audio sink */
 	mpf_frame_t          mix_frame;
 };
 
-static apt_bool_t mpf_frames_mix(mpf_frame_t *mix_frame, const mpf_frame_t *frame)
+static APR_INLINE apr_int16_t mpf_sample_saturate(apr_int32_t sample)
+{
+	if(sample > 32767) {
+		return 32767;
+	}
+	if(sample < -32768) {
+		return -32768;
+	}
+	return (apr_int16_t)sample;
+}
+
+/** Get the gains of a pair of sources, the second of which may be absent */
+static APR_INLINE void mpf_mixer_pair_gains_get(
+							const apr_int16_t *gain_arr,
+							apr_size_t index,
+							apr_size_t count,
+							apr_int32_t *gain1,
+							apr_int32_t *gain2)
+{
+	if(!gain_arr) {
+		*gain1 = 1;
+		*gain2 = (index + 1 < count) ? 1 : 0;
+		return;
+	}
+	*gain1 = gain_arr[index];
+	*gain2 = (index + 1 < count) ? gain_arr[index + 1] : 0;
+}
+
+/** Mix samples in range [from, samples) in scalar code */
+static void mpf_samples_mix_scalar(
+				apr_int16_t *mix_buf,
+				const apr_int16_t * const *buf_arr,
+				const apr_int16_t *gain_arr,
+				apr_size_t count,
+				apr_size_t from,
+				apr_size_t samples)
 {
 	apr_size_t i;
-	apr_int16_t *mix_buf = mix_frame->codec_frame.buffer;
-	const apr_int16_t *buf = frame->codec_frame.buffer;
-	apr_size_t samples = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_size_t j;
+	apr_int32_t gain1;
+	apr_int32_t gain2;
+	apr_int32_t sum;
+	int shift = gain_arr ? MPF_MIXER_GAIN_SHIFT : 0;
 
-	if(mix_frame->codec_frame.size != frame->codec_frame.size) {
-		return FALSE;
+	for(i=from; i<samples; i++) {
+		sum = 0;
+		for(j=0; j<count; j+=2) {
+			mpf_mixer_pair_gains_get(gain_arr,j,count,&gain1,&gain2);
+			if(gain2) {
+				sum += (buf_arr[j][i] * gain1 + buf_arr[j+1][i] * gain2) >> shift;
+			}
+			else {
+				sum += (buf_arr[j][i] * gain1) >> shift;
+			}
+		}
+		mix_buf[i] = mpf_sample_saturate(sum);
+	}
+}
+
+MPF_DECLARE(void) mpf_mixer_samples_mix(
+								apr_int16_t *mix_buf,
+								const apr_int16_t * const *buf_arr,
+								const apr_int16_t *gain_arr,
+								apr_size_t count,
+								apr_size_t samples)
+{
+	apr_size_t i = 0;
+	apr_size_t j;
+
+	if(!count) {
+		memset(mix_buf,0,samples * sizeof(apr_int16_t));
+		return;
 	}
 
-	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		for(i=0; i<samples; i++) {
-			/* overflow MUST be considered */
-			mix_buf[i] = mix_buf[i] + buf[i];
+	if(gain_arr) {
+		/* drop the gains if all of them are unity, so that products need no shifting */
+		for(j=0; j<count; j++) {
+			if(gain_arr[j] != MPF_MIXER_GAIN_UNITY) break;
+		}
+		if(j == count) {
+			gain_arr = NULL;
 		}
-		mix_frame->type |= MEDIA_FRAME_TYPE_AUDIO;
 	}
 
-	return TRUE;
+	if(!gain_arr && count == 1) {
+		if(mix_buf != buf_arr[0]) {
+			memcpy(mix_buf,buf_arr[0],samples * sizeof(apr_int16_t));
+		}
+		return;
+	}
+
+	/* sources are accumulated pairwise in 32-bit lanes and saturated once,
+	so that the result doesn't depend on the order of sources */
+#if defined(MPF_MIXER_SSE2)
+	if(!gain_arr && count == 2) {
+		for(; i + 8 <= samples; i += 8) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(buf_arr[0] + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(buf_arr[1] + i));
+			_mm_storeu_si128((__m128i*)(mix_buf + i),_mm_adds_epi16(a,b));
+		}
+	}
+	else {
+		__m128i zero = _mm_setzero_si128();
+		__m128i shift = _mm_cvtsi32_si128(gain_arr ? MPF_MIXER_GAIN_SHIFT : 0);
+		apr_int32_t gain1;
+		apr_int32_t gain2;
+		for(; i + 8 <= samples; i += 8) {
+			__m128i sum_lo = zero;
+			__m128i sum_hi = zero;
+			for(j=0; j<count; j+=2) {
+				__m128i a = _mm_loadu_si128((const __m128i*)(buf_arr[j] + i));
+				__m128i b = zero;
+				__m128i gains;
+				mpf_mixer_pair_gains_get(gain_arr,j,count,&gain1,&gain2);
+				if(gain2) {
+					b = _mm_loadu_si128((const __m128i*)(buf_arr[j+1] + i));
+				}
+				gains = _mm_set1_epi32((gain2 << 16) | gain1);
+				/* a*gain1 + b*gain2 in 32-bit lanes */
+				sum_lo = _mm_add_epi32(sum_lo,_mm_sra_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a,b),gains),shift));
+				sum_hi = _mm_add_epi32(sum_hi,_mm_sra_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a,b),gains),shift));
+			}
+			_mm_storeu_si128((__m128i*)(mix_buf + i),_mm_packs_epi32(sum_lo,sum_hi));
+		}
+	}
+#elif defined(MPF_MIXER_NEON)
+	if(!gain_arr && count == 2) {
+		for(; i + 8 <= samples; i += 8) {
+			vst1q_s16(mix_buf + i,vqaddq_s16(vld1q_s16(buf_arr[0] + i),vld1q_s16(buf_arr[1] + i)));
+		}
+	}
+	else {
+		int32x4_t shift = vdupq_n_s32(gain_arr ? -MPF_MIXER_GAIN_SHIFT : 0);
+		apr_int32_t gain1;
+		apr_int32_t gain2;
+		for(; i + 8 <= samples; i += 8) {
+			int32x4_t sum_lo = vdupq_n_s32(0);
+			int32x4_t sum_hi = vdupq_n_s32(0);
+			for(j=0; j<count; j+=2) {
+				int16x8_t a = vld1q_s16(buf_arr[j] + i);
+				int32x4_t prod_lo;
+				int32x4_t prod_hi;
+				mpf_mixer_pair_gains_get(gain_arr,j,count,&gain1,&gain2);
+				prod_lo = vmull_n_s16(vget_low_s16(a),(int16_t)gain1);
+				prod_hi = vmull_n_s16(vget_high_s16(a),(int16_t)gain1);
+				if(gain2) {
+					int16x8_t b = vld1q_s16(buf_arr[j+1] + i);
+					prod_lo = vmlal_n_s16(prod_lo,vget_low_s16(b),(int16_t)gain2);
+					prod_hi = vmlal_n_s16(prod_hi,vget_high_s16(b),(int16_t)gain2);
+				}
+				sum_lo = vaddq_s32(sum_lo,vshlq_s32(prod_lo,shift));
+				sum_hi = vaddq_s32(sum_hi,vshlq_s32(prod_hi,shift));
+			}
+			vst1q_s16(mix_buf + i,vcombine_s16(vqmovn_s32(sum_lo),vqmovn_s32(sum_hi)));
+		}
+	}
+#endif
+	mpf_samples_mix_scalar(mix_buf,buf_arr,gain_arr,count,i,samples);
 }
 
 static apt_bool_t mpf_mixer_process(mpf_object_t *object)
 {
 	apr_size_t i;
+	apr_size_t count = 0;
+	mpf_frame_t *frame;
 	mpf_audio_stream_t *source;
 	mpf_mixer_t *mixer = (mpf_mixer_t*) object;
 
 	mixer->mix_frame.type = MEDIA_FRAME_TYPE_NONE;
 	mixer->mix_frame.marker = MPF_MARKER_NONE;
-	memset(mixer->mix_frame.codec_frame.buffer,0,mixer->mix_frame.codec_frame.size);
 	for(i=0; i<mixer->source_count; i++) {
 		source = mixer->source_arr[i];
 		if(source) {
-			mixer->frame.type = MEDIA_FRAME_TYPE_NONE;
-			mixer->frame.marker = MPF_MARKER_NONE;
-			source->vtable->read_frame(source,&mixer->frame);
-			mpf_frames_mix(&mixer->mix_frame,&mixer->frame);
+			frame = &mixer->frame_arr[i];
+			frame->type = MEDIA_FRAME_TYPE_NONE;
+			frame->marker = MPF_MARKER_NONE;
+			source->vtable->read_frame(source,frame);
+			if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO &&
+				frame->codec_frame.size == mixer->mix_frame.codec_frame.size) {
+				mixer->mix_buf_arr[count] = frame->codec_frame.buffer;
+				mixer->mix_gain_arr[count] = mixer->gain_arr[i];
+				count++;
+			}
 		}
 	}
+
+	/* mix all the audio frames in a single pass */
+	mpf_mixer_samples_mix(
+		mixer->mix_frame.codec_frame.buffer,
+		mixer->mix_buf_arr,
+		mixer->mix_gain_arr,
+		count,
+		mixer->mix_frame.codec_frame.size / sizeof(apr_int16_t));
+	if(count) {
+		mixer->mix_frame.type |= MEDIA_FRAME_TYPE_AUDIO;
+	}
+	object->active = count ? TRUE : FALSE;
 	mixer->sink->vtable->write_frame(mixer->sink,&mixer->mix_frame);
 	return TRUE;
 }
@@ -154,6 +328,7 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 	mixer = apr_palloc(pool,sizeof(mpf_mixer_t));
 	mixer->source_arr = NULL;
 	mixer->source_count = 0;
+	mixer->gain_arr = NULL;
 	mixer->sink = NULL;
 	mpf_object_init(&mixer->base,name);
 	mixer->base.process = mpf_mixer_process;
@@ -209,9 +384,27 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 
 	descriptor = sink->tx_descriptor;
 	frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count,frame_duration);
-	mixer->frame.codec_frame.size = frame_size;
-	mixer->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	mixer->frame_arr = apr_pcalloc(pool,sizeof(mpf_frame_t) * source_count);
+	mixer->gain_arr = apr_palloc(pool,sizeof(apr_int16_t) * source_count);
+	mixer->mix_buf_arr = apr_palloc(pool,sizeof(const apr_int16_t*) * source_count);
+	mixer->mix_gain_arr = apr_palloc(pool,sizeof(apr_int16_t) * source_count);
+	for(i=0; i<source_count; i++) {
+		mixer->frame_arr[i].codec_frame.size = frame_size;
+		mixer->frame_arr[i].codec_frame.buffer = apr_palloc(pool,frame_size);
+		mixer->gain_arr[i] = MPF_MIXER_GAIN_UNITY;
+	}
 	mixer->mix_frame.codec_frame.size = frame_size;
 	mixer->mix_frame.codec_frame.buffer = apr_palloc(pool,frame_size);
 	return &mixer->base;
 }
+
+MPF_DECLARE(apt_bool_t) mpf_mixer_source_gain_set(mpf_object_t *object, apr_size_t index, apr_int16_t gain)
+{
+	mpf_mixer_t *mixer = (mpf_mixer_t*) object;
+	if(!mixer || index >= mixer->source_count || gain < 0) {
+		return FALSE;
+	}
+
+	mixer->gain_arr[index] = gain;
+	return TRUE;
+}
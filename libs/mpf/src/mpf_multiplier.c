@@ -47,6 +47,7 @@ static apt_bool_t mpf_multiplier_process(mpf_object_t *object)
 	multiplier->frame.type = MEDIA_FRAME_TYPE_NONE;
 	multiplier->frame.marker = MPF_MARKER_NONE;
 	multiplier->source->vtable->read_frame(multiplier->source,&multiplier->frame);
+	object->active = multiplier->frame.type != MEDIA_FRAME_TYPE_NONE ? TRUE : FALSE;
 	
 	if((multiplier->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
 		memset(	multiplier->frame.codec_frame.buffer,
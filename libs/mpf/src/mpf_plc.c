@@ -0,0 +1,306 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <float.h>
+#include <math.h>
+#include "mpf_plc.h"
+
+/** Min pitch period in msec (200 Hz) */
+#define PLC_PITCH_MIN          5
+/** Max pitch period in msec (66.7 Hz) */
+#define PLC_PITCH_MAX          15
+/** Length of the window used to estimate pitch in msec */
+#define PLC_CORR_LENGTH        20
+/** Duration of concealment not attenuated yet in msec */
+#define PLC_ATTENUATION_DELAY  10
+/** Increment of the overlap-add at the end of concealment per every 10 msec lost */
+#define PLC_OLA_INCREMENT      4
+/** Max length of the overlap-add at the end of concealment in msec */
+#define PLC_OLA_MAX_LENGTH     10
+
+/** Packet loss concealment */
+struct mpf_plc_t {
+	/* number of samples in a frame */
+	apr_size_t   frame_samples;
+	/* number of samples in a msec */
+	apr_size_t   ms_samples;
+	/* min pitch period in samples */
+	apr_size_t   pitch_min;
+	/* max pitch period in samples */
+	apr_size_t   pitch_max;
+	/* step of the coarse pitch search in samples */
+	apr_size_t   pitch_step;
+	/* length of the window used to estimate pitch in samples */
+	apr_size_t   corr_length;
+
+	/* the last (received or synthesized) samples */
+	apr_int16_t *history;
+	/* length of the history in samples */
+	apr_size_t   history_length;
+
+	/* the pitch period repeated in place of lost samples */
+	float       *pitch_buf;
+	/* pitch period in samples */
+	apr_size_t   pitch;
+	/* current position in the pitch period */
+	apr_size_t   pitch_offset;
+
+	/* number of samples concealed in a row */
+	apr_size_t   lost_samples;
+	/* max number of samples to conceal, the output is silent afterwards */
+	apr_size_t   max_lost_samples;
+};
+
+
+MPF_DECLARE(mpf_plc_t*) mpf_plc_create(apr_uint32_t sampling_rate, apr_size_t frame_samples, apr_pool_t *pool)
+{
+	mpf_plc_t *plc = apr_palloc(pool,sizeof(mpf_plc_t));
+	plc->frame_samples = frame_samples;
+	plc->ms_samples = sampling_rate / 1000;
+	if(!plc->ms_samples) {
+		plc->ms_samples = 8;
+	}
+	plc->pitch_min = PLC_PITCH_MIN * plc->ms_samples;
+	plc->pitch_max = PLC_PITCH_MAX * plc->ms_samples;
+	/* search every 4th lag at 16 kHz, every 2nd one at 8 kHz */
+	plc->pitch_step = plc->ms_samples / 4;
+	if(!plc->pitch_step) {
+		plc->pitch_step = 1;
+	}
+	plc->corr_length = PLC_CORR_LENGTH * plc->ms_samples;
+
+	/* the history must hold two pitch periods for the overlap-add at the start of concealment */
+	plc->history_length = plc->corr_length + plc->pitch_max;
+	plc->history = apr_palloc(pool,sizeof(apr_int16_t) * plc->history_length);
+	plc->pitch_buf = apr_palloc(pool,sizeof(float) * plc->pitch_max);
+	plc->max_lost_samples = MPF_PLC_MAX_DURATION * plc->ms_samples;
+
+	mpf_plc_reset(plc);
+	return plc;
+}
+
+MPF_DECLARE(void) mpf_plc_reset(mpf_plc_t *plc)
+{
+	memset(plc->history,0,sizeof(apr_int16_t) * plc->history_length);
+	plc->pitch = plc->pitch_max;
+	plc->pitch_offset = 0;
+	plc->lost_samples = 0;
+}
+
+static void mpf_plc_history_save(mpf_plc_t *plc, const apr_int16_t *samples)
+{
+	if(plc->frame_samples >= plc->history_length) {
+		memcpy(
+			plc->history,
+			samples + plc->frame_samples - plc->history_length,
+			sizeof(apr_int16_t) * plc->history_length);
+		return;
+	}
+
+	memmove(
+		plc->history,
+		plc->history + plc->frame_samples,
+		sizeof(apr_int16_t) * (plc->history_length - plc->frame_samples));
+	memcpy(
+		plc->history + plc->history_length - plc->frame_samples,
+		samples,
+		sizeof(apr_int16_t) * plc->frame_samples);
+}
+
+/** Score the similarity of the segments, favoring positive correlation */
+static float mpf_plc_corr_score(const apr_int16_t *ref, const apr_int16_t *seg, apr_size_t length, apr_size_t step)
+{
+	float corr = 0;
+	float energy = 0;
+	apr_size_t i;
+	for(i=0; i<length; i+=step) {
+		corr += (float)ref[i] * seg[i];
+		energy += (float)seg[i] * seg[i];
+	}
+	if(energy <= 0) {
+		return 0;
+	}
+	return corr * (float)fabs(corr) / energy;
+}
+
+/** Estimate pitch period by the max of normalized autocorrelation of the history */
+static apr_size_t mpf_plc_pitch_find(const mpf_plc_t *plc)
+{
+	const apr_int16_t *ref = plc->history + plc->history_length - plc->corr_length;
+	apr_size_t lag;
+	apr_size_t min_lag;
+	apr_size_t max_lag;
+	apr_size_t pitch = plc->pitch_max;
+	float score;
+	float max_score = -FLT_MAX;
+
+	/* coarse search over the decimated signal */
+	for(lag = plc->pitch_min; lag <= plc->pitch_max; lag += plc->pitch_step) {
+		score = mpf_plc_corr_score(ref,ref - lag,plc->corr_length,plc->pitch_step);
+		if(score > max_score) {
+			max_score = score;
+			pitch = lag;
+		}
+	}
+
+	if(plc->pitch_step == 1) {
+		return pitch;
+	}
+
+	/* fine search around the coarse estimate */
+	min_lag = pitch - plc->pitch_step + 1;
+	if(min_lag < plc->pitch_min) {
+		min_lag = plc->pitch_min;
+	}
+	max_lag = pitch + plc->pitch_step - 1;
+	if(max_lag > plc->pitch_max) {
+		max_lag = plc->pitch_max;
+	}
+	max_score = -FLT_MAX;
+	for(lag = min_lag; lag <= max_lag; lag++) {
+		score = mpf_plc_corr_score(ref,ref - lag,plc->corr_length,1);
+		if(score > max_score) {
+			max_score = score;
+			pitch = lag;
+		}
+	}
+	return pitch;
+}
+
+/** Take the last pitch period of the history to repeat in place of lost samples */
+static void mpf_plc_pitch_buf_init(mpf_plc_t *plc)
+{
+	const apr_int16_t *period;
+	const apr_int16_t *prev_period;
+	apr_size_t overlap;
+	apr_size_t i;
+	float weight;
+	float step;
+
+	plc->pitch = mpf_plc_pitch_find(plc);
+	plc->pitch_offset = 0;
+	period = plc->history + plc->history_length - plc->pitch;
+	prev_period = period - plc->pitch;
+	overlap = plc->pitch / 4;
+
+	for(i=0; i<plc->pitch - overlap; i++) {
+		plc->pitch_buf[i] = period[i];
+	}
+	/* cross-fade the end of the period into the preceding one,
+	so that the period smoothly wraps around when repeated */
+	step = 1.0f / (overlap + 1);
+	weight = step;
+	for(; i<plc->pitch; i++) {
+		plc->pitch_buf[i] = period[i] * (1.0f - weight) + prev_period[i] * weight;
+		weight += step;
+	}
+}
+
+/** Get gain of synthesized signal: no attenuation during the first 10 msec, fade out by the max duration afterwards */
+static APR_INLINE float mpf_plc_gain_get(const mpf_plc_t *plc)
+{
+	apr_size_t delay = PLC_ATTENUATION_DELAY * plc->ms_samples;
+	if(plc->lost_samples <= delay) {
+		return 1.0f;
+	}
+	if(plc->lost_samples >= plc->max_lost_samples) {
+		return 0.0f;
+	}
+	return 1.0f - (float)(plc->lost_samples - delay) / (plc->max_lost_samples - delay);
+}
+
+static APR_INLINE float mpf_plc_sample_synthesize(mpf_plc_t *plc)
+{
+	float sample = plc->pitch_buf[plc->pitch_offset] * mpf_plc_gain_get(plc);
+	if(++plc->pitch_offset == plc->pitch) {
+		plc->pitch_offset = 0;
+	}
+	plc->lost_samples++;
+	return sample;
+}
+
+static APR_INLINE apr_int16_t mpf_plc_sample_saturate(float sample)
+{
+	if(sample > 32767.0f) {
+		return 32767;
+	}
+	if(sample < -32768.0f) {
+		return -32768;
+	}
+	return (apr_int16_t)sample;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_plc_good_frame(mpf_plc_t *plc, apr_int16_t *samples)
+{
+	apt_bool_t modified = FALSE;
+	if(plc->lost_samples) {
+		/* cross-fade the continuation of the synthesized signal into the received one,
+		the longer the loss, the longer the overlap-add */
+		apr_size_t ten_ms = 10 * plc->ms_samples;
+		apr_size_t length = plc->pitch / 4 +
+			(plc->lost_samples - 1) / ten_ms * PLC_OLA_INCREMENT * plc->ms_samples;
+		apr_size_t i;
+		float weight;
+		if(length > PLC_OLA_MAX_LENGTH * plc->ms_samples) {
+			length = PLC_OLA_MAX_LENGTH * plc->ms_samples;
+		}
+		if(length > plc->frame_samples) {
+			length = plc->frame_samples;
+		}
+
+		for(i=0; i<length; i++) {
+			weight = (float)(i + 1) / (length + 1);
+			samples[i] = mpf_plc_sample_saturate(
+				mpf_plc_sample_synthesize(plc) * (1.0f - weight) + samples[i] * weight);
+		}
+		plc->lost_samples = 0;
+		modified = TRUE;
+	}
+
+	mpf_plc_history_save(plc,samples);
+	return modified;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_plc_lost_frame(mpf_plc_t *plc, apr_int16_t *samples)
+{
+	apr_size_t i;
+	if(plc->lost_samples >= plc->max_lost_samples) {
+		/* the synthesized signal has faded out */
+		memset(samples,0,sizeof(apr_int16_t) * plc->frame_samples);
+		mpf_plc_history_save(plc,samples);
+		return FALSE;
+	}
+
+	if(!plc->lost_samples) {
+		/* start of loss */
+		mpf_plc_pitch_buf_init(plc);
+	}
+
+	for(i=0; i<plc->frame_samples; i++) {
+		samples[i] = mpf_plc_sample_saturate(mpf_plc_sample_synthesize(plc));
+	}
+	mpf_plc_history_save(plc,samples);
+	return TRUE;
+}
+
+MPF_DECLARE(void) mpf_plc_skipped_frame(mpf_plc_t *plc)
+{
+	if(!plc->lost_samples) {
+		/* the continuation of the history to be overlap-added with the next received frame */
+		mpf_plc_pitch_buf_init(plc);
+		plc->lost_samples = 1;
+	}
+}
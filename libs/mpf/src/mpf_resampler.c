@@ -14,13 +14,283 @@
  * limitations under the License.
  */
 
+#include <math.h>
 #include "mpf_resampler.h"
 #include "apt_log.h"
 
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Number of filter taps per polyphase branch (kept a multiple of 8 to suit SIMD kernels) */
+#define RESAMPLER_TAPS_PER_PHASE 16
+/** Passband edge relative to the Nyquist frequency of the lower sampling rate */
+#define RESAMPLER_ROLLOFF        0.9
+
+typedef struct mpf_resampler_t mpf_resampler_t;
+
+/** Polyphase FIR resampler derived from audio stream */
+struct mpf_resampler_t {
+	/** Audio stream base */
+	mpf_audio_stream_t *base;
+	/** Audio stream source */
+	mpf_audio_stream_t *source;
+
+	/** Interpolation factor */
+	apr_size_t          up;
+	/** Decimation factor */
+	apr_size_t          down;
+	/** Number of taps per polyphase branch */
+	apr_size_t          taps;
+	/** Polyphase coefficients in Q15 [up][taps], reversed in time */
+	apr_int16_t        *coefs;
+	/** Last (taps-1) input samples followed by the current input frame */
+	apr_int16_t        *history;
+	/** Number of input samples per frame */
+	apr_size_t          in_samples;
+	/** Number of output samples per frame */
+	apr_size_t          out_samples;
+	/** Media frame used to read data from source (points into the history) */
+	mpf_frame_t         frame_in;
+};
+
+static apr_size_t mpf_resampler_gcd(apr_size_t a, apr_size_t b)
+{
+	apr_size_t r;
+	while(b) {
+		r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+/** Design windowed-sinc prototype filter and split it into polyphase branches */
+static void mpf_resampler_filter_design(mpf_resampler_t *resampler, apr_uint16_t in_rate, apr_uint16_t out_rate, apr_pool_t *pool)
+{
+	apr_size_t n,k,p;
+	apr_size_t length = resampler->up * resampler->taps;
+	double *h = apr_palloc(pool,length * sizeof(double));
+	double center = (length - 1) / 2.0;
+	/* cutoff frequency normalized to the interpolated sampling rate */
+	double cutoff = RESAMPLER_ROLLOFF * (in_rate < out_rate ? in_rate : out_rate) /
+		(2.0 * in_rate * resampler->up);
+	double x, w, sum, value;
+
+	for(n=0; n<length; n++) {
+		x = n - center;
+		/* Blackman window */
+		w = 0.42 - 0.5 * cos(2 * M_PI * n / (length - 1)) + 0.08 * cos(4 * M_PI * n / (length - 1));
+		if(x == 0) {
+			h[n] = 2 * cutoff * w;
+		}
+		else {
+			h[n] = sin(2 * M_PI * cutoff * x) / (M_PI * x) * w;
+		}
+	}
+
+	for(p=0; p<resampler->up; p++) {
+		/* normalize each branch to unity gain at DC */
+		sum = 0;
+		for(k=0; k<resampler->taps; k++) {
+			sum += h[p + k * resampler->up];
+		}
+
+		for(k=0; k<resampler->taps; k++) {
+			value = floor(h[p + k * resampler->up] / sum * 32768 + 0.5);
+			if(value > 32767) value = 32767;
+			else if(value < -32768) value = -32768;
+			/* store reversed, so that the kernel walks both arrays forward */
+			resampler->coefs[p * resampler->taps + resampler->taps - 1 - k] = (apr_int16_t)value;
+		}
+	}
+}
+
+/** Q15 dot product, written as a plain loop over contiguous arrays to be auto-vectorized */
+static APR_INLINE apr_int16_t mpf_resampler_dot_product(const apr_int16_t *coefs, const apr_int16_t *samples, apr_size_t count)
+{
+	apr_size_t k;
+	apr_int32_t sum = 1 << 14;
+	for(k=0; k<count; k++) {
+		sum += (apr_int32_t)coefs[k] * samples[k];
+	}
+	sum >>= 15;
+	if(sum > 32767) {
+		return 32767;
+	}
+	if(sum < -32768) {
+		return -32768;
+	}
+	return (apr_int16_t)sum;
+}
+
+static apt_bool_t mpf_resampler_destroy(mpf_audio_stream_t *stream)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	return mpf_audio_stream_destroy(resampler->source);
+}
+
+static apt_bool_t mpf_resampler_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	memset(resampler->history,0,(resampler->taps - 1) * sizeof(apr_int16_t));
+	return mpf_audio_stream_rx_open(resampler->source,codec);
+}
+
+static apt_bool_t mpf_resampler_close(mpf_audio_stream_t *stream)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	return mpf_audio_stream_rx_close(resampler->source);
+}
+
+static apt_bool_t mpf_resampler_process(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	mpf_resampler_t *resampler = stream->obj;
+	apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t n, t, i;
+	apr_size_t phase;
+
+	resampler->frame_in.type = MEDIA_FRAME_TYPE_NONE;
+	resampler->frame_in.marker = MPF_MARKER_NONE;
+	if(mpf_audio_stream_frame_read(resampler->source,&resampler->frame_in) != TRUE) {
+		return FALSE;
+	}
+
+	frame->type = resampler->frame_in.type;
+	frame->marker = resampler->frame_in.marker;
+	if((frame->type & MEDIA_FRAME_TYPE_EVENT) == MEDIA_FRAME_TYPE_EVENT) {
+		frame->event_frame = resampler->frame_in.event_frame;
+	}
+
+	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+		for(n=0, t=0; n<resampler->out_samples; n++, t+=resampler->down) {
+			i = t / resampler->up;
+			phase = t - i * resampler->up;
+			/* input sample i is stored at history[taps-1+i], the window ends there */
+			samples[n] = mpf_resampler_dot_product(
+							&resampler->coefs[phase * resampler->taps],
+							&resampler->history[i],
+							resampler->taps);
+		}
+	}
+	else {
+		/* keep the filter state continuous over gaps */
+		memset(resampler->frame_in.codec_frame.buffer,0,resampler->frame_in.codec_frame.size);
+	}
+
+	/* retain the tail of the input for the next frame */
+	memmove(resampler->history,
+		resampler->history + resampler->in_samples,
+		(resampler->taps - 1) * sizeof(apr_int16_t));
+	return TRUE;
+}
+
+static void mpf_resampler_trace(mpf_audio_stream_t *stream, mpf_stream_direction_e direction, apt_text_stream_t *output)
+{
+	apr_size_t offset;
+	mpf_codec_descriptor_t *descriptor;
+	mpf_resampler_t *resampler = stream->obj;
+
+	mpf_audio_stream_trace(resampler->source,direction,output);
+
+	descriptor = resampler->base->rx_descriptor;
+	if(descriptor) {
+		offset = output->pos - output->text.buf;
+		output->pos += apr_snprintf(output->pos, output->text.length - offset,
+			"->Resampler->[%s/%d/%d]",
+			descriptor->name.buf,
+			descriptor->sampling_rate,
+			descriptor->channel_count);
+	}
+}
+
+static const mpf_audio_stream_vtable_t vtable = {
+	mpf_resampler_destroy,
+	mpf_resampler_open,
+	mpf_resampler_close,
+	mpf_resampler_process,
+	NULL,
+	NULL,
+	NULL,
+	mpf_resampler_trace
+};
+
 MPF_DECLARE(mpf_audio_stream_t*) mpf_resampler_create(mpf_audio_stream_t *source, mpf_audio_stream_t *sink, apr_pool_t *pool)
 {
-	apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,
-		"Currently resampling is not supported. "
-		"Try to configure and use the same sampling rate on both ends");
-	return NULL;
+	mpf_resampler_t *resampler;
+	mpf_stream_capabilities_t *capabilities;
+	mpf_codec_descriptor_t *rx_descriptor;
+	mpf_codec_descriptor_t *tx_descriptor;
+	apr_size_t gcd;
+	if(!source || !sink) {
+		return NULL;
+	}
+
+	rx_descriptor = source->rx_descriptor;
+	tx_descriptor = sink->tx_descriptor;
+	if(!rx_descriptor || !tx_descriptor) {
+		return NULL;
+	}
+
+	if(mpf_codec_lpcm_descriptor_match(rx_descriptor) == FALSE ||
+		mpf_codec_lpcm_descriptor_match(tx_descriptor) == FALSE ||
+		rx_descriptor->channel_count != 1 || tx_descriptor->channel_count != 1) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resampler: only mono linear PCM is supported");
+		return NULL;
+	}
+
+	if(mpf_sample_rate_mask_get(rx_descriptor->sampling_rate) == MPF_SAMPLE_RATE_NONE ||
+		mpf_sample_rate_mask_get(tx_descriptor->sampling_rate) == MPF_SAMPLE_RATE_NONE) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resampler: unsupported sampling rate %d->%d",
+			rx_descriptor->sampling_rate,
+			tx_descriptor->sampling_rate);
+		return NULL;
+	}
+
+	resampler = apr_palloc(pool,sizeof(mpf_resampler_t));
+	capabilities = mpf_stream_capabilities_create(STREAM_DIRECTION_RECEIVE,pool);
+	resampler->base = mpf_audio_stream_create(resampler,&vtable,capabilities,pool);
+	if(!resampler->base) {
+		return NULL;
+	}
+	resampler->base->rx_descriptor = mpf_codec_lpcm_descriptor_create(
+		tx_descriptor->sampling_rate,
+		rx_descriptor->channel_count,
+		rx_descriptor->frame_duration,
+		pool);
+	resampler->base->rx_event_descriptor = source->rx_event_descriptor;
+	resampler->source = source;
+
+	gcd = mpf_resampler_gcd(rx_descriptor->sampling_rate,tx_descriptor->sampling_rate);
+	resampler->up = tx_descriptor->sampling_rate / gcd;
+	resampler->down = rx_descriptor->sampling_rate / gcd;
+	/* widen the filter proportionally to the decimation factor to retain the transition band */
+	resampler->taps = RESAMPLER_TAPS_PER_PHASE;
+	if(resampler->down > resampler->up) {
+		resampler->taps *= (resampler->down + resampler->up - 1) / resampler->up;
+	}
+	resampler->coefs = apr_palloc(pool,resampler->up * resampler->taps * sizeof(apr_int16_t));
+	mpf_resampler_filter_design(resampler,rx_descriptor->sampling_rate,tx_descriptor->sampling_rate,pool);
+
+	resampler->in_samples = mpf_codec_frame_samples_calculate(
+		rx_descriptor->sampling_rate,
+		rx_descriptor->channel_count,
+		rx_descriptor->frame_duration);
+	resampler->out_samples = mpf_codec_frame_samples_calculate(
+		tx_descriptor->sampling_rate,
+		rx_descriptor->channel_count,
+		rx_descriptor->frame_duration);
+	resampler->history = apr_pcalloc(pool,(resampler->taps - 1 + resampler->in_samples) * sizeof(apr_int16_t));
+
+	/* read source frames directly past the retained history */
+	resampler->frame_in.codec_frame.size = resampler->in_samples * sizeof(apr_int16_t);
+	resampler->frame_in.codec_frame.buffer = resampler->history + resampler->taps - 1;
+
+	apt_log(MPF_LOG_MARK,APT_PRIO_DEBUG,"Create Resampler %d->%d [up:%"APR_SIZE_T_FMT" down:%"APR_SIZE_T_FMT" taps:%"APR_SIZE_T_FMT"]",
+		rx_descriptor->sampling_rate,
+		tx_descriptor->sampling_rate,
+		resampler->up,
+		resampler->down,
+		resampler->taps);
+	return resampler->base;
 }
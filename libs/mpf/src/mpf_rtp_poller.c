@@ -0,0 +1,224 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* recvmmsg() */
+#endif
+
+#include <apr_poll.h>
+#include <apr_ring.h>
+#include <apr_portable.h>
+#include <apr_atomic.h>
+#include "mpf_rtp_poller.h"
+#include "apt_log.h"
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#if defined(MSG_WAITFORONE)
+#define MPF_RTP_POLLER_RECVMMSG
+#endif
+#endif
+
+/** Max size of RTP packet */
+#define MAX_RTP_PACKET_SIZE  1500
+/** Max number of packets received from a socket per tick */
+#define MAX_RTP_PACKET_COUNT 5
+
+/** RTP socket registered in the poller */
+struct mpf_rtp_poller_socket_t {
+	/** Ring entry */
+	APR_RING_ENTRY(mpf_rtp_poller_socket_t) link;
+	/** Poll descriptor (owned by the entry, since the pollset doesn't copy it) */
+	apr_pollfd_t             descriptor;
+	/** Handler of received packets */
+	mpf_rtp_poller_handler_f handler;
+	/** External object */
+	void                    *obj;
+};
+
+/** RTP poller */
+struct mpf_rtp_poller_t {
+	/** APR pollset */
+	apr_pollset_t         *pollset;
+	/** Ring of released sockets available for reuse */
+	APR_RING_HEAD(mpf_rtp_poller_socket_head_t, mpf_rtp_poller_socket_t) free_sockets;
+	/** Statistics */
+	mpf_rtp_poller_stat_t  stat;
+	/** Receive buffers */
+	char                   buffers[MAX_RTP_PACKET_COUNT][MAX_RTP_PACKET_SIZE];
+#ifdef MPF_RTP_POLLER_RECVMMSG
+	/** Scatter/gather arrays of the receive buffers */
+	struct iovec           iov[MAX_RTP_PACKET_COUNT];
+	/** Message headers of the receive buffers */
+	struct mmsghdr         msgs[MAX_RTP_PACKET_COUNT];
+#endif
+	/** Pool to allocate memory from */
+	apr_pool_t            *pool;
+};
+
+
+MPF_DECLARE(mpf_rtp_poller_t*) mpf_rtp_poller_create(apr_uint32_t size, apr_pool_t *pool)
+{
+	mpf_rtp_poller_t *poller = apr_palloc(pool,sizeof(mpf_rtp_poller_t));
+	poller->pool = pool;
+	if(apr_pollset_create(&poller->pollset,size,pool,APR_POLLSET_NOCOPY) != APR_SUCCESS) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create RTP Pollset [%u]",size);
+		return NULL;
+	}
+	APR_RING_INIT(&poller->free_sockets, mpf_rtp_poller_socket_t, link);
+	memset(&poller->stat,0,sizeof(poller->stat));
+
+#ifdef MPF_RTP_POLLER_RECVMMSG
+	{
+		int i;
+		memset(poller->msgs,0,sizeof(poller->msgs));
+		for(i=0; i<MAX_RTP_PACKET_COUNT; i++) {
+			poller->iov[i].iov_base = poller->buffers[i];
+			poller->iov[i].iov_len = MAX_RTP_PACKET_SIZE;
+			poller->msgs[i].msg_hdr.msg_iov = &poller->iov[i];
+			poller->msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+	}
+#endif
+	return poller;
+}
+
+MPF_DECLARE(void) mpf_rtp_poller_destroy(mpf_rtp_poller_t *poller)
+{
+	apr_pollset_destroy(poller->pollset);
+	poller->pollset = NULL;
+}
+
+MPF_DECLARE(mpf_rtp_poller_socket_t*) mpf_rtp_poller_socket_add(
+											mpf_rtp_poller_t *poller,
+											apr_socket_t *socket,
+											mpf_rtp_poller_handler_f handler,
+											void *obj)
+{
+	mpf_rtp_poller_socket_t *poller_socket;
+	if(!socket || !handler) {
+		return NULL;
+	}
+
+	if(!APR_RING_EMPTY(&poller->free_sockets, mpf_rtp_poller_socket_t, link)) {
+		poller_socket = APR_RING_FIRST(&poller->free_sockets);
+		APR_RING_REMOVE(poller_socket, link);
+	}
+	else {
+		poller_socket = apr_palloc(poller->pool,sizeof(mpf_rtp_poller_socket_t));
+	}
+
+	memset(&poller_socket->descriptor,0,sizeof(apr_pollfd_t));
+	poller_socket->descriptor.desc_type = APR_POLL_SOCKET;
+	poller_socket->descriptor.reqevents = APR_POLLIN;
+	poller_socket->descriptor.desc.s = socket;
+	poller_socket->descriptor.client_data = poller_socket;
+	poller_socket->handler = handler;
+	poller_socket->obj = obj;
+
+	if(apr_pollset_add(poller->pollset,&poller_socket->descriptor) != APR_SUCCESS) {
+		APR_RING_INSERT_TAIL(&poller->free_sockets, poller_socket, mpf_rtp_poller_socket_t, link);
+		return NULL;
+	}
+	poller->stat.sockets++;
+	return poller_socket;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_socket_remove(mpf_rtp_poller_t *poller, mpf_rtp_poller_socket_t *poller_socket)
+{
+	if(apr_pollset_remove(poller->pollset,&poller_socket->descriptor) != APR_SUCCESS) {
+		return FALSE;
+	}
+	poller->stat.sockets--;
+	APR_RING_INSERT_TAIL(&poller->free_sockets, poller_socket, mpf_rtp_poller_socket_t, link);
+	return TRUE;
+}
+
+/** Receive pending packets from the socket and return the number of system calls made */
+static apr_uint32_t mpf_rtp_poller_socket_receive(mpf_rtp_poller_t *poller, mpf_rtp_poller_socket_t *poller_socket)
+{
+	apr_uint32_t syscalls = 0;
+#ifdef MPF_RTP_POLLER_RECVMMSG
+	int i;
+	int count;
+	apr_os_sock_t fd;
+	if(apr_os_sock_get(&fd,poller_socket->descriptor.desc.s) != APR_SUCCESS) {
+		return 0;
+	}
+
+	/* the whole batch is received with a single system call */
+	count = recvmmsg(fd,poller->msgs,MAX_RTP_PACKET_COUNT,MSG_DONTWAIT,NULL);
+	syscalls++;
+	for(i=0; i<count; i++) {
+		poller_socket->handler(poller_socket->obj,poller->buffers[i],poller->msgs[i].msg_len);
+	}
+	if(count > 0) {
+		poller->stat.packets += count;
+	}
+#else
+	apr_size_t size = MAX_RTP_PACKET_SIZE;
+	apr_size_t count = 0;
+	while(count < MAX_RTP_PACKET_COUNT) {
+		syscalls++;
+		if(apr_socket_recv(poller_socket->descriptor.desc.s,poller->buffers[count],&size) != APR_SUCCESS) {
+			break;
+		}
+		poller_socket->handler(poller_socket->obj,poller->buffers[count],size);
+
+		size = MAX_RTP_PACKET_SIZE;
+		count++;
+	}
+	poller->stat.packets += (apr_uint32_t)count;
+#endif
+	return syscalls;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_rtp_poller_process(mpf_rtp_poller_t *poller)
+{
+	apr_int32_t i;
+	apr_int32_t num = 0;
+	const apr_pollfd_t *descriptors;
+	apr_uint32_t syscalls = 0;
+
+	if(poller->stat.sockets) {
+		/* query readable sockets without blocking */
+		syscalls++;
+		if(apr_pollset_poll(poller->pollset,0,&num,&descriptors) == APR_SUCCESS) {
+			for(i=0; i<num; i++) {
+				syscalls += mpf_rtp_poller_socket_receive(poller,descriptors[i].client_data);
+			}
+		}
+	}
+
+	poller->stat.ticks++;
+	poller->stat.syscalls += syscalls;
+	poller->stat.last_syscalls = syscalls;
+	if(syscalls > poller->stat.max_syscalls) {
+		poller->stat.max_syscalls = syscalls;
+	}
+	return TRUE;
+}
+
+MPF_DECLARE(void) mpf_rtp_poller_stat_get(const mpf_rtp_poller_t *poller, mpf_rtp_poller_stat_t *stat)
+{
+	/* the counters are updated by the worker thread, while they may be read from any other one */
+	stat->ticks = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.ticks);
+	stat->syscalls = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.syscalls);
+	stat->last_syscalls = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.last_syscalls);
+	stat->max_syscalls = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.max_syscalls);
+	stat->packets = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.packets);
+	stat->sockets = apr_atomic_read32((volatile apr_uint32_t*)&poller->stat.sockets);
+}
@@ -69,6 +69,8 @@ struct mpf_rtp_stream_t {
 	apr_sockaddr_t             *rtcp_l_sockaddr;
 	apr_sockaddr_t             *rtcp_r_sockaddr;
 
+	mpf_rtp_poller_socket_t    *rtp_poller_socket;
+
 	apt_timer_t                *rtcp_tx_timer;
 	apt_timer_t                *rtcp_rx_timer;
 	
@@ -79,6 +81,7 @@ static apt_bool_t mpf_rtp_stream_destroy(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec);
 static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_stream_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame);
+static apt_bool_t mpf_rtp_stream_view_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame);
 static apt_bool_t mpf_rtp_tx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec);
 static apt_bool_t mpf_rtp_tx_stream_close(mpf_audio_stream_t *stream);
 static apt_bool_t mpf_rtp_stream_transmit(mpf_audio_stream_t *stream, const mpf_frame_t *frame);
@@ -91,13 +94,16 @@ static const mpf_audio_stream_vtable_t vtable = {
 	mpf_rtp_tx_stream_open,
 	mpf_rtp_tx_stream_close,
 	mpf_rtp_stream_transmit,
-	NULL /* mpf_rtp_stream_trace */
+	NULL  /* mpf_rtp_stream_trace */
 };
 
 static apt_bool_t mpf_rtp_socket_pair_create(mpf_rtp_stream_t *stream, mpf_rtp_media_descriptor_t *local_media, apt_bool_t bind);
 static apt_bool_t mpf_rtp_socket_pair_bind(mpf_rtp_stream_t *stream, mpf_rtp_media_descriptor_t *local_media);
 static void mpf_rtp_socket_pair_close(mpf_rtp_stream_t *stream);
 
+static void rtp_rx_packet_handler(void *obj, void *buffer, apr_size_t size);
+static void rtp_rx_poller_socket_remove(mpf_rtp_stream_t *rtp_stream);
+
 static apt_bool_t mpf_rtcp_report_send(mpf_rtp_stream_t *stream);
 static apt_bool_t mpf_rtcp_bye_send(mpf_rtp_stream_t *stream, apt_str_t *reason);
 static void mpf_rtcp_tx_timer_proc(apt_timer_t *timer, void *obj);
@@ -115,6 +121,7 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_rtp_stream_create(mpf_termination_t *termin
 
 	audio_stream->direction = STREAM_DIRECTION_NONE;
 	audio_stream->termination = termination;
+	audio_stream->read_frame_view = mpf_rtp_stream_view_receive;
 
 	rtp_stream->base = audio_stream;
 	rtp_stream->pool = pool;
@@ -128,6 +135,7 @@ MPF_DECLARE(mpf_audio_stream_t*) mpf_rtp_stream_create(mpf_termination_t *termin
 	rtp_stream->rtp_r_sockaddr = NULL;
 	rtp_stream->rtcp_l_sockaddr = NULL;
 	rtp_stream->rtcp_r_sockaddr = NULL;
+	rtp_stream->rtp_poller_socket = NULL;
 	rtp_stream->rtcp_tx_timer = NULL;
 	rtp_stream->rtcp_rx_timer = NULL;
 	rtp_stream->state = MPF_MEDIA_DISABLED;
@@ -502,8 +510,18 @@ static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 						codec,
 						rtp_stream->pool);
 
+	if(stream->termination && stream->termination->rtp_poller) {
+		/* receive packets only once the socket becomes readable, 
+		otherwise fall back to polling the socket on every read */
+		rtp_stream->rtp_poller_socket = mpf_rtp_poller_socket_add(
+						stream->termination->rtp_poller,
+						rtp_stream->rtp_socket,
+						rtp_rx_packet_handler,
+						rtp_stream);
+	}
+
 	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,
-			"Open RTP Receiver %s:%hu <- %s:%hu playout [%u ms] bounds [%u - %u ms] adaptive [%d] skew detection [%d]",
+			"Open RTP Receiver %s:%hu <- %s:%hu playout [%u ms] bounds [%u - %u ms] adaptive [%d] skew detection [%d] plc [%d]",
 			rtp_stream->rtp_l_sockaddr->hostname,
 			rtp_stream->rtp_l_sockaddr->port,
 			rtp_stream->rtp_r_sockaddr->hostname,
@@ -512,7 +530,8 @@ static apt_bool_t mpf_rtp_rx_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 			jb_config->min_playout_delay,
 			jb_config->max_playout_delay,
 			jb_config->adaptive,
-			jb_config->time_skew_detection);
+			jb_config->time_skew_detection,
+			jb_config->plc);
 	return TRUE;
 }
 
@@ -521,6 +540,7 @@ static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream)
 	mpf_rtp_stream_t *rtp_stream = stream->obj;
 	rtp_receiver_t *receiver = &rtp_stream->receiver;
 
+	rtp_rx_poller_socket_remove(rtp_stream);
 	if(!rtp_stream->rtp_l_sockaddr || !rtp_stream->rtp_r_sockaddr) {
 		return FALSE;
 	}
@@ -534,7 +554,7 @@ static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream)
 		}
 	}
 
-	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Close RTP Receiver %s:%hu <- %s:%hu [r:%u l:%u j:%u p:%u d:%u i:%u]",
+	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Close RTP Receiver %s:%hu <- %s:%hu [r:%u l:%u j:%u p:%u d:%u i:%u c:%u]",
 			rtp_stream->rtp_l_sockaddr->hostname,
 			rtp_stream->rtp_l_sockaddr->port,
 			rtp_stream->rtp_r_sockaddr->hostname,
@@ -544,7 +564,8 @@ static apt_bool_t mpf_rtp_rx_stream_close(mpf_audio_stream_t *stream)
 			receiver->rr_stat.jitter,
 			mpf_jitter_buffer_playout_delay_get(receiver->jb),
 			receiver->stat.discarded_packets,
-			receiver->stat.ignored_packets);
+			receiver->stat.ignored_packets,
+			receiver->stat.concealed_frames);
 	mpf_jitter_buffer_destroy(receiver->jb);
 	return TRUE;
 }
@@ -872,12 +893,50 @@ static apt_bool_t rtp_rx_process(mpf_rtp_stream_t *rtp_stream)
 	return TRUE;
 }
 
+static void rtp_rx_packet_handler(void *obj, void *buffer, apr_size_t size)
+{
+	rtp_rx_packet_receive(obj,buffer,size);
+}
+
+static void rtp_rx_poller_socket_remove(mpf_rtp_stream_t *rtp_stream)
+{
+	if(rtp_stream->rtp_poller_socket) {
+		mpf_rtp_poller_socket_remove(rtp_stream->base->termination->rtp_poller,rtp_stream->rtp_poller_socket);
+		rtp_stream->rtp_poller_socket = NULL;
+	}
+}
+
+static APR_INLINE apt_bool_t mpf_rtp_stream_frame_receive(mpf_rtp_stream_t *rtp_stream, mpf_frame_t *frame, apt_bool_t view)
+{
+	apt_bool_t status;
+	if(!rtp_stream->rtp_poller_socket) {
+		/* packets are not delivered by the poller, receive them in place */
+		rtp_rx_process(rtp_stream);
+	}
+
+	if(view == TRUE) {
+		status = mpf_jitter_buffer_view_read(rtp_stream->receiver.jb,frame);
+	}
+	else {
+		status = mpf_jitter_buffer_read(rtp_stream->receiver.jb,frame);
+	}
+	if(status == FALSE) {
+		return FALSE;
+	}
+	/* the counter of the jitter buffer is reset along with the receiver statistics on restart */
+	rtp_stream->receiver.stat.concealed_frames = mpf_jitter_buffer_concealed_frames_get(rtp_stream->receiver.jb);
+	return TRUE;
+}
+
 static apt_bool_t mpf_rtp_stream_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame)
 {
-	mpf_rtp_stream_t *rtp_stream = stream->obj;
-	rtp_rx_process(rtp_stream);
+	return mpf_rtp_stream_frame_receive(stream->obj,frame,FALSE);
+}
 
-	return mpf_jitter_buffer_read(rtp_stream->receiver.jb,frame);
+static apt_bool_t mpf_rtp_stream_view_receive(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	/* the frame refers to the slot of the jitter buffer, packets are written to on the next receive */
+	return mpf_rtp_stream_frame_receive(stream->obj,frame,TRUE);
 }
 
 
@@ -969,6 +1028,30 @@ static APR_INLINE void rtp_header_prepare(
 	header->ssrc = htonl(transmitter->sr_stat.ssrc);
 }
 
+static APR_INLINE apt_bool_t mpf_rtp_packet_send(mpf_rtp_stream_t *rtp_stream, const char *packet_data, apr_size_t *packet_size)
+{
+	mpf_termination_t *termination = rtp_stream->base->termination;
+	if(termination && termination->rtp_tx_queue) {
+		/* defer the packet to be sent in a batch at the end of the tick */
+		return mpf_rtp_tx_queue_push(
+					termination->rtp_tx_queue,
+					rtp_stream->rtp_socket,
+					rtp_stream->rtp_r_sockaddr,
+					packet_data,
+					*packet_size);
+	}
+
+	if(apr_socket_sendto(
+				rtp_stream->rtp_socket,
+				rtp_stream->rtp_r_sockaddr,
+				0,
+				packet_data,
+				packet_size) != APR_SUCCESS) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
 static APR_INLINE apt_bool_t mpf_rtp_data_send(mpf_rtp_stream_t *rtp_stream, rtp_transmitter_t *transmitter, const mpf_frame_t *frame)
 {
 	apt_bool_t status = TRUE;
@@ -997,12 +1080,7 @@ static APR_INLINE apt_bool_t mpf_rtp_data_send(mpf_rtp_stream_t *rtp_stream, rtp
 			return FALSE;
 		}
 
-		if(apr_socket_sendto(
-					rtp_stream->rtp_socket,
-					rtp_stream->rtp_r_sockaddr,
-					0,
-					transmitter->packet_data,
-					&transmitter->packet_size) == APR_SUCCESS) {
+		if(mpf_rtp_packet_send(rtp_stream,transmitter->packet_data,&transmitter->packet_size) == TRUE) {
 			transmitter->sr_stat.sent_packets++;
 			transmitter->sr_stat.sent_octets += (apr_uint32_t)transmitter->packet_size - sizeof(rtp_header_t);
 		}
@@ -1040,12 +1118,7 @@ static APR_INLINE apt_bool_t mpf_rtp_event_send(mpf_rtp_stream_t *rtp_stream, rt
 		(named_event->edge == 1) ? '*' : ' ');
 	header->timestamp = htonl(header->timestamp);
 	named_event->duration = htons((apr_uint16_t)named_event->duration);
-	if(apr_socket_sendto(
-				rtp_stream->rtp_socket,
-				rtp_stream->rtp_r_sockaddr,
-				0,
-				packet_data,
-				&packet_size) != APR_SUCCESS) {
+	if(mpf_rtp_packet_send(rtp_stream,packet_data,&packet_size) != TRUE) {
 		return FALSE;
 	}
 	transmitter->sr_stat.sent_packets++;
@@ -1061,7 +1134,8 @@ static apt_bool_t mpf_rtp_stream_transmit(mpf_audio_stream_t *stream, const mpf_
 
 	transmitter->timestamp += transmitter->samples_per_frame;
 
-	if(frame->type == MEDIA_FRAME_TYPE_NONE) {
+	if((frame->type & ~MEDIA_FRAME_TYPE_LOST) == MEDIA_FRAME_TYPE_NONE) {
+		/* no media, lost frames left unconcealed are relayed as a gap */
 		if(!transmitter->inactivity) {
 			if(transmitter->current_frames == 0) {
 				/* set inactivity (ptime alligned) */
@@ -1197,6 +1271,8 @@ static apt_bool_t mpf_rtp_socket_pair_bind(mpf_rtp_stream_t *stream, mpf_rtp_med
 /* Close RTP/RTCP sockets */
 static void mpf_rtp_socket_pair_close(mpf_rtp_stream_t *stream)
 {
+	/* the socket must not remain in the poller once closed */
+	rtp_rx_poller_socket_remove(stream);
 	if(stream->rtp_socket) {
 		apr_socket_close(stream->rtp_socket);
 		stream->rtp_socket = NULL;
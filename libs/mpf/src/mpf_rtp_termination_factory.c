@@ -117,6 +117,11 @@ static mpf_termination_t* mpf_rtp_termination_create(mpf_termination_factory_t *
 	return termination;
 }
 
+MPF_DECLARE(apt_bool_t) mpf_rtp_termination_check(const mpf_termination_t *termination)
+{
+	return termination && termination->vtable == &rtp_vtable ? TRUE : FALSE;
+}
+
 static apt_bool_t mpf_rtp_factory_engine_assign(mpf_termination_factory_t *termination_factory, mpf_engine_t *media_engine)
 {
 	int i;
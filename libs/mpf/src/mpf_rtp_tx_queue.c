@@ -0,0 +1,200 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* sendmmsg() */
+#endif
+
+#include <apr_portable.h>
+#include "mpf_rtp_tx_queue.h"
+#include "apt_log.h"
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#if defined(MSG_WAITFORONE)
+#define MPF_RTP_TX_QUEUE_SENDMMSG
+#endif
+#endif
+
+/** Max size of RTP packet */
+#define MAX_RTP_PACKET_SIZE 1500
+
+/** Queued RTP packet */
+typedef struct mpf_rtp_tx_entry_t mpf_rtp_tx_entry_t;
+
+struct mpf_rtp_tx_entry_t {
+	/** Socket to send the packet from */
+	apr_socket_t   *socket;
+	/** Destination address */
+	apr_sockaddr_t *sockaddr;
+	/** Packet data */
+	char           *data;
+	/** Size of the packet */
+	apr_size_t      size;
+};
+
+/** RTP transmit queue */
+struct mpf_rtp_tx_queue_t {
+	/** Array of queued packets */
+	mpf_rtp_tx_entry_t     *entries;
+	/** Max number of queued packets */
+	apr_size_t              capacity;
+	/** Current number of queued packets */
+	apr_size_t              count;
+#ifdef MPF_RTP_TX_QUEUE_SENDMMSG
+	/** Scatter/gather arrays of the queued packets */
+	struct iovec           *iov;
+	/** Message headers of the queued packets */
+	struct mmsghdr         *msgs;
+#endif
+	/** Statistics */
+	mpf_rtp_tx_queue_stat_t stat;
+};
+
+
+MPF_DECLARE(mpf_rtp_tx_queue_t*) mpf_rtp_tx_queue_create(apr_size_t capacity, apr_pool_t *pool)
+{
+	apr_size_t i;
+	char *data;
+	mpf_rtp_tx_queue_t *queue = apr_palloc(pool,sizeof(mpf_rtp_tx_queue_t));
+	if(!capacity) {
+		capacity = 1;
+	}
+	queue->capacity = capacity;
+	queue->count = 0;
+	queue->entries = apr_palloc(pool,sizeof(mpf_rtp_tx_entry_t) * capacity);
+	data = apr_palloc(pool,MAX_RTP_PACKET_SIZE * capacity);
+	for(i=0; i<capacity; i++) {
+		queue->entries[i].data = data + i * MAX_RTP_PACKET_SIZE;
+	}
+#ifdef MPF_RTP_TX_QUEUE_SENDMMSG
+	queue->iov = apr_palloc(pool,sizeof(struct iovec) * capacity);
+	queue->msgs = apr_pcalloc(pool,sizeof(struct mmsghdr) * capacity);
+	for(i=0; i<capacity; i++) {
+		queue->iov[i].iov_base = queue->entries[i].data;
+		queue->msgs[i].msg_hdr.msg_iov = &queue->iov[i];
+		queue->msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+#endif
+	memset(&queue->stat,0,sizeof(queue->stat));
+	return queue;
+}
+
+MPF_DECLARE(apt_bool_t) mpf_rtp_tx_queue_push(
+							mpf_rtp_tx_queue_t *queue,
+							apr_socket_t *socket,
+							apr_sockaddr_t *sockaddr,
+							const void *data,
+							apr_size_t size)
+{
+	mpf_rtp_tx_entry_t *entry;
+	if(!socket || !sockaddr || size > MAX_RTP_PACKET_SIZE) {
+		return FALSE;
+	}
+
+	if(queue->count == queue->capacity) {
+		/* queue is full, send out the pending packets in advance */
+		mpf_rtp_tx_queue_flush(queue);
+	}
+
+	entry = &queue->entries[queue->count++];
+	entry->socket = socket;
+	entry->sockaddr = sockaddr;
+	entry->size = size;
+	memcpy(entry->data,data,size);
+	return TRUE;
+}
+
+#ifdef MPF_RTP_TX_QUEUE_SENDMMSG
+/** Send a run of packets sharing the same socket with as few system calls as possible */
+static void mpf_rtp_tx_queue_run_send(mpf_rtp_tx_queue_t *queue, apr_size_t first, apr_size_t count)
+{
+	int rv;
+	apr_size_t i;
+	apr_size_t sent = 0;
+	apr_os_sock_t fd;
+	mpf_rtp_tx_entry_t *entry;
+	struct mmsghdr *msg;
+	if(apr_os_sock_get(&fd,queue->entries[first].socket) != APR_SUCCESS) {
+		queue->stat.failed_packets += (apr_uint32_t)count;
+		return;
+	}
+
+	for(i=first; i<first+count; i++) {
+		entry = &queue->entries[i];
+		msg = &queue->msgs[i];
+		queue->iov[i].iov_len = entry->size;
+		msg->msg_hdr.msg_name = &entry->sockaddr->sa;
+		msg->msg_hdr.msg_namelen = entry->sockaddr->salen;
+		msg->msg_len = 0;
+	}
+
+	while(sent < count) {
+		rv = sendmmsg(fd,&queue->msgs[first+sent],(unsigned int)(count-sent),MSG_DONTWAIT);
+		queue->stat.syscalls++;
+		if(rv <= 0) {
+			/* drop the rest of the run, as the same would happen to individual packets */
+			queue->stat.failed_packets += (apr_uint32_t)(count - sent);
+			break;
+		}
+		sent += rv;
+		queue->stat.sent_packets += rv;
+	}
+}
+#endif
+
+MPF_DECLARE(apt_bool_t) mpf_rtp_tx_queue_flush(mpf_rtp_tx_queue_t *queue)
+{
+	apr_size_t i;
+#ifdef MPF_RTP_TX_QUEUE_SENDMMSG
+	apr_size_t first = 0;
+#else
+	mpf_rtp_tx_entry_t *entry;
+#endif
+	queue->stat.flushes++;
+	if(!queue->count) {
+		return TRUE;
+	}
+
+#ifdef MPF_RTP_TX_QUEUE_SENDMMSG
+	/* packets of a stream are queued adjacently, send each run of the same socket at once */
+	for(i=1; i<=queue->count; i++) {
+		if(i == queue->count || queue->entries[i].socket != queue->entries[first].socket) {
+			mpf_rtp_tx_queue_run_send(queue,first,i-first);
+			first = i;
+		}
+	}
+#else
+	for(i=0; i<queue->count; i++) {
+		entry = &queue->entries[i];
+		queue->stat.syscalls++;
+		if(apr_socket_sendto(entry->socket,entry->sockaddr,0,entry->data,&entry->size) == APR_SUCCESS) {
+			queue->stat.sent_packets++;
+		}
+		else {
+			queue->stat.failed_packets++;
+		}
+	}
+#endif
+
+	queue->count = 0;
+	return TRUE;
+}
+
+MPF_DECLARE(void) mpf_rtp_tx_queue_stat_get(const mpf_rtp_tx_queue_t *queue, mpf_rtp_tx_queue_stat_t *stat)
+{
+	*stat = queue->stat;
+}
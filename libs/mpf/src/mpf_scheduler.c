@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <apr_time.h>
 #include "mpf_scheduler.h"
 
 #ifdef WIN32
@@ -37,7 +38,8 @@
 
 struct mpf_scheduler_t {
 	apr_pool_t          *pool;
-	unsigned long        resolution; /* scheduler resolution */
+	unsigned long        resolution; /* scheduler resolution (media time of a tick) */
+	unsigned long        rate;       /* number of times faster than real-time */
 
 	unsigned long        media_resolution;
 	mpf_scheduler_proc_f media_proc;
@@ -48,6 +50,9 @@ struct mpf_scheduler_t {
 	mpf_scheduler_proc_f timer_proc;
 	void                *timer_obj;
 
+	apt_bool_t           free_running; /* process ticks back-to-back */
+	apt_bool_t           idle;         /* nothing to process, run in real time */
+
 #ifdef ENABLE_MULTIMEDIA_TIMERS
 	unsigned int         timer_id;
 #else
@@ -65,6 +70,7 @@ MPF_DECLARE(mpf_scheduler_t*) mpf_scheduler_create(apr_pool_t *pool)
 	mpf_scheduler_init(scheduler);
 	scheduler->pool = pool;
 	scheduler->resolution = 0;
+	scheduler->rate = 1;
 
 	scheduler->media_resolution = 0;
 	scheduler->media_obj = NULL;
@@ -74,6 +80,9 @@ MPF_DECLARE(mpf_scheduler_t*) mpf_scheduler_create(apr_pool_t *pool)
 	scheduler->timer_elapsed_time = 0;
 	scheduler->timer_obj = NULL;
 	scheduler->timer_proc = NULL;
+
+	scheduler->free_running = FALSE;
+	scheduler->idle = TRUE;
 	return scheduler;
 }
 
@@ -121,12 +130,18 @@ MPF_DECLARE(apt_bool_t) mpf_scheduler_rate_set(
 		however, the rates up to 10 times faster should be acceptable */
 		rate = 1;
 	}
-	
-	scheduler->media_resolution /= rate;
-	scheduler->timer_resolution /= rate;
+
+	/* the resolutions are kept in media time, so that timers are counted in ticks processed,
+	only the period ticks are scheduled at is shortened */
+	scheduler->rate = rate;
 	return TRUE;
 }
 
+MPF_DECLARE(void) mpf_scheduler_idle_set(mpf_scheduler_t *scheduler, apt_bool_t idle)
+{
+	scheduler->idle = idle;
+}
+
 static APR_INLINE void mpf_scheduler_resolution_set(mpf_scheduler_t *scheduler)
 {
 	if(scheduler->media_resolution) {
@@ -137,6 +152,12 @@ static APR_INLINE void mpf_scheduler_resolution_set(mpf_scheduler_t *scheduler)
 	}
 }
 
+/** Get the period ticks are scheduled at in usec */
+static APR_INLINE apr_interval_time_t mpf_scheduler_period_get(const mpf_scheduler_t *scheduler)
+{
+	return (apr_interval_time_t)scheduler->resolution * 1000 / scheduler->rate;
+}
+
 
 
 #ifdef ENABLE_MULTIMEDIA_TIMERS
@@ -162,12 +183,19 @@ static void CALLBACK mm_timer_proc(UINT uID, UINT uMsg, DWORD_PTR dwUser, DWORD_
 	}
 }
 
+MPF_DECLARE(apt_bool_t) mpf_scheduler_free_running_set(mpf_scheduler_t *scheduler, apt_bool_t free_running)
+{
+	/* multimedia timers are periodic by design */
+	scheduler->free_running = FALSE;
+	return free_running == TRUE ? FALSE : TRUE;
+}
+
 /** Start scheduler */
 MPF_DECLARE(apt_bool_t) mpf_scheduler_start(mpf_scheduler_t *scheduler)
 {
 	mpf_scheduler_resolution_set(scheduler);
 	scheduler->timer_id = timeSetEvent(
-					scheduler->resolution, 0, mm_timer_proc, (DWORD_PTR) scheduler, 
+					(UINT)(mpf_scheduler_period_get(scheduler) / 1000), 0, mm_timer_proc, (DWORD_PTR) scheduler, 
 					TIME_PERIODIC | TIME_CALLBACK_FUNCTION | TIME_KILL_SYNCHRONOUS);
 	return scheduler->timer_id ? TRUE : FALSE;
 }
@@ -197,7 +225,7 @@ static APR_INLINE void mpf_scheduler_init(mpf_scheduler_t *scheduler)
 static void* APR_THREAD_FUNC timer_thread_proc(apr_thread_t *thread, void *data)
 {
 	mpf_scheduler_t *scheduler = data;
-	apr_interval_time_t timeout = scheduler->resolution * 1000;
+	apr_interval_time_t timeout = mpf_scheduler_period_get(scheduler);
 	apr_interval_time_t time_drift = 0;
 	apr_time_t time_now, time_last;
 	
@@ -220,6 +248,14 @@ static void* APR_THREAD_FUNC timer_thread_proc(apr_thread_t *thread, void *data)
 			}
 		}
 
+		if(scheduler->free_running == TRUE && scheduler->idle == FALSE) {
+			/* proceed to the next tick right away, the clocks are driven by ticks processed,
+			otherwise, if no stream produced data, sleep for the period to let the data arrive */
+			time_now = apr_time_now();
+			time_drift = 0;
+			continue;
+		}
+
 		if(timeout > time_drift) {
 			apr_sleep(timeout - time_drift);
 		}
@@ -235,6 +271,12 @@ static void* APR_THREAD_FUNC timer_thread_proc(apr_thread_t *thread, void *data)
 	return NULL;
 }
 
+MPF_DECLARE(apt_bool_t) mpf_scheduler_free_running_set(mpf_scheduler_t *scheduler, apt_bool_t free_running)
+{
+	scheduler->free_running = free_running;
+	return TRUE;
+}
+
 MPF_DECLARE(apt_bool_t) mpf_scheduler_start(mpf_scheduler_t *scheduler)
 {
 	mpf_scheduler_resolution_set(scheduler);
@@ -334,6 +334,8 @@ MRCP_DECLARE(apt_bool_t) mrcp_application_resource_discover(mrcp_session_t *sess
  * Dispatch application message.
  * @param dispatcher the dispatcher inteface
  * @param app_message the message to dispatch
+ * @remark The rx buffers a received MRCP message refers to in zero-copy mode are retained as long
+ *         as the session, the application may release them before by mrcp_message_buffers_release().
  */
 MRCP_DECLARE(apt_bool_t) mrcp_application_message_dispatch(const mrcp_app_message_dispatcher_t *dispatcher, const mrcp_app_message_t *app_message);
 
@@ -484,6 +484,8 @@ static apt_bool_t mrcp_app_sig_event_raise(mrcp_client_session_t *session, mrcp_
 
 static apt_bool_t mrcp_app_control_message_raise(mrcp_client_session_t *session, mrcp_channel_t *channel, mrcp_message_t *mrcp_message)
 {
+	/* the application may keep the message, retain rx buffers it refers to (zero-copy mode) as long as the session */
+	mrcp_message_buffers_bind(mrcp_message,session->base.pool);
 	if(mrcp_message->start_line.message_type == MRCP_MESSAGE_TYPE_RESPONSE) {
 		mrcp_app_message_t *response;
 		mrcp_message_t *mrcp_request;
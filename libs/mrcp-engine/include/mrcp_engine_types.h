@@ -24,6 +24,7 @@
 
 #include <apr_tables.h>
 #include <apr_hash.h>
+#include <apr_time.h>
 #include "mrcp_state_machine.h"
 #include "mpf_types.h"
 #include "apt_string.h"
@@ -164,6 +165,12 @@ struct mrcp_engine_settings_t {
 	apr_table_t   *attribs;
 	/** Associated engine */
 	mrcp_engine_t *engine;
+	/** Weight of the engine among the engines of the resource (1 by default) */
+	apr_size_t     weight;
+	/** Time before which the engine is skipped, since it failed to create a channel */
+	apr_time_t     retry_time;
+	/** Next engine the resource is mapped to, if any */
+	mrcp_engine_settings_t *next;
 };
 
 APT_END_EXTERN_C
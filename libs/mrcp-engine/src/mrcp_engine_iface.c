@@ -108,5 +108,8 @@ mrcp_engine_settings_t* mrcp_engine_settings_alloc(apr_pool_t *pool)
 	settings->engine_id = NULL;
 	settings->attribs = NULL;
 	settings->engine = NULL;
+	settings->weight = 1;
+	settings->retry_time = 0;
+	settings->next = NULL;
 	return settings;
 }
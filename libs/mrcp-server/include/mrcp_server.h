@@ -159,6 +159,21 @@ MRCP_DECLARE(mrcp_server_profile_t*) mrcp_server_profile_create(
 										mpf_rtp_settings_t *rtp_settings,
 										apr_pool_t *pool);
 
+/**
+ * Create MRCP profile (extended version).
+ * @remark Each new session is placed on the least loaded media engine of the factory.
+ */
+MRCP_DECLARE(mrcp_server_profile_t*) mrcp_server_profile_create_ex(
+										const char *id,
+										mrcp_version_e mrcp_version,
+										mrcp_resource_factory_t *resource_factory,
+										mrcp_sig_agent_t *signaling_agent,
+										mrcp_connection_agent_t *connection_agent,
+										mpf_engine_factory_t *mpf_factory,
+										mpf_termination_factory_t *rtp_factory,
+										mpf_rtp_settings_t *rtp_settings,
+										apr_pool_t *pool);
+
 /**
  * Register MRCP profile.
  * @param server the MRCP server to set profile for
@@ -203,6 +218,14 @@ MRCP_DECLARE(mrcp_engine_t*) mrcp_server_engine_get(const mrcp_server_t *server,
  */
 MRCP_DECLARE(mpf_engine_t*) mrcp_server_media_engine_get(const mrcp_server_t *server, const char *name);
 
+/**
+ * Log the status of media engines (the number of workers, contexts and RTP sockets) and their placement in profiles.
+ * @param server the MRCP server to log the status of
+ * @remark The status is logged asynchronously in the context of the server task, thus the function
+ *         may be called from any thread (e.g. the console one).
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_server_status_log(const mrcp_server_t *server);
+
 /**
  * Get RTP termination factory by name.
  * @param server the MRCP server to get from
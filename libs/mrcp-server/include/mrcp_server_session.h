@@ -110,6 +110,8 @@ struct mrcp_server_session_t {
 	mrcp_server_session_state_e state;
 	/** Number of in-progress sub requests */
 	apr_size_t                  subrequest_count;
+	/** Handle encoded by the generated session id (0 - session id set by signaling agent) */
+	apr_uint32_t                handle;
 };
 
 /** MRCP server profile */
@@ -122,8 +124,8 @@ struct mrcp_server_profile_t {
 	apr_hash_t                *engine_table;
 	/** MRCP resource factory */
 	mrcp_resource_factory_t   *resource_factory;
-	/** Media processing engine */
-	mpf_engine_t              *media_engine;
+	/** Media engine factory */
+	mpf_engine_factory_t      *mpf_factory;
 	/** RTP termination factory */
 	mpf_termination_factory_t *rtp_termination_factory;
 	/** RTP settings */
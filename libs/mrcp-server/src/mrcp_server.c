@@ -24,13 +24,17 @@
 #include "mrcp_sig_agent.h"
 #include "mrcp_server_connection.h"
 #include "mpf_termination_factory.h"
+#include "mpf_engine_factory.h"
 #include "apt_pool.h"
 #include "apt_consumer_task.h"
 #include "apt_obj_list.h"
+#include "apt_handle_table.h"
 #include "apt_log.h"
 
 #define SERVER_TASK_NAME "MRCP Server"
 
+#define MRCP_SESSION_ID_HEX_STRING_LENGTH 16
+
 /** MRCP server */
 struct mrcp_server_t {
 	/** Main message processing task */
@@ -60,6 +64,8 @@ struct mrcp_server_t {
 
 	/** Table of sessions */
 	apr_hash_t              *session_table;
+	/** Table of sessions by the handle encoded in the generated session id */
+	apt_handle_table_t      *session_handle_table;
 
 	/** Connection task message pool */
 	apt_task_msg_pool_t     *connection_msg_pool;
@@ -81,7 +87,8 @@ typedef enum {
 	MRCP_SERVER_SIGNALING_TASK_MSG = TASK_MSG_USER,
 	MRCP_SERVER_CONNECTION_TASK_MSG,
 	MRCP_SERVER_ENGINE_TASK_MSG,
-	MRCP_SERVER_MEDIA_TASK_MSG
+	MRCP_SERVER_MEDIA_TASK_MSG,
+	MRCP_SERVER_STATUS_TASK_MSG
 } mrcp_server_task_msg_type_e;
 
 
@@ -206,11 +213,12 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->rtp_settings_table = NULL;
 	server->profile_table = NULL;
 	server->session_table = NULL;
+	server->session_handle_table = NULL;
 	server->connection_msg_pool = NULL;
 	server->engine_msg_pool = NULL;
 	server->shutdown_requested = FALSE;
 
-	msg_pool = apt_task_msg_pool_create_dynamic(0,pool);
+	msg_pool = apt_task_msg_pool_create_static(0,TASK_MSG_POOL_DEFAULT_SIZE,pool);
 
 	server->task = apt_consumer_task_create(server,msg_pool,pool);
 	if(!server->task) {
@@ -242,6 +250,7 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->profile_table = apr_hash_make(server->pool);
 	
 	server->session_table = apr_hash_make(server->pool);
+	server->session_handle_table = apt_handle_table_create(HANDLE_TABLE_DEFAULT_SIZE,server->pool);
 	return server;
 }
 
@@ -303,6 +312,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_shutdown(mrcp_server_t *server)
 		return FALSE;
 	}
 	server->session_table = NULL;
+	server->session_handle_table = NULL;
 	uptime = apr_time_now() - server->start_time;
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Server Uptime [%"APR_TIME_T_FMT" sec]", apr_time_sec(uptime));
 	return TRUE;
@@ -346,7 +356,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_engine_register(mrcp_server_t *server, mrcp
 	}
 	
 	if(!server->engine_msg_pool) {
-		server->engine_msg_pool = apt_task_msg_pool_create_dynamic(sizeof(engine_task_msg_data_t),server->pool);
+		server->engine_msg_pool = apt_task_msg_pool_create_static(sizeof(engine_task_msg_data_t),TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	}
 	engine->codec_manager = server->codec_manager;
 	engine->dir_layout = server->dir_layout;
@@ -408,6 +418,70 @@ MRCP_DECLARE(mpf_engine_t*) mrcp_server_media_engine_get(const mrcp_server_t *se
 	return apr_hash_get(server->media_engine_table,name,APR_HASH_KEY_STRING);
 }
 
+/** Log the status of media engines and their placement in profiles */
+MRCP_DECLARE(apt_bool_t) mrcp_server_status_log(const mrcp_server_t *server)
+{
+	apt_task_t *task;
+	apt_task_msg_t *task_msg;
+	if(!server || !server->task) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Invalid Server Instance");
+		return FALSE;
+	}
+
+	/* the status is logged in the context of the server task, which owns the tables */
+	task = apt_consumer_task_base_get(server->task);
+	task_msg = apt_task_msg_get(task);
+	if(!task_msg) {
+		return FALSE;
+	}
+	task_msg->type = MRCP_SERVER_STATUS_TASK_MSG;
+	return apt_task_msg_signal(task,task_msg);
+}
+
+/** Log the status of media engines and their placement in profiles (server task context) */
+static void mrcp_server_status_process(mrcp_server_t *server)
+{
+	apr_hash_index_t *it;
+	void *val;
+	mpf_engine_t *media_engine;
+	mrcp_server_profile_t *profile;
+	mpf_rtp_poller_stat_t rtp_stat;
+	apr_size_t count;
+	apr_size_t i;
+
+	it = apr_hash_first(NULL,server->media_engine_table);
+	for(; it; it = apr_hash_next(it)) {
+		apr_hash_this(it,NULL,NULL,&val);
+		media_engine = val;
+		if(!media_engine) continue;
+
+		mpf_engine_rtp_stat_get(media_engine,&rtp_stat);
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Media Engine [%s] workers:%"APR_SIZE_T_FMT" contexts:%"APR_SIZE_T_FMT" rtp-sockets:%u",
+			mpf_engine_id_get(media_engine),
+			mpf_engine_worker_count_get(media_engine),
+			mpf_engine_load_get(media_engine),
+			rtp_stat.sockets);
+	}
+
+	it = apr_hash_first(NULL,server->profile_table);
+	for(; it; it = apr_hash_next(it)) {
+		apr_hash_this(it,NULL,NULL,&val);
+		profile = val;
+		if(!profile) continue;
+
+		count = mpf_engine_factory_engine_count_get(profile->mpf_factory);
+		for(i=0; i<count; i++) {
+			media_engine = mpf_engine_factory_engine_get(profile->mpf_factory,i);
+			apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Profile [%s] Media Engine %"APR_SIZE_T_FMT"/%"APR_SIZE_T_FMT" [%s] contexts:%"APR_SIZE_T_FMT,
+				profile->id,
+				i+1,
+				count,
+				mpf_engine_id_get(media_engine),
+				mpf_engine_load_get(media_engine));
+		}
+	}
+}
+
 /** Register RTP termination factory */
 MRCP_DECLARE(apt_bool_t) mrcp_server_rtp_factory_register(mrcp_server_t *server, mpf_termination_factory_t *rtp_termination_factory, const char *name)
 {
@@ -452,7 +526,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_signaling_agent_register(mrcp_server_t *ser
 	signaling_agent->parent = server;
 	signaling_agent->resource_factory = server->resource_factory;
 	signaling_agent->create_server_session = mrcp_server_sig_agent_session_create;
-	signaling_agent->msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mrcp_signaling_message_t*),server->pool);
+	signaling_agent->msg_pool = apt_task_msg_pool_create_static(sizeof(mrcp_signaling_message_t*),TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	apr_hash_set(server->sig_agent_table,signaling_agent->id,APR_HASH_KEY_STRING,signaling_agent);
 	if(server->task) {
 		apt_task_t *task = apt_consumer_task_base_get(server->task);
@@ -481,7 +555,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_register(mrcp_server_t *se
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Register Connection Agent [%s]",id);
 	mrcp_server_connection_resource_factory_set(connection_agent,server->resource_factory);
 	mrcp_server_connection_agent_handler_set(connection_agent,server,&connection_method_vtable);
-	server->connection_msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_agent_task_msg_data_t),server->pool);
+	server->connection_msg_pool = apt_task_msg_pool_create_static(sizeof(connection_agent_task_msg_data_t),TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	apr_hash_set(server->cnt_agent_table,id,APR_HASH_KEY_STRING,connection_agent);
 	if(server->task) {
 		apt_task_t *task = apt_consumer_task_base_get(server->task);
@@ -508,19 +582,51 @@ MRCP_DECLARE(mrcp_server_profile_t*) mrcp_server_profile_create(
 										mpf_termination_factory_t *rtp_factory,
 										mpf_rtp_settings_t *rtp_settings,
 										apr_pool_t *pool)
+{
+	mpf_engine_factory_t *mpf_factory = NULL;
+	if(media_engine) {
+		mpf_factory = mpf_engine_factory_create(pool);
+		mpf_engine_factory_engine_add(mpf_factory,media_engine);
+	}
+
+	return mrcp_server_profile_create_ex(
+				id,
+				mrcp_version,
+				resource_factory,
+				signaling_agent,
+				connection_agent,
+				mpf_factory,
+				rtp_factory,
+				rtp_settings,
+				pool);
+}
+
+/** Create MRCP profile (extended version) */
+MRCP_DECLARE(mrcp_server_profile_t*) mrcp_server_profile_create_ex(
+										const char *id,
+										mrcp_version_e mrcp_version,
+										mrcp_resource_factory_t *resource_factory,
+										mrcp_sig_agent_t *signaling_agent,
+										mrcp_connection_agent_t *connection_agent,
+										mpf_engine_factory_t *mpf_factory,
+										mpf_termination_factory_t *rtp_factory,
+										mpf_rtp_settings_t *rtp_settings,
+										apr_pool_t *pool)
 {
 	mrcp_server_profile_t *profile = apr_palloc(pool,sizeof(mrcp_server_profile_t));
 	profile->id = id;
 	profile->mrcp_version = mrcp_version;
 	profile->resource_factory = resource_factory;
 	profile->engine_table = NULL;
-	profile->media_engine = media_engine;
+	profile->mpf_factory = mpf_factory;
 	profile->rtp_termination_factory = rtp_factory;
 	profile->rtp_settings = rtp_settings;
 	profile->signaling_agent = signaling_agent;
 	profile->connection_agent = connection_agent;
 
-	mpf_termination_factory_engine_assign(rtp_factory,media_engine);
+	/* the RTP port range of the factory is split among the assigned media engines */
+	if(mpf_factory && rtp_factory)
+		mpf_engine_factory_rtp_factory_assign(mpf_factory,rtp_factory);
 	return profile;
 }
 
@@ -529,6 +635,8 @@ static apt_bool_t mrcp_server_engine_table_make(mrcp_server_t *server, mrcp_serv
 	int i;
 	mrcp_resource_t *resource;
 	mrcp_engine_settings_t *settings;
+	mrcp_engine_settings_t *it;
+	apt_bool_t found;
 
 	profile->engine_table = apr_hash_make(server->pool);
 	for(i=0; i<MRCP_RESOURCE_TYPE_COUNT; i++) {
@@ -536,11 +644,19 @@ static apt_bool_t mrcp_server_engine_table_make(mrcp_server_t *server, mrcp_serv
 		if(!resource) continue;
 		
 		settings = NULL;
+		found = FALSE;
 		/* first, try to find engine settings by name specified in profile-based resource/engine map (if available) */
 		if(resource_engine_map) {
 			settings = apr_hash_get(resource_engine_map,resource->name.buf,resource->name.length);
-			if(settings) {
-				settings->engine = mrcp_engine_factory_engine_get(server->engine_factory,settings->engine_id);
+			/* the resource may be mapped to a set of engines */
+			for(it = settings; it; it = it->next) {
+				it->engine = mrcp_engine_factory_engine_get(server->engine_factory,it->engine_id);
+				if(it->engine) {
+					found = TRUE;
+				}
+				else if(it->engine_id) {
+					apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No Such Engine [%s] for Resource [%s] in Profile [%s]",it->engine_id,resource->name.buf,profile->id);
+				}
 			}
 		}
 
@@ -550,13 +666,16 @@ static apt_bool_t mrcp_server_engine_table_make(mrcp_server_t *server, mrcp_serv
 		}
 
 		/* next, if no engine found or specified, try to find the first available one */
-		if(!settings->engine) {
+		if(found == FALSE) {
 			settings->engine = mrcp_engine_factory_engine_find(server->engine_factory,i);
 		}
 
-		if(settings->engine) {
-			if(settings->engine->id) {
-				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Associate Resource [%s] to Engine [%s] in Profile [%s]",resource->name.buf,settings->engine->id, profile->id);
+		if(settings->engine || found == TRUE) {
+			for(it = settings; it; it = it->next) {
+				if(it->engine && it->engine->id) {
+					apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Associate Resource [%s] to Engine [%s] (weight %"APR_SIZE_T_FMT") in Profile [%s]",
+						resource->name.buf,it->engine->id,it->weight,profile->id);
+				}
 			}
 			apr_hash_set(profile->engine_table,resource->name.buf,resource->name.length,settings);
 		}
@@ -596,10 +715,14 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_profile_register(
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Register Profile [%s]: missing connection agent",profile->id);
 		return FALSE;
 	}
-	if(!profile->media_engine) {
+	if(!profile->mpf_factory) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Register Profile [%s]: missing media engine",profile->id);
 		return FALSE;
 	}
+	if(mpf_engine_factory_is_empty(profile->mpf_factory) == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Register Profile [%s]: empty media engine factory",profile->id);
+		return FALSE;
+	}
 	if(!profile->rtp_termination_factory) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Register Profile [%s]: missing RTP factory",profile->id);
 		return FALSE;
@@ -647,6 +770,11 @@ MRCP_DECLARE(apr_pool_t*) mrcp_server_memory_pool_get(const mrcp_server_t *serve
 
 void mrcp_server_session_add(mrcp_server_t *server, mrcp_server_session_t *session)
 {
+	if(!session->base.id.length) {
+		/* generate session id beginning with the handle the session is looked up by */
+		session->handle = apt_handle_table_add(server->session_handle_table,session);
+		apt_handle_id_generate(&session->base.id,session->handle,MRCP_SESSION_ID_HEX_STRING_LENGTH,session->base.pool);
+	}
 	if(!session->base.id.buf) 
 		return;
 
@@ -661,6 +789,10 @@ void mrcp_server_session_remove(mrcp_server_t *server, mrcp_server_session_t *se
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Remove Session " APT_SID_FMT,MRCP_SESSION_SID(&session->base));
 	apr_hash_set(server->session_table,session->base.id.buf,session->base.id.length,NULL);
+	if(session->handle) {
+		apt_handle_table_set(server->session_handle_table,session->handle,NULL);
+		session->handle = 0;
+	}
 }
 
 void mrcp_server_session_idle_test(mrcp_server_t *server)
@@ -676,6 +808,11 @@ void mrcp_server_session_idle_test(mrcp_server_t *server)
 
 static APR_INLINE mrcp_server_session_t* mrcp_server_session_find(mrcp_server_t *server, const apt_str_t *session_id)
 {
+	/* session ids set by signaling agents may begin with hex digits too, check the whole id */
+	mrcp_server_session_t *session = apt_handle_table_get(server->session_handle_table,apt_handle_id_parse(session_id));
+	if(session && apt_string_compare(&session->base.id,session_id) == TRUE) {
+		return session;
+	}
 	return apr_hash_get(server->session_table,session_id->buf,session_id->length);
 }
 
@@ -858,6 +995,12 @@ static apt_bool_t mrcp_server_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 			mrcp_server_mpf_message_process(mpf_message_container);
 			break;
 		}
+		case MRCP_SERVER_STATUS_TASK_MSG:
+		{
+			apt_consumer_task_t *consumer_task = apt_task_object_get(task);
+			mrcp_server_status_process(apt_consumer_task_object_get(consumer_task));
+			break;
+		}
 		default:
 		{
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Task Message Received [%d;%d]", msg->type,msg->sub_type);
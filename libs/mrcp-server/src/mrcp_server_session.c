@@ -26,6 +26,7 @@
 #include "mrcp_state_machine.h"
 #include "mrcp_message.h"
 #include "mpf_termination_factory.h"
+#include "mpf_engine_factory.h"
 #include "mpf_stream.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
@@ -34,8 +35,6 @@
 #define MRCP_SESSION_NAMESID(session) \
 	session->base.name, MRCP_SESSION_SID(&session->base)
 
-#define MRCP_SESSION_ID_HEX_STRING_LENGTH 16
-
 struct mrcp_channel_t {
 	/** Memory pool */
 	apr_pool_t             *pool;
@@ -114,6 +113,7 @@ mrcp_server_session_t* mrcp_server_session_create()
 	session->mpf_task_msg = NULL;
 	session->subrequest_count = 0;
 	session->state = SESSION_STATE_NONE;
+	session->handle = 0;
 	session->base.name = apr_psprintf(session->base.pool,"0x%pp",session);
 	return session;
 }
@@ -123,40 +123,95 @@ static APR_INLINE mrcp_version_e mrcp_session_version_get(mrcp_server_session_t
 	return session->profile->mrcp_version;
 }
 
+/** Max number of engines of a resource the channel creation is balanced among */
+#define MRCP_ENGINE_SET_MAX_SIZE 32
+
+/** Check whether the engine is open and able to take one more channel */
+static APR_INLINE apt_bool_t mrcp_engine_available(const mrcp_engine_t *engine)
+{
+	if(!engine || engine->is_open == FALSE) {
+		return FALSE;
+	}
+	if(engine->config->max_channel_count && engine->cur_channel_count >= engine->config->max_channel_count) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Interval an engine is skipped for, after it failed to create a channel */
+#define MRCP_ENGINE_RETRY_INTERVAL apr_time_from_sec(10)
+
+/** Select the available engine of the set having the least number of channels per weight */
+static mrcp_engine_settings_t* mrcp_server_engine_settings_select(mrcp_engine_settings_t *engine_set, apr_uint32_t *tried_mask)
+{
+	mrcp_engine_settings_t *selected = NULL;
+	mrcp_engine_settings_t *settings;
+	apr_size_t selected_index = 0;
+	apr_size_t index;
+	apr_time_t now = apr_time_now();
+	apt_bool_t skip_failed;
+
+	/* an engine, which recently failed to create a channel, is selected only if there is no other one,
+	otherwise, having the least number of channels, it would keep attracting all the new channels */
+	for(skip_failed = TRUE; ; skip_failed = FALSE) {
+		for(settings = engine_set, index = 0; settings && index < MRCP_ENGINE_SET_MAX_SIZE; settings = settings->next, index++) {
+			if((*tried_mask & (1U << index)) || mrcp_engine_available(settings->engine) == FALSE) {
+				continue;
+			}
+			if(skip_failed == TRUE && settings->retry_time > now) {
+				continue;
+			}
+			/* compare cur/weight ratios by cross-multiplication, the first listed engine wins a tie */
+			if(!selected ||
+				settings->engine->cur_channel_count * selected->weight < selected->engine->cur_channel_count * settings->weight) {
+				selected = settings;
+				selected_index = index;
+			}
+		}
+		if(selected || skip_failed == FALSE) {
+			break;
+		}
+	}
+
+	if(selected) {
+		*tried_mask |= 1U << selected_index;
+	}
+	return selected;
+}
+
 static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_session_t *session, mrcp_channel_t *channel, const apt_str_t *resource_name, mrcp_session_attribs_t *session_attribs)
 {
 	mrcp_engine_t *engine = NULL;
+	mrcp_engine_channel_t *engine_channel = NULL;
+	mrcp_engine_settings_t *selected;
+	mrcp_engine_settings_t *settings;
+	mrcp_engine_settings_t *attribs_settings = NULL;
+	apr_table_t *session_table = NULL;
 	apr_table_t *attribs = NULL;
+	apr_uint32_t tried_mask = 0;
 
-	/* get engine settings per profile */
-	mrcp_engine_settings_t *settings = apr_hash_get(
+	/* get engine settings per profile, the resource may be mapped to a set of engines */
+	mrcp_engine_settings_t *engine_set = apr_hash_get(
 											session->profile->engine_table,
 											resource_name->buf,
 											resource_name->length);
-	if(settings && settings->attribs) {
-		/* copy/apply global configuration attributes */
-		attribs = apr_table_copy(session->base.pool,settings->attribs);
-	}
 
 	/* process session attributes, if specified */
 	if(session_attribs) {
 		if(session_attribs->generic_attribs) {
-			if(!attribs) {
-				attribs = apr_table_make(session->base.pool,1);
-			}
 			/* copy/apply session generic attributes */
-			attribs = apr_table_overlay(session->base.pool,attribs,session_attribs->generic_attribs);
+			session_table = apr_table_copy(session->base.pool,session_attribs->generic_attribs);
 		}
 
 		if(session_attribs->resource_attribs) {
 			const char *engine_name;
 			apr_table_t *table = apr_hash_get(session_attribs->resource_attribs,resource_name->buf,resource_name->length);
 			if(table) {
-				if(!attribs) {
-					attribs = apr_table_make(session->base.pool,1);
+				if(!session_table) {
+					session_table = apr_table_make(session->base.pool,1);
 				}
 				/* copy/apply session resource-specific attributes */
-				attribs = apr_table_overlay(session->base.pool,attribs,table);
+				session_table = apr_table_overlay(session->base.pool,session_table,table);
 
 				/* check whether an engine is specified in the session attributes */
 				engine_name = apr_table_get(table,"engine");
@@ -173,11 +228,25 @@ static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_sess
 		}
 	}
 
-	/* if no engine is specified or found, then use the default one */
-	if(!engine) {
-		if(settings) {
-			engine = settings->engine;
+	settings = NULL;
+	if(engine) {
+		/* an engine specified in the session attributes is used as is, without balancing,
+		still the configuration attributes of the engine (or the default one) the resource is mapped to apply */
+		for(attribs_settings = engine_set; attribs_settings; attribs_settings = attribs_settings->next) {
+			if(attribs_settings->engine == engine) {
+				break;
+			}
 		}
+		if(!attribs_settings) {
+			attribs_settings = engine_set;
+		}
+	}
+	else if(engine_set) {
+		/* if no engine is specified or found, then use the least loaded one the resource is mapped to */
+		selected = mrcp_server_engine_settings_select(engine_set,&tried_mask);
+		settings = selected ? selected : engine_set;
+		engine = settings->engine;
+		attribs_settings = settings;
 	}
 
 	/* if no engine is available, then return with an error */
@@ -197,10 +266,46 @@ static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_sess
 		return NULL;
 	}
 
-	apt_log(APT_LOG_MARK, APT_PRIO_INFO, "Found MRCP Engine [%s] for Resource [%s] " APT_NAMESID_FMT,
+	for(;;) {
+		attribs = NULL;
+		if(attribs_settings && attribs_settings->attribs) {
+			/* copy/apply global configuration attributes of the engine */
+			attribs = apr_table_copy(session->base.pool,attribs_settings->attribs);
+		}
+		if(session_table) {
+			attribs = attribs ? apr_table_overlay(session->base.pool,attribs,session_table) : session_table;
+		}
+
+		apt_log(APT_LOG_MARK, APT_PRIO_INFO, "Found MRCP Engine [%s] for Resource [%s] " APT_NAMESID_FMT,
+				engine->id,
+				resource_name->buf,
+				MRCP_SESSION_NAMESID(session));
+		engine_channel = mrcp_engine_channel_virtual_create(engine,attribs,mrcp_session_version_get(session),session->base.pool);
+		if(engine_channel || !settings) {
+			break;
+		}
+
+		/* skip the engine for a while for subsequent channels */
+		settings->retry_time = apr_time_now() + MRCP_ENGINE_RETRY_INTERVAL;
+
+		/* fail over to the next least loaded engine the resource is mapped to */
+		selected = mrcp_server_engine_settings_select(engine_set,&tried_mask);
+		if(!selected) {
+			break;
+		}
+		apt_log(APT_LOG_MARK, APT_PRIO_NOTICE, "Failed to Create Channel on MRCP Engine [%s], Fail Over to [%s] " APT_NAMESID_FMT,
 			engine->id,
-			resource_name->buf,
+			selected->engine->id,
 			MRCP_SESSION_NAMESID(session));
+		settings = selected;
+		attribs_settings = selected;
+		engine = selected->engine;
+	}
+
+	if(!engine_channel) {
+		return NULL;
+	}
+
 	channel->state_machine = engine->create_state_machine(
 						channel,
 						mrcp_session_version_get(session),
@@ -209,8 +314,7 @@ static mrcp_engine_channel_t* mrcp_server_engine_channel_create(mrcp_server_sess
 		channel->state_machine->on_dispatch = state_machine_on_message_dispatch;
 		channel->state_machine->on_deactivate = state_machine_on_deactivate;
 	}
-
-	return mrcp_engine_channel_virtual_create(engine,attribs,mrcp_session_version_get(session),session->base.pool);
+	return engine_channel;
 }
 
 static mrcp_channel_t* mrcp_server_channel_create(mrcp_server_session_t *session, const apt_str_t *resource_name, apr_size_t id, apr_array_header_t *cmid_arr, mrcp_session_attribs_t *session_attribs)
@@ -428,14 +532,13 @@ apt_bool_t mrcp_server_on_engine_channel_message(mrcp_channel_t *channel, mrcp_m
 static apt_bool_t mrcp_server_session_offer_process(mrcp_server_session_t *session, mrcp_session_descriptor_t *descriptor)
 {
 	if(!session->context) {
-		/* initial offer received, generate session id and add to session's table */
-		if(!session->base.id.length) {
-			apt_unique_id_generate(&session->base.id,MRCP_SESSION_ID_HEX_STRING_LENGTH,session->base.pool);
-		}
+		/* initial offer received, generate session id (unless already set) and add to session's table */
 		mrcp_server_session_add(session->server,session);
 
+		/* place the session on the least loaded media engine of the profile */
+		session->base.media_engine = mpf_engine_factory_least_loaded_engine_select(session->profile->mpf_factory);
 		session->context = mpf_engine_context_create(
-			session->profile->media_engine,
+			session->base.media_engine,
 			session->base.name,
 			session,5,session->base.pool);
 	}
@@ -463,7 +566,7 @@ static apt_bool_t mrcp_server_session_offer_process(mrcp_server_session_t *sessi
 
 	/* first, reset/destroy existing associations and topology */
 	if(mpf_engine_topology_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_RESET_ASSOCIATIONS,session->context,
 				&session->mpf_task_msg) == TRUE){
 		mrcp_server_session_subrequest_add(session);
@@ -484,12 +587,12 @@ static apt_bool_t mrcp_server_session_offer_process(mrcp_server_session_t *sessi
 
 	/* apply topology based on assigned associations */
 	if(mpf_engine_topology_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_APPLY_TOPOLOGY,session->context,
 				&session->mpf_task_msg) == TRUE) {
 		mrcp_server_session_subrequest_add(session);
 	}
-	mpf_engine_message_send(session->profile->media_engine,&session->mpf_task_msg);
+	mpf_engine_message_send(session->base.media_engine,&session->mpf_task_msg);
 
 	if(!session->subrequest_count) {
 		/* send answer to client */
@@ -510,7 +613,7 @@ static apt_bool_t mrcp_server_session_terminate_process(mrcp_server_session_t *s
 	if(session->context) {
 		/* first, destroy existing topology */
 		if(mpf_engine_topology_message_add(
-					session->profile->media_engine,
+					session->base.media_engine,
 					MPF_RESET_ASSOCIATIONS,session->context,
 					&session->mpf_task_msg) == TRUE){
 			mrcp_server_session_subrequest_add(session);
@@ -541,7 +644,7 @@ static apt_bool_t mrcp_server_session_terminate_process(mrcp_server_session_t *s
 					MRCP_SESSION_NAMESID(session),
 					mpf_termination_name_get(termination));
 				if(mpf_engine_termination_message_add(
-							session->profile->media_engine,
+							session->base.media_engine,
 							MPF_SUBTRACT_TERMINATION,session->context,termination,NULL,
 							&session->mpf_task_msg) == TRUE) {
 					channel->waiting_for_termination = TRUE;
@@ -565,7 +668,7 @@ static apt_bool_t mrcp_server_session_terminate_process(mrcp_server_session_t *s
 			MRCP_SESSION_NAMESID(session),
 			mpf_termination_name_get(slot->termination));
 		if(mpf_engine_termination_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_SUBTRACT_TERMINATION,session->context,slot->termination,NULL,
 				&session->mpf_task_msg) == TRUE) {
 			slot->waiting = TRUE;
@@ -574,7 +677,7 @@ static apt_bool_t mrcp_server_session_terminate_process(mrcp_server_session_t *s
 	}
 
 	if(session->context) {
-		mpf_engine_message_send(session->profile->media_engine,&session->mpf_task_msg);
+		mpf_engine_message_send(session->base.media_engine,&session->mpf_task_msg);
 	}
 
 	if(!session->subrequest_count) {
@@ -725,7 +828,7 @@ static apt_bool_t mrcp_server_resource_offer_process(mrcp_server_session_t *sess
 			mpf_termination_t *termination = channel->engine_channel->termination;
 			/* send add termination request (add to media context) */
 			if(mpf_engine_termination_message_add(
-					session->profile->media_engine,
+					session->base.media_engine,
 					MPF_ADD_TERMINATION,session->context,termination,NULL,
 					&session->mpf_task_msg) == TRUE) {
 				channel->waiting_for_termination = TRUE;
@@ -817,7 +920,7 @@ static apt_bool_t mrcp_server_control_media_offer_process(mrcp_server_session_t
 			mpf_termination_t *termination = channel->engine_channel->termination;
 			/* send add termination request (add to media context) */
 			if(mpf_engine_termination_message_add(
-					session->profile->media_engine,
+					session->base.media_engine,
 					MPF_ADD_TERMINATION,session->context,termination,NULL,
 					&session->mpf_task_msg) == TRUE) {
 				channel->waiting_for_termination = TRUE;
@@ -912,7 +1015,7 @@ static apt_bool_t mrcp_server_associations_set(mrcp_server_session_t *session, m
 		if(!channel || !channel->engine_channel) continue;
 
 		if(mpf_engine_assoc_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_ADD_ASSOCIATION,session->context,slot->termination,channel->engine_channel->termination,
 				&session->mpf_task_msg) == TRUE) {
 			mrcp_server_session_subrequest_add(session);
@@ -953,7 +1056,7 @@ static apt_bool_t mrcp_server_av_media_offer_process(mrcp_server_session_t *sess
 				mpf_termination_name_get(slot->termination),
 				i);
 		if(mpf_engine_termination_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_MODIFY_TERMINATION,session->context,slot->termination,rtp_descriptor,
 				&session->mpf_task_msg) == TRUE) {
 			slot->waiting = TRUE;
@@ -987,7 +1090,7 @@ static apt_bool_t mrcp_server_av_media_offer_process(mrcp_server_session_t *sess
 
 		/* send add termination request (add to media context) */
 		if(mpf_engine_termination_message_add(
-				session->profile->media_engine,
+				session->base.media_engine,
 				MPF_ADD_TERMINATION,session->context,termination,rtp_descriptor,
 				&session->mpf_task_msg) == TRUE) {
 			slot->waiting = TRUE;
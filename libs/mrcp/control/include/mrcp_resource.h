@@ -39,11 +39,15 @@ struct mrcp_resource_t {
 	const apt_str_table_item_t* (*get_method_str_table)(mrcp_version_e version);
 	/** Number of methods */
 	apr_size_t       method_count;
+	/** Get perfect hash of the string table of methods (optional) */
+	const apt_str_table_hash_t* (*get_method_str_hash)(mrcp_version_e version);
 
 	/** Get string table of events */
 	const apt_str_table_item_t* (*get_event_str_table)(mrcp_version_e version);
 	/** Number of events */
 	apr_size_t       event_count;
+	/** Get perfect hash of the string table of events (optional) */
+	const apt_str_table_hash_t* (*get_event_str_hash)(mrcp_version_e version);
 
 	/** Get vtable of resource header */
 	const mrcp_header_vtable_t* (*get_resource_header_vtable)(mrcp_version_e version);
@@ -59,6 +63,8 @@ static APR_INLINE mrcp_resource_t* mrcp_resource_create(apr_pool_t *pool)
 	resource->event_count = 0;
 	resource->get_method_str_table = NULL;
 	resource->get_event_str_table = NULL;
+	resource->get_method_str_hash = NULL;
+	resource->get_event_str_hash = NULL;
 	resource->get_resource_header_vtable = NULL;
 	return resource;
 }
@@ -43,6 +43,9 @@ MRCP_DECLARE(void) mrcp_parser_resource_set(mrcp_parser_t *parser, const apt_str
 /** Set verbose mode for the parser */
 MRCP_DECLARE(void) mrcp_parser_verbose_set(mrcp_parser_t *parser, apt_bool_t verbose);
 
+/** Set the buffer to parse MRCP stream over in zero-copy mode (see apt_message_parser_buffer_set()) */
+MRCP_DECLARE(void) mrcp_parser_buffer_set(mrcp_parser_t *parser, apt_message_buffer_t *buffer);
+
 /** Parse MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_parser_run(mrcp_parser_t *parser, apt_text_stream_t *stream, mrcp_message_t **message);
 
@@ -81,10 +81,21 @@ MRCP_DECLARE(void) mrcp_parser_verbose_set(mrcp_parser_t *parser, apt_bool_t ver
 	apt_message_parser_verbose_set(parser->base,verbose);
 }
 
+/** Set the buffer to parse MRCP stream over in zero-copy mode */
+MRCP_DECLARE(void) mrcp_parser_buffer_set(mrcp_parser_t *parser, apt_message_buffer_t *buffer)
+{
+	apt_message_parser_buffer_set(parser->base,buffer);
+}
+
 /** Parse MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_parser_run(mrcp_parser_t *parser, apt_text_stream_t *stream, mrcp_message_t **message)
 {
-	return apt_message_parser_run(parser->base,stream,(void**)message);
+	apt_message_status_e status = apt_message_parser_run(parser->base,stream,(void**)message);
+	if(message && *message) {
+		/* the message owns the references to the buffers it refers to (zero-copy mode) */
+		(*message)->buffer_refs = apt_message_parser_buffer_refs_get(parser->base);
+	}
+	return status;
 }
 
 /** Create message and read start line */
@@ -26,6 +26,7 @@
 #include "mrcp_start_line.h"
 #include "mrcp_header.h"
 #include "mrcp_generic_header.h"
+#include "apt_text_message.h"
 
 APT_BEGIN_EXTERN_C
 
@@ -48,6 +49,8 @@ struct mrcp_message_t {
 	const mrcp_resource_t *resource;
 	/** Memory pool to allocate memory from */
 	apr_pool_t            *pool;
+	/** References to the receive buffers the message refers to (parsed in zero-copy mode only) */
+	apt_message_buffer_refs_t *buffer_refs;
 };
 
 /**
@@ -106,6 +109,22 @@ MRCP_DECLARE(apt_bool_t) mrcp_message_validate(mrcp_message_t *message);
  */
 MRCP_DECLARE(void) mrcp_message_destroy(mrcp_message_t *message);
 
+/**
+ * Release the receive buffers an MRCP message parsed in zero-copy mode refers to.
+ * @param message the message to release the buffers of
+ * @remark The header fields and the body of the message must not be accessed afterwards.
+ *         The buffers are otherwise released as the connection the message is received
+ *         over is destroyed. A received buffer is freed once no message refers to it.
+ */
+MRCP_DECLARE(void) mrcp_message_buffers_release(mrcp_message_t *message);
+
+/**
+ * Retain the receive buffers an MRCP message parsed in zero-copy mode refers to as long as the pool.
+ * @param message the message to retain the buffers of
+ * @param pool the pool, the buffers are released as it is destroyed (unless released before)
+ */
+MRCP_DECLARE(void) mrcp_message_buffers_bind(mrcp_message_t *message, apr_pool_t *pool);
+
 
 /**
  * Get MRCP generic header.
@@ -37,6 +37,13 @@ static const apt_str_table_item_t generic_header_string_table[] = {
 	{{"Set-Cookie2",               11},10}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t generic_header_string_hash_buckets[32] = {
+	9,0,0,16,14,3,0,5,0,0,4,6,0,8,7,0,
+	1,0,13,15,0,0,2,0,0,0,11,10,12,0,0,0
+};
+static const apt_str_table_hash_t generic_header_string_hash = {101,31,generic_header_string_hash_buckets};
+
 /** Parse mrcp request-id list */
 static apt_bool_t mrcp_request_id_list_parse(mrcp_request_id_list_t *request_id_list, const apt_str_t *value)
 {
@@ -315,7 +322,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_generic_header_generate,
 	mrcp_generic_header_duplicate,
 	generic_header_string_table,
-	GENERIC_HEADER_COUNT
+	GENERIC_HEADER_COUNT,
+	&generic_header_string_hash
 };
 
 
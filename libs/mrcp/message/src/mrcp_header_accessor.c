@@ -25,7 +25,11 @@ MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_parse(mrcp_header_accessor_t *a
 		return FALSE;
 	}
 
-	id = apt_string_table_id_find(accessor->vtable->field_table,accessor->vtable->field_count,&header_field->name);
+	id = apt_string_table_hash_id_find(
+			accessor->vtable->field_table,
+			accessor->vtable->field_count,
+			accessor->vtable->field_hash,
+			&header_field->name);
 	if(id >= accessor->vtable->field_count) {
 		return FALSE;
 	}
@@ -74,18 +74,20 @@ MRCP_DECLARE(apt_bool_t) mrcp_message_resource_set(mrcp_message_t *message, cons
 	
 	/* associate method_name and method_id */
 	if(message->start_line.message_type == MRCP_MESSAGE_TYPE_REQUEST) {
-		message->start_line.method_id = apt_string_table_id_find(
+		message->start_line.method_id = apt_string_table_hash_id_find(
 			resource->get_method_str_table(message->start_line.version),
 			resource->method_count,
+			resource->get_method_str_hash ? resource->get_method_str_hash(message->start_line.version) : NULL,
 			&message->start_line.method_name);
 		if(message->start_line.method_id >= resource->method_count) {
 			return FALSE;
 		}
 	}
 	else if(message->start_line.message_type == MRCP_MESSAGE_TYPE_EVENT) {
-		message->start_line.method_id = apt_string_table_id_find(
+		message->start_line.method_id = apt_string_table_hash_id_find(
 			resource->get_event_str_table(message->start_line.version),
 			resource->event_count,
+			resource->get_event_str_hash ? resource->get_event_str_hash(message->start_line.version) : NULL,
 			&message->start_line.method_name);
 		if(message->start_line.method_id >= resource->event_count) {
 			return FALSE;
@@ -105,6 +107,7 @@ MRCP_DECLARE(mrcp_message_t*) mrcp_message_create(apr_pool_t *pool)
 	apt_string_reset(&message->body);
 	message->resource = NULL;
 	message->pool = pool;
+	message->buffer_refs = NULL;
 	return message;
 }
 
@@ -157,6 +160,24 @@ MRCP_DECLARE(void) mrcp_message_destroy(mrcp_message_t *message)
 {
 	apt_string_reset(&message->body);
 	mrcp_message_header_destroy(&message->header);
+	mrcp_message_buffers_release(message);
+}
+
+/** Release the receive buffers the message refers to */
+MRCP_DECLARE(void) mrcp_message_buffers_release(mrcp_message_t *message)
+{
+	if(message->buffer_refs) {
+		apt_message_buffer_refs_release(message->buffer_refs);
+		message->buffer_refs = NULL;
+	}
+}
+
+/** Retain the receive buffers the message refers to as long as the pool */
+MRCP_DECLARE(void) mrcp_message_buffers_bind(mrcp_message_t *message, apr_pool_t *pool)
+{
+	if(message->buffer_refs) {
+		message->buffer_refs = apt_message_buffer_refs_transfer(message->buffer_refs,pool);
+	}
 }
 
 /** Validate MRCP message */
@@ -39,6 +39,12 @@ static const apt_str_table_item_t mrcp_request_state_string_table[] = {
 	{{"PENDING",     7},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t mrcp_request_state_string_hash_buckets[8] = {
+	1,0,0,3,0,0,2,0
+};
+static const apt_str_table_hash_t mrcp_request_state_string_hash = {0,7,mrcp_request_state_string_hash_buckets};
+
 
 /** Parse MRCP version */
 static mrcp_version_e mrcp_version_parse(const apt_str_t *field)
@@ -87,7 +93,7 @@ static apt_bool_t mrcp_version_generate(mrcp_version_e version, apt_text_stream_
 /** Parse MRCP request-state used in MRCP response and event */
 static APR_INLINE mrcp_request_state_e mrcp_request_state_parse(const apt_str_t *request_state_str)
 {
-	return apt_string_table_id_find(mrcp_request_state_string_table,MRCP_REQUEST_STATE_COUNT,request_state_str);
+	return apt_string_table_hash_id_find(mrcp_request_state_string_table,MRCP_REQUEST_STATE_COUNT,&mrcp_request_state_string_hash,request_state_str);
 }
 
 /** Generate MRCP request-state used in MRCP response and event */
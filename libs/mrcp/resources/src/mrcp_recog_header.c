@@ -65,6 +65,19 @@ static const apt_str_table_item_t v1_recog_header_string_table[] = {
 	{{"Abort-Phrase-Enrollment",          23},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v1_recog_header_string_hash_buckets[128] = {
+	25,0,45,0,0,0,37,0,0,0,0,31,1,0,0,0,
+	0,0,30,42,33,0,12,0,0,0,0,10,28,0,7,5,
+	22,0,0,9,34,0,32,0,36,29,2,0,11,0,0,0,
+	0,0,0,0,0,0,24,0,0,0,0,15,0,0,0,0,
+	44,0,6,0,18,0,0,27,0,0,16,38,0,0,0,0,
+	40,0,0,20,0,0,0,0,43,17,0,0,0,0,23,0,
+	3,0,13,0,0,4,39,14,0,0,0,0,26,0,0,0,
+	0,0,0,0,21,8,35,0,0,41,0,0,19,0,0,0
+};
+static const apt_str_table_hash_t v1_recog_header_string_hash = {3935,127,v1_recog_header_string_hash_buckets};
+
 /** String table of MRCPv2 recognizer header fields (mrcp_recog_header_id) */
 static const apt_str_table_item_t v2_recog_header_string_table[] = {
 	{{"Confidence-Threshold",             20},16},
@@ -114,6 +127,19 @@ static const apt_str_table_item_t v2_recog_header_string_table[] = {
 	{{"Abort-Phrase-Enrollment",          23},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v2_recog_header_string_hash_buckets[128] = {
+	25,0,45,0,0,0,37,0,0,0,0,31,1,0,0,0,
+	10,0,30,42,33,0,12,0,0,0,0,0,28,0,0,5,
+	22,0,0,9,34,0,32,0,36,29,2,0,11,0,0,0,
+	0,0,0,0,0,0,24,0,0,0,0,15,0,0,0,0,
+	44,0,6,0,18,0,0,27,0,0,16,38,0,0,0,0,
+	40,0,0,20,0,0,0,0,43,17,0,0,0,0,23,0,
+	3,0,13,0,0,4,39,14,0,0,0,0,26,0,0,0,
+	0,0,0,0,21,8,35,0,0,41,0,0,19,7,0,0
+};
+static const apt_str_table_hash_t v2_recog_header_string_hash = {3935,127,v2_recog_header_string_hash_buckets};
+
 /** String table of MRCPv1 recognizer completion-cause fields (mrcp_recog_completion_cause_e) */
 static const apt_str_table_item_t v1_completion_cause_string_table[] = {
 	{{"success",                     7},1},
@@ -747,7 +773,8 @@ static const mrcp_header_vtable_t v1_vtable = {
 	mrcp_v1_recog_header_generate,
 	mrcp_recog_header_duplicate,
 	v1_recog_header_string_table,
-	RECOGNIZER_HEADER_COUNT
+	RECOGNIZER_HEADER_COUNT,
+	&v1_recog_header_string_hash
 };
 
 static const mrcp_header_vtable_t v2_vtable = {
@@ -757,7 +784,8 @@ static const mrcp_header_vtable_t v2_vtable = {
 	mrcp_v2_recog_header_generate,
 	mrcp_recog_header_duplicate,
 	v2_recog_header_string_table,
-	RECOGNIZER_HEADER_COUNT
+	RECOGNIZER_HEADER_COUNT,
+	&v2_recog_header_string_hash
 };
 
 const mrcp_header_vtable_t* mrcp_recog_header_vtable_get(mrcp_version_e version)
@@ -35,6 +35,13 @@ static const apt_str_table_item_t v1_recog_method_string_table[] = {
 	{{"DELETE-PHRASE",            13},2}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v1_recog_method_string_hash_buckets[32] = {
+	12,4,0,0,7,0,0,0,6,11,0,3,0,0,0,8,
+	13,0,10,1,0,0,0,0,0,0,9,0,2,0,5,0
+};
+static const apt_str_table_hash_t v1_recog_method_string_hash = {27,31,v1_recog_method_string_hash_buckets};
+
 /** String table of MRCPv2 recognizer methods (mrcp_recognizer_method_id) */
 static const apt_str_table_item_t v2_recog_method_string_table[] = {
 	{{"SET-PARAMS",               10},10},
@@ -52,6 +59,13 @@ static const apt_str_table_item_t v2_recog_method_string_table[] = {
 	{{"DELETE-PHRASE",            13},2}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v2_recog_method_string_hash_buckets[32] = {
+	12,4,7,0,0,0,0,0,6,11,0,3,0,0,0,8,
+	13,0,10,1,0,0,0,0,0,0,9,0,2,0,5,0
+};
+static const apt_str_table_hash_t v2_recog_method_string_hash = {27,31,v2_recog_method_string_hash_buckets};
+
 /** String table of MRCP recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v1_recog_event_string_table[] = {
 	{{"START-OF-SPEECH",          15},0},
@@ -59,6 +73,12 @@ static const apt_str_table_item_t v1_recog_event_string_table[] = {
 	{{"INTERPRETATION-COMPLETE",  23},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v1_recog_event_string_hash_buckets[8] = {
+	0,2,0,3,1,0,0,0
+};
+static const apt_str_table_hash_t v1_recog_event_string_hash = {1,7,v1_recog_event_string_hash_buckets};
+
 /** String table of MRCPv2 recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v2_recog_event_string_table[] = {
 	{{"START-OF-INPUT",           14},0},
@@ -66,6 +86,12 @@ static const apt_str_table_item_t v2_recog_event_string_table[] = {
 	{{"INTERPRETATION-COMPLETE",  23},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t v2_recog_event_string_hash_buckets[8] = {
+	1,2,0,3,0,0,0,0
+};
+static const apt_str_table_hash_t v2_recog_event_string_hash = {1,7,v2_recog_event_string_hash_buckets};
+
 
 static APR_INLINE const apt_str_table_item_t* recog_method_string_table_get(mrcp_version_e version)
 {
@@ -75,6 +101,14 @@ static APR_INLINE const apt_str_table_item_t* recog_method_string_table_get(mrcp
 	return v2_recog_method_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* recog_method_string_hash_get(mrcp_version_e version)
+{
+	if(version == MRCP_VERSION_1) {
+		return &v1_recog_method_string_hash;
+	}
+	return &v2_recog_method_string_hash;
+}
+
 static APR_INLINE const apt_str_table_item_t* recog_event_string_table_get(mrcp_version_e version)
 {
 	if(version == MRCP_VERSION_1) {
@@ -83,6 +117,14 @@ static APR_INLINE const apt_str_table_item_t* recog_event_string_table_get(mrcp_
 	return v2_recog_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* recog_event_string_hash_get(mrcp_version_e version)
+{
+	if(version == MRCP_VERSION_1) {
+		return &v1_recog_event_string_hash;
+	}
+	return &v2_recog_event_string_hash;
+}
+
 /** Create MRCP recognizer resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_recog_resource_create(apr_pool_t *pool)
 {
@@ -92,6 +134,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_recog_resource_create(apr_pool_t *pool)
 	resource->event_count = RECOGNIZER_EVENT_COUNT;
 	resource->get_method_str_table = recog_method_string_table_get;
 	resource->get_event_str_table = recog_event_string_table_get;
+	resource->get_method_str_hash = recog_method_string_hash_get;
+	resource->get_event_str_hash = recog_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_recog_header_vtable_get;
 	return resource;
 }
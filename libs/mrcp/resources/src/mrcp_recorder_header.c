@@ -35,6 +35,13 @@ static const apt_str_table_item_t recorder_header_string_table[] = {
 	{{"New-Audio-Channel",    17},2}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t recorder_header_string_hash_buckets[32] = {
+	12,4,3,0,0,0,0,14,1,0,7,8,0,11,0,15,
+	0,0,0,5,13,0,6,0,9,0,10,0,2,0,0,0
+};
+static const apt_str_table_hash_t recorder_header_string_hash = {11,31,recorder_header_string_hash_buckets};
+
 /** String table of recorder completion-cause fields (mrcp_recorder_completion_cause_e) */
 static const apt_str_table_item_t completion_cause_string_table[] = {
 	{{"success-silence",  15},8},
@@ -264,7 +271,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_recorder_header_generate,
 	mrcp_recorder_header_duplicate,
 	recorder_header_string_table,
-	RECORDER_HEADER_COUNT
+	RECORDER_HEADER_COUNT,
+	&recorder_header_string_hash
 };
 
 const mrcp_header_vtable_t* mrcp_recorder_header_vtable_get(mrcp_version_e version)
@@ -27,22 +27,44 @@ static const apt_str_table_item_t recorder_method_string_table[] = {
 	{{"START-INPUT-TIMERS", 18},2}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t recorder_method_string_hash_buckets[16] = {
+	0,0,0,0,0,2,3,0,4,0,0,0,0,1,5,0
+};
+static const apt_str_table_hash_t recorder_method_string_hash = {6,15,recorder_method_string_hash_buckets};
+
 /** String table of MRCP recorder events (mrcp_recorder_event_id) */
 static const apt_str_table_item_t recorder_event_string_table[] = {
 	{{"START-OF-INPUT",     14},0},
 	{{"RECORD-COMPLETE",    15},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t recorder_event_string_hash_buckets[4] = {
+	2,0,0,1
+};
+static const apt_str_table_hash_t recorder_event_string_hash = {0,3,recorder_event_string_hash_buckets};
+
 static APR_INLINE const apt_str_table_item_t* recorder_method_string_table_get(mrcp_version_e version)
 {
 	return recorder_method_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* recorder_method_string_hash_get(mrcp_version_e version)
+{
+	return &recorder_method_string_hash;
+}
+
 static APR_INLINE const apt_str_table_item_t* recorder_event_string_table_get(mrcp_version_e version)
 {
 	return recorder_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* recorder_event_string_hash_get(mrcp_version_e version)
+{
+	return &recorder_event_string_hash;
+}
+
 /** Create MRCP recorder resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_recorder_resource_create(apr_pool_t *pool)
 {
@@ -52,6 +74,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_recorder_resource_create(apr_pool_t *pool)
 	resource->event_count = RECORDER_EVENT_COUNT;
 	resource->get_method_str_table = recorder_method_string_table_get;
 	resource->get_event_str_table = recorder_event_string_table_get;
+	resource->get_method_str_hash = recorder_method_string_hash_get;
+	resource->get_event_str_hash = recorder_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_recorder_header_vtable_get;
 	return resource;
 }
@@ -41,6 +41,15 @@ static const apt_str_table_item_t synth_header_string_table[] = {
 	{{"Lexicon-Search-Order",20},2}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t synth_header_string_hash_buckets[64] = {
+	21,0,5,9,18,10,0,12,0,0,0,0,0,8,19,0,
+	0,3,17,0,0,0,0,2,0,0,0,11,15,4,0,0,
+	0,0,14,0,0,0,0,0,16,0,0,0,0,0,0,0,
+	7,0,0,0,1,0,6,0,0,13,0,0,0,20,0,0
+};
+static const apt_str_table_hash_t synth_header_string_hash = {29,63,synth_header_string_hash_buckets};
+
 /** String table of MRCP speech-unit fields (mrcp_speech_unit_t) */
 static const apt_str_table_item_t speech_unit_string_table[] = {
 	{{"Second",   6},2},
@@ -49,6 +58,12 @@ static const apt_str_table_item_t speech_unit_string_table[] = {
 	{{"Paragraph",9},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t speech_unit_string_hash_buckets[8] = {
+	0,0,4,0,3,1,2,0
+};
+static const apt_str_table_hash_t speech_unit_string_hash = {1,7,speech_unit_string_hash_buckets};
+
 /** String table of MRCP voice-gender fields (mrcp_voice_gender_t) */
 static const apt_str_table_item_t voice_gender_string_table[] = {
 	{{"male",   4},0},
@@ -56,6 +71,12 @@ static const apt_str_table_item_t voice_gender_string_table[] = {
 	{{"neutral",7},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t voice_gender_string_hash_buckets[8] = {
+	0,0,0,3,0,1,0,2
+};
+static const apt_str_table_hash_t voice_gender_string_hash = {0,7,voice_gender_string_hash_buckets};
+
 /** String table of MRCP prosody-volume fields (mrcp_prosody_volume_t) */
 static const apt_str_table_item_t prosody_volume_string_table[] = {
 	{{"silent", 6},1},
@@ -67,6 +88,12 @@ static const apt_str_table_item_t prosody_volume_string_table[] = {
 	{{"default",7},0} 
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t prosody_volume_string_hash_buckets[16] = {
+	0,0,6,0,0,0,2,5,4,0,3,1,0,7,0,0
+};
+static const apt_str_table_hash_t prosody_volume_string_hash = {2,15,prosody_volume_string_hash_buckets};
+
 /** String table of MRCP prosody-rate fields (mrcp_prosody_rate_t) */
 static const apt_str_table_item_t prosody_rate_string_table[] = {
 	{{"x-slow", 6},3},
@@ -77,6 +104,12 @@ static const apt_str_table_item_t prosody_rate_string_table[] = {
 	{{"default",7},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t prosody_rate_string_hash_buckets[16] = {
+	0,2,0,0,0,3,0,0,1,6,0,4,0,0,0,5
+};
+static const apt_str_table_hash_t prosody_rate_string_hash = {9,15,prosody_rate_string_hash_buckets};
+
 /** String table of MRCP synthesizer completion-cause fields (mrcp_synthesizer_completion_cause_t) */
 static const apt_str_table_item_t completion_cause_string_table[] = {
 	{{"normal",               6},0},
@@ -90,9 +123,9 @@ static const apt_str_table_item_t completion_cause_string_table[] = {
 };
 
 
-static APR_INLINE apr_size_t apt_string_table_value_parse(const apt_str_table_item_t *string_table, apr_size_t count, const apt_str_t *value)
+static APR_INLINE apr_size_t apt_string_table_value_parse(const apt_str_table_item_t *string_table, apr_size_t count, const apt_str_table_hash_t *hash, const apt_str_t *value)
 {
-	return apt_string_table_id_find(string_table,count,value);
+	return apt_string_table_hash_id_find(string_table,count,hash,value);
 }
 
 static apt_bool_t apt_string_table_value_pgenerate(const apt_str_table_item_t *string_table, apr_size_t count, apr_size_t id, apt_str_t *str, apr_pool_t *pool)
@@ -125,7 +158,7 @@ static apt_bool_t mrcp_prosody_param_rate_parse(mrcp_prosody_rate_t *prosody_rat
 		prosody_rate->value.relative = apt_float_value_parse(value);
 	}
 	else {
-		prosody_rate->value.label = apt_string_table_value_parse(prosody_rate_string_table,PROSODY_RATE_COUNT,value);
+		prosody_rate->value.label = apt_string_table_value_parse(prosody_rate_string_table,PROSODY_RATE_COUNT,&prosody_rate_string_hash,value);
 	}
 
 	return TRUE;
@@ -174,7 +207,7 @@ static apt_bool_t mrcp_prosody_param_volume_parse(mrcp_prosody_volume_t *prosody
 		prosody_volume->value.numeric = apt_float_value_parse(value);
 	}
 	else {
-		prosody_volume->value.label = apt_string_table_value_parse(prosody_volume_string_table,PROSODY_VOLUME_COUNT,value);
+		prosody_volume->value.label = apt_string_table_value_parse(prosody_volume_string_table,PROSODY_VOLUME_COUNT,&prosody_volume_string_hash,value);
 	}
 
 	return TRUE;
@@ -232,7 +265,7 @@ static apt_bool_t mrcp_speech_length_value_parse(mrcp_speech_length_value_t *spe
 		if(apt_text_field_read(&stream,APT_TOKEN_SP,TRUE,&str) == FALSE) {
 			return FALSE;
 		}
-		numeric->unit = apt_string_table_value_parse(speech_unit_string_table,SPEECH_UNIT_COUNT,&str);
+		numeric->unit = apt_string_table_value_parse(speech_unit_string_table,SPEECH_UNIT_COUNT,&speech_unit_string_hash,&str);
 	}
 	return TRUE;
 }
@@ -322,7 +355,7 @@ static apt_bool_t mrcp_synth_header_parse(mrcp_header_accessor_t *accessor, apr_
 			synth_header->completion_reason = *value;
 			break;
 		case SYNTHESIZER_HEADER_VOICE_GENDER:
-			synth_header->voice_param.gender = apt_string_table_value_parse(voice_gender_string_table,VOICE_GENDER_COUNT,value);
+			synth_header->voice_param.gender = apt_string_table_value_parse(voice_gender_string_table,VOICE_GENDER_COUNT,&voice_gender_string_hash,value);
 			break;
 		case SYNTHESIZER_HEADER_VOICE_AGE:
 			synth_header->voice_param.age = apt_size_value_parse(value);
@@ -547,7 +580,8 @@ static const mrcp_header_vtable_t vtable = {
 	mrcp_synth_header_generate,
 	mrcp_synth_header_duplicate,
 	synth_header_string_table,
-	SYNTHESIZER_HEADER_COUNT
+	SYNTHESIZER_HEADER_COUNT,
+	&synth_header_string_hash
 };
 
 const mrcp_header_vtable_t* mrcp_synth_header_vtable_get(mrcp_version_e version)
@@ -31,22 +31,45 @@ static const apt_str_table_item_t synth_method_string_table[] = {
 	{{"DEFINE-LEXICON",   14},0}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t synth_method_string_hash_buckets[32] = {
+	8,0,2,0,0,9,0,0,0,5,0,0,7,0,0,0,
+	0,3,0,6,0,0,4,0,0,0,0,0,0,0,1,0
+};
+static const apt_str_table_hash_t synth_method_string_hash = {0,31,synth_method_string_hash_buckets};
+
 /** String table of MRCP synthesizer events (mrcp_synthesizer_event_id) */
 static const apt_str_table_item_t synth_event_string_table[] = {
 	{{"SPEECH-MARKER", 13},3},
 	{{"SPEAK-COMPLETE",14},3}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t synth_event_string_hash_buckets[4] = {
+	0,2,1,0
+};
+static const apt_str_table_hash_t synth_event_string_hash = {0,3,synth_event_string_hash_buckets};
+
 static APR_INLINE const apt_str_table_item_t* synth_method_string_table_get(mrcp_version_e version)
 {
 	return synth_method_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* synth_method_string_hash_get(mrcp_version_e version)
+{
+	return &synth_method_string_hash;
+}
+
 static APR_INLINE const apt_str_table_item_t* synth_event_string_table_get(mrcp_version_e version)
 {
 	return synth_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* synth_event_string_hash_get(mrcp_version_e version)
+{
+	return &synth_event_string_hash;
+}
+
 /** Create MRCP synthesizer resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_synth_resource_create(apr_pool_t *pool)
 {
@@ -56,6 +79,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_synth_resource_create(apr_pool_t *pool)
 	resource->event_count = SYNTHESIZER_EVENT_COUNT;
 	resource->get_method_str_table = synth_method_string_table_get;
 	resource->get_event_str_table = synth_event_string_table_get;
+	resource->get_method_str_hash = synth_method_string_hash_get;
+	resource->get_event_str_hash = synth_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_synth_header_vtable_get;
 	return resource;
 }
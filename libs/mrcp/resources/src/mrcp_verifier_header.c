@@ -41,6 +41,15 @@ static const apt_str_table_item_t verifier_header_string_table[] = {
 	{{"Start-Input-Timers",          18},1}
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t verifier_header_string_hash_buckets[64] = {
+	11,14,2,0,0,0,0,0,15,4,0,0,0,0,16,0,
+	0,17,8,0,0,19,0,0,0,5,0,0,0,1,0,0,
+	0,7,0,0,0,0,0,0,0,0,0,21,0,0,0,10,
+	0,0,0,0,3,0,18,0,20,0,6,0,9,0,12,13
+};
+static const apt_str_table_hash_t verifier_header_string_hash = {34,63,verifier_header_string_hash_buckets};
+
 /** String table of MRCP verifier completion-cause fields (mrcp_verifier_completion_cause_e) */
 static const apt_str_table_item_t completion_cause_string_table[] = {
 	{{"success",                 7},2},
@@ -335,7 +344,8 @@ static const mrcp_header_vtable_t header_vtable = {
 	mrcp_verifier_header_generate,
 	mrcp_verifier_header_duplicate,
 	verifier_header_string_table,
-	VERIFIER_HEADER_COUNT
+	VERIFIER_HEADER_COUNT,
+	&verifier_header_string_hash
 };
 
 const mrcp_header_vtable_t* mrcp_verifier_header_vtable_get(mrcp_version_e version)
@@ -35,22 +35,45 @@ static const apt_str_table_item_t verifier_method_string_table[] = {
 	{{"GET-INTERMEDIATE-RESULT",23},4},
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t verifier_method_string_hash_buckets[32] = {
+	10,0,13,0,3,6,0,0,0,0,9,0,0,4,0,12,
+	0,1,8,0,7,5,0,0,0,0,2,11,0,0,0,0
+};
+static const apt_str_table_hash_t verifier_method_string_hash = {12,31,verifier_method_string_hash_buckets};
+
 /** String table of MRCP verifier events (mrcp_verifier_event_id) */
 static const apt_str_table_item_t verifier_event_string_table[] = {
 	{{"START-OF-INPUT",       14},0},
 	{{"VERIFICATION-COMPLETE",21},0},
 };
 
+/** Perfect hash of the string table above (generated by strtablegen) */
+static const apr_byte_t verifier_event_string_hash_buckets[4] = {
+	2,0,0,1
+};
+static const apt_str_table_hash_t verifier_event_string_hash = {0,3,verifier_event_string_hash_buckets};
+
 static APR_INLINE const apt_str_table_item_t* verifier_method_string_table_get(mrcp_version_e version)
 {
 	return verifier_method_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* verifier_method_string_hash_get(mrcp_version_e version)
+{
+	return &verifier_method_string_hash;
+}
+
 static APR_INLINE const apt_str_table_item_t* verifier_event_string_table_get(mrcp_version_e version)
 {
 	return verifier_event_string_table;
 }
 
+static APR_INLINE const apt_str_table_hash_t* verifier_event_string_hash_get(mrcp_version_e version)
+{
+	return &verifier_event_string_hash;
+}
+
 
 /** Create MRCP verifier resource */
 MRCP_DECLARE(mrcp_resource_t*) mrcp_verifier_resource_create(apr_pool_t *pool)
@@ -61,6 +84,8 @@ MRCP_DECLARE(mrcp_resource_t*) mrcp_verifier_resource_create(apr_pool_t *pool)
 	resource->event_count = VERIFIER_EVENT_COUNT;
 	resource->get_method_str_table = verifier_method_string_table_get;
 	resource->get_event_str_table = verifier_event_string_table_get;
+	resource->get_method_str_hash = verifier_method_string_hash_get;
+	resource->get_event_str_hash = verifier_event_string_hash_get;
 	resource->get_resource_header_vtable = mrcp_verifier_header_vtable_get;
 	return resource;
 }
@@ -96,6 +96,26 @@ MRCP_DECLARE(void) mrcp_client_connection_tx_size_set(
 								mrcp_connection_agent_t *agent,
 								apr_size_t size);
 
+/**
+ * Set high-water mark of the output queue.
+ * @param agent the agent to set the parameter for
+ * @param size the max number of bytes pending per connection (0 - unlimited)
+ * @remark Requests sent to a connection, which has reached the mark, are failed.
+ */
+MRCP_DECLARE(void) mrcp_client_connection_tx_hwm_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size);
+
+/**
+ * Set zero-copy mode of parsing received messages.
+ * @param agent the agent to set the parameter for
+ * @param zero_copy whether header fields and body of received messages should refer to the rx buffer rather than be copied
+ * @remark Each rx buffer, parsed messages refer to, is retained until the messages are destroyed.
+ */
+MRCP_DECLARE(void) mrcp_client_connection_zero_copy_set(
+								mrcp_connection_agent_t *agent,
+								apt_bool_t zero_copy);
+
 /**
  * Set max shared use count for an MRCPv2 connection.
  * @param agent the agent to set the parameter for
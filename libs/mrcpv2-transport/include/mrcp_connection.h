@@ -29,13 +29,36 @@
 #endif
 #include <apr_ring.h>
 #include "mrcp_connection_types.h"
+#include "mrcp_header.h"
 #include "mrcp_stream.h"
+#include "apt_poller_task.h"
+#include "apt_handle_table.h"
 
 APT_BEGIN_EXTERN_C
 
 /** Size of the buffer used for MRCP rx/tx stream */
 #define MRCP_STREAM_BUFFER_SIZE 1024
 
+/** Default high-water mark of the output queue in bytes */
+#define MRCP_TX_QUEUE_DEFAULT_HWM (1024 * 1024)
+
+/** Opaque chunk of data pending transmission */
+typedef struct mrcp_tx_chunk_t mrcp_tx_chunk_t;
+
+/** Opaque request received in zero-copy mode, which is pending completion */
+typedef struct mrcp_rx_request_t mrcp_rx_request_t;
+
+/** Table of control channels looked up by Channel-Identifier */
+typedef struct mrcp_channel_table_t mrcp_channel_table_t;
+
+/** Table of control channels looked up by Channel-Identifier */
+struct mrcp_channel_table_t {
+	/** Channels by identifier (foreign identifiers are looked up here only) */
+	apr_hash_t         *hash;
+	/** Lists of channels by the handle encoded in the session identifier */
+	apt_handle_table_t *handles;
+};
+
 /** MRCPv2 connection */
 struct mrcp_connection_t {
 	/** Ring entry */
@@ -68,7 +91,7 @@ struct mrcp_connection_t {
 	void             *agent;
 
 	/** Table of control channels */
-	apr_hash_t       *channel_table;
+	mrcp_channel_table_t channel_table;
 
 	/** Rx buffer */
 	char             *rx_buffer;
@@ -76,6 +99,12 @@ struct mrcp_connection_t {
 	apr_size_t        rx_buffer_size;
 	/** Rx stream */
 	apt_text_stream_t rx_stream;
+	/** Rx buffer shared with parsed messages (zero-copy mode only) */
+	apt_message_buffer_t *rx_shared_buffer;
+	/** Requests referring to rx buffers until completed (zero-copy mode only) */
+	APR_RING_HEAD(mrcp_rx_request_head_t, mrcp_rx_request_t) rx_requests;
+	/** List of request entries available for reuse */
+	APR_RING_HEAD(mrcp_rx_request_free_head_t, mrcp_rx_request_t) rx_free_list;
 	/** MRCP parser */
 	mrcp_parser_t    *parser;
 
@@ -86,6 +115,15 @@ struct mrcp_connection_t {
 	/** MRCP generator */
 	mrcp_generator_t *generator;
 
+	/** Output queue (chunks of tx_buffer_size) pending transmission */
+	APR_RING_HEAD(mrcp_tx_chunk_head_t, mrcp_tx_chunk_t) tx_queue;
+	/** List of chunks available for reuse */
+	APR_RING_HEAD(mrcp_tx_chunk_free_head_t, mrcp_tx_chunk_t) tx_free_list;
+	/** Number of bytes pending in the output queue */
+	apr_size_t        tx_queued_bytes;
+	/** High-water mark of the output queue (0 - unlimited) */
+	apr_size_t        tx_hwm;
+
 	/** Inactivity timer  */
 	apt_timer_t      *inactivity_timer;
 	/** Termination timer  */
@@ -98,11 +136,30 @@ mrcp_connection_t* mrcp_connection_create(void);
 /** Destroy MRCP connection. */
 void mrcp_connection_destroy(mrcp_connection_t *connection);
 
+/** Allocate rx buffer of MRCP connection, optionally shared with parsed messages (zero-copy mode). */
+apt_bool_t mrcp_connection_rx_buffer_create(mrcp_connection_t *connection, apr_size_t size, apt_bool_t zero_copy);
+
+/** Scroll rx stream of MRCP connection, once received data has been parsed. */
+apt_bool_t mrcp_connection_rx_stream_scroll(mrcp_connection_t *connection);
+
+/**
+ * Keep track of request received in zero-copy mode, so that its rx buffers are released once it is completed.
+ * @remark Neither the server nor the engine may access the data of the request once a response or an event
+ *         completing it is sent, or the channel is removed.
+ */
+apt_bool_t mrcp_connection_rx_request_add(mrcp_connection_t *connection, mrcp_control_channel_t *channel, mrcp_message_t *request);
+
+/** Release rx buffers of the requests a response or an event sent over control channel completes. */
+void mrcp_connection_rx_requests_complete(mrcp_connection_t *connection, mrcp_control_channel_t *channel, const mrcp_message_t *message);
+
+/** Release rx buffers of the requests pending completion over control channel. */
+void mrcp_connection_rx_requests_release(mrcp_connection_t *connection, mrcp_control_channel_t *channel);
+
 /** Add Control Channel to MRCP connection. */
 apt_bool_t mrcp_connection_channel_add(mrcp_connection_t *connection, mrcp_control_channel_t *channel);
 
 /** Find Control Channel by Channel Identifier. */
-mrcp_control_channel_t* mrcp_connection_channel_find(const mrcp_connection_t *connection, const apt_str_t *identifier);
+mrcp_control_channel_t* mrcp_connection_channel_find(const mrcp_connection_t *connection, const mrcp_channel_id *channel_id);
 
 /** Remove Control Channel from MRCP connection. */
 apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_control_channel_t *channel);
@@ -110,6 +167,33 @@ apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_co
 /** Raise disconnect event for each channel from the specified connection. */
 apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const mrcp_connection_event_vtable_t *vtable);
 
+/** Check whether the output queue of MRCP connection has reached the high-water mark. */
+apt_bool_t mrcp_connection_is_congested(const mrcp_connection_t *connection);
+
+/** Initialize table of control channels. */
+void mrcp_channel_table_init(mrcp_channel_table_t *table, apr_pool_t *pool);
+
+/** Add Control Channel to the table under its identifier. */
+void mrcp_channel_table_add(mrcp_channel_table_t *table, mrcp_control_channel_t *channel);
+
+/** Find Control Channel in the table by Channel Identifier (the pool is used for long foreign identifiers only). */
+mrcp_control_channel_t* mrcp_channel_table_find(const mrcp_channel_table_t *table, const mrcp_channel_id *channel_id, apr_pool_t *pool);
+
+/** Remove Control Channel from the table. */
+void mrcp_channel_table_remove(mrcp_channel_table_t *table, mrcp_control_channel_t *channel);
+
+/** Get the number of control channels in the table. */
+static APR_INLINE apr_size_t mrcp_channel_table_count(const mrcp_channel_table_t *table)
+{
+	return apr_hash_count(table->hash);
+}
+
+/** Send data through non-blocking socket, queueing whatever cannot be sent right away. */
+apt_bool_t mrcp_connection_send(mrcp_connection_t *connection, apt_poller_task_t *task, const char *buf, apr_size_t length);
+
+/** Flush the output queue, once the socket is signalled as writable. */
+apt_bool_t mrcp_connection_flush(mrcp_connection_t *connection, apt_poller_task_t *task);
+
 APT_END_EXTERN_C
 
 #endif /* MRCP_CONNECTION_H */
@@ -81,6 +81,10 @@ struct mrcp_control_channel_t {
 	apr_pool_t              *pool;
 	/** Channel identifier (id at resource) */
 	apt_str_t                identifier;
+	/** Handle encoded at the beginning of the identifier (0 - foreign identifier) */
+	apr_uint32_t             handle;
+	/** Next channel of the same handle in the channel table */
+	mrcp_control_channel_t  *handle_next;
 };
 
 /** Send channel add response */
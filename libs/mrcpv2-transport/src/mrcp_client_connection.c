@@ -37,6 +37,8 @@ struct mrcp_connection_agent_t {
 	apr_size_t                            max_shared_use_count;
 	apr_size_t                            tx_buffer_size;
 	apr_size_t                            rx_buffer_size;
+	apr_size_t                            tx_hwm;
+	apt_bool_t                            zero_copy;
 
 	void                                 *obj;
 	const mrcp_connection_event_vtable_t *vtable;
@@ -84,8 +86,10 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_client_connection_agent_create(
 	agent->max_shared_use_count = 100;
 	agent->rx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
 	agent->tx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
+	agent->tx_hwm = MRCP_TX_QUEUE_DEFAULT_HWM;
+	agent->zero_copy = FALSE;
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
+	msg_pool = apt_task_msg_pool_create_static(sizeof(connection_task_msg_t),TASK_MSG_POOL_DEFAULT_SIZE,pool);
 
 	agent->task = apt_poller_task_create(
 					max_connection_count,
@@ -171,6 +175,21 @@ MRCP_DECLARE(void) mrcp_client_connection_tx_size_set(
 	agent->tx_buffer_size = size;
 }
 
+/** Set high-water mark of the output queue */
+MRCP_DECLARE(void) mrcp_client_connection_tx_hwm_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size)
+{
+	agent->tx_hwm = size;
+}
+
+MRCP_DECLARE(void) mrcp_client_connection_zero_copy_set(
+								mrcp_connection_agent_t *agent,
+								apt_bool_t zero_copy)
+{
+	agent->zero_copy = zero_copy;
+}
+
 /** Set max shared use count for an MRCPv2 connection */
 MRCP_DECLARE(void) mrcp_client_connection_max_shared_use_set(
 								mrcp_connection_agent_t *agent,
@@ -219,6 +238,8 @@ MRCP_DECLARE(mrcp_control_channel_t*) mrcp_client_control_channel_create(mrcp_co
 	channel->obj = obj;
 	channel->log_obj = NULL;
 	channel->pool = pool;
+	channel->handle = 0;
+	channel->handle_next = NULL;
 
 	channel->request_timer = apt_poller_task_timer_create(
 								agent->task,
@@ -331,6 +352,10 @@ static mrcp_connection_t* mrcp_client_agent_connection_create(mrcp_connection_ag
 		local_ip,connection->l_sockaddr->port,
 		remote_ip,connection->r_sockaddr->port);
 
+	/* never block the poller task on a slow peer, whatever cannot be sent is queued */
+	apr_socket_opt_set(connection->sock, APR_SO_NONBLOCK, 1);
+	apr_socket_timeout_set(connection->sock, 0);
+
 	memset(&connection->sock_pfd,0,sizeof(apr_pollfd_t));
 	connection->sock_pfd.desc_type = APR_POLL_SOCKET;
 	connection->sock_pfd.reqevents = APR_POLLIN;
@@ -352,10 +377,9 @@ static mrcp_connection_t* mrcp_client_agent_connection_create(mrcp_connection_ag
 
 	connection->tx_buffer_size = agent->tx_buffer_size;
 	connection->tx_buffer = apr_palloc(connection->pool,connection->tx_buffer_size+1);
+	connection->tx_hwm = agent->tx_hwm;
 
-	connection->rx_buffer_size = agent->rx_buffer_size;
-	connection->rx_buffer = apr_palloc(connection->pool,connection->rx_buffer_size+1);
-	apt_text_stream_init(&connection->rx_stream,connection->rx_buffer,connection->rx_buffer_size);
+	mrcp_connection_rx_buffer_create(connection,agent->rx_buffer_size,agent->zero_copy);
 
 	if(apt_log_masking_get() != APT_LOG_MASKING_NONE) {
 		connection->verbose = FALSE;
@@ -456,7 +480,7 @@ static apt_bool_t mrcp_client_agent_channel_modify(mrcp_connection_agent_t *agen
 				apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Add Control Channel <%s> %s [%d]",
 						channel->identifier.buf,
 						connection->id,
-						apr_hash_count(connection->channel_table));
+						mrcp_channel_table_count(&connection->channel_table));
 				if(descriptor->connection_type == MRCP_CONNECTION_TYPE_NEW) {
 					/* set connection type to existing for the next offers / if any */
 					descriptor->connection_type = MRCP_CONNECTION_TYPE_EXISTING;
@@ -479,7 +503,7 @@ static apt_bool_t mrcp_client_agent_channel_remove(mrcp_connection_agent_t *agen
 		mrcp_connection_channel_remove(connection,channel);
 		apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Remove Control Channel <%s> [%d]",
 				channel->identifier.buf,
-				apr_hash_count(connection->channel_table));
+				mrcp_channel_table_count(&connection->channel_table));
 		if(!connection->access_count) {
 			mrcp_client_agent_connection_remove(agent,connection);
 			/* set connection to be destroyed on channel destroy */
@@ -507,7 +531,7 @@ static apt_bool_t mrcp_client_agent_disconnect_raise(mrcp_connection_agent_t *ag
 {
 	mrcp_control_channel_t *channel;
 	void *val;
-	apr_hash_index_t *it = apr_hash_first(connection->pool,connection->channel_table);
+	apr_hash_index_t *it = apr_hash_first(connection->pool,connection->channel_table.hash);
 	/* walk through the list of channels and raise disconnect event for them */
 	for(; it; it = apr_hash_next(it)) {
 		apr_hash_this(it,NULL,NULL,&val);
@@ -541,6 +565,16 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 		return FALSE;
 	}
 
+	if(mrcp_connection_is_congested(connection) == TRUE) {
+		/* the server does not read, fail the request rather than grow the output queue unbounded */
+		apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Output Queue Overflow %s [%"APR_SIZE_T_FMT" bytes] " APT_SIDRES_FMT,
+			connection->id,
+			connection->tx_queued_bytes,
+			MRCP_MESSAGE_SIDRES(message));
+		mrcp_client_agent_request_cancel(agent,channel,message);
+		return FALSE;
+	}
+
 	do {
 		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
 		result = mrcp_generator_run(connection->generator,message,&stream);
@@ -554,7 +588,7 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 				connection->verbose == TRUE ? stream.text.length : 0,
 				stream.text.buf);
 
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
+			if(mrcp_connection_send(connection,agent->task,stream.text.buf,stream.text.length) == TRUE) {
 				status = TRUE;
 			}
 			else {
@@ -585,10 +619,7 @@ static apt_bool_t mrcp_client_message_handler(mrcp_connection_t *connection, mrc
 {
 	if(status == APT_MESSAGE_STATUS_COMPLETE) {
 		/* message is completely parsed */
-		mrcp_control_channel_t *channel;
-		apt_str_t identifier;
-		apt_id_resource_generate(&message->channel_id.session_id,&message->channel_id.resource_name,'@',&identifier,message->pool);
-		channel = mrcp_connection_channel_find(connection,&identifier);
+		mrcp_control_channel_t *channel = mrcp_connection_channel_find(connection,&message->channel_id);
 		if(channel) {
 			mrcp_connection_agent_t *agent = connection->agent;
 			if(message->start_line.message_type == MRCP_MESSAGE_TYPE_RESPONSE) {
@@ -597,6 +628,7 @@ static apt_bool_t mrcp_client_message_handler(mrcp_connection_t *connection, mrc
 					apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Unexpected MRCP Response " APT_SIDRES_FMT" [%d]",
 						MRCP_MESSAGE_SIDRES(message),
 						message->start_line.request_id);
+					mrcp_message_buffers_release(message);
 					return FALSE;
 				}
 				if(channel->request_timer) {
@@ -611,13 +643,14 @@ static apt_bool_t mrcp_client_message_handler(mrcp_connection_t *connection, mrc
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Find Channel " APT_SIDRES_FMT" in Connection %s [%d]",
 				MRCP_MESSAGE_SIDRES(message),
 				connection->id,
-				apr_hash_count(connection->channel_table));
+				mrcp_channel_table_count(&connection->channel_table));
+			mrcp_message_buffers_release(message);
 		}
 	}
 	return TRUE;
 }
 
-/* Receive MRCP message through TCP/MRCPv2 connection */
+/* Receive MRCP message through TCP/MRCPv2 connection and flush the output queue */
 static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_t *descriptor)
 {
 	mrcp_connection_agent_t *agent = obj;
@@ -632,6 +665,13 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 	if(!connection || !connection->sock) {
 		return FALSE;
 	}
+
+	if(descriptor->rtnevents & APR_POLLOUT) {
+		mrcp_connection_flush(connection,agent->task);
+		if(!(descriptor->rtnevents & (APR_POLLIN | APR_POLLHUP | APR_POLLERR))) {
+			return TRUE;
+		}
+	}
 	stream = &connection->rx_stream;
 
 	/* calculate offset remaining from the previous receive / if any */
@@ -640,6 +680,9 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 	length = connection->rx_buffer_size - offset;
 
 	status = apr_socket_recv(connection->sock,stream->pos,&length);
+	if(APR_STATUS_IS_EAGAIN(status)) {
+		return TRUE;
+	}
 	if(status == APR_EOF || length == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"TCP/MRCPv2 Peer Disconnected %s",connection->id);
 		apt_poller_task_descriptor_remove(agent->task,&connection->sock_pfd);
@@ -671,7 +714,7 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 	while(apt_text_is_eos(stream) == FALSE);
 
 	/* scroll remaining stream */
-	apt_text_stream_scroll(stream);
+	mrcp_connection_rx_stream_scroll(connection);
 	return TRUE;
 }
 
@@ -15,7 +15,38 @@
  */
 
 #include "mrcp_connection.h"
+#include "mrcp_message.h"
+#include "apt_text_stream.h"
 #include "apt_pool.h"
+#include "apt_log.h"
+
+/** Max number of chunks sent at once by writev */
+#define MRCP_TX_IOVEC_COUNT 16
+
+/** Max length of Channel-Identifier composed on the stack to look up a foreign identifier */
+#define MRCP_CHANNEL_IDENTIFIER_MAX_LENGTH 256
+
+/** Chunk of data pending transmission */
+struct mrcp_tx_chunk_t {
+	/** Ring entry */
+	APR_RING_ENTRY(mrcp_tx_chunk_t) link;
+	/** Buffer of tx_buffer_size */
+	char       *buf;
+	/** Number of bytes stored in the buffer */
+	apr_size_t  length;
+	/** Number of bytes already sent */
+	apr_size_t  offset;
+};
+
+/** Request received in zero-copy mode, which is pending completion */
+struct mrcp_rx_request_t {
+	/** Ring entry */
+	APR_RING_ENTRY(mrcp_rx_request_t) link;
+	/** Control channel the request is received over */
+	mrcp_control_channel_t *channel;
+	/** Request message referring to rx buffers */
+	mrcp_message_t         *message;
+};
 
 mrcp_connection_t* mrcp_connection_create(void)
 {
@@ -36,13 +67,20 @@ mrcp_connection_t* mrcp_connection_create(void)
 	connection->access_count = 0;
 	connection->use_count = 0;
 	APR_RING_ELEM_INIT(connection,link);
-	connection->channel_table = apr_hash_make(pool);
+	mrcp_channel_table_init(&connection->channel_table,pool);
 	connection->parser = NULL;
 	connection->generator = NULL;
 	connection->rx_buffer = NULL;
 	connection->rx_buffer_size = 0;
+	connection->rx_shared_buffer = NULL;
+	APR_RING_INIT(&connection->rx_requests, mrcp_rx_request_t, link);
+	APR_RING_INIT(&connection->rx_free_list, mrcp_rx_request_t, link);
 	connection->tx_buffer = NULL;
 	connection->tx_buffer_size = 0;
+	APR_RING_INIT(&connection->tx_queue, mrcp_tx_chunk_t, link);
+	APR_RING_INIT(&connection->tx_free_list, mrcp_tx_chunk_t, link);
+	connection->tx_queued_bytes = 0;
+	connection->tx_hwm = MRCP_TX_QUEUE_DEFAULT_HWM;
 	connection->inactivity_timer = NULL;
 	connection->termination_timer = NULL;
 
@@ -52,28 +90,150 @@ mrcp_connection_t* mrcp_connection_create(void)
 void mrcp_connection_destroy(mrcp_connection_t *connection)
 {
 	if(connection && connection->pool) {
+		if(connection->rx_shared_buffer) {
+			/* parsed messages release their references as the pool is destroyed */
+			apt_message_buffer_unref(connection->rx_shared_buffer);
+			connection->rx_shared_buffer = NULL;
+		}
 		apr_pool_destroy(connection->pool);
 	}
 }
 
+apt_bool_t mrcp_connection_rx_buffer_create(mrcp_connection_t *connection, apr_size_t size, apt_bool_t zero_copy)
+{
+	connection->rx_buffer_size = size;
+	if(zero_copy == TRUE) {
+		connection->rx_shared_buffer = apt_message_buffer_create(size);
+		if(!connection->rx_shared_buffer) {
+			return FALSE;
+		}
+		connection->rx_buffer = apt_message_buffer_data_get(connection->rx_shared_buffer);
+		if(connection->parser) {
+			mrcp_parser_buffer_set(connection->parser,connection->rx_shared_buffer);
+		}
+	}
+	else {
+		connection->rx_buffer = apr_palloc(connection->pool,size+1);
+	}
+	apt_text_stream_init(&connection->rx_stream,connection->rx_buffer,size);
+	return TRUE;
+}
+
+apt_bool_t mrcp_connection_rx_stream_scroll(mrcp_connection_t *connection)
+{
+	apt_bool_t status;
+	if(!connection->rx_shared_buffer) {
+		return apt_text_stream_scroll(&connection->rx_stream);
+	}
+
+	/* the stream is moved to a new buffer, if parsed messages refer to the current one */
+	status = apt_message_buffer_stream_scroll(&connection->rx_shared_buffer,&connection->rx_stream);
+	connection->rx_buffer = apt_message_buffer_data_get(connection->rx_shared_buffer);
+	if(connection->parser) {
+		mrcp_parser_buffer_set(connection->parser,connection->rx_shared_buffer);
+	}
+	return status;
+}
+
+/** Release rx buffers of the request and recycle its entry */
+static void mrcp_connection_rx_request_release(mrcp_connection_t *connection, mrcp_rx_request_t *rx_request)
+{
+	mrcp_message_buffers_release(rx_request->message);
+	rx_request->message = NULL;
+	rx_request->channel = NULL;
+	APR_RING_REMOVE(rx_request,link);
+	APR_RING_INSERT_TAIL(&connection->rx_free_list,rx_request,mrcp_rx_request_t,link);
+}
+
+apt_bool_t mrcp_connection_rx_request_add(mrcp_connection_t *connection, mrcp_control_channel_t *channel, mrcp_message_t *request)
+{
+	mrcp_rx_request_t *rx_request;
+	if(!request->buffer_refs) {
+		/* the request is parsed in copy mode */
+		return FALSE;
+	}
+
+	if(!APR_RING_EMPTY(&connection->rx_free_list, mrcp_rx_request_t, link)) {
+		rx_request = APR_RING_FIRST(&connection->rx_free_list);
+		APR_RING_REMOVE(rx_request,link);
+	}
+	else {
+		rx_request = apr_palloc(connection->pool,sizeof(mrcp_rx_request_t));
+	}
+	rx_request->channel = channel;
+	rx_request->message = request;
+	APR_RING_INSERT_TAIL(&connection->rx_requests,rx_request,mrcp_rx_request_t,link);
+	return TRUE;
+}
+
+void mrcp_connection_rx_requests_complete(mrcp_connection_t *connection, mrcp_control_channel_t *channel, const mrcp_message_t *message)
+{
+	mrcp_rx_request_t *rx_request;
+	mrcp_rx_request_t *next;
+	mrcp_message_t *request;
+	const mrcp_generic_header_t *generic_header;
+	apt_bool_t terminates_listed = FALSE;
+	if(APR_RING_EMPTY(&connection->rx_requests, mrcp_rx_request_t, link)) {
+		return;
+	}
+	if(message->start_line.message_type == MRCP_MESSAGE_TYPE_REQUEST ||
+		message->start_line.request_state != MRCP_REQUEST_STATE_COMPLETE) {
+		/* the request is still in progress or pending */
+		return;
+	}
+
+	/* a response to STOP or BARGE-IN-OCCURRED also completes the requests it lists */
+	generic_header = mrcp_generic_header_get(message);
+	if(generic_header && mrcp_generic_header_property_check(message,GENERIC_HEADER_ACTIVE_REQUEST_ID_LIST) == TRUE) {
+		terminates_listed = TRUE;
+	}
+
+	rx_request = APR_RING_FIRST(&connection->rx_requests);
+	while(rx_request != APR_RING_SENTINEL(&connection->rx_requests, mrcp_rx_request_t, link)) {
+		next = APR_RING_NEXT(rx_request,link);
+		request = rx_request->message;
+		if(rx_request->channel == channel &&
+			(request->start_line.request_id == message->start_line.request_id ||
+			(terminates_listed == TRUE && active_request_id_list_find(generic_header,request->start_line.request_id) == TRUE))) {
+			/* neither the server nor the engine refer to the data of a completed request */
+			mrcp_connection_rx_request_release(connection,rx_request);
+		}
+		rx_request = next;
+	}
+}
+
+void mrcp_connection_rx_requests_release(mrcp_connection_t *connection, mrcp_control_channel_t *channel)
+{
+	mrcp_rx_request_t *rx_request;
+	mrcp_rx_request_t *next;
+	rx_request = APR_RING_FIRST(&connection->rx_requests);
+	while(rx_request != APR_RING_SENTINEL(&connection->rx_requests, mrcp_rx_request_t, link)) {
+		next = APR_RING_NEXT(rx_request,link);
+		if(rx_request->channel == channel) {
+			mrcp_connection_rx_request_release(connection,rx_request);
+		}
+		rx_request = next;
+	}
+}
+
 apt_bool_t mrcp_connection_channel_add(mrcp_connection_t *connection, mrcp_control_channel_t *channel)
 {
 	if(!connection || !channel) {
 		return FALSE;
 	}
-	apr_hash_set(connection->channel_table,channel->identifier.buf,channel->identifier.length,channel);
+	mrcp_channel_table_add(&connection->channel_table,channel);
 	channel->connection = connection;
 	connection->access_count++;
 	connection->use_count++;
 	return TRUE;
 }
 
-mrcp_control_channel_t* mrcp_connection_channel_find(const mrcp_connection_t *connection, const apt_str_t *identifier)
+mrcp_control_channel_t* mrcp_connection_channel_find(const mrcp_connection_t *connection, const mrcp_channel_id *channel_id)
 {
-	if(!connection || !identifier) {
+	if(!connection || !channel_id) {
 		return NULL;
 	}
-	return apr_hash_get(connection->channel_table,identifier->buf,identifier->length);
+	return mrcp_channel_table_find(&connection->channel_table,channel_id,connection->pool);
 }
 
 apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_control_channel_t *channel)
@@ -81,7 +241,9 @@ apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_co
 	if(!connection || !channel) {
 		return FALSE;
 	}
-	apr_hash_set(connection->channel_table,channel->identifier.buf,channel->identifier.length,NULL);
+	mrcp_channel_table_remove(&connection->channel_table,channel);
+	/* requests still in progress over the channel are not going to complete */
+	mrcp_connection_rx_requests_release(connection,channel);
 	channel->connection = NULL;
 	connection->access_count--;
 	return TRUE;
@@ -92,7 +254,7 @@ apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const
 	if(vtable && vtable->on_disconnect) {
 		mrcp_control_channel_t *channel;
 		void *val;
-		apr_hash_index_t *it = apr_hash_first(connection->pool,connection->channel_table);
+		apr_hash_index_t *it = apr_hash_first(connection->pool,connection->channel_table.hash);
 		/* walk through the list of channels and raise disconnect event for them */
 		for(; it; it = apr_hash_next(it)) {
 			apr_hash_this(it,NULL,NULL,&val);
@@ -104,3 +266,267 @@ apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const
 	}
 	return TRUE;
 }
+
+void mrcp_channel_table_init(mrcp_channel_table_t *table, apr_pool_t *pool)
+{
+	table->hash = apr_hash_make(pool);
+	table->handles = apt_handle_table_create(HANDLE_TABLE_DEFAULT_SIZE,pool);
+}
+
+void mrcp_channel_table_add(mrcp_channel_table_t *table, mrcp_control_channel_t *channel)
+{
+	apr_hash_set(table->hash,channel->identifier.buf,channel->identifier.length,channel);
+
+	/* channels of the same session share the handle, link them into the list */
+	channel->handle = apt_handle_id_parse(&channel->identifier);
+	channel->handle_next = NULL;
+	if(channel->handle) {
+		channel->handle_next = apt_handle_table_get(table->handles,channel->handle);
+		apt_handle_table_set(table->handles,channel->handle,channel);
+	}
+}
+
+/** Check whether the identifier of the channel is composed of session id and resource name */
+static APR_INLINE apt_bool_t mrcp_channel_identifier_match(const mrcp_control_channel_t *channel, const mrcp_channel_id *channel_id)
+{
+	const apt_str_t *identifier = &channel->identifier;
+	const apt_str_t *session_id = &channel_id->session_id;
+	const apt_str_t *resource_name = &channel_id->resource_name;
+	if(identifier->length != session_id->length + 1 + resource_name->length) {
+		return FALSE;
+	}
+	if(identifier->buf[session_id->length] != '@' ||
+		memcmp(identifier->buf,session_id->buf,session_id->length) != 0 ||
+		memcmp(identifier->buf + session_id->length + 1,resource_name->buf,resource_name->length) != 0) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+mrcp_control_channel_t* mrcp_channel_table_find(const mrcp_channel_table_t *table, const mrcp_channel_id *channel_id, apr_pool_t *pool)
+{
+	mrcp_control_channel_t *channel;
+	char buf[MRCP_CHANNEL_IDENTIFIER_MAX_LENGTH];
+	apt_str_t identifier;
+	apr_uint32_t handle = apt_handle_id_parse(&channel_id->session_id);
+	if(handle) {
+		/* an identifier beginning with the handle is never stored elsewhere, so a miss is final */
+		channel = apt_handle_table_get(table->handles,handle);
+		for(; channel; channel = channel->handle_next) {
+			if(mrcp_channel_identifier_match(channel,channel_id) == TRUE) {
+				return channel;
+			}
+		}
+		return NULL;
+	}
+
+	/* foreign identifier, compose it on the stack unless it is too long */
+	identifier.length = channel_id->session_id.length + 1 + channel_id->resource_name.length;
+	if(identifier.length < sizeof(buf)) {
+		identifier.buf = buf;
+		memcpy(buf,channel_id->session_id.buf,channel_id->session_id.length);
+		buf[channel_id->session_id.length] = '@';
+		memcpy(buf + channel_id->session_id.length + 1,channel_id->resource_name.buf,channel_id->resource_name.length);
+	}
+	else {
+		apt_id_resource_generate(&channel_id->session_id,&channel_id->resource_name,'@',&identifier,pool);
+	}
+	return apr_hash_get(table->hash,identifier.buf,identifier.length);
+}
+
+void mrcp_channel_table_remove(mrcp_channel_table_t *table, mrcp_control_channel_t *channel)
+{
+	mrcp_control_channel_t *head;
+	mrcp_control_channel_t *it;
+
+	apr_hash_set(table->hash,channel->identifier.buf,channel->identifier.length,NULL);
+	if(!channel->handle) {
+		return;
+	}
+
+	head = apt_handle_table_get(table->handles,channel->handle);
+	if(head == channel) {
+		/* the next channel becomes the head, or the handle is removed from the table */
+		apt_handle_table_set(table->handles,channel->handle,channel->handle_next);
+	}
+	else {
+		for(it = head; it; it = it->handle_next) {
+			if(it->handle_next == channel) {
+				it->handle_next = channel->handle_next;
+				break;
+			}
+		}
+	}
+	channel->handle_next = NULL;
+}
+
+/** Request or cancel POLLOUT events for the socket of MRCP connection */
+static void mrcp_connection_pollout_set(mrcp_connection_t *connection, apt_poller_task_t *task, apt_bool_t enable)
+{
+	apr_int16_t reqevents = (enable == TRUE) ? (APR_POLLIN | APR_POLLOUT) : APR_POLLIN;
+	if(connection->sock_pfd.reqevents == reqevents) {
+		return;
+	}
+
+	/* descriptor cannot be modified in the pollset, re-add it instead */
+	apt_poller_task_descriptor_remove(task,&connection->sock_pfd);
+	connection->sock_pfd.reqevents = reqevents;
+	if(apt_poller_task_descriptor_add(task,&connection->sock_pfd) != TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Add to Pollset %s",connection->id);
+	}
+}
+
+/** Get a chunk either from the list of released ones or allocate a new one */
+static mrcp_tx_chunk_t* mrcp_tx_chunk_get(mrcp_connection_t *connection)
+{
+	mrcp_tx_chunk_t *chunk;
+	if(!APR_RING_EMPTY(&connection->tx_free_list, mrcp_tx_chunk_t, link)) {
+		chunk = APR_RING_FIRST(&connection->tx_free_list);
+		APR_RING_REMOVE(chunk,link);
+	}
+	else {
+		chunk = apr_palloc(connection->pool,sizeof(mrcp_tx_chunk_t));
+		chunk->buf = apr_palloc(connection->pool,connection->tx_buffer_size);
+		APR_RING_ELEM_INIT(chunk,link);
+	}
+	chunk->length = 0;
+	chunk->offset = 0;
+	return chunk;
+}
+
+/** Append data to the output queue, filling up the last chunk first */
+static void mrcp_connection_tx_enqueue(mrcp_connection_t *connection, const char *buf, apr_size_t length)
+{
+	mrcp_tx_chunk_t *chunk = NULL;
+	apr_size_t size;
+	if(!APR_RING_EMPTY(&connection->tx_queue, mrcp_tx_chunk_t, link)) {
+		chunk = APR_RING_LAST(&connection->tx_queue);
+	}
+
+	while(length) {
+		if(!chunk || chunk->length == connection->tx_buffer_size) {
+			chunk = mrcp_tx_chunk_get(connection);
+			APR_RING_INSERT_TAIL(&connection->tx_queue,chunk,mrcp_tx_chunk_t,link);
+		}
+		size = connection->tx_buffer_size - chunk->length;
+		if(size > length) {
+			size = length;
+		}
+		memcpy(chunk->buf + chunk->length,buf,size);
+		chunk->length += size;
+		connection->tx_queued_bytes += size;
+		buf += size;
+		length -= size;
+	}
+}
+
+/** Release the chunks which have been sent and advance the partially sent one */
+static void mrcp_connection_tx_consume(mrcp_connection_t *connection, apr_size_t length)
+{
+	mrcp_tx_chunk_t *chunk;
+	apr_size_t size;
+	connection->tx_queued_bytes -= length;
+	while(length) {
+		chunk = APR_RING_FIRST(&connection->tx_queue);
+		size = chunk->length - chunk->offset;
+		if(length < size) {
+			chunk->offset += length;
+			break;
+		}
+		length -= size;
+		APR_RING_REMOVE(chunk,link);
+		APR_RING_INSERT_TAIL(&connection->tx_free_list,chunk,mrcp_tx_chunk_t,link);
+	}
+}
+
+/** Discard whatever is pending in the output queue */
+static void mrcp_connection_tx_discard(mrcp_connection_t *connection)
+{
+	mrcp_tx_chunk_t *chunk;
+	while(!APR_RING_EMPTY(&connection->tx_queue, mrcp_tx_chunk_t, link)) {
+		chunk = APR_RING_FIRST(&connection->tx_queue);
+		APR_RING_REMOVE(chunk,link);
+		APR_RING_INSERT_TAIL(&connection->tx_free_list,chunk,mrcp_tx_chunk_t,link);
+	}
+	connection->tx_queued_bytes = 0;
+}
+
+apt_bool_t mrcp_connection_is_congested(const mrcp_connection_t *connection)
+{
+	if(connection->tx_hwm && connection->tx_queued_bytes >= connection->tx_hwm) {
+		return TRUE;
+	}
+	return FALSE;
+}
+
+apt_bool_t mrcp_connection_send(mrcp_connection_t *connection, apt_poller_task_t *task, const char *buf, apr_size_t length)
+{
+	apr_size_t sent = 0;
+	if(APR_RING_EMPTY(&connection->tx_queue, mrcp_tx_chunk_t, link)) {
+		/* nothing is pending, try to send right away */
+		apr_status_t status;
+		sent = length;
+		status = apr_socket_send(connection->sock,buf,&sent);
+		if(status != APR_SUCCESS && !APR_STATUS_IS_EAGAIN(status)) {
+			return FALSE;
+		}
+		if(sent == length) {
+			return TRUE;
+		}
+	}
+
+	/* keep the order of data, queue the rest and wait for the socket to become writable */
+	mrcp_connection_tx_enqueue(connection,buf + sent,length - sent);
+	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Queue MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes] pending [%"APR_SIZE_T_FMT" bytes]",
+		connection->id,
+		length - sent,
+		connection->tx_queued_bytes);
+	mrcp_connection_pollout_set(connection,task,TRUE);
+	return TRUE;
+}
+
+apt_bool_t mrcp_connection_flush(mrcp_connection_t *connection, apt_poller_task_t *task)
+{
+	struct iovec vec[MRCP_TX_IOVEC_COUNT];
+	apr_int32_t count;
+	apr_size_t length;
+	apr_size_t requested;
+	apr_status_t status = APR_SUCCESS;
+	mrcp_tx_chunk_t *chunk;
+
+	while(!APR_RING_EMPTY(&connection->tx_queue, mrcp_tx_chunk_t, link)) {
+		/* coalesce queued chunks into a single writev */
+		count = 0;
+		requested = 0;
+		for(chunk = APR_RING_FIRST(&connection->tx_queue);
+				chunk != APR_RING_SENTINEL(&connection->tx_queue, mrcp_tx_chunk_t, link) && count < MRCP_TX_IOVEC_COUNT;
+					chunk = APR_RING_NEXT(chunk, link)) {
+			vec[count].iov_base = chunk->buf + chunk->offset;
+			vec[count].iov_len = chunk->length - chunk->offset;
+			requested += vec[count].iov_len;
+			count++;
+		}
+
+		length = 0;
+		status = apr_socket_sendv(connection->sock,vec,count,&length);
+		mrcp_connection_tx_consume(connection,length);
+		if(status != APR_SUCCESS || length < requested) {
+			/* socket buffer is full, wait for the next POLLOUT */
+			break;
+		}
+	}
+
+	if(status != APR_SUCCESS && !APR_STATUS_IS_EAGAIN(status)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Data %s, discard [%"APR_SIZE_T_FMT" bytes]",
+			connection->id,
+			connection->tx_queued_bytes);
+		mrcp_connection_tx_discard(connection);
+		mrcp_connection_pollout_set(connection,task,FALSE);
+		return FALSE;
+	}
+
+	if(APR_RING_EMPTY(&connection->tx_queue, mrcp_tx_chunk_t, link)) {
+		mrcp_connection_pollout_set(connection,task,FALSE);
+	}
+	return TRUE;
+}
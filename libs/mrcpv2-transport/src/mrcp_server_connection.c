@@ -33,12 +33,14 @@ struct mrcp_connection_agent_t {
 	/** List (ring) of MRCP connections */
 	APR_RING_HEAD(mrcp_connection_head_t, mrcp_connection_t) connection_list;
 	/** Table of pending control channels */
-	apr_hash_t                           *pending_channel_table;
+	mrcp_channel_table_t                  pending_channel_table;
 
 	apt_bool_t                            force_new_connection;
 	apr_size_t                            max_shared_use_count;
 	apr_size_t                            tx_buffer_size;
 	apr_size_t                            rx_buffer_size;
+	apr_size_t                            tx_hwm;
+	apt_bool_t                            zero_copy;
 	apr_uint32_t                          inactivity_timeout;
 	apr_uint32_t                          termination_timeout;
 
@@ -105,6 +107,8 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 	agent->max_shared_use_count = 100;
 	agent->rx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
 	agent->tx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
+	agent->tx_hwm = MRCP_TX_QUEUE_DEFAULT_HWM;
+	agent->zero_copy = FALSE;
 	agent->inactivity_timeout = 600000; /* 10 min */
 	agent->termination_timeout = 3000; /* 3 sec */
 
@@ -113,7 +117,7 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 		return NULL;
 	}
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
+	msg_pool = apt_task_msg_pool_create_static(sizeof(connection_task_msg_t),TASK_MSG_POOL_DEFAULT_SIZE,pool);
 	
 	agent->task = apt_poller_task_create(
 					max_connection_count + 1,
@@ -137,7 +141,7 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 	}
 
 	APR_RING_INIT(&agent->connection_list, mrcp_connection_t, link);
-	agent->pending_channel_table = apr_hash_make(pool);
+	mrcp_channel_table_init(&agent->pending_channel_table,pool);
 
 	if(mrcp_server_agent_listening_socket_create(agent) != TRUE) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
@@ -218,6 +222,21 @@ MRCP_DECLARE(void) mrcp_server_connection_tx_size_set(
 	agent->tx_buffer_size = size;
 }
 
+/** Set high-water mark of the output queue */
+MRCP_DECLARE(void) mrcp_server_connection_tx_hwm_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size)
+{
+	agent->tx_hwm = size;
+}
+
+MRCP_DECLARE(void) mrcp_server_connection_zero_copy_set(
+								mrcp_connection_agent_t *agent,
+								apt_bool_t zero_copy)
+{
+	agent->zero_copy = zero_copy;
+}
+
 /** Set max shared use count for an MRCPv2 connection */
 MRCP_DECLARE(void) mrcp_server_connection_max_shared_use_set(
 								mrcp_connection_agent_t *agent,
@@ -275,6 +294,8 @@ MRCP_DECLARE(mrcp_control_channel_t*) mrcp_server_control_channel_create(mrcp_co
 	channel->obj = obj;
 	channel->log_obj = NULL;
 	channel->pool = pool;
+	channel->handle = 0;
+	channel->handle_next = NULL;
 	return channel;
 }
 
@@ -397,23 +418,21 @@ static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_agent_t *
 /** Associate control channel with MRCPv2 connection */
 static mrcp_control_channel_t* mrcp_connection_channel_associate(mrcp_connection_agent_t *agent, mrcp_connection_t *connection, const mrcp_message_t *message)
 {
-	apt_str_t identifier;
 	mrcp_control_channel_t *channel;
 	if(!connection || !message) {
 		return NULL;
 	}
-	apt_id_resource_generate(&message->channel_id.session_id,&message->channel_id.resource_name,'@',&identifier,connection->pool);
-	channel = mrcp_connection_channel_find(connection,&identifier);
+	channel = mrcp_connection_channel_find(connection,&message->channel_id);
 	if(!channel) {
-		channel = apr_hash_get(agent->pending_channel_table,identifier.buf,identifier.length);
+		channel = mrcp_channel_table_find(&agent->pending_channel_table,&message->channel_id,connection->pool);
 		if(channel) {
-			apr_hash_set(agent->pending_channel_table,identifier.buf,identifier.length,NULL);
+			mrcp_channel_table_remove(&agent->pending_channel_table,channel);
 			mrcp_connection_channel_add(connection,channel);
 			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Assign Control Channel <%s> to Connection %s [%d] -> [%d]",
 				channel->identifier.buf,
 				connection->id,
-				apr_hash_count(agent->pending_channel_table),
-				apr_hash_count(connection->channel_table));
+				mrcp_channel_table_count(&agent->pending_channel_table),
+				mrcp_channel_table_count(&connection->channel_table));
 		}
 	}
 	return channel;
@@ -483,13 +502,17 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 		local_ip,connection->l_sockaddr->port,
 		remote_ip,connection->r_sockaddr->port);
 
-	if(apr_hash_count(agent->pending_channel_table) == 0) {
+	if(mrcp_channel_table_count(&agent->pending_channel_table) == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Reject Unexpected TCP/MRCPv2 Connection %s",connection->id);
 		apr_socket_close(connection->sock);
 		mrcp_connection_destroy(connection);
 		return FALSE;
 	}
 
+	/* never block the poller task on a slow peer, whatever cannot be sent is queued */
+	apr_socket_opt_set(connection->sock, APR_SO_NONBLOCK, 1);
+	apr_socket_timeout_set(connection->sock, 0);
+
 	memset(&connection->sock_pfd,0,sizeof(apr_pollfd_t));
 	connection->sock_pfd.desc_type = APR_POLL_SOCKET;
 	connection->sock_pfd.reqevents = APR_POLLIN;
@@ -510,10 +533,9 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 
 	connection->tx_buffer_size = agent->tx_buffer_size;
 	connection->tx_buffer = apr_palloc(connection->pool,connection->tx_buffer_size+1);
+	connection->tx_hwm = agent->tx_hwm;
 
-	connection->rx_buffer_size = agent->rx_buffer_size;
-	connection->rx_buffer = apr_palloc(connection->pool,connection->rx_buffer_size+1);
-	apt_text_stream_init(&connection->rx_stream,connection->rx_buffer,connection->rx_buffer_size);
+	mrcp_connection_rx_buffer_create(connection,agent->rx_buffer_size,agent->zero_copy);
 
 	if(apt_log_masking_get() != APT_LOG_MASKING_NONE) {
 		connection->verbose = FALSE;
@@ -623,10 +645,10 @@ static apt_bool_t mrcp_server_agent_channel_add(mrcp_connection_agent_t *agent,
 		}
 	}
 
-	apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,channel);
+	mrcp_channel_table_add(&agent->pending_channel_table,channel);
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Add Pending Control Channel <%s> [%d]",
 			channel->identifier.buf,
-			apr_hash_count(agent->pending_channel_table));
+			mrcp_channel_table_count(&agent->pending_channel_table));
 	/* send response */
 	return mrcp_control_channel_add_respond(agent->vtable,channel,answer,TRUE);
 }
@@ -649,7 +671,7 @@ static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agen
 		mrcp_connection_channel_remove(connection,channel);
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Control Channel <%s> [%d]",
 				channel->identifier.buf,
-				apr_hash_count(connection->channel_table));
+				mrcp_channel_table_count(&connection->channel_table));
 		if(!connection->access_count) {
 			if(!connection->sock) {
 				/* set connection to be destroyed on channel destroy */
@@ -664,10 +686,10 @@ static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agen
 		}
 	}
 	else {
-		apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,NULL);
+		mrcp_channel_table_remove(&agent->pending_channel_table,channel);
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Pending Control Channel <%s> [%d]",
 				channel->identifier.buf,
-				apr_hash_count(agent->pending_channel_table));
+				mrcp_channel_table_count(&agent->pending_channel_table));
 	}
 	/* send response */
 	return mrcp_control_channel_remove_respond(agent->vtable,channel,TRUE);
@@ -683,6 +705,15 @@ static apt_bool_t mrcp_server_agent_messsage_send(mrcp_connection_agent_t *agent
 		return FALSE;
 	}
 
+	if(mrcp_connection_is_congested(connection) == TRUE) {
+		/* do not let a peer which does not read grow the output queue unbounded */
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Output Queue Overflow %s [%"APR_SIZE_T_FMT" bytes] " APT_SIDRES_FMT,
+			connection->id,
+			connection->tx_queued_bytes,
+			MRCP_MESSAGE_SIDRES(message));
+		return FALSE;
+	}
+
 	do {
 		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
 		result = mrcp_generator_run(connection->generator,message,&stream);
@@ -696,7 +727,7 @@ static apt_bool_t mrcp_server_agent_messsage_send(mrcp_connection_agent_t *agent
 					connection->verbose == TRUE ? stream.text.length : 0,
 					stream.text.buf);
 
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
+			if(mrcp_connection_send(connection,agent->task,stream.text.buf,stream.text.length) == TRUE) {
 				status = TRUE;
 			}
 			else {
@@ -724,12 +755,15 @@ static apt_bool_t mrcp_server_message_handler(mrcp_connection_t *connection, mrc
 				apt_timer_set(connection->inactivity_timer,agent->inactivity_timeout);
 			}
 
+			/* rx buffers are released once the request is completed */
+			mrcp_connection_rx_request_add(connection,channel,message);
 			mrcp_connection_message_receive(agent->vtable,channel,message);
 		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Find Channel " APT_SIDRES_FMT " in Connection %s",
 				MRCP_MESSAGE_SIDRES(message),
 				connection->id);
+			mrcp_message_buffers_release(message);
 		}
 	}
 	else if(status == APT_MESSAGE_STATUS_INVALID) {
@@ -743,11 +777,14 @@ static apt_bool_t mrcp_server_message_handler(mrcp_connection_t *connection, mrc
 				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Response");
 			}
 		}
+		if(message) {
+			mrcp_message_buffers_release(message);
+		}
 	}
 	return TRUE;
 }
 
-/* Receive MRCP message through TCP/MRCPv2 connection */
+/* Receive MRCP message through TCP/MRCPv2 connection and flush the output queue */
 static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_t *descriptor)
 {
 	mrcp_connection_agent_t *agent = obj;
@@ -766,6 +803,13 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 	if(!connection || !connection->sock) {
 		return FALSE;
 	}
+
+	if(descriptor->rtnevents & APR_POLLOUT) {
+		mrcp_connection_flush(connection,agent->task);
+		if(!(descriptor->rtnevents & (APR_POLLIN | APR_POLLHUP | APR_POLLERR))) {
+			return TRUE;
+		}
+	}
 	stream = &connection->rx_stream;
 
 	/* calculate offset remaining from the previous receive / if any */
@@ -774,6 +818,9 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 	length = connection->rx_buffer_size - offset;
 
 	status = apr_socket_recv(connection->sock,stream->pos,&length);
+	if(APR_STATUS_IS_EAGAIN(status)) {
+		return TRUE;
+	}
 	if(status == APR_EOF || length == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"TCP/MRCPv2 Peer Disconnected %s",connection->id);
 		return mrcp_server_agent_connection_close(agent,connection,FALSE);
@@ -801,7 +848,7 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 	while(apt_text_is_eos(stream) == FALSE);
 
 	/* scroll remaining stream */
-	apt_text_stream_scroll(stream);
+	mrcp_connection_rx_stream_scroll(connection);
 	return TRUE;
 }
 
@@ -823,6 +870,9 @@ static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t
 			break;
 		case CONNECTION_TASK_MSG_SEND_MESSAGE:
 			mrcp_server_agent_messsage_send(agent,msg->channel->connection,msg->message);
+			if(msg->channel->connection) {
+				mrcp_connection_rx_requests_complete(msg->channel->connection,msg->channel,msg->message);
+			}
 			break;
 	}
 
@@ -46,6 +46,19 @@ typedef struct {
 	apr_pool_t        *pool;
 } asr_params_t;
 
+typedef struct {
+	const char        *input_file;
+	const char        *params_file;
+	/* grammar URIs to define in turn */
+	const char        *grammar_uris[MAX_URIS];
+	int                uri_count;
+	/* number of grammars defined so far */
+	int                defined_count;
+	float              weights[MAX_URIS];
+
+	apr_pool_t        *pool;
+} asr_async_params_t;
+
 /** Thread function to run ASR scenario in */
 static void* APR_THREAD_FUNC asr_session_run(apr_thread_t *thread, void *data)
 {
@@ -88,6 +101,100 @@ static void* APR_THREAD_FUNC asr_session_run(apr_thread_t *thread, void *data)
 	return NULL;
 }
 
+/** Terminate asynchronous ASR session, the params are destroyed upon termination */
+static void asr_async_session_terminate(asr_session_t *session, asr_async_params_t *params)
+{
+	if(asr_session_destroy_async(session) == FALSE) {
+		/* the session is destroyed straightaway */
+		apr_pool_destroy(params->pool);
+	}
+}
+
+/** Handler of asynchronous ASR session events, sending the next request of the scenario */
+static void asr_async_session_handler(asr_session_t *session, const asr_event_t *event, void *obj)
+{
+	asr_async_params_t *params = obj;
+	apt_bool_t status = event->status;
+
+	switch(event->type) {
+		case ASR_EVENT_SESSION_CREATE:
+		case ASR_EVENT_DEFINE_GRAMMAR:
+			if(status == FALSE) {
+				break;
+			}
+			if(params->defined_count < params->uri_count) {
+				/* define the next grammar */
+				status = asr_session_define_grammar_async(session,params->grammar_uris[params->defined_count],params->defined_count);
+				params->defined_count++;
+			}
+			else {
+				/* all the grammars are defined, do recognition */
+				status = asr_session_file_recognize_async(session,params->input_file,params->uri_count,params->weights,params->params_file,FALSE);
+			}
+			break;
+		case ASR_EVENT_RECOGNIZE:
+		case ASR_EVENT_START_OF_INPUT:
+			break;
+		case ASR_EVENT_RECOGNITION_COMPLETE:
+		{
+			const char *result = nlsml_result_get(event->message);
+			if(result) {
+				printf("Recog Result [%s]\n",result);
+			}
+			asr_async_session_terminate(session,params);
+			return;
+		}
+		case ASR_EVENT_SESSION_TERMINATE:
+			/* the session is destroyed once the handler returns */
+			apr_pool_destroy(params->pool);
+			return;
+		default:
+			break;
+	}
+
+	if(status == FALSE) {
+		printf("Async Session Failed [%d]\n",event->type);
+		asr_async_session_terminate(session,params);
+	}
+}
+
+/** Launch demo ASR sessions driven by events from the thread of the command line */
+static apt_bool_t asr_async_session_launch(asr_engine_t *engine, const char *grammar_file, const char *input_file, const char *profile, const char *params_file, int count)
+{
+	apr_pool_t *pool;
+	asr_async_params_t *params;
+	char *grammar_uris;
+	char *grammar_uri;
+	char *last;
+	int i;
+
+	for(i = 0; i < count; i++) {
+		/* create pool to allocate params from, destroyed upon session termination */
+		apr_pool_create(&pool,NULL);
+		params = apr_palloc(pool,sizeof(asr_async_params_t));
+		params->pool = pool;
+		params->input_file = apr_pstrdup(pool,input_file ? input_file : DEFAULT_INPUT_FILE);
+		params->params_file = (params_file && params_file[0] != '-') ? apr_pstrdup(pool,params_file) : NULL;
+		params->uri_count = 0;
+		params->defined_count = 0;
+
+		grammar_uris = apr_pstrdup(pool,grammar_file ? grammar_file : DEFAULT_GRAMMAR_FILE);
+		grammar_uri = apr_strtok(grammar_uris,",",&last);
+		while(grammar_uri && params->uri_count < MAX_URIS) {
+			params->grammar_uris[params->uri_count] = grammar_uri;
+			params->weights[params->uri_count] = 1.0f;
+			params->uri_count++;
+			grammar_uri = apr_strtok(NULL,",",&last);
+		}
+
+		if(!asr_session_create_async(engine,(profile && profile[0] != '-') ? profile : DEFAULT_PROFILE,asr_async_session_handler,params)) {
+			apr_pool_destroy(pool);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 /** Launch demo ASR session */
 static apt_bool_t asr_session_launch(asr_engine_t *engine, const char *grammar_file, const char *input_file, const char *profile, const char* params_file, apt_bool_t send_set_params, apt_bool_t send_get_params)
 {
@@ -169,6 +276,16 @@ static apt_bool_t cmdline_process(asr_engine_t *engine, char *cmdline)
 
 		asr_session_launch(engine,grammar,input,profile,params_file,send_set_params,send_get_params);
 	}
+	else if(strcasecmp(name,"arun") == 0) {
+		char *grammar = apr_strtok(NULL, " ", &last);
+		char *input = apr_strtok(NULL, " ", &last);
+		char *profile = apr_strtok(NULL, " ", &last);
+		char *params_file = apr_strtok(NULL, " ", &last);
+		char *str_count = apr_strtok(NULL, " ", &last);
+		int count = str_count ? atoi(str_count) : 1;
+
+		asr_async_session_launch(engine,grammar,input,profile,params_file,count > 0 ? count : 1);
+	}
 	else if(strcasecmp(name,"loglevel") == 0) {
 		char *priority = apr_strtok(NULL, " ", &last);
 		if(priority) {
@@ -223,6 +340,18 @@ static apt_bool_t cmdline_process(asr_engine_t *engine, char *cmdline)
 			"      run http://example.com/grammars/grammar.grxml one.wav uni2\n"
 			"      run <http://localhost/grammars/grammar.grxml>;weight=\"2.0\",<builtin:grammar/boolean>;weight=\"0.75\"\n"
 			"\n"
+			"Run demo ASR sessions by the asynchronous API, without a thread per session\n"
+			"Arun grammar_uri_list audio_input_file [profile_name | -] [params_file | -] [session_count]\n"
+			"\n"
+			"    grammar_uri_list is a comma separated list of grammar uris (weights are not supported)\n"
+			"\n"
+			"    params_file is sent as headers in the MRCP RECOGNIZE method\n"
+			"\n"
+			"    session_count is the number of sessions to run concurrently (default is 1)\n"
+			"\n"
+			"   example: \n"
+			"      arun grammar.xml one-8kHz.pcm uni2 - 10\n"
+			"\n"
 			"- loglevel [level] (set loglevel, one of 0,1...7)\n"
 			"\n"
 			"- quit, exit\n");
@@ -68,6 +68,41 @@ typedef enum {
 
 #define MAX_URIS 10
 
+/** Max number of events queued for blocking calls */
+#define ASR_EVENT_QUEUE_SIZE 8
+
+/** Enumeration of ASR session events */
+typedef enum {
+	ASR_EVENT_SESSION_CREATE,       /**< response to session creation (channel add) */
+	ASR_EVENT_DEFINE_GRAMMAR,       /**< response to DEFINE-GRAMMAR */
+	ASR_EVENT_SET_PARAMS,           /**< response to SET-PARAMS */
+	ASR_EVENT_GET_PARAMS,           /**< response to GET-PARAMS */
+	ASR_EVENT_RECOGNIZE,            /**< response to RECOGNIZE, audio is streamed on success */
+	ASR_EVENT_START_OF_INPUT,       /**< START-OF-INPUT event */
+	ASR_EVENT_RECOGNITION_COMPLETE, /**< RECOGNITION-COMPLETE event */
+	ASR_EVENT_SESSION_TERMINATE     /**< response to session termination */
+} asr_event_type_e;
+
+/** ASR session event */
+typedef struct {
+	/** Event type */
+	asr_event_type_e type;
+	/** Success or failure of the request */
+	apt_bool_t       status;
+	/** MRCP response or event (NULL for session creation and termination) */
+	mrcp_message_t  *message;
+} asr_event_t;
+
+/**
+ * Handler of ASR session events, called from the thread of the client stack.
+ * @param session the session the event is raised in the scope of
+ * @param event the event
+ * @param obj the object associated with the session
+ *
+ * @remark The handler may send further requests by asynchronous functions, but must not call blocking ones.
+ */
+typedef void (*asr_session_event_handler_f)(asr_session_t *session, const asr_event_t *event, void *obj);
+
 /** ASR engine on top of UniMRCP client stack */
 struct asr_engine_t {
 	/** MRCP client stack */
@@ -97,14 +132,25 @@ struct asr_session_t {
 	mpf_frame_buffer_t       *media_buffer;
 	/** Streaming is in-progress */
 	apt_bool_t                streaming;
+	/** Mutex guarding the input against the media thread reading it */
+	apr_thread_mutex_t       *input_mutex;
 
 	/** Conditional wait object */
 	apr_thread_cond_t        *wait_object;
 	/** Mutex of the wait object */
 	apr_thread_mutex_t       *mutex;
 
-	/** Message sent from client stack */
-	const mrcp_app_message_t *app_message;
+	/** Event handler */
+	asr_session_event_handler_f handler;
+	/** Object to pass to the event handler */
+	void                     *obj;
+
+	/** Queue of events, blocking calls wait for */
+	asr_event_t               events[ASR_EVENT_QUEUE_SIZE];
+	/** Index of the first event in the queue */
+	apr_size_t                event_head;
+	/** Number of events in the queue not taken by blocking calls yet */
+	apr_size_t                event_count;
 };
 
 
@@ -246,6 +292,103 @@ ASR_CLIENT_DECLARE(mrcp_recognizer_event_id) asr_session_file_recognize_receive(
  */
 ASR_CLIENT_DECLARE(const char*) nlsml_result_get(mrcp_message_t *message);
 
+/**
+ * Get parameters.
+ * @param message the GET-PARAMS response to retrieve parameters from
+ */
+ASR_CLIENT_DECLARE(ParameterSet*) asr_parameter_set_get(mrcp_message_t *message);
+
+
+/*
+ * Asynchronous API
+ *
+ * The functions below return as soon as the request is sent, and the completion
+ * is reported to the event handler of the session, so that any number of sessions
+ * may be driven from a single thread. Requests sent back-to-back are queued by
+ * the client stack and processed in order. The blocking functions above are only
+ * allowed for sessions created by asr_session_create().
+ */
+
+/**
+ * Create ASR session asynchronously.
+ * @param engine the engine session belongs to
+ * @param profile the name of UniMRCP profile to use
+ * @param handler the handler of session events
+ * @param obj the object to pass to the handler
+ *
+ * @remark ASR_EVENT_SESSION_CREATE is raised upon completion
+ */
+ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create_async(
+									asr_engine_t *engine,
+									const char *profile,
+									asr_session_event_handler_f handler,
+									void *obj);
+
+/**
+ * Send DEFINE-GRAMMAR request asynchronously.
+ * @param session the session to send DEFINE-GRAMMAR in the scope of
+ * @param grammar_uri the grammar URI to use
+ * @param grammar_id the identifier of the grammar to use in Content-Id
+ *
+ * @remark ASR_EVENT_DEFINE_GRAMMAR is raised upon completion
+ */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_define_grammar_async(
+									asr_session_t *session,
+									const char *grammar_uri,
+									int grammar_id);
+
+/**
+ * Send SET-PARAMS request asynchronously.
+ * @param session the session to send SET-PARAMS in the scope of
+ * @param set_params_file the name of the parameters file to use (path is relative to data dir)
+ * @param param_name the name of the individual parameter to set
+ * @param param_value the value of the individual parameter to set
+ *
+ * @remark ASR_EVENT_SET_PARAMS is raised upon completion
+ */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_set_param_async(
+									asr_session_t *session,
+									const char *set_params_file,
+									const char *param_name,
+									const char *param_value);
+
+/**
+ * Send GET-PARAMS request asynchronously.
+ * @param session the session to send GET-PARAMS in the scope of
+ *
+ * @remark ASR_EVENT_GET_PARAMS is raised upon completion, see asr_parameter_set_get()
+ */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_get_all_params_async(asr_session_t *session);
+
+/**
+ * Send RECOGNIZE request asynchronously and stream the input file once it is in-progress.
+ * @param session the session to send RECOGNIZE in the scope of
+ * @param input_file the name of the audio input file to use (path is relative to data dir)
+ * @param uri_count the number of grammars defined before
+ * @param weights the array of grammar weights to use
+ * @param set_params_file the name of the parameters file to use (path is relative to data dir)
+ * @param send_set_params whether or not parameters are sent by a separate SET-PARAMS request
+ *
+ * @remark ASR_EVENT_RECOGNIZE, ASR_EVENT_START_OF_INPUT and ASR_EVENT_RECOGNITION_COMPLETE
+ * are raised in turn, see nlsml_result_get()
+ */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_file_recognize_async(
+									asr_session_t *session,
+									const char *input_file,
+									int uri_count,
+									float weights[],
+									const char *set_params_file,
+									apt_bool_t send_set_params);
+
+/**
+ * Destroy ASR session asynchronously.
+ * @param session the session to destroy
+ *
+ * @remark ASR_EVENT_SESSION_TERMINATE is raised upon completion and the session is destroyed
+ * right after the handler returns. If FALSE is returned, the session is destroyed straightaway.
+ */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_destroy_async(asr_session_t *session);
+
 APT_END_EXTERN_C
 
 #endif /* ASR_ENGINE_H */
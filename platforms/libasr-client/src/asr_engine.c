@@ -70,6 +70,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 };
 
 static apt_bool_t app_message_handler(const mrcp_app_message_t *app_message);
+static void asr_session_sync_handler(asr_session_t *asr_session, const asr_event_t *event, void *obj);
+static FILE* asr_input_set(asr_session_t *asr_session, input_mode_e input_mode, FILE *audio_in);
 
 
 /** Create ASR engine */
@@ -172,23 +174,77 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_engine_destroy(asr_engine_t *engine)
 
 
 
+/** Lock blocking session prior to sending a request, the completion of which is waited for */
+static apt_bool_t asr_session_sync_lock(asr_session_t *asr_session)
+{
+	if(asr_session->handler != asr_session_sync_handler) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot Block on Asynchronous Session");
+		return FALSE;
+	}
+	apr_thread_mutex_lock(asr_session->mutex);
+	/* drop stale events (if any) */
+	asr_session->event_head = 0;
+	asr_session->event_count = 0;
+	return TRUE;
+}
+
+/** Wait for the next event of blocking session, the mutex must be locked */
+static apt_bool_t asr_session_sync_wait(asr_session_t *asr_session, apr_interval_time_t timeout, asr_event_t *event)
+{
+	while(asr_session->event_count == 0) {
+		if(timeout) {
+			if(apr_thread_cond_timedwait(asr_session->wait_object,asr_session->mutex,timeout) != APR_SUCCESS) {
+				return FALSE;
+			}
+		}
+		else {
+			apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
+		}
+	}
+	*event = asr_session->events[asr_session->event_head];
+	asr_session->event_head = (asr_session->event_head + 1) % ASR_EVENT_QUEUE_SIZE;
+	asr_session->event_count--;
+	return TRUE;
+}
+
+/** Handler of blocking session events, signaling the waiting caller */
+static void asr_session_sync_handler(asr_session_t *asr_session, const asr_event_t *event, void *obj)
+{
+	apr_thread_mutex_lock(asr_session->mutex);
+	if(asr_session->event_count == ASR_EVENT_QUEUE_SIZE) {
+		/* the caller does not take events, drop the oldest one */
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Drop ASR Event [%d]",asr_session->events[asr_session->event_head].type);
+		asr_session->event_head = (asr_session->event_head + 1) % ASR_EVENT_QUEUE_SIZE;
+		asr_session->event_count--;
+	}
+	asr_session->events[(asr_session->event_head + asr_session->event_count) % ASR_EVENT_QUEUE_SIZE] = *event;
+	asr_session->event_count++;
+	apr_thread_cond_signal(asr_session->wait_object);
+	apr_thread_mutex_unlock(asr_session->mutex);
+}
+
 /** Destroy ASR session */
 static apt_bool_t asr_session_destroy_ex(asr_session_t *asr_session, apt_bool_t terminate)
 {
 	if(terminate == TRUE) {
-		apr_thread_mutex_lock(asr_session->mutex);
+		asr_event_t event;
+		if(asr_session_sync_lock(asr_session) == FALSE) {
+			return FALSE;
+		}
 		if(mrcp_application_session_terminate(asr_session->mrcp_session) == TRUE) {
-			apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-			/* the response must be checked to be the valid one */
+			asr_session_sync_wait(asr_session,0,&event);
 		}
 		apr_thread_mutex_unlock(asr_session->mutex);
 	}
 
-	if(asr_session->audio_in) {
-		fclose(asr_session->audio_in);
-		asr_session->audio_in = NULL;
+	if(asr_session->input_mutex) {
+		FILE *audio_in = asr_input_set(asr_session,INPUT_MODE_NONE,NULL);
+		if(audio_in) {
+			fclose(audio_in);
+		}
+		apr_thread_mutex_destroy(asr_session->input_mutex);
+		asr_session->input_mutex = NULL;
 	}
-
 	if(asr_session->mutex) {
 		apr_thread_mutex_destroy(asr_session->mutex);
 		asr_session->mutex = NULL;
@@ -205,60 +261,81 @@ static apt_bool_t asr_session_destroy_ex(asr_session_t *asr_session, apt_bool_t
 	return mrcp_application_session_destroy(asr_session->mrcp_session);
 }
 
-/** Open audio input file */
-static apt_bool_t asr_input_file_open(asr_session_t *asr_session, const char *input_file)
+/** Open audio input file and skip the wave header (if any) */
+static FILE* asr_input_file_open(asr_session_t *asr_session, const char *input_file)
 {
 	const apt_dir_layout_t *dir_layout = mrcp_application_dir_layout_get(asr_session->engine->mrcp_app);
 	apr_pool_t *pool = mrcp_application_session_pool_get(asr_session->mrcp_session);
 	char *input_file_path = apt_datadir_filepath_get(dir_layout,input_file,pool);
+	FILE *audio_in;
+	char buf[RIFF_CHUNK_LEN+1] = "";
 
 	if(!input_file_path) {
-		return FALSE;
-	}
-	
-	if(asr_session->audio_in) {
-		fclose(asr_session->audio_in);
-		asr_session->audio_in = NULL;
+		return NULL;
 	}
 
-	asr_session->audio_in = fopen(input_file_path,"rb");
+	audio_in = fopen(input_file_path,"rb");
+	if(!audio_in) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot Open [%s]",input_file_path);
+		return NULL;
+	}
 
-	if(asr_session->audio_in != NULL) {
-		char buf[RIFF_CHUNK_LEN+1] = "";
-		if(fread(buf,1,RIFF_CHUNK_LEN,asr_session->audio_in) == RIFF_CHUNK_LEN &&
-			strncmp(buf,"RIFF",4) == 0 &&
-			strncmp(buf+8,"WAVE",4) == 0) {
+	if(fread(buf,1,RIFF_CHUNK_LEN,audio_in) == RIFF_CHUNK_LEN &&
+		strncmp(buf,"RIFF",4) == 0 &&
+		strncmp(buf+8,"WAVE",4) == 0) {
 
-			// advance to data chunk
-			while(strncmp(buf,"data",4) != 0) {
-				if(fread(buf,1,4,asr_session->audio_in) != 4) {
-					apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No data in [%s]",input_file_path);
-					return FALSE;
-				}
-			}
-			if(fread(buf,1,4,asr_session->audio_in) != 4) {
-				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot seek in [%s]",input_file_path);
-				return FALSE;
+		// advance to data chunk
+		while(strncmp(buf,"data",4) != 0) {
+			if(fread(buf,1,4,audio_in) != 4) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No data in [%s]",input_file_path);
+				fclose(audio_in);
+				return NULL;
 			}
 		}
-		else {
-			rewind(asr_session->audio_in); // rewind if no wave header
+		if(fread(buf,1,4,audio_in) != 4) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot seek in [%s]",input_file_path);
+			fclose(audio_in);
+			return NULL;
 		}
 	}
-
-	if(!asr_session->audio_in) {
-		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot Open [%s]",input_file_path);
-		return FALSE;
+	else {
+		rewind(audio_in); // rewind if no wave header
 	}
+	return audio_in;
+}
 
-	return TRUE;
+/** Set input, streamed once RECOGNIZE is in-progress, and return the file previously set (if any) */
+static FILE* asr_input_set(asr_session_t *asr_session, input_mode_e input_mode, FILE *audio_in)
+{
+	FILE *prev_audio_in;
+	/* the media thread may be reading the input */
+	apr_thread_mutex_lock(asr_session->input_mutex);
+	asr_session->streaming = FALSE;
+	asr_session->input_mode = input_mode;
+	prev_audio_in = asr_session->audio_in;
+	asr_session->audio_in = audio_in;
+	apr_thread_mutex_unlock(asr_session->input_mutex);
+	return prev_audio_in;
+}
+
+/** Start or stop streaming the input */
+static void asr_input_streaming_set(asr_session_t *asr_session, apt_bool_t streaming)
+{
+	apr_thread_mutex_lock(asr_session->input_mutex);
+	asr_session->streaming = streaming;
+	apr_thread_mutex_unlock(asr_session->input_mutex);
 }
 
 /** MPF callback to read audio frame */
 static apt_bool_t asr_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
 {
 	asr_session_t *asr_session = stream->obj;
-	if(asr_session && asr_session->streaming == TRUE) {
+	if(!asr_session) {
+		return TRUE;
+	}
+
+	apr_thread_mutex_lock(asr_session->input_mutex);
+	if(asr_session->streaming == TRUE) {
 		if(asr_session->input_mode == INPUT_MODE_FILE) {
 			if(asr_session->audio_in) {
 				if(fread(frame->codec_frame.buffer,1,frame->codec_frame.size,asr_session->audio_in) == frame->codec_frame.size) {
@@ -277,6 +354,7 @@ static apt_bool_t asr_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame
 			}
 		}
 	}
+	apr_thread_mutex_unlock(asr_session->input_mutex);
 	return TRUE;
 }
 
@@ -485,24 +563,6 @@ ASR_CLIENT_DECLARE(const char*) nlsml_result_get(mrcp_message_t *message)
 }
 
 
-/** Application message handler */
-static apt_bool_t app_message_handler(const mrcp_app_message_t *app_message)
-{
-	if((app_message->message_type == MRCP_APP_MESSAGE_TYPE_SIGNALING && 
-		app_message->sig_message.message_type == MRCP_SIG_MESSAGE_TYPE_RESPONSE) ||
-		app_message->message_type == MRCP_APP_MESSAGE_TYPE_CONTROL) {
-
-		asr_session_t *asr_session = mrcp_application_session_object_get(app_message->session);
-		if(asr_session) {
-			apr_thread_mutex_lock(asr_session->mutex);
-			asr_session->app_message = app_message;
-			apr_thread_cond_signal(asr_session->wait_object);
-			apr_thread_mutex_unlock(asr_session->mutex);
-		}
-	}
-	return TRUE;
-}
-
 /** Check signaling response */
 static apt_bool_t sig_response_check(const mrcp_app_message_t *app_message)
 {
@@ -532,27 +592,106 @@ static apt_bool_t mrcp_response_check(const mrcp_app_message_t *app_message, mrc
 	return (mrcp_message->start_line.request_state == state) ? TRUE : FALSE;
 }
 
-/** Get MRCP event */
-static mrcp_message_t* mrcp_event_get(const mrcp_app_message_t *app_message)
+/** Application message handler, raising events of ASR sessions */
+static apt_bool_t app_message_handler(const mrcp_app_message_t *app_message)
 {
-	mrcp_message_t *mrcp_message = NULL;
-	if(app_message && app_message->message_type == MRCP_APP_MESSAGE_TYPE_CONTROL) {
-		mrcp_message = app_message->control_message;
+	asr_event_t event;
+	asr_session_t *asr_session = mrcp_application_session_object_get(app_message->session);
+	if(!asr_session) {
+		return TRUE;
 	}
 
-	if(!mrcp_message || mrcp_message->start_line.message_type != MRCP_MESSAGE_TYPE_EVENT) {
-		return NULL;
+	event.status = FALSE;
+	event.message = NULL;
+	if(app_message->message_type == MRCP_APP_MESSAGE_TYPE_SIGNALING) {
+		if(app_message->sig_message.message_type != MRCP_SIG_MESSAGE_TYPE_RESPONSE) {
+			return TRUE;
+		}
+		if(app_message->sig_message.command_id == MRCP_SIG_COMMAND_CHANNEL_ADD) {
+			event.type = ASR_EVENT_SESSION_CREATE;
+		}
+		else if(app_message->sig_message.command_id == MRCP_SIG_COMMAND_SESSION_TERMINATE) {
+			event.type = ASR_EVENT_SESSION_TERMINATE;
+		}
+		else {
+			return TRUE;
+		}
+		event.status = sig_response_check(app_message);
+	}
+	else if(app_message->message_type == MRCP_APP_MESSAGE_TYPE_CONTROL && app_message->control_message) {
+		mrcp_message_t *mrcp_message = app_message->control_message;
+		event.message = mrcp_message;
+		if(mrcp_message->start_line.message_type == MRCP_MESSAGE_TYPE_RESPONSE) {
+			switch(mrcp_message->start_line.method_id) {
+				case RECOGNIZER_DEFINE_GRAMMAR:
+					event.type = ASR_EVENT_DEFINE_GRAMMAR;
+					break;
+				case RECOGNIZER_SET_PARAMS:
+					event.type = ASR_EVENT_SET_PARAMS;
+					break;
+				case RECOGNIZER_GET_PARAMS:
+					event.type = ASR_EVENT_GET_PARAMS;
+					break;
+				case RECOGNIZER_RECOGNIZE:
+					event.type = ASR_EVENT_RECOGNIZE;
+					break;
+				default:
+					return TRUE;
+			}
+			if(event.type == ASR_EVENT_RECOGNIZE) {
+				event.status = mrcp_response_check(app_message,MRCP_REQUEST_STATE_INPROGRESS);
+				if(event.status == TRUE) {
+					/* start streaming */
+					asr_input_streaming_set(asr_session,TRUE);
+				}
+			}
+			else {
+				event.status = mrcp_response_check(app_message,MRCP_REQUEST_STATE_COMPLETE);
+			}
+		}
+		else if(mrcp_message->start_line.message_type == MRCP_MESSAGE_TYPE_EVENT) {
+			if(mrcp_message->start_line.method_id == RECOGNIZER_START_OF_INPUT) {
+				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"START-OF-INPUT received");
+				event.type = ASR_EVENT_START_OF_INPUT;
+			}
+			else if(mrcp_message->start_line.method_id == RECOGNIZER_RECOGNITION_COMPLETE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"RECOGNTION-COMPLETE received");
+				event.type = ASR_EVENT_RECOGNITION_COMPLETE;
+				asr_session->recog_complete = mrcp_message;
+				/* stop streaming, the input may be replaced from now on */
+				asr_input_streaming_set(asr_session,FALSE);
+			}
+			else {
+				return TRUE;
+			}
+			event.status = TRUE;
+		}
+		else {
+			return TRUE;
+		}
 	}
-	return mrcp_message;
+	else {
+		return TRUE;
+	}
+
+	asr_session->handler(asr_session,&event,asr_session->obj);
+	if(event.type == ASR_EVENT_SESSION_TERMINATE && asr_session->handler != asr_session_sync_handler) {
+		/* asynchronous session is destroyed once the handler is done with it */
+		asr_session_destroy_ex(asr_session,FALSE);
+	}
+	return TRUE;
 }
 
-/** Create ASR session */
-ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create(asr_engine_t *engine, const char *profile)
+/** Allocate ASR session, the channel of which is to be added */
+static asr_session_t* asr_session_alloc(
+							asr_engine_t *engine,
+							const char *profile,
+							asr_session_event_handler_f handler,
+							void *obj)
 {
 	mpf_termination_t *termination;
 	mrcp_channel_t *channel;
 	mrcp_session_t *session;
-	const mrcp_app_message_t *app_message;
 	apr_pool_t *pool;
 	asr_session_t *asr_session;
 	mpf_stream_capabilities_t *capabilities;
@@ -601,34 +740,73 @@ ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create(asr_engine_t *engine, cons
 	asr_session->streaming = FALSE;
 	asr_session->audio_in = NULL;
 	asr_session->media_buffer = NULL;
+	asr_session->input_mutex = NULL;
 	asr_session->mutex = NULL;
 	asr_session->wait_object = NULL;
-	asr_session->app_message = NULL;
+	asr_session->handler = handler;
+	asr_session->obj = obj;
+	asr_session->event_head = 0;
+	asr_session->event_count = 0;
 
-	/* Create cond wait object and mutex */
+	/* Create cond wait object and mutexes */
+	apr_thread_mutex_create(&asr_session->input_mutex,APR_THREAD_MUTEX_DEFAULT,pool);
 	apr_thread_mutex_create(&asr_session->mutex,APR_THREAD_MUTEX_DEFAULT,pool);
 	apr_thread_cond_create(&asr_session->wait_object,pool);
 
 	/* Create media buffer */
 	asr_session->media_buffer = mpf_frame_buffer_create(160,20,pool);
+	return asr_session;
+}
+
+/** Create ASR session */
+ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create(asr_engine_t *engine, const char *profile)
+{
+	asr_event_t event;
+	asr_session_t *asr_session = asr_session_alloc(engine,profile,asr_session_sync_handler,NULL);
+	if(!asr_session) {
+		return NULL;
+	}
 
 	/* Send add channel request and wait for the response */
-	apr_thread_mutex_lock(asr_session->mutex);
-	app_message = NULL;
+	event.status = FALSE;
+	asr_session_sync_lock(asr_session);
 	if(mrcp_application_channel_add(asr_session->mrcp_session,asr_session->mrcp_channel) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
+		asr_session_sync_wait(asr_session,0,&event);
 	}
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	if(sig_response_check(app_message) == FALSE) {
+	if(event.status == FALSE) {
 		asr_session_destroy_ex(asr_session,TRUE);
 		return NULL;
 	}
 	return asr_session;
 }
 
+/** Create ASR session asynchronously */
+ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create_async(
+									asr_engine_t *engine,
+									const char *profile,
+									asr_session_event_handler_f handler,
+									void *obj)
+{
+	asr_session_t *asr_session;
+	if(!handler) {
+		return NULL;
+	}
+
+	asr_session = asr_session_alloc(engine,profile,handler,obj);
+	if(!asr_session) {
+		return NULL;
+	}
+
+	/* Send add channel request, the response is reported to the handler */
+	if(mrcp_application_channel_add(asr_session->mrcp_session,asr_session->mrcp_channel) != TRUE) {
+		asr_session_destroy_ex(asr_session,FALSE);
+		return NULL;
+	}
+	return asr_session;
+}
+
 // udpate note - break up original asr_session_file_recognize()
 // into:
 //   asr_session_file_recognize()
@@ -699,6 +877,10 @@ ASR_CLIENT_DECLARE(const char*) asr_session_file_recognize(
 		else if(event_id == RECOGNIZER_RECOGNITION_COMPLETE) {
 			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Receieved Recognition-Complete");
 		}
+		else if(event_id == RECOGNIZER_EVENT_COUNT && !asr_session->recog_complete) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Receive Recognition-Complete");
+			return NULL;
+		}
 	} while(!asr_session->recog_complete);
 	/* Get results */
 	return nlsml_result_get(asr_session->recog_complete);
@@ -710,9 +892,28 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_define_grammar(
 								const char *grammar_uri,
 								int grammar_id)
 {
-	const mrcp_app_message_t *app_message = NULL;
+	asr_event_t event;
+
+	/* Send DEFINE-GRAMMAR request and wait for the response */
+	event.status = FALSE;
+	if(asr_session_sync_lock(asr_session) == FALSE) {
+		return FALSE;
+	}
+	if(asr_session_define_grammar_async(asr_session,grammar_uri,grammar_id) == TRUE) {
+		asr_session_sync_wait(asr_session,0,&event);
+	}
+	apr_thread_mutex_unlock(asr_session->mutex);
+
+	return (event.status == TRUE && event.type == ASR_EVENT_DEFINE_GRAMMAR) ? TRUE : FALSE;
+}
+
+/** Send DEFINE-GRAMMAR request asynchronously */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_define_grammar_async(
+								asr_session_t *asr_session,
+								const char *grammar_uri,
+								int grammar_id)
+{
 	mrcp_message_t *mrcp_message;
-	mrcp_status_code_e status_code;
 
 	mrcp_channel_t *client_channel = (mrcp_channel_t*) asr_session->mrcp_channel;
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Begin asr_session_define_grammar. session: %s. grammar_uri: %s. grammar_id: %d",client_channel->session->id.buf,grammar_uri,grammar_id);
@@ -723,21 +924,7 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_define_grammar(
 		return FALSE;
 	}
 
-	/* Send DEFINE-GRAMMAR request and wait for the response */
-	apr_thread_mutex_lock(asr_session->mutex);
-	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
-	}
-	apr_thread_mutex_unlock(asr_session->mutex);
-
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_COMPLETE) == FALSE) {
-		return FALSE;
-	}
-
-	status_code = app_message->control_message->start_line.status_code;
-	return (MRCP_STATUS_CODE_SUCCESS == status_code || MRCP_STATUS_CODE_SUCCESS_WITH_IGNORE == status_code);
+	return mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message);
 }
 
 static void *set_individual_param(mrcp_message_t *mrcp_message, mrcp_recog_header_t *recog_header, const char *pname, const char *pvalue)
@@ -1014,12 +1201,36 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_file_recognize_send(
 								const char *set_params_file,
 								apt_bool_t send_set_params)
 {
-	const mrcp_app_message_t *app_message = NULL;
-	mrcp_message_t *mrcp_message;
+	asr_event_t event;
 
 	mrcp_channel_t *client_channel = (mrcp_channel_t*) asr_session->mrcp_channel;
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Begin asr_session_file_recognize_send. session: %s. input_file: %s,grammar_file: %s",client_channel->session->id.buf, input_file,grammar_file == NULL ? "(null)" : grammar_file);
 
+	/* Send RECOGNIZE request and wait for the response */
+	event.status = FALSE;
+	if(asr_session_sync_lock(asr_session) == FALSE) {
+		return FALSE;
+	}
+	if(asr_session_file_recognize_async(asr_session,input_file,uri_count,weights,set_params_file,send_set_params) == TRUE) {
+		asr_session_sync_wait(asr_session,0,&event);
+	}
+	apr_thread_mutex_unlock(asr_session->mutex);
+
+	return (event.status == TRUE && event.type == ASR_EVENT_RECOGNIZE) ? TRUE : FALSE;
+}
+
+/** Send RECOGNIZE request asynchronously */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_file_recognize_async(
+								asr_session_t *asr_session,
+								const char *input_file,
+								int uri_count,
+								float weights[],
+								const char *set_params_file,
+								apt_bool_t send_set_params)
+{
+	mrcp_message_t *mrcp_message;
+	FILE *audio_in;
+
 	/* Reset prev recog result (if any) */
 	asr_session->recog_complete = NULL;
 
@@ -1034,56 +1245,40 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_file_recognize_send(
 		set_param_from_file(asr_session,set_params_file,mrcp_message,recog_header);
 	}
 
-	/* Send RECOGNIZE request */
-	apr_thread_mutex_lock(asr_session->mutex);
-	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
-	}
-	apr_thread_mutex_unlock(asr_session->mutex);
-
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_INPROGRESS) == FALSE) {
+	/* Open input file, which is streamed once RECOGNIZE is in-progress */
+	audio_in = asr_input_file_open(asr_session,input_file);
+	if(!audio_in) {
 		return FALSE;
 	}
-
-	/* Open input file and start streaming */
-	asr_session->input_mode = INPUT_MODE_FILE;
-	if(asr_input_file_open(asr_session,input_file) == FALSE) {
-		return FALSE;
+	/* hand the file over to the media thread, and close the previous one it no longer reads */
+	audio_in = asr_input_set(asr_session,INPUT_MODE_FILE,audio_in);
+	if(audio_in) {
+		fclose(audio_in);
 	}
-	asr_session->streaming = TRUE;
 
-	return TRUE;
+	return mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message);
 }
 
 /* Exported for usage with external tools. */
 ASR_CLIENT_DECLARE(mrcp_recognizer_event_id) asr_session_file_recognize_receive(asr_session_t *asr_session)
 {
-	const mrcp_app_message_t *app_message = NULL;
-	mrcp_message_t *mrcp_message;
+	asr_event_t event;
+	apt_bool_t status;
 
-	apr_thread_mutex_lock(asr_session->mutex);
-	if(apr_thread_cond_timedwait(asr_session->wait_object,asr_session->mutex,60 * 1000000) != APR_SUCCESS) {
-		apr_thread_mutex_unlock(asr_session->mutex);
+	if(asr_session->handler != asr_session_sync_handler) {
 		return RECOGNIZER_EVENT_COUNT;
 	}
-	app_message = asr_session->app_message;
 
-	asr_session->app_message = NULL;
+	/* Wait for the event either pending or the next one */
+	apr_thread_mutex_lock(asr_session->mutex);
+	status = asr_session_sync_wait(asr_session,60 * 1000000,&event);
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	mrcp_message = mrcp_event_get(app_message);
-
-	if(mrcp_message && mrcp_message->start_line.method_id == RECOGNIZER_START_OF_INPUT) {
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"START-OF-INPUT received");
-	}
-	if(mrcp_message && mrcp_message->start_line.method_id == RECOGNIZER_RECOGNITION_COMPLETE) {
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"RECOGNTION-COMPLETE received");
-		asr_session->recog_complete = mrcp_message;
+	if(status == FALSE || !event.message ||
+		(event.type != ASR_EVENT_START_OF_INPUT && event.type != ASR_EVENT_RECOGNITION_COMPLETE)) {
+		return RECOGNIZER_EVENT_COUNT;
 	}
-
-	return mrcp_message->start_line.method_id;
+	return event.message->start_line.method_id;
 }
 
 // udpate note - is this ever used? Should it be removed?
@@ -1092,7 +1287,9 @@ ASR_CLIENT_DECLARE(const char*) asr_session_stream_recognize(
 									asr_session_t *asr_session,
 									const char *grammar_file)
 {
-	const mrcp_app_message_t *app_message = NULL;
+	asr_event_t event;
+	apt_bool_t status;
+	FILE *audio_in;
 	mrcp_message_t *mrcp_message = define_grammar_message_create(asr_session,grammar_file,1);
 	if(!mrcp_message) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create DEFINE-GRAMMAR Request");
@@ -1100,63 +1297,56 @@ ASR_CLIENT_DECLARE(const char*) asr_session_stream_recognize(
 	}
 
 	/* Send DEFINE-GRAMMAR request and wait for the response */
-	apr_thread_mutex_lock(asr_session->mutex);
+	event.status = FALSE;
+	if(asr_session_sync_lock(asr_session) == FALSE) {
+		return NULL;
+	}
 	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
+		asr_session_sync_wait(asr_session,0,&event);
 	}
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_COMPLETE) == FALSE) {
+	if(event.status == FALSE || event.type != ASR_EVENT_DEFINE_GRAMMAR) {
 		return NULL;
 	}
 
 	/* Reset prev recog result (if any) */
 	asr_session->recog_complete = NULL;
 
-	app_message = NULL;
 	mrcp_message = recognize_message_create(asr_session,1,NULL);
 	if(!mrcp_message) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create RECOGNIZE Request");
 		return NULL;
 	}
 
+	/* Set input mode, streaming is started once RECOGNIZE is in-progress */
+	audio_in = asr_input_set(asr_session,INPUT_MODE_STREAM,NULL);
+	if(audio_in) {
+		fclose(audio_in);
+	}
+
+	/* Reset media buffer */
+	mpf_frame_buffer_restart(asr_session->media_buffer);
+
 	/* Send RECOGNIZE request and wait for the response */
-	apr_thread_mutex_lock(asr_session->mutex);
+	event.status = FALSE;
+	asr_session_sync_lock(asr_session);
 	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
+		asr_session_sync_wait(asr_session,0,&event);
 	}
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_INPROGRESS) == FALSE) {
+	if(event.status == FALSE || event.type != ASR_EVENT_RECOGNIZE) {
 		return NULL;
 	}
 
-	/* Reset media buffer */
-	mpf_frame_buffer_restart(asr_session->media_buffer);
-
-	/* Set input mode and start streaming */
-	asr_session->input_mode = INPUT_MODE_STREAM;
-	asr_session->streaming = TRUE;
-
 	/* Wait for events either START-OF-INPUT or RECOGNITION-COMPLETE */
 	do {
 		apr_thread_mutex_lock(asr_session->mutex);
-		app_message = NULL;
-		if(apr_thread_cond_timedwait(asr_session->wait_object,asr_session->mutex, 60 * 1000000) != APR_SUCCESS) {
-			apr_thread_mutex_unlock(asr_session->mutex);
-			return NULL;
-		}
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
+		status = asr_session_sync_wait(asr_session,60 * 1000000,&event);
 		apr_thread_mutex_unlock(asr_session->mutex);
-
-		mrcp_message = mrcp_event_get(app_message);
-		if(mrcp_message && mrcp_message->start_line.method_id == RECOGNIZER_RECOGNITION_COMPLETE) {
-			asr_session->recog_complete = mrcp_message;
+		if(status == FALSE) {
+			return NULL;
 		}
 	}
 	while(!asr_session->recog_complete);
@@ -1191,6 +1381,18 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_destroy(asr_session_t *asr_session)
 	return asr_session_destroy_ex(asr_session,TRUE);
 }
 
+/** Destroy ASR session asynchronously */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_destroy_async(asr_session_t *asr_session)
+{
+	/* the session is destroyed upon the response to session termination */
+	if(mrcp_application_session_terminate(asr_session->mrcp_session) == TRUE) {
+		return TRUE;
+	}
+
+	asr_session_destroy_ex(asr_session,FALSE);
+	return FALSE;
+}
+
 /** Set log priority */
 ASR_CLIENT_DECLARE(apt_bool_t) asr_engine_log_priority_set(apt_log_priority_e log_priority)
 {
@@ -1241,36 +1443,41 @@ ASR_CLIENT_DECLARE(apt_bool_t) asr_session_set_param(
 							const char *param_name,
 							const char *param_value)
 {
-	const mrcp_app_message_t *app_message = NULL;
-	mrcp_message_t *mrcp_message = set_param_message_create(asr_session,set_params_file,param_name,param_value);
-	mrcp_status_code_e status_code;
+	asr_event_t event;
 
-	if(!mrcp_message) {
-		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create SET-PARAMS Request");
+	/* Send SET-PARAMS request and wait for the response */
+	event.status = FALSE;
+	if(asr_session_sync_lock(asr_session) == FALSE) {
 		return FALSE;
 	}
-
-	/* Send SET-PARAMS request and wait for the response */
-	apr_thread_mutex_lock(asr_session->mutex);
-	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
-		asr_session->app_message = NULL;
+	if(asr_session_set_param_async(asr_session,set_params_file,param_name,param_value) == TRUE) {
+		asr_session_sync_wait(asr_session,0,&event);
 	}
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_COMPLETE) == FALSE) {
+	return (event.status == TRUE && event.type == ASR_EVENT_SET_PARAMS) ? TRUE : FALSE;
+}
+
+/** Send SET-PARAMS request asynchronously */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_set_param_async(
+							asr_session_t *asr_session,
+							const char *set_params_file,
+							const char *param_name,
+							const char *param_value)
+{
+	mrcp_message_t *mrcp_message = set_param_message_create(asr_session,set_params_file,param_name,param_value);
+	if(!mrcp_message) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create SET-PARAMS Request");
 		return FALSE;
 	}
 
-	status_code = app_message->control_message->start_line.status_code;
-	return (MRCP_STATUS_CODE_SUCCESS == status_code || MRCP_STATUS_CODE_SUCCESS_WITH_IGNORE == status_code);
+	return mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message);
 }
 
-static void initialize_parameter_set(asr_session_t *asr_session, ParameterSet *p)
+static void initialize_parameter_set(mrcp_message_t *mrcp_message, ParameterSet *p)
 {
-	if(asr_session->app_message->message_type == MRCP_APP_MESSAGE_TYPE_CONTROL) {
-		mrcp_recog_header_t *recog_header = mrcp_resource_header_get(asr_session->app_message->control_message);
+	if(mrcp_message) {
+		mrcp_recog_header_t *recog_header = mrcp_resource_header_get(mrcp_message);
 
 		p->confidence_threshold = recog_header->confidence_threshold;
 		p->sensitivity_level = recog_header->sensitivity_level;
@@ -1299,32 +1506,47 @@ static void initialize_parameter_set(asr_session_t *asr_session, ParameterSet *p
 	}
 }
 
-ASR_CLIENT_DECLARE(ParameterSet*) asr_session_get_all_params(asr_session_t *asr_session)
+/** Get parameters from GET-PARAMS response, exported for usage with asynchronous sessions. */
+ASR_CLIENT_DECLARE(ParameterSet*) asr_parameter_set_get(mrcp_message_t *message)
 {
-	ParameterSet *p = NULL;
-	const mrcp_app_message_t *app_message = NULL;
-	apr_pool_t *pool = mrcp_application_session_pool_get(asr_session->mrcp_session);
-	mrcp_message_t *mrcp_message = get_param_message_create(asr_session);
-	if(!mrcp_message) {
-		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create GET-PARAMS Request");
+	ParameterSet *p;
+	if(!message) {
 		return NULL;
 	}
 
-	apr_thread_mutex_lock(asr_session->mutex);
-	if(mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message) == TRUE) {
-		apr_thread_cond_wait(asr_session->wait_object,asr_session->mutex);
-		app_message = asr_session->app_message;
+	p = apr_pcalloc(message->pool, sizeof(ParameterSet));
+	initialize_parameter_set(message, p);
+	return p;
+}
+
+ASR_CLIENT_DECLARE(ParameterSet*) asr_session_get_all_params(asr_session_t *asr_session)
+{
+	asr_event_t event;
 
+	/* Send GET-PARAMS request and wait for the response */
+	event.status = FALSE;
+	if(asr_session_sync_lock(asr_session) == FALSE) {
+		return NULL;
+	}
+	if(asr_session_get_all_params_async(asr_session) == TRUE) {
+		asr_session_sync_wait(asr_session,0,&event);
 	}
 	apr_thread_mutex_unlock(asr_session->mutex);
 
-	if(mrcp_response_check(app_message,MRCP_REQUEST_STATE_COMPLETE) == FALSE) {
+	if(event.status == FALSE || event.type != ASR_EVENT_GET_PARAMS) {
 		return NULL;
 	}
+	return asr_parameter_set_get(event.message);
+}
 
-	p = apr_palloc(pool, sizeof(ParameterSet));
-	initialize_parameter_set(asr_session, p);
-	asr_session->app_message = NULL;
+/** Send GET-PARAMS request asynchronously */
+ASR_CLIENT_DECLARE(apt_bool_t) asr_session_get_all_params_async(asr_session_t *asr_session)
+{
+	mrcp_message_t *mrcp_message = get_param_message_create(asr_session);
+	if(!mrcp_message) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create GET-PARAMS Request");
+		return FALSE;
+	}
 
-	return p;
+	return mrcp_application_message_send(asr_session->mrcp_session,asr_session->mrcp_channel,mrcp_message);
 }
@@ -510,6 +510,8 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 	apt_bool_t offer_new_connection = FALSE;
 	const char *rx_buffer_size = NULL;
 	const char *tx_buffer_size = NULL;
+	const char *tx_hwm = NULL;
+	apt_bool_t zero_copy = FALSE;
 	const char *request_timeout = NULL;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading MRCPv2 Agent <%s>",id);
@@ -540,6 +542,16 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 				tx_buffer_size = cdata_text_get(elem);
 			}
 		}
+		else if(strcasecmp(elem->name,"tx-high-water-mark") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				tx_hwm = cdata_text_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"zero-copy-parser") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				zero_copy = cdata_bool_get(elem);
+			}
+		}
 		else if(strcasecmp(elem->name,"request-timeout") == 0) {
 			if(is_cdata_valid(elem) == TRUE) {
 				request_timeout = cdata_text_get(elem);
@@ -558,6 +570,10 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 		if(tx_buffer_size) {
 			mrcp_client_connection_tx_size_set(agent,atol(tx_buffer_size));
 		}
+		if(tx_hwm) {
+			mrcp_client_connection_tx_hwm_set(agent,atol(tx_hwm));
+		}
+		mrcp_client_connection_zero_copy_set(agent,zero_copy);
 		if(request_timeout) {
 			mrcp_client_connection_timeout_set(agent,atol(request_timeout));
 		}
@@ -572,6 +588,8 @@ static apt_bool_t unimrcp_client_media_engine_load(unimrcp_client_loader_t *load
 	const apr_xml_elem *elem;
 	mpf_engine_t *media_engine;
 	unsigned long realtime_rate = 1;
+	apt_bool_t free_running = FALSE;
+	apr_size_t worker_count = 1;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Media Engine <%s>",id);
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -581,6 +599,16 @@ static apt_bool_t unimrcp_client_media_engine_load(unimrcp_client_loader_t *load
 				realtime_rate = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"free-running") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				free_running = cdata_bool_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				worker_count = atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -589,6 +617,10 @@ static apt_bool_t unimrcp_client_media_engine_load(unimrcp_client_loader_t *load
 	media_engine = mpf_engine_create(id,loader->pool);
 	if(media_engine) {
 		mpf_engine_scheduler_rate_set(media_engine,realtime_rate);
+		if(free_running == TRUE) {
+			mpf_engine_free_running_set(media_engine,TRUE);
+		}
+		mpf_engine_worker_count_set(media_engine,worker_count);
 	}
 	return mrcp_client_media_engine_register(loader->client,media_engine);
 }
@@ -780,6 +812,11 @@ static apt_bool_t unimrcp_client_jb_settings_load(unimrcp_client_loader_t *loade
 				jb->time_skew_detection = (apr_byte_t) atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"plc") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				jb->plc = (apr_byte_t) atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -22,6 +22,7 @@
 #include "unimrcp_server.h"
 #include "mrcp_resource_loader.h"
 #include "mpf_engine.h"
+#include "mpf_engine_factory.h"
 #include "mpf_codec_manager.h"
 #include "mpf_rtp_termination_factory.h"
 #include "mrcp_sofiasip_server_agent.h"
@@ -72,6 +73,9 @@ struct unimrcp_server_loader_t {
 	
 	/** Implicitly detected, cached IP address */
 	const char      *auto_ip;
+
+	/** Table of media engine pools (id -> apr_array_header_t* of mpf_engine_t*) */
+	apr_hash_t      *media_engine_pools;
 };
 
 static apt_bool_t unimrcp_server_load(mrcp_server_t *mrcp_server, apt_dir_layout_t *dir_layout, apr_pool_t *pool);
@@ -512,6 +516,8 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 	apr_size_t termination_timeout = 3; /* sec */
 	apr_size_t rx_buffer_size = 0;
 	apr_size_t tx_buffer_size = 0;
+	const char *tx_hwm = NULL;
+	apt_bool_t zero_copy = FALSE;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading MRCPv2 Agent <%s>",id);
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -559,6 +565,16 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 				tx_buffer_size = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"tx-high-water-mark") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				tx_hwm = cdata_text_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"zero-copy-parser") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				zero_copy = cdata_bool_get(elem);
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -577,6 +593,10 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 		if(tx_buffer_size) {
 			mrcp_server_connection_tx_size_set(agent,tx_buffer_size);
 		}
+		if(tx_hwm) {
+			mrcp_server_connection_tx_hwm_set(agent,atol(tx_hwm));
+		}
+		mrcp_server_connection_zero_copy_set(agent,zero_copy);
 		mrcp_server_connection_max_shared_use_set(agent,max_shared_use_count);
 		mrcp_server_connection_timeout_set(agent,inactivity_timeout);
 		mrcp_server_connection_term_timeout_set(agent,termination_timeout);
@@ -584,14 +604,27 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 	return mrcp_server_connection_agent_register(loader->server,agent);
 }
 
-/** Load media engine */
+/** Load media engine (or a pool of media engines, if "count" is specified) */
 static apt_bool_t unimrcp_server_media_engine_load(unimrcp_server_loader_t *loader, const apr_xml_elem *root, const char *id)
 {
 	const apr_xml_elem *elem;
+	const apr_xml_attr *attr;
 	mpf_engine_t *media_engine;
+	apr_array_header_t *media_engines;
 	unsigned long realtime_rate = 1;
+	apt_bool_t free_running = FALSE;
+	apr_size_t worker_count = 1;
+	apr_size_t count = 1;
+	apr_size_t i;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Media Engine <%s>",id);
+	for(attr = root->attr; attr; attr = attr->next) {
+		if(strcasecmp(attr->name,"count") == 0) {
+			if(is_attr_valid(attr) == TRUE && atol(attr->value) > 0) {
+				count = atol(attr->value);
+			}
+		}
+	}
 	for(elem = root->first_child; elem; elem = elem->next) {
 		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Element <%s>",elem->name);
 		if(strcasecmp(elem->name,"realtime-rate") == 0) {
@@ -599,16 +632,72 @@ static apt_bool_t unimrcp_server_media_engine_load(unimrcp_server_loader_t *load
 				realtime_rate = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"free-running") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				free_running = cdata_bool_get(elem);
+			}
+		}
+		else if(strcasecmp(elem->name,"worker-count") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				worker_count = atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
 	}
 
-	media_engine = mpf_engine_create(id,loader->pool);
+	media_engines = apr_array_make(loader->pool,(int)count,sizeof(mpf_engine_t*));
+	for(i=0; i<count; i++) {
+		/* engines of the pool are named after the element, each running its own scheduler thread */
+		const char *engine_id = (count == 1) ? id : apr_psprintf(loader->pool,"%s-%"APR_SIZE_T_FMT,id,i+1);
+		media_engine = mpf_engine_create(engine_id,loader->pool);
+		if(media_engine) {
+			mpf_engine_scheduler_rate_set(media_engine,realtime_rate);
+			if(free_running == TRUE) {
+				mpf_engine_free_running_set(media_engine,TRUE);
+			}
+			mpf_engine_worker_count_set(media_engine,worker_count);
+		}
+		if(mrcp_server_media_engine_register(loader->server,media_engine) == TRUE) {
+			APR_ARRAY_PUSH(media_engines,mpf_engine_t*) = media_engine;
+		}
+	}
+
+	if(!media_engines->nelts) {
+		return FALSE;
+	}
+	apr_hash_set(loader->media_engine_pools,id,APR_HASH_KEY_STRING,media_engines);
+	return TRUE;
+}
+
+/** Add media engines referenced by name (either a single engine or a pool) to factory of media engines */
+static mpf_engine_factory_t* unimrcp_server_mpf_factory_add(unimrcp_server_loader_t *loader, const char *name, mpf_engine_factory_t *mpf_factory)
+{
+	int i;
+	mpf_engine_t *media_engine;
+	apr_array_header_t *media_engines = apr_hash_get(loader->media_engine_pools,name,APR_HASH_KEY_STRING);
+	if(media_engines) {
+		if(!mpf_factory)
+			mpf_factory = mpf_engine_factory_create(loader->pool);
+
+		for(i=0; i<media_engines->nelts; i++) {
+			mpf_engine_factory_engine_add(mpf_factory,APR_ARRAY_IDX(media_engines,i,mpf_engine_t*));
+		}
+		return mpf_factory;
+	}
+
+	media_engine = mrcp_server_media_engine_get(loader->server,name);
 	if(media_engine) {
-		mpf_engine_scheduler_rate_set(media_engine,realtime_rate);
+		if(!mpf_factory)
+			mpf_factory = mpf_engine_factory_create(loader->pool);
+
+		mpf_engine_factory_engine_add(mpf_factory,media_engine);
 	}
-	return mrcp_server_media_engine_register(loader->server,media_engine);
+	else {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No Such Media Engine <%s>",name);
+	}
+	return mpf_factory;
 }
 
 /** Load RTP factory */
@@ -795,6 +884,11 @@ static apt_bool_t unimrcp_server_jb_settings_load(unimrcp_server_loader_t *loade
 				jb->time_skew_detection = (apr_byte_t) atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"plc") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				jb->plc = (apr_byte_t) atol(cdata_text_get(elem));
+			}
+		}
 		else {
 			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown Element <%s>",elem->name);
 		}
@@ -923,6 +1017,7 @@ static mrcp_engine_settings_t* resource_engine_settings_load(const apr_xml_elem
 	mrcp_engine_settings_t *settings;
 	const apr_xml_attr *attr_resource = NULL;
 	const apr_xml_attr *attr_engine = NULL;
+	const apr_xml_attr *attr_weight = NULL;
 	if(strcasecmp(elem->name,"param") == 0) {
 		/* this option remains for backward compatibility */
 		name_value_attribs_get(elem,&attr_resource,&attr_engine);
@@ -936,6 +1031,9 @@ static mrcp_engine_settings_t* resource_engine_settings_load(const apr_xml_elem
 			else if(strcasecmp(attr->name,"engine") == 0) {
 				attr_engine = attr;
 			}
+			else if(strcasecmp(attr->name,"weight") == 0) {
+				attr_weight = attr;
+			}
 		}
 	}
 	else {
@@ -953,6 +1051,9 @@ static mrcp_engine_settings_t* resource_engine_settings_load(const apr_xml_elem
 	if(attr_engine) {
 		settings->engine_id = attr_engine->value;
 	}
+	if(is_attr_valid(attr_weight) == TRUE && atol(attr_weight->value) > 0) {
+		settings->weight = atol(attr_weight->value);
+	}
 	if(elem->first_child) {
 		settings->attribs = resource_engine_attribs_load(elem,pool);
 	}
@@ -964,11 +1065,23 @@ static apr_hash_t* resource_engine_map_load(const apr_xml_elem *root, apr_pool_t
 {
 	const apr_xml_elem *elem;
 	mrcp_engine_settings_t *settings;
+	mrcp_engine_settings_t *head;
 	apr_hash_t *resource_engine_map = apr_hash_make(pool);
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading Resource Engine Map");
 	for(elem = root->first_child; elem; elem = elem->next) {
 		settings = resource_engine_settings_load(elem, pool);
-		if(settings) {
+		if(!settings) {
+			continue;
+		}
+		head = apr_hash_get(resource_engine_map,settings->resource_id,APR_HASH_KEY_STRING);
+		if(head) {
+			/* the resource is mapped to a set of engines, append the engine to the set */
+			while(head->next) {
+				head = head->next;
+			}
+			head->next = settings;
+		}
+		else {
 			apr_hash_set(resource_engine_map,settings->resource_id,APR_HASH_KEY_STRING,settings);
 		}
 	}
@@ -982,7 +1095,7 @@ static apt_bool_t unimrcp_server_mrcpv2_profile_load(unimrcp_server_loader_t *lo
 	mrcp_server_profile_t *profile;
 	mrcp_sig_agent_t *sip_agent = NULL;
 	mrcp_connection_agent_t *mrcpv2_agent = NULL;
-	mpf_engine_t *media_engine = NULL;
+	mpf_engine_factory_t *mpf_factory = NULL;
 	mpf_termination_factory_t *rtp_factory = NULL;
 	mpf_rtp_settings_t *rtp_settings = NULL;
 	apr_hash_t *resource_engine_map = NULL;
@@ -1002,7 +1115,7 @@ static apt_bool_t unimrcp_server_mrcpv2_profile_load(unimrcp_server_loader_t *lo
 			mrcpv2_agent = mrcp_server_connection_agent_get(loader->server,cdata_text_get(elem));
 		}
 		else if(strcasecmp(elem->name,"media-engine") == 0) {
-			media_engine = mrcp_server_media_engine_get(loader->server,cdata_text_get(elem));
+			mpf_factory = unimrcp_server_mpf_factory_add(loader,cdata_text_get(elem),mpf_factory);
 		}
 		else if(strcasecmp(elem->name,"rtp-factory") == 0) {
 			rtp_factory = mrcp_server_rtp_factory_get(loader->server,cdata_text_get(elem));
@@ -1019,13 +1132,13 @@ static apt_bool_t unimrcp_server_mrcpv2_profile_load(unimrcp_server_loader_t *lo
 	}
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv2 Profile [%s]",id);
-	profile = mrcp_server_profile_create(
+	profile = mrcp_server_profile_create_ex(
 				id,
 				MRCP_VERSION_2,
 				NULL,
 				sip_agent,
 				mrcpv2_agent,
-				media_engine,
+				mpf_factory,
 				rtp_factory,
 				rtp_settings,
 				loader->pool);
@@ -1038,7 +1151,7 @@ static apt_bool_t unimrcp_server_mrcpv1_profile_load(unimrcp_server_loader_t *lo
 	const apr_xml_elem *elem;
 	mrcp_server_profile_t *profile;
 	mrcp_sig_agent_t *rtsp_agent = NULL;
-	mpf_engine_t *media_engine = NULL;
+	mpf_engine_factory_t *mpf_factory = NULL;
 	mpf_termination_factory_t *rtp_factory = NULL;
 	mpf_rtp_settings_t *rtp_settings = NULL;
 	apr_hash_t *resource_engine_map = NULL;
@@ -1055,7 +1168,7 @@ static apt_bool_t unimrcp_server_mrcpv1_profile_load(unimrcp_server_loader_t *lo
 			rtsp_agent = mrcp_server_signaling_agent_get(loader->server,cdata_text_get(elem));
 		}
 		else if(strcasecmp(elem->name,"media-engine") == 0) {
-			media_engine = mrcp_server_media_engine_get(loader->server,cdata_text_get(elem));
+			mpf_factory = unimrcp_server_mpf_factory_add(loader,cdata_text_get(elem),mpf_factory);
 		}
 		else if(strcasecmp(elem->name,"rtp-factory") == 0) {
 			rtp_factory = mrcp_server_rtp_factory_get(loader->server,cdata_text_get(elem));
@@ -1072,13 +1185,13 @@ static apt_bool_t unimrcp_server_mrcpv1_profile_load(unimrcp_server_loader_t *lo
 	}
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv1 Profile [%s]",id);
-	profile = mrcp_server_profile_create(
+	profile = mrcp_server_profile_create_ex(
 				id,
 				MRCP_VERSION_1,
 				NULL,
 				rtsp_agent,
 				NULL,
-				media_engine,
+				mpf_factory,
 				rtp_factory,
 				rtp_settings,
 				loader->pool);
@@ -1351,6 +1464,7 @@ static apt_bool_t unimrcp_server_load(mrcp_server_t *mrcp_server, apt_dir_layout
 	loader->ip = DEFAULT_IP_ADDRESS;
 	loader->ext_ip = NULL;
 	loader->auto_ip = NULL;
+	loader->media_engine_pools = apr_hash_make(pool);
 
 	/* Navigate through document */
 	for(elem = root->first_child; elem; elem = elem->next) {
@@ -43,11 +43,15 @@ static apt_bool_t cmdline_process(mrcp_server_t *server, char *cmdline)
 	else if(strcasecmp(name,"online") == 0) {
 		mrcp_server_online(server);
 	}
+	else if(strcasecmp(name,"status") == 0) {
+		mrcp_server_status_log(server);
+	}
 	else if(strcasecmp(name,"help") == 0) {
 		printf("usage:\n");
 		printf("- loglevel [level] (set loglevel, one of 0,1...7)\n");
 		printf("- offline (take server offline)\n");
 		printf("- online (bring server online)\n");
+		printf("- status (log load of media engines)\n");
 		printf("- quit, exit\n");
 	}
 	else {
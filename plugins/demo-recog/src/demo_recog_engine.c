@@ -29,6 +29,7 @@
 
 #include "mrcp_recog_engine.h"
 #include "mpf_activity_detector.h"
+#include "mpf_file_io.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
 
@@ -85,6 +86,7 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo recognizer engine */
 struct demo_recog_engine_t {
 	apt_consumer_task_t    *task;
+	mpf_file_io_t          *file_io;
 };
 
 /** Declaration of demo recognizer channel */
@@ -103,7 +105,7 @@ struct demo_recog_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write utterance to */
-	FILE                    *audio_out;
+	mpf_async_file_t        *audio_out;
 };
 
 typedef enum {
@@ -144,6 +146,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	apt_task_msg_pool_t *msg_pool;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_recog_msg_t),pool);
+	demo_engine->file_io = NULL;
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -183,6 +186,18 @@ static apt_bool_t demo_recog_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+
+	/* audio is written by a dedicated I/O thread, off the media processing thread */
+	demo_engine->file_io = mpf_file_io_create(
+								mpf_file_io_max_files_get(engine->config->max_channel_count,engine->config->params),
+								MPF_FILE_IO_DEFAULT_BUFFER_SIZE,
+								engine->pool);
+	if(demo_engine->file_io && mpf_file_io_start(demo_engine->file_io) == FALSE) {
+		demo_engine->file_io = NULL;
+	}
+	if(!demo_engine->file_io) {
+		apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Failed to Start File I/O");
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -194,6 +209,10 @@ static apt_bool_t demo_recog_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->file_io) {
+		mpf_file_io_terminate(demo_engine->file_io);
+		demo_engine->file_io = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -208,6 +227,10 @@ static mrcp_engine_channel_t* demo_recog_engine_channel_create(mrcp_engine_t *en
 	recog_channel->recog_request = NULL;
 	recog_channel->stop_response = NULL;
 	recog_channel->detector = mpf_activity_detector_create(pool);
+	/* "vad-mode" and "vad-snr-threshold" engine params */
+	if(engine->config) {
+		mpf_activity_detector_params_set(recog_channel->detector,engine->config->params);
+	}
 	recog_channel->audio_out = NULL;
 
 	capabilities = mpf_sink_stream_capabilities_create(pool);
@@ -234,10 +257,29 @@ static mrcp_engine_channel_t* demo_recog_engine_channel_create(mrcp_engine_t *en
 	return recog_channel->channel;
 }
 
+/** Close utterance output file, reporting data dropped, since the I/O thread lagged behind */
+static void demo_recog_file_close(demo_recog_channel_t *recog_channel)
+{
+	mpf_async_file_stat_t stat;
+	if(!recog_channel->audio_out) {
+		return;
+	}
+
+	mpf_async_file_stat_get(recog_channel->audio_out,&stat);
+	if(stat.dropped) {
+		apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Dropped %"APR_SIZE_T_FMT" Frames (%"APR_SIZE_T_FMT" bytes) of Utterance Output File",
+			stat.dropped,
+			stat.dropped_bytes);
+	}
+	mpf_async_file_close(recog_channel->audio_out);
+	recog_channel->audio_out = NULL;
+}
+
 /** Destroy engine channel */
 static apt_bool_t demo_recog_channel_destroy(mrcp_engine_channel_t *channel)
 {
-	/* nothing to destrtoy */
+	/* the file is normally closed on stream close, unless the stream has never been processed */
+	demo_recog_file_close(channel->method_obj);
 	return TRUE;
 }
 
@@ -299,7 +341,7 @@ static apt_bool_t demo_recog_channel_recognize(mrcp_engine_channel_t *channel, m
 		}
 	}
 
-	if(!recog_channel->audio_out) {
+	if(!recog_channel->audio_out && recog_channel->demo_engine->file_io) {
 		const apt_dir_layout_t *dir_layout = channel->engine->dir_layout;
 		char *file_name = apr_psprintf(channel->pool,"utter-%dkHz-%s.pcm",
 							descriptor->sampling_rate/1000,
@@ -307,7 +349,7 @@ static apt_bool_t demo_recog_channel_recognize(mrcp_engine_channel_t *channel, m
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
 		if(file_path) {
 			apt_log(RECOG_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			recog_channel->audio_out = fopen(file_path,"wb");
+			recog_channel->audio_out = mpf_async_file_sink_open(recog_channel->demo_engine->file_io,file_path);
 			if(!recog_channel->audio_out) {
 				apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 			}
@@ -387,6 +429,8 @@ static apt_bool_t demo_recog_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 /** Callback is called from MPF engine context to perform any action after close */
 static apt_bool_t demo_recog_stream_close(mpf_audio_stream_t *stream)
 {
+	/* close the file in the same context it is written in */
+	demo_recog_file_close(stream->obj);
 	return TRUE;
 }
 
@@ -525,7 +569,7 @@ static apt_bool_t demo_recog_stream_write(mpf_audio_stream_t *stream, const mpf_
 		}
 
 		if(recog_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recog_channel->audio_out);
+			mpf_async_file_write(recog_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -560,17 +604,9 @@ static apt_bool_t demo_recog_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 			mrcp_engine_channel_open_respond(demo_msg->channel,TRUE);
 			break;
 		case DEMO_RECOG_MSG_CLOSE_CHANNEL:
-		{
-			/* close channel, make sure there is no activity and send asynch response */
-			demo_recog_channel_t *recog_channel = demo_msg->channel->method_obj;
-			if(recog_channel->audio_out) {
-				fclose(recog_channel->audio_out);
-				recog_channel->audio_out = NULL;
-			}
-
+			/* close channel and send asynch response, the file is closed on stream close in MPF engine context */
 			mrcp_engine_channel_close_respond(demo_msg->channel);
 			break;
-		}
 		case DEMO_RECOG_MSG_REQUEST_PROCESS:
 			demo_recog_channel_request_dispatch(demo_msg->channel,demo_msg->request);
 			break;
@@ -28,6 +28,7 @@
  */
 
 #include "mrcp_synth_engine.h"
+#include "mpf_file_io.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
 
@@ -84,6 +85,7 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo synthesizer engine */
 struct demo_synth_engine_t {
 	apt_consumer_task_t    *task;
+	mpf_file_io_t          *file_io;
 };
 
 /** Declaration of demo synthesizer channel */
@@ -102,7 +104,7 @@ struct demo_synth_channel_t {
 	/** Is paused */
 	apt_bool_t             paused;
 	/** Speech source (used instead of actual synthesis) */
-	FILE                  *audio_file;
+	mpf_async_file_t      *audio_file;
 };
 
 typedef enum {
@@ -146,6 +148,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 
 	/* create task/thread to run demo engine in the context of this task */
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_synth_msg_t),pool);
+	demo_engine->file_io = NULL;
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -185,6 +188,18 @@ static apt_bool_t demo_synth_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+
+	/* speech is read ahead by a dedicated I/O thread, off the media processing thread */
+	demo_engine->file_io = mpf_file_io_create(
+								mpf_file_io_max_files_get(engine->config->max_channel_count,engine->config->params),
+								MPF_FILE_IO_DEFAULT_BUFFER_SIZE,
+								engine->pool);
+	if(demo_engine->file_io && mpf_file_io_start(demo_engine->file_io) == FALSE) {
+		demo_engine->file_io = NULL;
+	}
+	if(!demo_engine->file_io) {
+		apt_log(SYNTH_LOG_MARK,APT_PRIO_WARNING,"Failed to Start File I/O");
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -196,6 +211,10 @@ static apt_bool_t demo_synth_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->file_io) {
+		mpf_file_io_terminate(demo_engine->file_io);
+		demo_engine->file_io = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -238,10 +257,28 @@ static mrcp_engine_channel_t* demo_synth_engine_channel_create(mrcp_engine_t *en
 	return synth_channel->channel;
 }
 
+/** Close speech source, reporting frames not read in time */
+static void demo_synth_file_close(demo_synth_channel_t *synth_channel)
+{
+	mpf_async_file_stat_t stat;
+	if(!synth_channel->audio_file) {
+		return;
+	}
+
+	mpf_async_file_stat_get(synth_channel->audio_file,&stat);
+	if(stat.late) {
+		apt_log(SYNTH_LOG_MARK,APT_PRIO_WARNING,"Replaced %"APR_SIZE_T_FMT" Late Frames of Speech Source with Silence",
+			stat.late);
+	}
+	mpf_async_file_close(synth_channel->audio_file);
+	synth_channel->audio_file = NULL;
+}
+
 /** Destroy engine channel */
 static apt_bool_t demo_synth_channel_destroy(mrcp_engine_channel_t *channel)
 {
-	/* nothing to destroy */
+	/* the file is normally closed on stream close, unless the stream has never been processed */
+	demo_synth_file_close(channel->method_obj);
 	return TRUE;
 }
 
@@ -281,8 +318,8 @@ static apt_bool_t demo_synth_channel_speak(mrcp_engine_channel_t *channel, mrcp_
 		char *file_name = apr_psprintf(channel->pool,"demo-%dkHz.pcm",descriptor->sampling_rate/1000);
 		file_path = apt_datadir_filepath_get(channel->engine->dir_layout,file_name,channel->pool);
 	}
-	if(file_path) {
-		synth_channel->audio_file = fopen(file_path,"rb");
+	if(file_path && synth_channel->demo_engine->file_io) {
+		synth_channel->audio_file = mpf_async_file_source_open(synth_channel->demo_engine->file_io,file_path);
 		if(synth_channel->audio_file) {
 			apt_log(SYNTH_LOG_MARK,APT_PRIO_INFO,"Set [%s] as Speech Source " APT_SIDRES_FMT,
 				file_path,
@@ -443,6 +480,8 @@ static apt_bool_t demo_synth_stream_open(mpf_audio_stream_t *stream, mpf_codec_t
 /** Callback is called from MPF engine context to perform any action after close */
 static apt_bool_t demo_synth_stream_close(mpf_audio_stream_t *stream)
 {
+	/* close the file in the same context it is read in */
+	demo_synth_file_close(stream->obj);
 	return TRUE;
 }
 
@@ -457,10 +496,7 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 		synth_channel->stop_response = NULL;
 		synth_channel->speak_request = NULL;
 		synth_channel->paused = FALSE;
-		if(synth_channel->audio_file) {
-			fclose(synth_channel->audio_file);
-			synth_channel->audio_file = NULL;
-		}
+		demo_synth_file_close(synth_channel);
 		return TRUE;
 	}
 
@@ -471,12 +507,17 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 		if(synth_channel->audio_file) {
 			/* read speech from file */
 			apr_size_t size = frame->codec_frame.size;
-			if(fread(frame->codec_frame.buffer,1,size,synth_channel->audio_file) == size) {
+			if(mpf_async_file_read(synth_channel->audio_file,frame->codec_frame.buffer,size) == TRUE) {
 				frame->type |= MEDIA_FRAME_TYPE_AUDIO;
 			}
-			else {
+			else if(mpf_async_file_eof(synth_channel->audio_file) == TRUE) {
 				completed = TRUE;
 			}
+			else {
+				/* the I/O thread lags behind, fill with silence rather than block */
+				memset(frame->codec_frame.buffer,0,size);
+				frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+			}
 		}
 		else {
 			/* fill with silence in case no file available */
@@ -508,10 +549,7 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 				message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
 
 				synth_channel->speak_request = NULL;
-				if(synth_channel->audio_file) {
-					fclose(synth_channel->audio_file);
-					synth_channel->audio_file = NULL;
-				}
+				demo_synth_file_close(synth_channel);
 				/* send asynch event */
 				mrcp_engine_channel_message_send(synth_channel->channel,message);
 			}
@@ -549,7 +587,7 @@ static apt_bool_t demo_synth_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 			mrcp_engine_channel_open_respond(demo_msg->channel,TRUE);
 			break;
 		case DEMO_SYNTH_MSG_CLOSE_CHANNEL:
-			/* close channel, make sure there is no activity and send asynch response */
+			/* close channel and send asynch response, the file is closed on stream close in MPF engine context */
 			mrcp_engine_channel_close_respond(demo_msg->channel);
 			break;
 		case DEMO_SYNTH_MSG_REQUEST_PROCESS:
@@ -29,6 +29,7 @@
 
 #include "mrcp_verifier_engine.h"
 #include "mpf_activity_detector.h"
+#include "mpf_file_io.h"
 #include "apt_consumer_task.h"
 #include "apt_log.h"
 
@@ -85,6 +86,7 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo verification engine */
 struct demo_verifier_engine_t {
 	apt_consumer_task_t    *task;
+	mpf_file_io_t          *file_io;
 };
 
 /** Declaration of demo verification channel */
@@ -103,7 +105,7 @@ struct demo_verifier_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write voiceprint to */
-	FILE                    *audio_out;
+	mpf_async_file_t        *audio_out;
 };
 
 typedef enum {
@@ -146,6 +148,7 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	apt_task_msg_pool_t *msg_pool;
 
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_verifier_msg_t),pool);
+	demo_engine->file_io = NULL;
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
 	if(!demo_engine->task) {
 		return NULL;
@@ -185,6 +188,18 @@ static apt_bool_t demo_verifier_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+
+	/* audio is written by a dedicated I/O thread, off the media processing thread */
+	demo_engine->file_io = mpf_file_io_create(
+								engine->config->max_channel_count,
+								MPF_FILE_IO_DEFAULT_BUFFER_SIZE,
+								engine->pool);
+	if(demo_engine->file_io && mpf_file_io_start(demo_engine->file_io) == FALSE) {
+		demo_engine->file_io = NULL;
+	}
+	if(!demo_engine->file_io) {
+		apt_log(VERIF_LOG_MARK,APT_PRIO_WARNING,"Failed to Start File I/O");
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -196,6 +211,10 @@ static apt_bool_t demo_verifier_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->file_io) {
+		mpf_file_io_terminate(demo_engine->file_io);
+		demo_engine->file_io = NULL;
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -291,7 +310,7 @@ static apt_bool_t demo_verifier_channel_verify(mrcp_engine_channel_t *channel, m
 		}
 	}
 
-	if(!verifier_channel->audio_out) {
+	if(!verifier_channel->audio_out && verifier_channel->demo_engine->file_io) {
 		const apt_dir_layout_t *dir_layout = channel->engine->dir_layout;
 		char *file_name = apr_psprintf(channel->pool,"voiceprint-%dkHz-%s.pcm",
 							descriptor->sampling_rate/1000,
@@ -299,7 +318,7 @@ static apt_bool_t demo_verifier_channel_verify(mrcp_engine_channel_t *channel, m
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
 		if(file_path) {
 			apt_log(VERIF_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			verifier_channel->audio_out = fopen(file_path,"wb");
+			verifier_channel->audio_out = mpf_async_file_sink_open(verifier_channel->demo_engine->file_io,file_path);
 			if(!verifier_channel->audio_out) {
 				apt_log(VERIF_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 			}
@@ -540,7 +559,7 @@ static apt_bool_t demo_verifier_stream_write(mpf_audio_stream_t *stream, const m
 		}
 
 		if(verifier_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,verifier_channel->audio_out);
+			mpf_async_file_write(verifier_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -579,7 +598,14 @@ static apt_bool_t demo_verifier_msg_process(apt_task_t *task, apt_task_msg_t *ms
 			/* close channel, make sure there is no activity and send asynch response */
 			demo_verifier_channel_t *verifier_channel = demo_msg->channel->method_obj;
 			if(verifier_channel->audio_out) {
-				fclose(verifier_channel->audio_out);
+				mpf_async_file_stat_t stat;
+				mpf_async_file_stat_get(verifier_channel->audio_out,&stat);
+				if(stat.dropped) {
+					apt_log(VERIF_LOG_MARK,APT_PRIO_WARNING,"Dropped %"APR_SIZE_T_FMT" Frames (%"APR_SIZE_T_FMT" bytes) of Voiceprint Output File",
+						stat.dropped,
+						stat.dropped_bytes);
+				}
+				mpf_async_file_close(verifier_channel->audio_out);
 				verifier_channel->audio_out = NULL;
 			}
 
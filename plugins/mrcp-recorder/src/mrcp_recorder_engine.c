@@ -29,6 +29,7 @@
 
 #include "mrcp_recorder_engine.h"
 #include "mpf_activity_detector.h"
+#include "mpf_file_io.h"
 #include "apt_log.h"
 
 #define RECORDER_ENGINE_TASK_NAME "Recorder Engine"
@@ -100,8 +101,10 @@ struct recorder_channel_t {
 	apr_size_t               cur_size;
 	/** File name of the recording */
 	const char              *file_name;
+	/** File I/O agent of the engine */
+	mpf_file_io_t           *file_io;
 	/** File to write to */
-	FILE                    *audio_out;
+	mpf_async_file_t        *audio_out;
 };
 
 /** Declare this macro to set plugin version */
@@ -137,12 +140,26 @@ static apt_bool_t recorder_engine_destroy(mrcp_engine_t *engine)
 /** Open recorder engine */
 static apt_bool_t recorder_engine_open(mrcp_engine_t *engine)
 {
+	/* recordings are flushed by a dedicated I/O thread, off the media processing thread */
+	mpf_file_io_t *file_io = mpf_file_io_create(
+								mpf_file_io_max_files_get(engine->config->max_channel_count,engine->config->params),
+								MPF_FILE_IO_DEFAULT_BUFFER_SIZE,
+								engine->pool);
+	if(!file_io || mpf_file_io_start(file_io) == FALSE) {
+		apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Failed to Start File I/O");
+		return mrcp_engine_open_respond(engine,FALSE);
+	}
+	engine->obj = file_io;
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
 /** Close recorder engine */
 static apt_bool_t recorder_engine_close(mrcp_engine_t *engine)
 {
+	mpf_file_io_t *file_io = engine->obj;
+	if(file_io) {
+		mpf_file_io_terminate(file_io);
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -156,10 +173,15 @@ static mrcp_engine_channel_t* recorder_engine_channel_create(mrcp_engine_t *engi
 	recorder_channel->record_request = NULL;
 	recorder_channel->stop_response = NULL;
 	recorder_channel->detector = mpf_activity_detector_create(pool);
+	/* "vad-mode" and "vad-snr-threshold" engine params */
+	if(engine->config) {
+		mpf_activity_detector_params_set(recorder_channel->detector,engine->config->params);
+	}
 	recorder_channel->max_time = 0;
 	recorder_channel->cur_time = 0;
 	recorder_channel->cur_size = 0;
 	recorder_channel->file_name = NULL;
+	recorder_channel->file_io = engine->obj;
 	recorder_channel->audio_out = NULL;
 
 	capabilities = mpf_sink_stream_capabilities_create(pool);
@@ -186,10 +208,30 @@ static mrcp_engine_channel_t* recorder_engine_channel_create(mrcp_engine_t *engi
 	return recorder_channel->channel;
 }
 
+/** Close file, reporting data dropped, since the I/O thread lagged behind */
+static void recorder_file_close(recorder_channel_t *recorder_channel)
+{
+	mpf_async_file_stat_t stat;
+	if(!recorder_channel->audio_out) {
+		return;
+	}
+
+	mpf_async_file_stat_get(recorder_channel->audio_out,&stat);
+	if(stat.dropped) {
+		apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Dropped %"APR_SIZE_T_FMT" Frames (%"APR_SIZE_T_FMT" bytes) of Recording [%s]",
+			stat.dropped,
+			stat.dropped_bytes,
+			recorder_channel->file_name);
+	}
+	mpf_async_file_close(recorder_channel->audio_out);
+	recorder_channel->audio_out = NULL;
+}
+
 /** Destroy engine channel */
 static apt_bool_t recorder_channel_destroy(mrcp_engine_channel_t *channel)
 {
-	/* nothing to destrtoy */
+	/* the file is normally closed on stream close, unless the stream has never been processed */
+	recorder_file_close(channel->method_obj);
 	return TRUE;
 }
 
@@ -203,7 +245,7 @@ static apt_bool_t recorder_channel_open(mrcp_engine_channel_t *channel)
 /** Close engine channel (asynchronous response MUST be sent)*/
 static apt_bool_t recorder_channel_close(mrcp_engine_channel_t *channel)
 {
-	/* close channel, make sure there is no activity and send asynch response */
+	/* close channel and send asynch response, the file is closed on stream close in MPF engine context */
 	return mrcp_engine_channel_close_respond(channel);
 }
 
@@ -230,13 +272,10 @@ static apt_bool_t recorder_file_open(recorder_channel_t *recorder_channel, mrcp_
 		return FALSE;
 	}
 
-	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
-		recorder_channel->audio_out = NULL;
-	}
+	recorder_file_close(recorder_channel);
 
 	apt_log(RECORD_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-	recorder_channel->audio_out = fopen(file_path,"wb");
+	recorder_channel->audio_out = mpf_async_file_sink_open(recorder_channel->file_io,file_path);
 	if(!recorder_channel->audio_out) {
 		apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 		return FALSE;
@@ -386,10 +425,7 @@ static apt_bool_t recorder_record_complete(recorder_channel_t *recorder_channel,
 		return FALSE;
 	}
 
-	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
-		recorder_channel->audio_out = NULL;
-	}
+	recorder_file_close(recorder_channel);
 
 	/* get/allocate recorder header */
 	recorder_header = mrcp_resource_header_prepare(message);
@@ -423,6 +459,8 @@ static apt_bool_t recorder_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *
 /** Callback is called from MPF engine context to perform any action after close */
 static apt_bool_t recorder_stream_close(mpf_audio_stream_t *stream)
 {
+	/* close the file in the same context it is written in */
+	recorder_file_close(stream->obj);
 	return TRUE;
 }
 
@@ -431,10 +469,7 @@ static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_fr
 {
 	recorder_channel_t *recorder_channel = stream->obj;
 	if(recorder_channel->stop_response) {
-		if(recorder_channel->audio_out) {
-			fclose(recorder_channel->audio_out);
-			recorder_channel->audio_out = NULL;
-		}
+		recorder_file_close(recorder_channel);
 		
 		if(recorder_channel->record_request){
 			/* set record-uri */
@@ -472,7 +507,7 @@ static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_fr
 		}
 
 		if(recorder_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recorder_channel->audio_out);
+			mpf_async_file_write(recorder_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 			
 			recorder_channel->cur_size += frame->codec_frame.size;
 			recorder_channel->cur_time += stream->tx_descriptor->frame_duration;
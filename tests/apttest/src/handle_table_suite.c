@@ -0,0 +1,164 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_hash.h>
+#include "apt_test_suite.h"
+#include "apt_handle_table.h"
+#include "apt_log.h"
+
+/** Default number of lookups made by the benchmark */
+#define HANDLE_BENCH_LOOKUP_COUNT  10000000
+/** Number of objects kept in the tables (concurrent sessions) */
+#define HANDLE_OBJECT_COUNT        1000
+/** Number of random operations checked against the reference */
+#define HANDLE_VERIFY_OP_COUNT     200000
+/** Length of generated identifiers */
+#define HANDLE_ID_LENGTH           16
+
+/** Check random adds and removes against a plain array of objects indexed by handle */
+static apt_bool_t handle_table_verify(apr_pool_t *pool)
+{
+	apt_handle_table_t *table = apt_handle_table_create(2,pool);
+	void **reference = apr_pcalloc(pool,sizeof(void*) * (HANDLE_VERIFY_OP_COUNT + 1));
+	apr_uint32_t *live = apr_palloc(pool,sizeof(apr_uint32_t) * HANDLE_VERIFY_OP_COUNT);
+	apr_size_t live_count = 0;
+	apr_uint32_t seed = 1;
+	apr_uint32_t handle;
+	apr_size_t i;
+	apr_size_t n;
+
+	for(n=0; n<HANDLE_VERIFY_OP_COUNT; n++) {
+		seed = seed * 1103515245 + 12345;
+		if(live_count && (seed >> 16) % 3 == 0) {
+			/* remove random live handle */
+			i = (seed >> 8) % live_count;
+			handle = live[i];
+			live[i] = live[--live_count];
+			apt_handle_table_set(table,handle,NULL);
+			reference[handle] = NULL;
+		}
+		else {
+			handle = apt_handle_table_add(table,&reference[n]);
+			if(!handle || handle > HANDLE_VERIFY_OP_COUNT || reference[handle]) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Handle [%u]",handle);
+				return FALSE;
+			}
+			reference[handle] = &reference[n];
+			live[live_count++] = handle;
+		}
+
+		if(apt_handle_table_count(table) != live_count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Count Mismatch [%"APR_SIZE_T_FMT"]",live_count);
+			return FALSE;
+		}
+		if(n % 1000 == 0) {
+			for(handle=1; handle<=n+1; handle++) {
+				if(apt_handle_table_get(table,handle) != reference[handle]) {
+					apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Lookup Mismatch [%u]",handle);
+					return FALSE;
+				}
+			}
+		}
+	}
+	return TRUE;
+}
+
+/** Check identifiers encode handles, and foreign identifiers decode to no handle */
+static apt_bool_t handle_id_verify(apr_pool_t *pool)
+{
+	static const char *foreign_ids[] = {"", "1234567", "session-42", "7f3a9b2g00000000"};
+	apt_str_t id;
+	apr_uint32_t handles[] = {1, 0xabcdef, 0xFFFFFFFF};
+	apr_size_t i;
+
+	for(i=0; i<sizeof(handles)/sizeof(handles[0]); i++) {
+		apt_handle_id_generate(&id,handles[i],HANDLE_ID_LENGTH,pool);
+		if(id.length != HANDLE_ID_LENGTH || strlen(id.buf) != HANDLE_ID_LENGTH || apt_handle_id_parse(&id) != handles[i]) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Parse Handle [%u] from [%s]",handles[i],id.buf);
+			return FALSE;
+		}
+	}
+	for(i=0; i<sizeof(foreign_ids)/sizeof(foreign_ids[0]); i++) {
+		apt_string_assign(&id,foreign_ids[i],pool);
+		if(apt_handle_id_parse(&id) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Handle Parsed from [%s]",foreign_ids[i]);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static apt_bool_t handle_table_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apt_handle_table_t *table = apt_handle_table_create(HANDLE_TABLE_DEFAULT_SIZE,suite->pool);
+	apr_hash_t *hash = apr_hash_make(suite->pool);
+	apt_str_t *ids = apr_palloc(suite->pool,sizeof(apt_str_t) * HANDLE_OBJECT_COUNT);
+	apr_size_t lookup_count = HANDLE_BENCH_LOOKUP_COUNT;
+	apr_size_t found = 0;
+	apr_time_t start;
+	apr_time_t handle_time;
+	apr_time_t hash_time;
+	apr_uint32_t handle;
+	apr_size_t i;
+	const apt_str_t *id;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		lookup_count = atol(argv[0]);
+	}
+
+	if(handle_table_verify(suite->pool) == FALSE || handle_id_verify(suite->pool) == FALSE) {
+		return FALSE;
+	}
+
+	for(i=0; i<HANDLE_OBJECT_COUNT; i++) {
+		handle = apt_handle_table_add(table,&ids[i]);
+		apt_handle_id_generate(&ids[i],handle,HANDLE_ID_LENGTH,suite->pool);
+		apr_hash_set(hash,ids[i].buf,ids[i].length,&ids[i]);
+	}
+
+	/* look up objects by identifiers as received in messages */
+	start = apr_time_now();
+	for(i=0; i<lookup_count; i++) {
+		id = &ids[i % HANDLE_OBJECT_COUNT];
+		if(apt_handle_table_get(table,apt_handle_id_parse(id)) == id) {
+			found++;
+		}
+	}
+	handle_time = apr_time_now() - start;
+
+	start = apr_time_now();
+	for(i=0; i<lookup_count; i++) {
+		id = &ids[i % HANDLE_OBJECT_COUNT];
+		if(apr_hash_get(hash,id->buf,id->length) == id) {
+			found++;
+		}
+	}
+	hash_time = apr_time_now() - start;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Lookup of %d Objects: %"APR_SIZE_T_FMT" lookups, handle table %.1f ns/lookup, string hash %.1f ns/lookup",
+		HANDLE_OBJECT_COUNT,
+		lookup_count,
+		(double)handle_time * 1000 / lookup_count,
+		(double)hash_time * 1000 / lookup_count);
+	return found == lookup_count * 2 ? TRUE : FALSE;
+}
+
+apt_test_suite_t* handle_table_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"handle-table",NULL,handle_table_test_run);
+	return suite;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include "apt_test_suite.h"
+#include "apt_lockfree_queue.h"
+#include "apt_cyclic_queue.h"
+#include "apt_log.h"
+
+/** Default number of objects pushed by each producer */
+#define QUEUE_BENCH_OBJECT_COUNT   1000000
+/** Max number of producer threads */
+#define QUEUE_BENCH_MAX_PRODUCERS  8
+/** Number of bits used to encode the sequence number of object */
+#define QUEUE_BENCH_SEQUENCE_BITS  24
+
+typedef struct queue_bench_t queue_bench_t;
+
+/** Queue under the benchmark */
+typedef struct {
+	const char *name;
+	apt_bool_t (*push)(queue_bench_t *bench, void *obj);
+	void*      (*pop)(queue_bench_t *bench);
+} queue_bench_vtable_t;
+
+/** Benchmark of the queue contended by producers and a single consumer */
+struct queue_bench_t {
+	const queue_bench_vtable_t *vtable;
+	apt_lockfree_queue_t       *lockfree_queue;
+	apt_cyclic_queue_t         *cyclic_queue;
+	apr_thread_mutex_t         *guard;
+	apr_size_t                  object_count;
+};
+
+/** Producer of objects */
+typedef struct {
+	queue_bench_t *bench;
+	apr_size_t     id;
+	apr_size_t     retries;
+} queue_producer_t;
+
+static apt_bool_t lockfree_push(queue_bench_t *bench, void *obj)
+{
+	return apt_lockfree_queue_push(bench->lockfree_queue,obj);
+}
+
+static void* lockfree_pop(queue_bench_t *bench)
+{
+	return apt_lockfree_queue_pop(bench->lockfree_queue);
+}
+
+static apt_bool_t mutex_push(queue_bench_t *bench, void *obj)
+{
+	apt_bool_t status;
+	apr_thread_mutex_lock(bench->guard);
+	status = apt_cyclic_queue_push(bench->cyclic_queue,obj);
+	apr_thread_mutex_unlock(bench->guard);
+	return status;
+}
+
+static void* mutex_pop(queue_bench_t *bench)
+{
+	void *obj;
+	apr_thread_mutex_lock(bench->guard);
+	obj = apt_cyclic_queue_pop(bench->cyclic_queue);
+	apr_thread_mutex_unlock(bench->guard);
+	return obj;
+}
+
+static const queue_bench_vtable_t lockfree_vtable = {"lock-free", lockfree_push, lockfree_pop};
+static const queue_bench_vtable_t mutex_vtable = {"mutex", mutex_push, mutex_pop};
+
+static void* APR_THREAD_FUNC queue_producer_run(apr_thread_t *thread, void *data)
+{
+	queue_producer_t *producer = data;
+	queue_bench_t *bench = producer->bench;
+	apr_size_t i;
+	void *obj;
+	for(i=1; i<=bench->object_count; i++) {
+		/* encode the producer id along with the sequence number, which never is 0 */
+		obj = (void*)((producer->id << QUEUE_BENCH_SEQUENCE_BITS) | i);
+		while(bench->vtable->push(bench,obj) == FALSE) {
+			producer->retries++;
+			apr_thread_yield();
+		}
+	}
+	apr_thread_exit(thread,APR_SUCCESS);
+	return NULL;
+}
+
+static apt_bool_t queue_bench_run(queue_bench_t *bench, apr_size_t producer_count, apr_pool_t *pool)
+{
+	queue_producer_t producers[QUEUE_BENCH_MAX_PRODUCERS];
+	apr_thread_t *threads[QUEUE_BENCH_MAX_PRODUCERS];
+	apr_size_t last_sequence[QUEUE_BENCH_MAX_PRODUCERS];
+	apr_size_t expected_count = producer_count * bench->object_count;
+	apr_size_t count = 0;
+	apr_size_t empty_count = 0;
+	apr_size_t retries = 0;
+	apr_size_t id, sequence;
+	apr_size_t i;
+	apr_time_t start, pop_start, pop_time, max_pop_time = 0;
+	apr_time_t elapsed;
+	apr_status_t rv;
+	apt_bool_t status = TRUE;
+	void *obj;
+
+	start = apr_time_now();
+	for(i=0; i<producer_count; i++) {
+		producers[i].bench = bench;
+		producers[i].id = i;
+		producers[i].retries = 0;
+		last_sequence[i] = 0;
+		if(apr_thread_create(&threads[i],NULL,queue_producer_run,&producers[i],pool) != APR_SUCCESS) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Producer Thread");
+			return FALSE;
+		}
+	}
+
+	/* consume objects checking the order of every producer is retained */
+	while(count < expected_count) {
+		pop_start = apr_time_now();
+		obj = bench->vtable->pop(bench);
+		pop_time = apr_time_now() - pop_start;
+		if(pop_time > max_pop_time) {
+			max_pop_time = pop_time;
+		}
+		if(!obj) {
+			empty_count++;
+			apr_thread_yield();
+			continue;
+		}
+
+		id = (apr_size_t)obj >> QUEUE_BENCH_SEQUENCE_BITS;
+		sequence = (apr_size_t)obj & ((1 << QUEUE_BENCH_SEQUENCE_BITS) - 1);
+		if(id >= producer_count || sequence != last_sequence[id] + 1) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Object [%"APR_SIZE_T_FMT":%"APR_SIZE_T_FMT"]",id,sequence);
+			/* keep draining the queue, so that the producers can complete */
+			status = FALSE;
+		}
+		else {
+			last_sequence[id] = sequence;
+		}
+		count++;
+	}
+
+	for(i=0; i<producer_count; i++) {
+		apr_thread_join(&rv,threads[i]);
+		retries += producers[i].retries;
+	}
+	elapsed = apr_time_now() - start;
+	if(elapsed <= 0) {
+		elapsed = 1;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Queue [%s] producers [%"APR_SIZE_T_FMT"]: %"APR_SIZE_T_FMT" objects in %"APR_TIME_T_FMT" usec, %.0f objects/sec, max pop %"APR_TIME_T_FMT" usec, empty pops %"APR_SIZE_T_FMT", full retries %"APR_SIZE_T_FMT,
+		bench->vtable->name,
+		producer_count,
+		count,
+		elapsed,
+		(double)count * 1000000 / elapsed,
+		max_pop_time,
+		empty_count,
+		retries);
+	return status;
+}
+
+static apt_bool_t lockfree_queue_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const apr_size_t producer_counts[] = {1, 2, 4};
+	queue_bench_t bench;
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+
+	bench.object_count = QUEUE_BENCH_OBJECT_COUNT;
+	if(argc > 0) {
+		bench.object_count = atol(argv[0]);
+		if(!bench.object_count || bench.object_count >= (1 << QUEUE_BENCH_SEQUENCE_BITS)) {
+			bench.object_count = QUEUE_BENCH_OBJECT_COUNT;
+		}
+	}
+
+	bench.lockfree_queue = apt_lockfree_queue_create(LOCKFREE_QUEUE_DEFAULT_SIZE,suite->pool);
+	bench.cyclic_queue = apt_cyclic_queue_create(CYCLIC_QUEUE_DEFAULT_SIZE);
+	apr_thread_mutex_create(&bench.guard,APR_THREAD_MUTEX_UNNESTED,suite->pool);
+
+	for(i=0; i<sizeof(producer_counts)/sizeof(producer_counts[0]); i++) {
+		bench.vtable = &lockfree_vtable;
+		if(queue_bench_run(&bench,producer_counts[i],suite->pool) == FALSE) {
+			status = FALSE;
+		}
+
+		bench.vtable = &mutex_vtable;
+		if(queue_bench_run(&bench,producer_counts[i],suite->pool) == FALSE) {
+			status = FALSE;
+		}
+	}
+
+	apr_thread_mutex_destroy(bench.guard);
+	apt_cyclic_queue_destroy(bench.cyclic_queue);
+	return status;
+}
+
+apt_test_suite_t* lockfree_queue_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"lockfree-queue",NULL,lockfree_queue_test_run);
+	return suite;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_timer_queue.h"
+#include "apt_log.h"
+
+/** Max timeout of timers in msec */
+#define TIMER_BENCH_MAX_TIMEOUT  30000
+/** Time the queue is advanced by at once in msec */
+#define TIMER_BENCH_STEP         10
+/** Resolution of the wheel in msec */
+#define TIMER_BENCH_RESOLUTION   10
+/** Number of steps to run timers for */
+#define TIMER_BENCH_STEPS        (TIMER_BENCH_MAX_TIMEOUT / TIMER_BENCH_STEP)
+/** Max number of timers the sorted list is run with by default (100k timers take minutes) */
+#define TIMER_BENCH_LIST_MAX_COUNT 10000
+/** Period of the timer rearmed from its own proc in msec (as RTCP timers are) */
+#define TIMER_PERIODIC_PERIOD    50
+/** Number of steps to run the periodic timer for */
+#define TIMER_PERIODIC_STEPS     1000
+
+typedef struct timer_bench_t timer_bench_t;
+
+/** Timer under the benchmark */
+typedef struct {
+	timer_bench_t *bench;
+	apt_timer_t   *timer;
+	apr_uint32_t   due_time;
+	apt_bool_t     set;
+} timer_bench_item_t;
+
+/** Benchmark of the timer queue */
+struct timer_bench_t {
+	timer_bench_item_t *items;
+	apr_size_t          count;
+	apr_uint32_t        now;
+	apr_uint32_t        seed;
+	apr_size_t          fired;
+	apr_size_t          early;
+	apr_size_t          late;
+};
+
+/** Pseudo-random number generator, so that both queues get the same sequence */
+static apr_uint32_t timer_bench_random(timer_bench_t *bench, apr_uint32_t max)
+{
+	bench->seed = bench->seed * 1103515245 + 12345;
+	return 1 + (bench->seed >> 8) % max;
+}
+
+static void timer_bench_proc(apt_timer_t *timer, void *obj)
+{
+	timer_bench_item_t *item = obj;
+	timer_bench_t *bench = item->bench;
+	if(bench->now < item->due_time) {
+		bench->early++;
+	}
+	else if(bench->now - item->due_time >= TIMER_BENCH_STEP + TIMER_BENCH_RESOLUTION) {
+		bench->late++;
+	}
+	item->set = FALSE;
+	bench->fired++;
+}
+
+static void timer_bench_set(timer_bench_t *bench, timer_bench_item_t *item)
+{
+	apr_uint32_t timeout = timer_bench_random(bench,TIMER_BENCH_MAX_TIMEOUT);
+	item->due_time = bench->now + timeout;
+	item->set = TRUE;
+	apt_timer_set(item->timer,timeout);
+}
+
+static apt_bool_t timer_bench_run(apt_timer_queue_type_e type, apr_size_t count, apr_pool_t *pool)
+{
+	timer_bench_t bench;
+	apt_timer_queue_t *timer_queue;
+	apr_size_t i;
+	apr_size_t step;
+	apr_size_t lost = 0;
+	apt_bool_t status = TRUE;
+	apr_time_t start;
+	apr_time_t set_time, churn_time, kill_time;
+
+	if(type == APT_TIMER_QUEUE_WHEEL) {
+		timer_queue = apt_timer_queue_create_ex(APT_TIMER_QUEUE_WHEEL,TIMER_BENCH_RESOLUTION,pool);
+	}
+	else {
+		timer_queue = apt_timer_queue_create(pool);
+	}
+
+	bench.count = count;
+	bench.now = 0;
+	bench.seed = 1;
+	bench.fired = 0;
+	bench.early = 0;
+	bench.late = 0;
+	bench.items = apr_palloc(pool,sizeof(timer_bench_item_t) * count);
+	for(i=0; i<count; i++) {
+		bench.items[i].bench = &bench;
+		bench.items[i].set = FALSE;
+		bench.items[i].timer = apt_timer_create(timer_queue,timer_bench_proc,&bench.items[i],pool);
+	}
+
+	/* set all the timers */
+	start = apr_time_now();
+	for(i=0; i<count; i++) {
+		timer_bench_set(&bench,&bench.items[i]);
+	}
+	set_time = apr_time_now() - start;
+
+	/* advance the queue, rearming a random timer on every step
+	the same way inactivity timers are rearmed on activity */
+	start = apr_time_now();
+	for(step=0; step<TIMER_BENCH_STEPS; step++) {
+		for(i=0; i<count / TIMER_BENCH_STEPS + 1; i++) {
+			timer_bench_set(&bench,&bench.items[timer_bench_random(&bench,(apr_uint32_t)count) - 1]);
+		}
+		bench.now += TIMER_BENCH_STEP;
+		apt_timer_queue_advance(timer_queue,TIMER_BENCH_STEP);
+	}
+	churn_time = apr_time_now() - start;
+
+	/* kill the rest of the timers */
+	start = apr_time_now();
+	for(i=0; i<count; i++) {
+		if(bench.items[i].set == TRUE) {
+			if(apt_timer_kill(bench.items[i].timer) == FALSE) {
+				/* the timer has neither fired nor remained set */
+				lost++;
+			}
+			bench.items[i].set = FALSE;
+		}
+	}
+	kill_time = apr_time_now() - start;
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Timer Queue [%s] timers [%"APR_SIZE_T_FMT"]: set %"APR_TIME_T_FMT" usec, advance with rearm %"APR_TIME_T_FMT" usec, kill %"APR_TIME_T_FMT" usec, fired %"APR_SIZE_T_FMT" early %"APR_SIZE_T_FMT" late %"APR_SIZE_T_FMT,
+		type == APT_TIMER_QUEUE_WHEEL ? "wheel" : "sorted-list",
+		count,
+		set_time,
+		churn_time,
+		kill_time,
+		bench.fired,
+		bench.early,
+		bench.late);
+
+	if(bench.early || bench.late || lost || apt_timer_queue_is_empty(timer_queue) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Timer Queue [%s] State",
+			type == APT_TIMER_QUEUE_WHEEL ? "wheel" : "sorted-list");
+		status = FALSE;
+	}
+	apt_timer_queue_destroy(timer_queue);
+	return status;
+}
+
+/** Timer rearmed from its own proc */
+typedef struct {
+	apt_timer_t   *timer;
+	apr_uint32_t   now;
+	apr_uint32_t   due_time;
+	apr_size_t     fired;
+	apr_size_t     off;
+} timer_periodic_t;
+
+static void timer_periodic_proc(apt_timer_t *timer, void *obj)
+{
+	timer_periodic_t *periodic = obj;
+	/* the first period may be one step longer, since the advance the timer was set within is skipped */
+	if(periodic->now < periodic->due_time ||
+		periodic->now - periodic->due_time >= (periodic->fired ? 1 : TIMER_BENCH_STEP + 1)) {
+		periodic->off++;
+	}
+	periodic->fired++;
+	periodic->due_time = periodic->now + TIMER_PERIODIC_PERIOD;
+	apt_timer_set(timer,TIMER_PERIODIC_PERIOD);
+}
+
+/** Check a single timer rearmed from its own proc fires every period on time */
+static apt_bool_t timer_periodic_run(apt_timer_queue_type_e type, apr_pool_t *pool)
+{
+	timer_periodic_t periodic;
+	apt_timer_queue_t *timer_queue;
+	apr_size_t step;
+	apr_size_t expected = TIMER_PERIODIC_STEPS * TIMER_BENCH_STEP / TIMER_PERIODIC_PERIOD - 1;
+
+	if(type == APT_TIMER_QUEUE_WHEEL) {
+		timer_queue = apt_timer_queue_create_ex(APT_TIMER_QUEUE_WHEEL,TIMER_BENCH_RESOLUTION,pool);
+	}
+	else {
+		timer_queue = apt_timer_queue_create(pool);
+	}
+
+	periodic.now = 0;
+	periodic.fired = 0;
+	periodic.off = 0;
+	periodic.timer = apt_timer_create(timer_queue,timer_periodic_proc,&periodic,pool);
+	periodic.due_time = TIMER_PERIODIC_PERIOD;
+	apt_timer_set(periodic.timer,TIMER_PERIODIC_PERIOD);
+
+	for(step=0; step<TIMER_PERIODIC_STEPS; step++) {
+		periodic.now += TIMER_BENCH_STEP;
+		apt_timer_queue_advance(timer_queue,TIMER_BENCH_STEP);
+	}
+	apt_timer_kill(periodic.timer);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Periodic Timer [%s]: fired %"APR_SIZE_T_FMT" expected %"APR_SIZE_T_FMT" off-time %"APR_SIZE_T_FMT,
+		type == APT_TIMER_QUEUE_WHEEL ? "wheel" : "sorted-list",
+		periodic.fired,
+		expected,
+		periodic.off);
+	apt_timer_queue_destroy(timer_queue);
+	return (periodic.off == 0 && periodic.fired >= expected) ? TRUE : FALSE;
+}
+
+static apt_bool_t timer_queue_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const apr_size_t counts[] = {10000, 100000};
+	apr_size_t list_max_count = TIMER_BENCH_LIST_MAX_COUNT;
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		list_max_count = atol(argv[0]);
+	}
+
+	if(timer_periodic_run(APT_TIMER_QUEUE_WHEEL,suite->pool) == FALSE ||
+		timer_periodic_run(APT_TIMER_QUEUE_SORTED_LIST,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+
+	for(i=0; i<sizeof(counts)/sizeof(counts[0]); i++) {
+		if(timer_bench_run(APT_TIMER_QUEUE_WHEEL,counts[i],suite->pool) == FALSE) {
+			status = FALSE;
+		}
+		if(counts[i] > list_max_count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Skip Timer Queue [sorted-list] timers [%"APR_SIZE_T_FMT"]",counts[i]);
+			continue;
+		}
+		if(timer_bench_run(APT_TIMER_QUEUE_SORTED_LIST,counts[i],suite->pool) == FALSE) {
+			status = FALSE;
+		}
+	}
+	return status;
+}
+
+apt_test_suite_t* timer_queue_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"timer-queue",NULL,timer_queue_test_run);
+	return suite;
+}
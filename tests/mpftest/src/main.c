@@ -18,6 +18,17 @@
 #include "apt_log.h"
 
 apt_test_suite_t* mpf_suite_create(apr_pool_t *pool);
+apt_test_suite_t* resampler_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* buffer_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* g711_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* mixer_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* vad_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* dtmf_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* file_io_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* rx_path_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* plc_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* jb_test_suite_create(apr_pool_t *pool);
+apt_test_suite_t* scheduler_test_suite_create(apr_pool_t *pool);
 
 int main(int argc, const char * const *argv)
 {
@@ -38,6 +49,39 @@ int main(int argc, const char * const *argv)
 	test_suite = mpf_suite_create(pool);
 	apt_test_framework_suite_add(test_framework,test_suite);
 
+	test_suite = resampler_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = buffer_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = g711_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = mixer_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = vad_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = dtmf_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = file_io_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = rx_path_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = plc_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = jb_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = scheduler_test_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
 	/* run tests */
 	apt_test_framework_run(test_framework,argc,argv);
 
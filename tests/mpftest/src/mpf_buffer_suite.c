@@ -0,0 +1,249 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_buffer.h"
+
+/** Default number of bytes streamed through the buffer (1 minute of 8 kHz linear PCM) */
+#define BUFFER_TEST_STREAM_SIZE  (16000 * 60)
+/** Size of frames read from the buffer */
+#define BUFFER_TEST_FRAME_SIZE   320
+/** Max size of chunks written to the buffer */
+#define BUFFER_TEST_MAX_CHUNK    4000
+/** Max number of bytes the writer keeps buffered ahead of the reader */
+#define BUFFER_TEST_MAX_FILL     (BUFFER_TEST_MAX_CHUNK * 4)
+
+/** Pattern of the streamed data, so that the order of bytes can be verified */
+static APR_INLINE char buffer_test_pattern(apr_size_t offset)
+{
+	return (char)(offset * 7 + (offset >> 8));
+}
+
+static apt_bool_t buffer_stream_test(mpf_buffer_t *buffer, apr_size_t stream_size)
+{
+	char chunk[BUFFER_TEST_MAX_CHUNK];
+	char data[BUFFER_TEST_FRAME_SIZE];
+	mpf_frame_t frame;
+	mpf_buffer_stat_t stat;
+	apr_size_t written = 0;
+	apr_size_t read = 0;
+	apr_size_t size;
+	apr_size_t i;
+	apr_size_t events_written = 0;
+	apr_size_t events_read = 0;
+	apr_uint32_t seed = 1;
+
+	while(read < stream_size) {
+		/* write chunks of random size, interleaved with events, as a TTS engine does */
+		while(written < stream_size && mpf_buffer_get_size(buffer) < BUFFER_TEST_MAX_FILL) {
+			seed = seed * 1103515245 + 12345;
+			size = 1 + (seed >> 8) % BUFFER_TEST_MAX_CHUNK;
+			if(size > stream_size - written) {
+				size = stream_size - written;
+			}
+			for(i=0; i<size; i++) {
+				chunk[i] = buffer_test_pattern(written + i);
+			}
+			if(mpf_buffer_audio_write(buffer,chunk,size) == FALSE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Write to Buffer [%"APR_SIZE_T_FMT" bytes]",size);
+				return FALSE;
+			}
+			written += size;
+			if((seed >> 4) % 8 == 0) {
+				mpf_buffer_event_write(buffer,MEDIA_FRAME_TYPE_EVENT);
+				events_written++;
+			}
+		}
+
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.codec_frame.buffer = data;
+		frame.codec_frame.size = sizeof(data);
+		mpf_buffer_frame_read(buffer,&frame);
+		if(frame.type & MEDIA_FRAME_TYPE_EVENT) {
+			events_read++;
+		}
+		size = sizeof(data);
+		if(size > stream_size - read) {
+			size = stream_size - read;
+		}
+		for(i=0; i<size; i++) {
+			if(data[i] != buffer_test_pattern(read + i)) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Data at [%"APR_SIZE_T_FMT"]",read + i);
+				return FALSE;
+			}
+		}
+		read += size;
+	}
+
+	/* drain trailing events */
+	do {
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.codec_frame.buffer = data;
+		frame.codec_frame.size = sizeof(data);
+		mpf_buffer_frame_read(buffer,&frame);
+		if(frame.type & MEDIA_FRAME_TYPE_EVENT) {
+			events_read++;
+		}
+	}
+	while(frame.type != MEDIA_FRAME_TYPE_NONE);
+
+	mpf_buffer_stat_get(buffer,&stat);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Buffer Stream [%"APR_SIZE_T_FMT" bytes]: peak %"APR_SIZE_T_FMT" bytes, slots allocated %"APR_SIZE_T_FMT" used %"APR_SIZE_T_FMT" of %"APR_SIZE_T_FMT" bytes, events written %"APR_SIZE_T_FMT" frames with events read %"APR_SIZE_T_FMT,
+		stream_size,
+		stat.peak_size,
+		stat.allocated_slots,
+		stat.used_slots,
+		stat.slot_size,
+		events_written,
+		events_read);
+
+	/* memory must be bounded by the fill level rather than grow with the stream */
+	if(stat.size || stat.used_slots || (events_written && !events_read) ||
+		stat.allocated_slots * stat.slot_size > BUFFER_TEST_MAX_FILL * 4) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Buffer State");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t buffer_overflow_test(apr_pool_t *pool)
+{
+	char chunk[BUFFER_TEST_FRAME_SIZE];
+	mpf_buffer_stat_t stat;
+	apt_bool_t status = TRUE;
+	/* 4 slots without overflow */
+	mpf_buffer_t *buffer = mpf_buffer_create_ex(BUFFER_TEST_FRAME_SIZE,4,4,pool);
+	memset(chunk,0,sizeof(chunk));
+
+	if(mpf_buffer_audio_write(buffer,chunk,sizeof(chunk) / 2) == FALSE ||
+		mpf_buffer_audio_write(buffer,chunk,sizeof(chunk) * 3) == FALSE) {
+		status = FALSE;
+	}
+	/* the buffer is full except a half of the last slot */
+	if(mpf_buffer_audio_write(buffer,chunk,sizeof(chunk)) == TRUE ||
+		mpf_buffer_event_write(buffer,MEDIA_FRAME_TYPE_EVENT) == TRUE ||
+		mpf_buffer_audio_write(buffer,chunk,sizeof(chunk) / 2) == FALSE) {
+		status = FALSE;
+	}
+
+	mpf_buffer_stat_get(buffer,&stat);
+	if(stat.size != sizeof(chunk) * 4 || stat.used_slots != 4 || stat.allocated_slots != 4 || stat.overflow_count != 2) {
+		status = FALSE;
+	}
+	if(status == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Bounded Buffer State");
+	}
+	mpf_buffer_destroy(buffer);
+	return status;
+}
+
+static apt_bool_t buffer_shrink_test(apr_pool_t *pool)
+{
+	char chunk[BUFFER_TEST_FRAME_SIZE];
+	mpf_frame_t frame;
+	mpf_buffer_stat_t stat;
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+	/* 2 preallocated slots with unlimited overflow */
+	mpf_buffer_t *buffer = mpf_buffer_create_ex(BUFFER_TEST_FRAME_SIZE,2,0,pool);
+	memset(chunk,0,sizeof(chunk));
+
+	for(i=0; i<8; i++) {
+		mpf_buffer_audio_write(buffer,chunk,sizeof(chunk));
+	}
+	mpf_buffer_stat_get(buffer,&stat);
+	if(stat.allocated_slots != 8 || stat.used_slots != 8) {
+		status = FALSE;
+	}
+
+	/* overflow slots are freed once read, the preallocated ones remain */
+	for(i=0; i<8; i++) {
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.codec_frame.buffer = chunk;
+		frame.codec_frame.size = sizeof(chunk);
+		mpf_buffer_frame_read(buffer,&frame);
+	}
+	mpf_buffer_stat_get(buffer,&stat);
+	if(stat.allocated_slots != 2 || stat.used_slots || stat.size) {
+		status = FALSE;
+	}
+
+	/* overflow slots still in use are freed on destroy */
+	for(i=0; i<4; i++) {
+		mpf_buffer_audio_write(buffer,chunk,sizeof(chunk));
+	}
+	if(status == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Overflow Slots [%"APR_SIZE_T_FMT"]",stat.allocated_slots);
+	}
+	mpf_buffer_destroy(buffer);
+	return status;
+}
+
+static apt_bool_t buffer_pool_cleanup_test(apr_pool_t *pool)
+{
+	char chunk[BUFFER_TEST_FRAME_SIZE];
+	mpf_buffer_t *buffer;
+	apr_pool_t *subpool;
+	apr_size_t i;
+	if(apr_pool_create(&subpool,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+
+	/* overflow slots still queued are freed along with the pool, without mpf_buffer_destroy() */
+	buffer = mpf_buffer_create_ex(BUFFER_TEST_FRAME_SIZE,2,0,subpool);
+	memset(chunk,0,sizeof(chunk));
+	for(i=0; i<8; i++) {
+		mpf_buffer_audio_write(buffer,chunk,sizeof(chunk));
+	}
+	apr_pool_destroy(subpool);
+	return TRUE;
+}
+
+static apt_bool_t buffer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mpf_buffer_t *buffer;
+	apr_size_t stream_size = BUFFER_TEST_STREAM_SIZE;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		stream_size = atol(argv[0]);
+	}
+
+	buffer = mpf_buffer_create(suite->pool);
+	if(buffer_stream_test(buffer,stream_size) == FALSE) {
+		status = FALSE;
+	}
+	mpf_buffer_destroy(buffer);
+
+	if(buffer_overflow_test(suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(buffer_shrink_test(suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(buffer_pool_cleanup_test(suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	return status;
+}
+
+apt_test_suite_t* buffer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"buffer",NULL,buffer_test_run);
+	return suite;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <apr_file_io.h>
+#include "apt_test_suite.h"
+#include "apt_dir_layout.h"
+#include "apt_log.h"
+#include "mpf_stream.h"
+#include "mpf_dtmf_detector.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Default number of frames processed by the benchmark */
+#define DTMF_BENCH_FRAME_COUNT   200000
+/** Frame duration in msec */
+#define DTMF_FRAME_TIME          20
+/** Duration of a tone in msec */
+#define DTMF_TONE_TIME           70
+/** Duration of a pause between tones in msec */
+#define DTMF_PAUSE_TIME          130
+/** Amplitude of each of the two frequencies of a tone (-12 dBov) */
+#define DTMF_TONE_AMPLITUDE      8200
+
+/** Digits to mix into speech */
+static const char dtmf_digits[] = "0123456789*#ABCD";
+
+/** Audio files of the data dir to mix digits into */
+static const char *dtmf_files[] = {
+	"demo-8kHz.pcm",
+	"johnsmith-8kHz.pcm",
+	"one-8kHz.pcm",
+	"demo-16kHz.pcm",
+	"johnsmith-16kHz.pcm",
+	"one-16kHz.pcm"
+};
+
+/** Get the row and column frequencies of a digit */
+static void dtmf_digit_freqs_get(char digit, double *row, double *col)
+{
+	static const char *keys = "123A456B789C*0#D";
+	static const double rows[] = {697, 770, 852, 941};
+	static const double cols[] = {1209, 1336, 1477, 1633};
+	apr_size_t index = strchr(keys,digit) - keys;
+	*row = rows[index / 4];
+	*col = cols[index % 4];
+}
+
+/** Load linear samples from the data dir */
+static apr_int16_t* dtmf_file_load(apt_dir_layout_t *dir_layout, const char *name, apr_size_t *count, apr_pool_t *pool)
+{
+	const char *file_path = apt_datadir_filepath_get(dir_layout,name,pool);
+	apr_file_t *file;
+	apr_finfo_t finfo;
+	apr_size_t size;
+	apr_int16_t *samples;
+
+	if(!file_path || apr_file_open(&file,file_path,APR_FOPEN_READ | APR_FOPEN_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_file_info_get(&finfo,APR_FINFO_SIZE,file) != APR_SUCCESS || finfo.size <= 0) {
+		apr_file_close(file);
+		return NULL;
+	}
+	size = (apr_size_t)finfo.size;
+	samples = apr_palloc(pool,size);
+	if(apr_file_read_full(file,samples,size,&size) != APR_SUCCESS) {
+		apr_file_close(file);
+		return NULL;
+	}
+	apr_file_close(file);
+	*count = size / sizeof(apr_int16_t);
+	return samples;
+}
+
+/** Compose speech (looped as needed) with the digits mixed in, each digit followed by a pause */
+static apr_int16_t* dtmf_mix_compose(
+						const apr_int16_t *speech,
+						apr_size_t speech_count,
+						apr_uint32_t rate,
+						apt_bool_t tones,
+						apr_size_t *count,
+						apr_pool_t *pool)
+{
+	apr_size_t tone_samples = rate * DTMF_TONE_TIME / 1000;
+	apr_size_t digit_samples = tone_samples + rate * DTMF_PAUSE_TIME / 1000;
+	apr_size_t total = digit_samples * (sizeof(dtmf_digits) - 1);
+	apr_int16_t *samples;
+	apr_size_t i;
+	apr_size_t n;
+	double row, col;
+	double value;
+
+	/* whole frames */
+	total -= total % (rate * DTMF_FRAME_TIME / 1000);
+	samples = apr_palloc(pool,total * sizeof(apr_int16_t));
+	for(i=0; i<total; i++) {
+		samples[i] = speech[i % speech_count];
+	}
+
+	for(n=0; tones == TRUE && n<sizeof(dtmf_digits)-1; n++) {
+		dtmf_digit_freqs_get(dtmf_digits[n],&row,&col);
+		for(i=0; i<tone_samples && n*digit_samples+i < total; i++) {
+			value = samples[n*digit_samples + i] +
+				DTMF_TONE_AMPLITUDE * (sin(2 * M_PI * row * i / rate) + sin(2 * M_PI * col * i / rate));
+			if(value > 32767) value = 32767;
+			if(value < -32768) value = -32768;
+			samples[n*digit_samples + i] = (apr_int16_t)value;
+		}
+	}
+	*count = total;
+	return samples;
+}
+
+/** Run the detector over the samples frame by frame, collect detected digits */
+static void dtmf_detect(mpf_dtmf_detector_t *detector, const apr_int16_t *samples, apr_size_t count, apr_uint32_t rate, char *digits, apr_size_t max_digits)
+{
+	apr_size_t frame_samples = rate * DTMF_FRAME_TIME / 1000;
+	apr_size_t detected = 0;
+	mpf_frame_t frame;
+	apr_size_t i;
+	char digit;
+
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.size = frame_samples * sizeof(apr_int16_t);
+	for(i=0; i + frame_samples <= count; i += frame_samples) {
+		frame.codec_frame.buffer = (void*)(samples + i);
+		mpf_dtmf_detector_get_frame(detector,&frame);
+		while((digit = mpf_dtmf_detector_digit_get(detector)) != 0) {
+			if(detected < max_digits) {
+				digits[detected++] = digit;
+			}
+		}
+	}
+	digits[detected] = '\0';
+}
+
+static apt_bool_t dtmf_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apt_dir_layout_t *dir_layout = apt_default_dir_layout_create(NULL,suite->pool);
+	mpf_audio_stream_t stream;
+	mpf_codec_descriptor_t descriptor;
+	mpf_dtmf_detector_t *detector;
+	apr_size_t frame_count = DTMF_BENCH_FRAME_COUNT;
+	char digits[64];
+	apr_int16_t *speech;
+	apr_int16_t *samples;
+	apr_size_t speech_count;
+	apr_size_t count;
+	apr_uint32_t rate;
+	apr_size_t frame_samples;
+	apr_size_t i;
+	apr_size_t n;
+	apr_size_t passed = 0;
+	apr_size_t talkoff = 0;
+	apr_time_t start;
+	apr_time_t elapsed;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+
+	memset(&stream,0,sizeof(stream));
+	memset(&descriptor,0,sizeof(descriptor));
+	stream.tx_descriptor = &descriptor;
+
+	for(n=0; n<sizeof(dtmf_files)/sizeof(dtmf_files[0]); n++) {
+		speech = dtmf_file_load(dir_layout,dtmf_files[n],&speech_count,suite->pool);
+		if(!speech) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Load [%s]",dtmf_files[n]);
+			return FALSE;
+		}
+		rate = strstr(dtmf_files[n],"16kHz") ? 16000 : 8000;
+		descriptor.sampling_rate = (apr_uint16_t)rate;
+		detector = mpf_dtmf_detector_create_ex(&stream,MPF_DTMF_DETECTOR_INBAND,suite->pool);
+
+		/* digits over speech must be detected exactly */
+		samples = dtmf_mix_compose(speech,speech_count,rate,TRUE,&count,suite->pool);
+		dtmf_detect(detector,samples,count,rate,digits,sizeof(digits)-1);
+		if(strcmp(digits,dtmf_digits) == 0) {
+			passed++;
+		}
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"DTMF over [%s]: detected [%s] expected [%s]",
+			dtmf_files[n],digits,dtmf_digits);
+
+		/* speech alone must not trigger digits */
+		mpf_dtmf_detector_reset(detector);
+		dtmf_detect(detector,speech,speech_count,rate,digits,sizeof(digits)-1);
+		if(*digits) {
+			talkoff++;
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"DTMF Talk-off over [%s]: detected [%s]",dtmf_files[n],digits);
+		}
+
+		/* benchmark over speech with digits */
+		frame_samples = rate * DTMF_FRAME_TIME / 1000;
+		mpf_dtmf_detector_reset(detector);
+		start = apr_time_now();
+		for(i=0; i<frame_count; i++) {
+			mpf_frame_t frame;
+			frame.type = MEDIA_FRAME_TYPE_AUDIO;
+			frame.marker = MPF_MARKER_NONE;
+			frame.codec_frame.size = frame_samples * sizeof(apr_int16_t);
+			frame.codec_frame.buffer = samples + (i * frame_samples) % (count - frame_samples + 1);
+			mpf_dtmf_detector_get_frame(detector,&frame);
+			while(mpf_dtmf_detector_digit_get(detector) != 0);
+		}
+		elapsed = apr_time_now() - start;
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"DTMF Detector [%u Hz]: %"APR_SIZE_T_FMT" frames, %.0f ns/frame",
+			rate,
+			frame_count,
+			(double)elapsed * 1000 / frame_count);
+		mpf_dtmf_detector_destroy(detector);
+
+		/* a destroyed detector ignores subsequent frames */
+		dtmf_detect(detector,samples,count,rate,digits,sizeof(digits)-1);
+		if(*digits) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"DTMF Detected after Destroy [%s]: [%s]",dtmf_files[n],digits);
+			return FALSE;
+		}
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"DTMF Accuracy: %"APR_SIZE_T_FMT" of %"APR_SIZE_T_FMT" files detected exactly, talk-off in %"APR_SIZE_T_FMT,
+		passed,
+		sizeof(dtmf_files)/sizeof(dtmf_files[0]),
+		talkoff);
+	return (passed == sizeof(dtmf_files)/sizeof(dtmf_files[0]) && talkoff == 0) ? TRUE : FALSE;
+}
+
+apt_test_suite_t* dtmf_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"dtmf",NULL,dtmf_test_run);
+	return suite;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <apr_time.h>
+#include "apt_test_suite.h"
+#include "apt_dir_layout.h"
+#include "apt_log.h"
+#include "mpf_file_io.h"
+
+/** Default number of frames written by the benchmark */
+#define FILE_IO_BENCH_FRAME_COUNT  100000
+/** Number of frames written and read back by the round trip test */
+#define FILE_IO_FRAME_COUNT        1000
+/** Size of a frame (20 msec of 8 kHz linear audio) */
+#define FILE_IO_FRAME_SIZE         320
+/** Size of each buffer of a file (not a multiple of frame size) */
+#define FILE_IO_BUFFER_SIZE        16000
+/** Number of frames written in a row, prior to giving the I/O thread a chance to catch up */
+#define FILE_IO_BURST_FRAME_COUNT  10
+
+/** Fill the frame with a pattern unique to its number */
+static void file_io_frame_fill(unsigned char *frame, apr_size_t n)
+{
+	apr_size_t i;
+	for(i=0; i<FILE_IO_FRAME_SIZE; i++) {
+		frame[i] = (unsigned char)(n * 7 + i);
+	}
+}
+
+/** Write frames to the file sink in bursts, as a media processing thread would */
+static apt_bool_t file_io_write_test(mpf_file_io_t *file_io, const char *file_path)
+{
+	unsigned char frame[FILE_IO_FRAME_SIZE];
+	mpf_async_file_stat_t stat;
+	mpf_async_file_t *file;
+	apr_size_t n;
+
+	file = mpf_async_file_sink_open(file_io,file_path);
+	if(!file) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File Sink [%s]",file_path);
+		return FALSE;
+	}
+
+	for(n=0; n<FILE_IO_FRAME_COUNT; n++) {
+		file_io_frame_fill(frame,n);
+		mpf_async_file_write(file,frame,sizeof(frame));
+		if(n % FILE_IO_BURST_FRAME_COUNT == 0) {
+			apr_sleep(FILE_IO_BURST_FRAME_COUNT * 1000);
+		}
+	}
+
+	mpf_async_file_stat_get(file,&stat);
+	mpf_async_file_close(file);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"File Sink: %"APR_SIZE_T_FMT" bytes written, %"APR_SIZE_T_FMT" writes dropped",
+		stat.transferred,
+		stat.dropped);
+	return stat.dropped == 0 ? TRUE : FALSE;
+}
+
+/** Read frames back from the file source, retrying late reads */
+static apt_bool_t file_io_read_test(mpf_file_io_t *file_io, const char *file_path)
+{
+	unsigned char frame[FILE_IO_FRAME_SIZE];
+	unsigned char expected[FILE_IO_FRAME_SIZE];
+	mpf_async_file_stat_t stat;
+	mpf_async_file_t *file;
+	apr_size_t n = 0;
+
+	file = mpf_async_file_source_open(file_io,file_path);
+	if(!file) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File Source [%s]",file_path);
+		return FALSE;
+	}
+
+	while(mpf_async_file_eof(file) == FALSE) {
+		if(mpf_async_file_read(file,frame,sizeof(frame)) == FALSE) {
+			apr_sleep(1000);
+			continue;
+		}
+		file_io_frame_fill(expected,n);
+		if(memcmp(frame,expected,sizeof(frame)) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Frame %"APR_SIZE_T_FMT,n);
+			mpf_async_file_close(file);
+			return FALSE;
+		}
+		n++;
+	}
+
+	mpf_async_file_stat_get(file,&stat);
+	mpf_async_file_close(file);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"File Source: %"APR_SIZE_T_FMT" frames read, %"APR_SIZE_T_FMT" reads late",
+		n,
+		stat.late);
+	return n == FILE_IO_FRAME_COUNT ? TRUE : FALSE;
+}
+
+/** Write frames without pacing, so that the I/O thread lags behind and writes are dropped and accounted */
+static apt_bool_t file_io_overrun_test(mpf_file_io_t *file_io, const char *file_path, apr_size_t frame_count)
+{
+	unsigned char frame[FILE_IO_FRAME_SIZE];
+	mpf_async_file_stat_t stat;
+	mpf_async_file_t *file;
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t n;
+
+	file = mpf_async_file_sink_open(file_io,file_path);
+	if(!file) {
+		return FALSE;
+	}
+
+	file_io_frame_fill(frame,0);
+	start = apr_time_now();
+	for(n=0; n<frame_count; n++) {
+		mpf_async_file_write(file,frame,sizeof(frame));
+	}
+	elapsed = apr_time_now() - start;
+
+	mpf_async_file_stat_get(file,&stat);
+	mpf_async_file_close(file);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"File Sink Overrun: %"APR_SIZE_T_FMT" frames, %.0f ns/frame, %"APR_SIZE_T_FMT" bytes written, %"APR_SIZE_T_FMT" writes (%"APR_SIZE_T_FMT" bytes) dropped",
+		frame_count,
+		(double)elapsed * 1000 / frame_count,
+		stat.transferred,
+		stat.dropped,
+		stat.dropped_bytes);
+	return stat.transferred + stat.dropped_bytes == frame_count * sizeof(frame) ? TRUE : FALSE;
+}
+
+/** Measure the time to write a frame by the former blocking fwrite() in nsec */
+static double file_io_fwrite_bench(const char *file_path, apr_size_t frame_count)
+{
+	unsigned char frame[FILE_IO_FRAME_SIZE];
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t n;
+	FILE *file = fopen(file_path,"wb");
+	if(!file) {
+		return 0;
+	}
+
+	file_io_frame_fill(frame,0);
+	start = apr_time_now();
+	for(n=0; n<frame_count; n++) {
+		fwrite(frame,1,sizeof(frame),file);
+	}
+	fclose(file);
+	elapsed = apr_time_now() - start;
+	return (double)elapsed * 1000 / frame_count;
+}
+
+static apt_bool_t file_io_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apt_dir_layout_t *dir_layout = apt_default_dir_layout_create(NULL,suite->pool);
+	const char *file_path = apt_vardir_filepath_get(dir_layout,"fileio-test.pcm",suite->pool);
+	apr_size_t frame_count = FILE_IO_BENCH_FRAME_COUNT;
+	mpf_file_io_t *file_io;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+	if(!file_path) {
+		return FALSE;
+	}
+
+	file_io = mpf_file_io_create(2,FILE_IO_BUFFER_SIZE,suite->pool);
+	if(!file_io || mpf_file_io_start(file_io) == FALSE) {
+		return FALSE;
+	}
+
+	if(file_io_write_test(file_io,file_path) == FALSE) {
+		status = FALSE;
+	}
+	/* termination flushes and closes the file sink */
+	mpf_file_io_terminate(file_io);
+	mpf_file_io_start(file_io);
+
+	if(status == TRUE && file_io_read_test(file_io,file_path) == FALSE) {
+		status = FALSE;
+	}
+	if(status == TRUE && file_io_overrun_test(file_io,file_path,frame_count) == FALSE) {
+		status = FALSE;
+	}
+	mpf_file_io_terminate(file_io);
+
+	if(status == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Blocking fwrite(): %"APR_SIZE_T_FMT" frames, %.0f ns/frame",
+			frame_count,
+			file_io_fwrite_bench(file_path,frame_count));
+	}
+	remove(file_path);
+	return status;
+}
+
+apt_test_suite_t* file_io_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"fileio",NULL,file_io_test_run);
+	return suite;
+}
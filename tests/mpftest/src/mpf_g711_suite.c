@@ -0,0 +1,202 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_g711_kernel.h"
+
+/** Default number of frames encoded and decoded by each kernel */
+#define G711_BENCH_FRAME_COUNT    500000
+/** Number of samples in a frame (20 msec of 8 kHz audio) */
+#define G711_BENCH_FRAME_SAMPLES  160
+/** Number of distinct frames the benchmark cycles through */
+#define G711_BENCH_FRAME_SET      64
+/** Number of all the 16-bit linear samples */
+#define G711_SAMPLE_COUNT         65536
+
+/** Check the selected kernel against the reference (generic) output for all the samples and code words */
+static apt_bool_t g711_kernel_verify(
+					const apr_int16_t *samples,
+					const apr_byte_t *ref_ulaw,
+					const apr_byte_t *ref_alaw,
+					const apr_int16_t *ref_ulaw_linear,
+					const apr_int16_t *ref_alaw_linear,
+					apr_pool_t *pool)
+{
+	apr_byte_t *code = apr_palloc(pool,G711_SAMPLE_COUNT);
+	apr_int16_t linear[256];
+	apr_byte_t code_words[256];
+	apr_size_t i;
+
+	for(i=0; i<256; i++) {
+		code_words[i] = (apr_byte_t)i;
+	}
+
+	mpf_g711u_encode(samples,code,G711_SAMPLE_COUNT);
+	if(memcmp(code,ref_ulaw,G711_SAMPLE_COUNT) != 0) {
+		return FALSE;
+	}
+	mpf_g711a_encode(samples,code,G711_SAMPLE_COUNT);
+	if(memcmp(code,ref_alaw,G711_SAMPLE_COUNT) != 0) {
+		return FALSE;
+	}
+	mpf_g711u_decode(code_words,linear,256);
+	if(memcmp(linear,ref_ulaw_linear,sizeof(linear)) != 0) {
+		return FALSE;
+	}
+	mpf_g711a_decode(code_words,linear,256);
+	if(memcmp(linear,ref_alaw_linear,sizeof(linear)) != 0) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Measure throughput of the encoder in MB/s of linear PCM */
+static double g711_encode_bench(apt_bool_t alaw, const apr_int16_t *samples, apr_byte_t *code, apr_size_t frame_count)
+{
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t offset;
+	apr_size_t i;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		offset = (i % G711_BENCH_FRAME_SET) * G711_BENCH_FRAME_SAMPLES;
+		if(alaw == TRUE) {
+			mpf_g711a_encode(samples + offset,code + offset,G711_BENCH_FRAME_SAMPLES);
+		}
+		else {
+			mpf_g711u_encode(samples + offset,code + offset,G711_BENCH_FRAME_SAMPLES);
+		}
+	}
+	elapsed = apr_time_now() - start;
+	if(elapsed <= 0) {
+		elapsed = 1;
+	}
+	return (double)frame_count * G711_BENCH_FRAME_SAMPLES * sizeof(apr_int16_t) / elapsed;
+}
+
+/** Measure throughput of the decoder in MB/s of linear PCM */
+static double g711_decode_bench(apt_bool_t alaw, const apr_byte_t *code, apr_int16_t *samples, apr_size_t frame_count)
+{
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t offset;
+	apr_size_t i;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		offset = (i % G711_BENCH_FRAME_SET) * G711_BENCH_FRAME_SAMPLES;
+		if(alaw == TRUE) {
+			mpf_g711a_decode(code + offset,samples + offset,G711_BENCH_FRAME_SAMPLES);
+		}
+		else {
+			mpf_g711u_decode(code + offset,samples + offset,G711_BENCH_FRAME_SAMPLES);
+		}
+	}
+	elapsed = apr_time_now() - start;
+	if(elapsed <= 0) {
+		elapsed = 1;
+	}
+	return (double)frame_count * G711_BENCH_FRAME_SAMPLES * sizeof(apr_int16_t) / elapsed;
+}
+
+static apt_bool_t g711_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_int16_t *samples;
+	apr_byte_t *ref_ulaw;
+	apr_byte_t *ref_alaw;
+	apr_int16_t ref_ulaw_linear[256];
+	apr_int16_t ref_alaw_linear[256];
+	apr_byte_t code_words[256];
+	apr_int16_t *bench_samples;
+	apr_int16_t *bench_linear;
+	apr_byte_t *bench_code;
+	apr_size_t frame_count = G711_BENCH_FRAME_COUNT;
+	apr_size_t bench_size = G711_BENCH_FRAME_SET * G711_BENCH_FRAME_SAMPLES;
+	mpf_g711_kernel_e selected_kernel;
+	int kernel;
+	apr_uint32_t seed = 1;
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+
+	mpf_g711_init();
+	selected_kernel = mpf_g711_kernel_get();
+
+	/* compose all the 16-bit samples and the reference output of the generic kernel */
+	samples = apr_palloc(suite->pool,G711_SAMPLE_COUNT * sizeof(apr_int16_t));
+	ref_ulaw = apr_palloc(suite->pool,G711_SAMPLE_COUNT);
+	ref_alaw = apr_palloc(suite->pool,G711_SAMPLE_COUNT);
+	for(i=0; i<G711_SAMPLE_COUNT; i++) {
+		samples[i] = (apr_int16_t)i;
+	}
+	for(i=0; i<256; i++) {
+		code_words[i] = (apr_byte_t)i;
+	}
+	mpf_g711_kernel_set(MPF_G711_KERNEL_GENERIC);
+	mpf_g711u_encode(samples,ref_ulaw,G711_SAMPLE_COUNT);
+	mpf_g711a_encode(samples,ref_alaw,G711_SAMPLE_COUNT);
+	mpf_g711u_decode(code_words,ref_ulaw_linear,256);
+	mpf_g711a_decode(code_words,ref_alaw_linear,256);
+
+	/* random speech-like samples to benchmark with */
+	bench_samples = apr_palloc(suite->pool,bench_size * sizeof(apr_int16_t));
+	bench_linear = apr_palloc(suite->pool,bench_size * sizeof(apr_int16_t));
+	bench_code = apr_palloc(suite->pool,bench_size);
+	for(i=0; i<bench_size; i++) {
+		seed = seed * 1103515245 + 12345;
+		bench_samples[i] = (apr_int16_t)((apr_int32_t)(seed >> 16) - 32768) / 4;
+	}
+
+	for(kernel = MPF_G711_KERNEL_GENERIC; kernel < MPF_G711_KERNEL_COUNT; kernel++) {
+		if(mpf_g711_kernel_set((mpf_g711_kernel_e)kernel) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"G.711 Kernel [%s] not supported",
+				mpf_g711_kernel_name_get((mpf_g711_kernel_e)kernel));
+			continue;
+		}
+
+		if(g711_kernel_verify(samples,ref_ulaw,ref_alaw,ref_ulaw_linear,ref_alaw_linear,suite->pool) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"G.711 Kernel [%s] mismatches generic output",
+				mpf_g711_kernel_name_get((mpf_g711_kernel_e)kernel));
+			status = FALSE;
+			continue;
+		}
+
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"G.711 Kernel [%s]%s: %"APR_SIZE_T_FMT" frames, "
+			"PCMU encode %.0f MB/s decode %.0f MB/s, PCMA encode %.0f MB/s decode %.0f MB/s",
+			mpf_g711_kernel_name_get((mpf_g711_kernel_e)kernel),
+			kernel == selected_kernel ? " (selected)" : "",
+			frame_count,
+			g711_encode_bench(FALSE,bench_samples,bench_code,frame_count),
+			g711_decode_bench(FALSE,bench_code,bench_linear,frame_count),
+			g711_encode_bench(TRUE,bench_samples,bench_code,frame_count),
+			g711_decode_bench(TRUE,bench_code,bench_linear,frame_count));
+	}
+
+	mpf_g711_kernel_set(selected_kernel);
+	return status;
+}
+
+apt_test_suite_t* g711_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"g711",NULL,g711_test_run);
+	return suite;
+}
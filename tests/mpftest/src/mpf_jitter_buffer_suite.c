@@ -0,0 +1,271 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_engine.h"
+#include "mpf_codec_manager.h"
+#include "mpf_jitter_buffer.h"
+
+/** Frame duration in msec */
+#define JB_FRAME_DURATION       20
+/** Sampling rate of L16 the packets are encoded in */
+#define JB_SAMPLING_RATE        8000
+/** Number of samples in a frame */
+#define JB_FRAME_SAMPLES        (JB_SAMPLING_RATE * JB_FRAME_DURATION / 1000)
+/** Initial playout delay in msec, shrunk to the min one while there is no jitter */
+#define JB_INITIAL_DELAY        100
+/** Min playout delay in msec */
+#define JB_MIN_DELAY            20
+/** Max playout delay in msec */
+#define JB_MAX_DELAY            400
+/** Max delay of a packet in transit in frames, during the phase of jitter */
+#define JB_MAX_TRANSIT_DELAY    1
+/** Number of packets sent in each phase of the scenario: no jitter, jitter, no jitter */
+#define JB_PHASE_PACKET_COUNT   500
+/** Value of the samples of the first packet, the value is incremented for every subsequent packet */
+#define JB_TAG_BASE             -30000
+/** Increment of the value of the samples from packet to packet */
+#define JB_TAG_STEP             32
+
+/** Adaptive jitter buffer receiving a stream of tagged packets */
+typedef struct {
+	mpf_jitter_buffer_t *jb;
+	apr_byte_t           packet[JB_FRAME_SAMPLES * 2];
+	apr_byte_t           frame[JB_FRAME_SAMPLES * 2];
+	/* tag of the last packet read out */
+	apr_int32_t          read_tag;
+	/* number of packets, which have been skipped */
+	apr_size_t           skip_count;
+	/* number of frames, which have been inserted */
+	apr_size_t           insert_count;
+	/* number of frames read out, which are not audio */
+	apr_size_t           gap_count;
+	/* number of packets discarded by the jitter buffer */
+	apr_size_t           discard_count;
+	/* the delay the last packet has been read out with, measured in msec since it was sent */
+	apr_uint32_t         measured_delay;
+} jb_scenario_t;
+
+/** Fill the packet with the samples of the tag in network byte order (L16) */
+static void jb_packet_compose(jb_scenario_t *scenario, apr_size_t seq)
+{
+	apr_int32_t value = JB_TAG_BASE + (apr_int32_t)seq * JB_TAG_STEP;
+	apr_size_t i;
+	for(i=0; i<JB_FRAME_SAMPLES; i++) {
+		scenario->packet[2*i] = (apr_byte_t)((value >> 8) & 0xFF);
+		scenario->packet[2*i+1] = (apr_byte_t)(value & 0xFF);
+	}
+}
+
+/** Get the tag of the frame read out, or -1 if the frame is synthesized */
+static apr_int32_t jb_frame_tag_get(const jb_scenario_t *scenario)
+{
+	/* the last sample is never overlap-added with a synthesized signal */
+	apr_int16_t value = (apr_int16_t)((scenario->frame[JB_FRAME_SAMPLES*2-2] << 8) | scenario->frame[JB_FRAME_SAMPLES*2-1]);
+	if((value - JB_TAG_BASE) % JB_TAG_STEP != 0) {
+		return -1;
+	}
+	return (value - JB_TAG_BASE) / JB_TAG_STEP;
+}
+
+/** Get the delay of the packet in transit in frames */
+static apr_size_t jb_transit_delay_get(apr_size_t seq, apr_uint32_t *seed)
+{
+	if(seq < JB_PHASE_PACKET_COUNT || seq >= 2 * JB_PHASE_PACKET_COUNT) {
+		/* no jitter */
+		return 0;
+	}
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) % (JB_MAX_TRANSIT_DELAY + 1);
+}
+
+/** Read a frame on every tick, and check the delay the packets are read out with */
+static apt_bool_t jb_scenario_read(jb_scenario_t *scenario, apr_size_t tick)
+{
+	mpf_frame_t frame;
+	apr_int32_t tag;
+	frame.type = MEDIA_FRAME_TYPE_NONE;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.buffer = scenario->frame;
+	frame.codec_frame.size = sizeof(scenario->frame);
+	mpf_jitter_buffer_read(scenario->jb,&frame);
+
+	if((frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
+		if(scenario->read_tag >= 0) {
+			/* gap within the stream */
+			scenario->gap_count++;
+		}
+		return TRUE;
+	}
+
+	tag = jb_frame_tag_get(scenario);
+	if(tag <= scenario->read_tag) {
+		/* the frame has been inserted to grow the playout delay */
+		scenario->insert_count++;
+		return TRUE;
+	}
+
+	if(scenario->read_tag >= 0) {
+		/* packets missing in between have been skipped to shrink the playout delay */
+		scenario->skip_count += tag - scenario->read_tag - 1;
+	}
+	scenario->read_tag = tag;
+	/* the packet is sent on the tick of its sequence number */
+	scenario->measured_delay = (apr_uint32_t)(tick - tag) * JB_FRAME_DURATION;
+	return TRUE;
+}
+
+/** Check the playout delay is on target, and the delay packets are read out with matches it */
+static apt_bool_t jb_scenario_check(jb_scenario_t *scenario, const char *phase, apr_uint32_t target_delay)
+{
+	apr_uint32_t playout_delay = mpf_jitter_buffer_playout_delay_get(scenario->jb);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"JB %s: playout delay %u msec, measured %u msec, target %u msec, "
+		"skipped %"APR_SIZE_T_FMT", inserted %"APR_SIZE_T_FMT", gaps %"APR_SIZE_T_FMT", concealed %u, discarded %"APR_SIZE_T_FMT,
+		phase,
+		playout_delay,
+		scenario->measured_delay,
+		target_delay,
+		scenario->skip_count,
+		scenario->insert_count,
+		scenario->gap_count,
+		mpf_jitter_buffer_concealed_frames_get(scenario->jb),
+		scenario->discard_count);
+
+	if(scenario->gap_count || scenario->discard_count || mpf_jitter_buffer_concealed_frames_get(scenario->jb)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"JB %s: packets lost",phase);
+		return FALSE;
+	}
+	if(playout_delay != target_delay) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"JB %s: playout delay is off target",phase);
+		return FALSE;
+	}
+	if(scenario->measured_delay != playout_delay) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"JB %s: measured delay mismatches playout delay",phase);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t jb_scenario_run(jb_scenario_t *scenario)
+{
+	/* arrival tick of each packet in transit */
+	apr_size_t arrival[3 * JB_PHASE_PACKET_COUNT];
+	apr_size_t packet_count = 3 * JB_PHASE_PACKET_COUNT;
+	apr_size_t next_seq = 0;
+	apr_size_t seq;
+	apr_size_t tick;
+	apr_uint32_t seed = 1;
+
+	for(seq=0; seq<packet_count; seq++) {
+		arrival[seq] = seq + jb_transit_delay_get(seq,&seed);
+		if(seq && arrival[seq] < arrival[seq-1]) {
+			/* keep the order */
+			arrival[seq] = arrival[seq-1];
+		}
+	}
+
+	for(tick=0; next_seq<packet_count; tick++) {
+		/* receive the packets arrived by now */
+		for(; next_seq<packet_count && arrival[next_seq] <= tick; next_seq++) {
+			jb_packet_compose(scenario,next_seq);
+			if(mpf_jitter_buffer_write(scenario->jb,scenario->packet,sizeof(scenario->packet),
+					(apr_uint32_t)(next_seq * JB_FRAME_SAMPLES),next_seq == 0) != JB_OK) {
+				scenario->discard_count++;
+			}
+		}
+
+		jb_scenario_read(scenario,tick);
+
+		if(tick + 1 == JB_PHASE_PACKET_COUNT) {
+			/* the initial playout delay has been shrunk to the min one */
+			if(jb_scenario_check(scenario,"No Jitter",JB_MIN_DELAY) == FALSE) {
+				return FALSE;
+			}
+		}
+		else if(tick + 1 == 2 * JB_PHASE_PACKET_COUNT) {
+			/* the playout delay has been grown to absorb the jitter */
+			if(jb_scenario_check(scenario,"Jitter",JB_MIN_DELAY + JB_FRAME_DURATION * JB_MAX_TRANSIT_DELAY) == FALSE) {
+				return FALSE;
+			}
+		}
+	}
+
+	if(!scenario->skip_count || !scenario->insert_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"JB playout delay not adapted");
+		return FALSE;
+	}
+	/* the jitter has faded away */
+	return jb_scenario_check(scenario,"Jitter Over",JB_MIN_DELAY);
+}
+
+static apt_bool_t jb_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mpf_codec_manager_t *codec_manager;
+	mpf_codec_descriptor_t *descriptor;
+	mpf_codec_t *codec;
+	mpf_jb_config_t *jb_config;
+	jb_scenario_t *scenario;
+	apt_bool_t status;
+
+	codec_manager = mpf_engine_codec_manager_create(suite->pool);
+	if(!codec_manager) {
+		return FALSE;
+	}
+
+	descriptor = mpf_codec_descriptor_create(suite->pool);
+	descriptor->payload_type = 96;
+	apt_string_set(&descriptor->name,"L16");
+	descriptor->sampling_rate = JB_SAMPLING_RATE;
+	descriptor->rtp_sampling_rate = JB_SAMPLING_RATE;
+	descriptor->channel_count = 1;
+	descriptor->frame_duration = JB_FRAME_DURATION;
+	codec = mpf_codec_manager_codec_get(codec_manager,descriptor,suite->pool);
+	if(!codec) {
+		mpf_codec_manager_destroy(codec_manager);
+		return FALSE;
+	}
+
+	jb_config = apr_palloc(suite->pool,sizeof(mpf_jb_config_t));
+	mpf_jb_config_init(jb_config);
+	jb_config->adaptive = 1;
+	jb_config->time_skew_detection = 0;
+	jb_config->plc = 1;
+	jb_config->initial_playout_delay = JB_INITIAL_DELAY;
+	jb_config->min_playout_delay = JB_MIN_DELAY;
+	jb_config->max_playout_delay = JB_MAX_DELAY;
+
+	scenario = apr_palloc(suite->pool,sizeof(jb_scenario_t));
+	scenario->jb = mpf_jitter_buffer_create(jb_config,descriptor,codec,suite->pool);
+	scenario->read_tag = -1;
+	scenario->skip_count = 0;
+	scenario->insert_count = 0;
+	scenario->gap_count = 0;
+	scenario->discard_count = 0;
+	scenario->measured_delay = 0;
+
+	status = jb_scenario_run(scenario);
+
+	mpf_jitter_buffer_destroy(scenario->jb);
+	mpf_codec_manager_destroy(codec_manager);
+	return status;
+}
+
+apt_test_suite_t* jb_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"jb",NULL,jb_test_run);
+	return suite;
+}
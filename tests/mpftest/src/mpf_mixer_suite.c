@@ -0,0 +1,183 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_mixer.h"
+
+/** Default number of frames mixed for each number of sources */
+#define MIXER_BENCH_FRAME_COUNT    200000
+/** Number of samples in a frame (20 msec of 8 kHz audio) */
+#define MIXER_BENCH_FRAME_SAMPLES  160
+/** Max number of sources */
+#define MIXER_MAX_SOURCE_COUNT     32
+/** Number of samples mixed by the verification (not a multiple of vector width) */
+#define MIXER_VERIFY_SAMPLES       1003
+
+static apr_int16_t mixer_sample_saturate(double sample)
+{
+	if(sample > 32767) {
+		return 32767;
+	}
+	if(sample < -32768) {
+		return -32768;
+	}
+	return (apr_int16_t)sample;
+}
+
+/** Check the mixer against the exact sum of sources for the given number of sources */
+static apt_bool_t mixer_verify(const apr_int16_t * const *buf_arr, apr_size_t count, apr_int16_t *mix_buf)
+{
+	apr_int16_t gain_arr[MIXER_MAX_SOURCE_COUNT];
+	apr_size_t i;
+	apr_size_t j;
+	double sum;
+	double expected;
+	double tolerance;
+
+	/* unity gains must be bit-exact with the saturated sum */
+	mpf_mixer_samples_mix(mix_buf,buf_arr,NULL,count,MIXER_VERIFY_SAMPLES);
+	for(i=0; i<MIXER_VERIFY_SAMPLES; i++) {
+		sum = 0;
+		for(j=0; j<count; j++) {
+			sum += buf_arr[j][i];
+		}
+		if(mix_buf[i] != mixer_sample_saturate(sum)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch [%"APR_SIZE_T_FMT" sources, unity gain] sample %"APR_SIZE_T_FMT": %d",
+				count,i,mix_buf[i]);
+			return FALSE;
+		}
+	}
+
+	/* arbitrary gains may differ by rounding of each pair of sources */
+	for(j=0; j<count; j++) {
+		gain_arr[j] = (apr_int16_t)(MPF_MIXER_GAIN_UNITY / 4 + j * 997 % (2 * MPF_MIXER_GAIN_UNITY));
+	}
+	tolerance = (double)(count + 1) / 2 + 1;
+	mpf_mixer_samples_mix(mix_buf,buf_arr,gain_arr,count,MIXER_VERIFY_SAMPLES);
+	for(i=0; i<MIXER_VERIFY_SAMPLES; i++) {
+		sum = 0;
+		for(j=0; j<count; j++) {
+			sum += (double)buf_arr[j][i] * gain_arr[j] / MPF_MIXER_GAIN_UNITY;
+		}
+		expected = sum > 32767 ? 32767 : sum < -32768 ? -32768 : sum;
+		if(mix_buf[i] > expected + tolerance || mix_buf[i] < expected - tolerance) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch [%"APR_SIZE_T_FMT" sources] sample %"APR_SIZE_T_FMT": %d expected %.1f",
+				count,i,mix_buf[i],expected);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Mix frames by the former per-source wrapping add for reference */
+static void mixer_legacy_mix(apr_int16_t *mix_buf, const apr_int16_t * const *buf_arr, apr_size_t count, apr_size_t samples)
+{
+	apr_size_t i;
+	apr_size_t j;
+
+	memset(mix_buf,0,samples * sizeof(apr_int16_t));
+	for(j=0; j<count; j++) {
+		for(i=0; i<samples; i++) {
+			mix_buf[i] = mix_buf[i] + buf_arr[j][i];
+		}
+	}
+}
+
+/** Measure the time to mix a frame in nsec */
+static double mixer_bench(
+					apt_bool_t legacy,
+					const apr_int16_t * const *buf_arr,
+					const apr_int16_t *gain_arr,
+					apr_size_t count,
+					apr_int16_t *mix_buf,
+					apr_size_t frame_count)
+{
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t i;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		if(legacy == TRUE) {
+			mixer_legacy_mix(mix_buf,buf_arr,count,MIXER_BENCH_FRAME_SAMPLES);
+		}
+		else {
+			mpf_mixer_samples_mix(mix_buf,buf_arr,gain_arr,count,MIXER_BENCH_FRAME_SAMPLES);
+		}
+	}
+	elapsed = apr_time_now() - start;
+	return (double)elapsed * 1000 / frame_count;
+}
+
+static apt_bool_t mixer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	const apr_int16_t *buf_arr[MIXER_MAX_SOURCE_COUNT];
+	apr_int16_t gain_arr[MIXER_MAX_SOURCE_COUNT];
+	apr_int16_t *buf;
+	apr_int16_t *mix_buf;
+	apr_size_t frame_count = MIXER_BENCH_FRAME_COUNT;
+	apr_size_t counts[] = {2, 8, 32};
+	apr_size_t count;
+	apr_uint32_t seed = 1;
+	apr_size_t i;
+	apr_size_t j;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+
+	/* loud random sources, so that sums do overflow 16 bits */
+	for(j=0; j<MIXER_MAX_SOURCE_COUNT; j++) {
+		buf = apr_palloc(suite->pool,MIXER_VERIFY_SAMPLES * sizeof(apr_int16_t));
+		for(i=0; i<MIXER_VERIFY_SAMPLES; i++) {
+			seed = seed * 1103515245 + 12345;
+			buf[i] = (apr_int16_t)((apr_int32_t)(seed >> 16) - 32768);
+		}
+		buf_arr[j] = buf;
+		gain_arr[j] = MPF_MIXER_GAIN_UNITY / 2;
+	}
+	mix_buf = apr_palloc(suite->pool,MIXER_VERIFY_SAMPLES * sizeof(apr_int16_t));
+
+	for(count=1; count<=MIXER_MAX_SOURCE_COUNT; count++) {
+		if(mixer_verify(buf_arr,count,mix_buf) == FALSE) {
+			status = FALSE;
+		}
+	}
+	if(status == FALSE) {
+		return FALSE;
+	}
+
+	for(i=0; i<sizeof(counts)/sizeof(counts[0]); i++) {
+		count = counts[i];
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Mix %"APR_SIZE_T_FMT" Sources: %"APR_SIZE_T_FMT" frames, "
+			"unity gain %.0f ns/frame, half gain %.0f ns/frame, legacy %.0f ns/frame",
+			count,
+			frame_count,
+			mixer_bench(FALSE,buf_arr,NULL,count,mix_buf,frame_count),
+			mixer_bench(FALSE,buf_arr,gain_arr,count,mix_buf,frame_count),
+			mixer_bench(TRUE,buf_arr,NULL,count,mix_buf,frame_count));
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* mixer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"mixer",NULL,mixer_test_run);
+	return suite;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_plc.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Duration of a frame in msec */
+#define PLC_FRAME_DURATION       20
+/** Frequency of the test tone in Hz (pitch period of 8 msec) */
+#define PLC_TONE_FREQUENCY       125
+/** Amplitude of the test tone */
+#define PLC_TONE_AMPLITUDE       8000
+/** Number of frames received before the loss */
+#define PLC_GOOD_FRAME_COUNT     10
+/** Number of frames lost in a row, the concealment is over by then */
+#define PLC_LOST_FRAME_COUNT     ((MPF_PLC_MAX_DURATION + PLC_FRAME_DURATION - 1) / PLC_FRAME_DURATION + 1)
+/** Max mean abs error of the first concealed frame against the lost signal, in percents of the amplitude */
+#define PLC_MAX_ERROR_PERCENT    5
+
+/** Get sample of the test tone */
+static apr_int16_t plc_tone_sample(apr_uint32_t sampling_rate, apr_size_t n)
+{
+	return (apr_int16_t)(PLC_TONE_AMPLITUDE * sin(2 * M_PI * PLC_TONE_FREQUENCY * n / sampling_rate));
+}
+
+/** Generate frame of the test tone starting at the given sample */
+static void plc_tone_generate(apr_uint32_t sampling_rate, apr_size_t start, apr_int16_t *samples, apr_size_t frame_samples)
+{
+	apr_size_t i;
+	for(i=0; i<frame_samples; i++) {
+		samples[i] = plc_tone_sample(sampling_rate,start + i);
+	}
+}
+
+/** Get peak of the frame */
+static apr_int16_t plc_peak_get(const apr_int16_t *samples, apr_size_t frame_samples)
+{
+	apr_int16_t peak = 0;
+	apr_size_t i;
+	for(i=0; i<frame_samples; i++) {
+		if(abs(samples[i]) > peak) {
+			peak = (apr_int16_t)abs(samples[i]);
+		}
+	}
+	return peak;
+}
+
+/** Check the step between consecutive samples does not exceed the one of the tone (with a margin) */
+static apt_bool_t plc_continuity_check(apr_int16_t prev, const apr_int16_t *samples, apr_size_t frame_samples, apr_int32_t max_step, const char *name, apr_size_t n)
+{
+	apr_size_t i;
+	for(i=0; i<frame_samples; i++) {
+		if(abs(samples[i] - prev) > max_step) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Discontinuity in %s Frame %"APR_SIZE_T_FMT" at Sample %"APR_SIZE_T_FMT" [%d -> %d]",
+				name,n,i,prev,samples[i]);
+			return FALSE;
+		}
+		prev = samples[i];
+	}
+	return TRUE;
+}
+
+/** Conceal a long loss of the tone and check continuity and fade-out across the lost frames */
+static apt_bool_t plc_fade_out_test(apr_uint32_t sampling_rate, apr_pool_t *pool)
+{
+	apr_size_t frame_samples = sampling_rate * PLC_FRAME_DURATION / 1000;
+	mpf_plc_t *plc = mpf_plc_create(sampling_rate,frame_samples,pool);
+	apr_int16_t *samples = apr_palloc(pool,sizeof(apr_int16_t) * frame_samples);
+	apr_int32_t max_step = (apr_int32_t)(2 * PLC_TONE_AMPLITUDE * 2 * M_PI * PLC_TONE_FREQUENCY / sampling_rate) + 1;
+	apr_int16_t prev;
+	apr_int16_t peak;
+	apr_int16_t prev_peak = PLC_TONE_AMPLITUDE;
+	apr_size_t error;
+	apr_size_t pos = 0;
+	apr_size_t n;
+	apr_size_t i;
+	apt_bool_t concealed;
+
+	for(n=0; n<PLC_GOOD_FRAME_COUNT; n++) {
+		plc_tone_generate(sampling_rate,pos,samples,frame_samples);
+		if(mpf_plc_good_frame(plc,samples) == TRUE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Modification of Good Frame %"APR_SIZE_T_FMT,n);
+			return FALSE;
+		}
+		pos += frame_samples;
+	}
+	prev = samples[frame_samples-1];
+
+	for(n=0; n<PLC_LOST_FRAME_COUNT; n++) {
+		concealed = mpf_plc_lost_frame(plc,samples);
+		if(plc_continuity_check(prev,samples,frame_samples,max_step,"Lost",n) == FALSE) {
+			return FALSE;
+		}
+		prev = samples[frame_samples-1];
+		peak = plc_peak_get(samples,frame_samples);
+
+		if(n == 0) {
+			/* the tone is periodic, the first frame is expected to follow it closely */
+			error = 0;
+			for(i=0; i<frame_samples; i++) {
+				error += abs(samples[i] - plc_tone_sample(sampling_rate,pos + i));
+			}
+			error /= frame_samples;
+			if(error * 100 > PLC_MAX_ERROR_PERCENT * PLC_TONE_AMPLITUDE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Concealed Frame Deviates from Signal [%"APR_SIZE_T_FMT"]",error);
+				return FALSE;
+			}
+		}
+
+		if((n + 1) * PLC_FRAME_DURATION <= MPF_PLC_MAX_DURATION) {
+			if(concealed == FALSE || peak == 0) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Lost Frame %"APR_SIZE_T_FMT" Not Concealed",n);
+				return FALSE;
+			}
+			if(n > 0 && peak >= prev_peak) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Lost Frame %"APR_SIZE_T_FMT" Not Attenuated [%d >= %d]",n,peak,prev_peak);
+				return FALSE;
+			}
+		}
+		else if(n * PLC_FRAME_DURATION >= MPF_PLC_MAX_DURATION) {
+			/* the concealment is over, silence is synthesized */
+			if(concealed == TRUE || peak != 0) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Lost Frame %"APR_SIZE_T_FMT" Not Faded Out [%d]",n,peak);
+				return FALSE;
+			}
+		}
+		prev_peak = peak;
+		pos += frame_samples;
+	}
+	return TRUE;
+}
+
+/** Conceal a single lost frame and check the received signal smoothly follows the concealed one */
+static apt_bool_t plc_recovery_test(apr_uint32_t sampling_rate, apr_pool_t *pool)
+{
+	apr_size_t frame_samples = sampling_rate * PLC_FRAME_DURATION / 1000;
+	mpf_plc_t *plc = mpf_plc_create(sampling_rate,frame_samples,pool);
+	apr_int16_t *samples = apr_palloc(pool,sizeof(apr_int16_t) * frame_samples);
+	apr_int32_t max_step = (apr_int32_t)(2 * PLC_TONE_AMPLITUDE * 2 * M_PI * PLC_TONE_FREQUENCY / sampling_rate) + 1;
+	apr_int16_t prev;
+	apr_size_t pos = 0;
+	apr_size_t n;
+
+	for(n=0; n<PLC_GOOD_FRAME_COUNT; n++) {
+		plc_tone_generate(sampling_rate,pos,samples,frame_samples);
+		mpf_plc_good_frame(plc,samples);
+		pos += frame_samples;
+	}
+
+	mpf_plc_lost_frame(plc,samples);
+	prev = samples[frame_samples-1];
+	/* the received signal is a quarter period ahead of the concealed one (e.g. due to clock drift) */
+	pos += frame_samples + sampling_rate / PLC_TONE_FREQUENCY / 4;
+
+	plc_tone_generate(sampling_rate,pos,samples,frame_samples);
+	if(mpf_plc_good_frame(plc,samples) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Received Frame Not Overlap-Added after Loss");
+		return FALSE;
+	}
+	if(plc_continuity_check(prev,samples,frame_samples,max_step,"Received",n) == FALSE) {
+		return FALSE;
+	}
+	/* the end of the frame is past the overlap-add and left intact */
+	if(samples[frame_samples-1] != plc_tone_sample(sampling_rate,pos + frame_samples - 1)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Received Frame Modified past Overlap-Add");
+		return FALSE;
+	}
+
+	/* next frames are left intact */
+	pos += frame_samples;
+	plc_tone_generate(sampling_rate,pos,samples,frame_samples);
+	if(mpf_plc_good_frame(plc,samples) == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Modification of Good Frame after Recovery");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t plc_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const apr_uint32_t sampling_rates[] = {8000, 16000};
+	apr_size_t i;
+
+	for(i=0; i<sizeof(sampling_rates)/sizeof(sampling_rates[0]); i++) {
+		if(plc_fade_out_test(sampling_rates[i],suite->pool) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"PLC Fade-Out Test Failed [%u Hz]",sampling_rates[i]);
+			return FALSE;
+		}
+		if(plc_recovery_test(sampling_rates[i],suite->pool) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"PLC Recovery Test Failed [%u Hz]",sampling_rates[i]);
+			return FALSE;
+		}
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"PLC Tests Passed [%u Hz]",sampling_rates[i]);
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* plc_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"plc",NULL,plc_test_run);
+	return suite;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <apr_time.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_resampler.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Default number of frames to process per conversion (100 sec) */
+#define RESAMPLER_BENCH_FRAME_COUNT 10000
+/** Frequency of the test tone */
+#define RESAMPLER_BENCH_TONE        1000
+/** Amplitude of the test tone */
+#define RESAMPLER_BENCH_AMPLITUDE   10000
+
+/** Test tone generator (source stream) */
+typedef struct {
+	apr_uint16_t sampling_rate;
+	apr_size_t   position;
+} tone_generator_t;
+
+/** Level meter of the resampled signal (sink stream) */
+typedef struct {
+	double       energy;
+	apr_size_t   count;
+} level_meter_t;
+
+static apt_bool_t tone_generator_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	tone_generator_t *generator = stream->obj;
+	apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t count = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		samples[i] = (apr_int16_t)(RESAMPLER_BENCH_AMPLITUDE *
+			sin(2 * M_PI * RESAMPLER_BENCH_TONE * (generator->position + i) / generator->sampling_rate));
+	}
+	generator->position += count;
+	frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+	return TRUE;
+}
+
+static const mpf_audio_stream_vtable_t tone_generator_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	tone_generator_read,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+static apt_bool_t level_meter_write(mpf_audio_stream_t *stream, const mpf_frame_t *frame)
+{
+	level_meter_t *meter = stream->obj;
+	const apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t count = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		meter->energy += (double)samples[i] * samples[i];
+	}
+	meter->count += count;
+	return TRUE;
+}
+
+static const mpf_audio_stream_vtable_t level_meter_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	level_meter_write,
+	NULL
+};
+
+static apt_bool_t resampler_bench_run(apr_uint16_t in_rate, apr_uint16_t out_rate, apr_size_t frame_count, apr_pool_t *pool)
+{
+	tone_generator_t generator;
+	level_meter_t meter;
+	mpf_audio_stream_t *source;
+	mpf_audio_stream_t *sink;
+	mpf_audio_stream_t *resampler;
+	mpf_frame_t frame;
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t i;
+	double rms;
+	double expected_rms = RESAMPLER_BENCH_AMPLITUDE / sqrt(2.0);
+
+	generator.sampling_rate = in_rate;
+	generator.position = 0;
+	source = mpf_audio_stream_create(
+				&generator,
+				&tone_generator_vtable,
+				mpf_stream_capabilities_create(STREAM_DIRECTION_RECEIVE,pool),
+				pool);
+	source->rx_descriptor = mpf_codec_lpcm_descriptor_create(in_rate,1,CODEC_FRAME_TIME_BASE,pool);
+
+	meter.energy = 0;
+	meter.count = 0;
+	sink = mpf_audio_stream_create(
+				&meter,
+				&level_meter_vtable,
+				mpf_stream_capabilities_create(STREAM_DIRECTION_SEND,pool),
+				pool);
+	sink->tx_descriptor = mpf_codec_lpcm_descriptor_create(out_rate,1,CODEC_FRAME_TIME_BASE,pool);
+
+	resampler = mpf_resampler_create(source,sink,pool);
+	if(!resampler) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resampler %d->%d",in_rate,out_rate);
+		return FALSE;
+	}
+	mpf_audio_stream_rx_open(resampler,NULL);
+
+	frame.codec_frame.size = mpf_codec_linear_frame_size_calculate(out_rate,1,CODEC_FRAME_TIME_BASE);
+	frame.codec_frame.buffer = apr_palloc(pool,frame.codec_frame.size);
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.marker = MPF_MARKER_NONE;
+		mpf_audio_stream_frame_read(resampler,&frame);
+		/* skip the first frame containing the transient response of the filter */
+		if(i) {
+			mpf_audio_stream_frame_write(sink,&frame);
+		}
+	}
+	elapsed = apr_time_now() - start;
+	mpf_audio_stream_rx_close(resampler);
+	if(elapsed <= 0) {
+		elapsed = 1;
+	}
+
+	rms = meter.count ? sqrt(meter.energy / meter.count) : 0;
+	/* every channel takes one frame per CODEC_FRAME_TIME_BASE of real time */
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Resample %5d->%5d: %"APR_SIZE_T_FMT" frames in %"APR_TIME_T_FMT" usec, %.0f channels per core, level %.3f",
+		in_rate,
+		out_rate,
+		frame_count,
+		elapsed,
+		(double)frame_count * CODEC_FRAME_TIME_BASE * 1000 / elapsed,
+		rms / expected_rms);
+
+	if(rms < expected_rms * 0.9 || rms > expected_rms * 1.1) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Level of Resampled Tone %d->%d",in_rate,out_rate);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t resampler_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const apr_uint16_t sampling_rates[] = {8000, 16000, 32000, 48000};
+	apr_size_t count = sizeof(sampling_rates)/sizeof(sampling_rates[0]);
+	apr_size_t frame_count = RESAMPLER_BENCH_FRAME_COUNT;
+	apr_size_t i,j;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0) {
+		frame_count = atol(argv[0]);
+		if(!frame_count) {
+			frame_count = RESAMPLER_BENCH_FRAME_COUNT;
+		}
+	}
+
+	for(i=0; i<count; i++) {
+		for(j=0; j<count; j++) {
+			if(i == j) continue;
+
+			if(resampler_bench_run(sampling_rates[i],sampling_rates[j],frame_count,suite->pool) == FALSE) {
+				status = FALSE;
+			}
+		}
+	}
+	return status;
+}
+
+apt_test_suite_t* resampler_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"resampler",NULL,resampler_test_run);
+	return suite;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_engine.h"
+#include "mpf_codec_manager.h"
+#include "mpf_jitter_buffer.h"
+#include "mpf_decoder.h"
+
+/** Default number of frames received by each leg */
+#define RX_BENCH_FRAME_COUNT    1000000
+/** Number of concurrent legs the benchmark cycles through, so that the jitter buffers do not fit in cache */
+#define RX_BENCH_LEG_COUNT      256
+/** Number of distinct packets the benchmark cycles through */
+#define RX_BENCH_PACKET_SET     64
+/** Frame duration in msec */
+#define RX_FRAME_DURATION       20
+/** Max size of the encoded frame */
+#define RX_MAX_FRAME_SIZE       1920
+
+/** Receive leg, the jitter buffer of which is read by the decoder, as the RTP stream does */
+typedef struct {
+	mpf_jitter_buffer_t    *jb;
+	mpf_audio_stream_t     *source;
+	mpf_audio_stream_t     *decoder;
+	mpf_frame_t             frame;
+	apr_size_t              packet_size;
+	apr_uint32_t            ts;
+	apr_uint32_t            frame_ts;
+} rx_leg_t;
+
+static apt_bool_t rx_source_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	rx_leg_t *leg = stream->obj;
+	return mpf_jitter_buffer_read(leg->jb,frame);
+}
+
+static apt_bool_t rx_source_view_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	rx_leg_t *leg = stream->obj;
+	return mpf_jitter_buffer_view_read(leg->jb,frame);
+}
+
+/** Source copying frames out of the jitter buffer, the view read is set for legs lending its slots */
+static const mpf_audio_stream_vtable_t rx_source_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	rx_source_read,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+static rx_leg_t* rx_leg_create(const mpf_codec_manager_t *codec_manager, const mpf_codec_descriptor_t *descriptor, apt_bool_t view, apr_pool_t *pool)
+{
+	mpf_jb_config_t *jb_config;
+	mpf_codec_t *codec;
+	mpf_stream_capabilities_t *capabilities;
+	rx_leg_t *leg = apr_palloc(pool,sizeof(rx_leg_t));
+	mpf_codec_descriptor_t *rx_descriptor = mpf_codec_descriptor_create(pool);
+
+	*rx_descriptor = *descriptor;
+	codec = mpf_codec_manager_codec_get(codec_manager,rx_descriptor,pool);
+	if(!codec) {
+		return NULL;
+	}
+
+	jb_config = apr_palloc(pool,sizeof(mpf_jb_config_t));
+	mpf_jb_config_init(jb_config);
+	jb_config->initial_playout_delay = 2 * RX_FRAME_DURATION;
+	jb_config->time_skew_detection = 0;
+	leg->jb = mpf_jitter_buffer_create(jb_config,rx_descriptor,codec,pool);
+	leg->packet_size = mpf_codec_frame_size_calculate(
+		rx_descriptor->sampling_rate,
+		rx_descriptor->channel_count,
+		RX_FRAME_DURATION,
+		codec->attribs->bits_per_sample);
+	leg->ts = 0;
+	leg->frame_ts = (apr_uint32_t)mpf_codec_frame_samples_calculate(rx_descriptor->rtp_sampling_rate,rx_descriptor->channel_count,RX_FRAME_DURATION);
+
+	capabilities = mpf_stream_capabilities_create(STREAM_DIRECTION_RECEIVE,pool);
+	leg->source = mpf_audio_stream_create(leg,&rx_source_vtable,capabilities,pool);
+	leg->source->rx_descriptor = rx_descriptor;
+	if(view == TRUE) {
+		leg->source->read_frame_view = rx_source_view_read;
+	}
+	leg->decoder = mpf_decoder_create(leg->source,codec,pool);
+	if(!leg->decoder || mpf_audio_stream_rx_open(leg->decoder,NULL) == FALSE) {
+		return NULL;
+	}
+
+	leg->frame.codec_frame.size = mpf_codec_linear_frame_size_calculate(rx_descriptor->sampling_rate,rx_descriptor->channel_count,RX_FRAME_DURATION);
+	leg->frame.codec_frame.buffer = apr_palloc(pool,leg->frame.codec_frame.size);
+	return leg;
+}
+
+/** Receive a packet and read the decoded frame, as done on every tick */
+static APR_INLINE apt_bool_t rx_leg_process(rx_leg_t *leg, apr_byte_t *packet)
+{
+	mpf_jitter_buffer_write(leg->jb,packet,leg->packet_size,leg->ts,0);
+	leg->ts += leg->frame_ts;
+
+	leg->frame.type = MEDIA_FRAME_TYPE_NONE;
+	leg->frame.marker = MPF_MARKER_NONE;
+	return mpf_audio_stream_frame_read(leg->decoder,&leg->frame);
+}
+
+/** Check the legs lending and copying frames decode the same audio */
+static apt_bool_t rx_leg_verify(rx_leg_t *copy_leg, rx_leg_t *view_leg, apr_byte_t *packets)
+{
+	apr_size_t i;
+	apr_size_t audio_count = 0;
+	for(i=0; i<RX_BENCH_PACKET_SET * 4; i++) {
+		rx_leg_process(copy_leg,packets + (i % RX_BENCH_PACKET_SET) * RX_MAX_FRAME_SIZE);
+		rx_leg_process(view_leg,packets + (i % RX_BENCH_PACKET_SET) * RX_MAX_FRAME_SIZE);
+		if(copy_leg->frame.type != view_leg->frame.type) {
+			return FALSE;
+		}
+		if((copy_leg->frame.type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+			if(memcmp(copy_leg->frame.codec_frame.buffer,view_leg->frame.codec_frame.buffer,copy_leg->frame.codec_frame.size) != 0) {
+				return FALSE;
+			}
+			audio_count++;
+		}
+	}
+	return audio_count ? TRUE : FALSE;
+}
+
+/** Measure the time a leg takes to receive and decode a frame in nsec, processing the legs in turn */
+static double rx_leg_bench(rx_leg_t **legs, apr_byte_t *packets, apr_size_t frame_count)
+{
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t i;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		rx_leg_process(legs[i % RX_BENCH_LEG_COUNT],packets + (i % RX_BENCH_PACKET_SET) * RX_MAX_FRAME_SIZE);
+	}
+	elapsed = apr_time_now() - start;
+	return (double)elapsed * 1000 / frame_count;
+}
+
+static apt_bool_t rx_path_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	static const struct {
+		const char  *name;
+		apr_byte_t   payload_type;
+		apr_uint16_t sampling_rate;
+	} codecs[] = {
+		{"PCMU", 0,  8000},
+		{"L16",  96, 8000},
+		{"L16",  96, 16000},
+		{"L16",  96, 48000}
+	};
+	mpf_codec_manager_t *codec_manager;
+	mpf_codec_descriptor_t descriptor;
+	rx_leg_t **copy_legs;
+	rx_leg_t **view_legs;
+	apr_byte_t *packets;
+	apr_size_t frame_count = RX_BENCH_FRAME_COUNT;
+	apr_size_t n;
+	apr_size_t i;
+	apr_uint32_t seed = 1;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+
+	codec_manager = mpf_engine_codec_manager_create(suite->pool);
+	if(!codec_manager) {
+		return FALSE;
+	}
+	copy_legs = apr_palloc(suite->pool,sizeof(rx_leg_t*) * RX_BENCH_LEG_COUNT);
+	view_legs = apr_palloc(suite->pool,sizeof(rx_leg_t*) * RX_BENCH_LEG_COUNT);
+
+	/* random payloads to receive */
+	packets = apr_palloc(suite->pool,RX_BENCH_PACKET_SET * RX_MAX_FRAME_SIZE);
+	for(i=0; i<RX_BENCH_PACKET_SET * RX_MAX_FRAME_SIZE; i++) {
+		seed = seed * 1103515245 + 12345;
+		packets[i] = (apr_byte_t)(seed >> 16);
+	}
+
+	for(n=0; n<sizeof(codecs)/sizeof(codecs[0]); n++) {
+		mpf_codec_descriptor_init(&descriptor);
+		descriptor.payload_type = codecs[n].payload_type;
+		apt_string_set(&descriptor.name,codecs[n].name);
+		descriptor.sampling_rate = codecs[n].sampling_rate;
+		descriptor.rtp_sampling_rate = codecs[n].sampling_rate;
+		descriptor.channel_count = 1;
+		descriptor.frame_duration = RX_FRAME_DURATION;
+
+		for(i=0; i<RX_BENCH_LEG_COUNT; i++) {
+			copy_legs[i] = rx_leg_create(codec_manager,&descriptor,FALSE,suite->pool);
+			view_legs[i] = rx_leg_create(codec_manager,&descriptor,TRUE,suite->pool);
+			if(!copy_legs[i] || !view_legs[i]) {
+				break;
+			}
+		}
+		if(i < RX_BENCH_LEG_COUNT) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Rx Leg [%s/%d]",codecs[n].name,codecs[n].sampling_rate);
+			status = FALSE;
+			continue;
+		}
+
+		if(rx_leg_verify(copy_legs[0],view_legs[0],packets) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rx Leg [%s/%d] reading frame views mismatches copying frames",
+				codecs[n].name,codecs[n].sampling_rate);
+			status = FALSE;
+			continue;
+		}
+
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Rx Leg [%s/%d]: %d legs, %"APR_SIZE_T_FMT" frames, copy %.1f ns/frame, view %.1f ns/frame",
+			codecs[n].name,
+			codecs[n].sampling_rate,
+			RX_BENCH_LEG_COUNT,
+			frame_count,
+			rx_leg_bench(copy_legs,packets,frame_count),
+			rx_leg_bench(view_legs,packets,frame_count));
+
+		for(i=0; i<RX_BENCH_LEG_COUNT; i++) {
+			mpf_audio_stream_rx_close(copy_legs[i]->decoder);
+			mpf_audio_stream_rx_close(view_legs[i]->decoder);
+		}
+	}
+
+	mpf_codec_manager_destroy(codec_manager);
+	return status;
+}
+
+apt_test_suite_t* rx_path_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"rx-path",NULL,rx_path_test_run);
+	return suite;
+}
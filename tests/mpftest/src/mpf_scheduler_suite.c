@@ -0,0 +1,197 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_time.h>
+#include <apr_atomic.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_scheduler.h"
+
+/** Media clock resolution in msec */
+#define SCHEDULER_MEDIA_RESOLUTION   10
+/** Timer clock resolution in msec */
+#define SCHEDULER_TIMER_RESOLUTION   100
+/** Number of ticks, in which data is produced, in free-running mode (a minute of media) */
+#define SCHEDULER_DATA_TICKS         6000
+/** Min speedup of free-running mode over real time */
+#define SCHEDULER_MIN_SPEEDUP        10
+/** Time in msec to run the scheduler for, while no data is produced or at a fixed rate */
+#define SCHEDULER_RUN_TIME           500
+/** Rate to run the scheduler at */
+#define SCHEDULER_RATE               4
+/** Max time in msec to wait for the scheduler */
+#define SCHEDULER_MAX_WAIT_TIME      30000
+
+/** Scheduler driving counters of ticks and timer ticks */
+typedef struct {
+	mpf_scheduler_t      *scheduler;
+	/* number of ticks processed */
+	volatile apr_uint32_t ticks;
+	/* number of timer ticks processed */
+	volatile apr_uint32_t timer_ticks;
+	/* number of timer ticks out of pace with the media time of ticks */
+	volatile apr_uint32_t timer_misses;
+	/* number of ticks, in which data is produced */
+	apr_uint32_t          data_ticks;
+} scheduler_scenario_t;
+
+static void scheduler_media_proc(mpf_scheduler_t *scheduler, void *obj)
+{
+	scheduler_scenario_t *scenario = obj;
+	apr_uint32_t ticks = apr_atomic_inc32(&scenario->ticks) + 1;
+	mpf_scheduler_idle_set(scheduler,ticks < scenario->data_ticks ? FALSE : TRUE);
+}
+
+static void scheduler_timer_proc(mpf_scheduler_t *scheduler, void *obj)
+{
+	scheduler_scenario_t *scenario = obj;
+	apr_uint32_t ticks = apr_atomic_read32(&scenario->ticks);
+	apr_uint32_t timer_ticks = apr_atomic_inc32(&scenario->timer_ticks) + 1;
+	/* the timer clock is counted in the media time of ticks processed */
+	if(ticks * SCHEDULER_MEDIA_RESOLUTION != timer_ticks * SCHEDULER_TIMER_RESOLUTION) {
+		apr_atomic_inc32(&scenario->timer_misses);
+	}
+}
+
+static scheduler_scenario_t* scheduler_scenario_create(apr_uint32_t data_ticks, apr_pool_t *pool)
+{
+	scheduler_scenario_t *scenario = apr_palloc(pool,sizeof(scheduler_scenario_t));
+	scenario->ticks = 0;
+	scenario->timer_ticks = 0;
+	scenario->timer_misses = 0;
+	scenario->data_ticks = data_ticks;
+	scenario->scheduler = mpf_scheduler_create(pool);
+	mpf_scheduler_media_clock_set(scenario->scheduler,SCHEDULER_MEDIA_RESOLUTION,scheduler_media_proc,scenario);
+	mpf_scheduler_timer_clock_set(scenario->scheduler,SCHEDULER_TIMER_RESOLUTION,scheduler_timer_proc,scenario);
+	return scenario;
+}
+
+static apt_bool_t scheduler_timers_check(scheduler_scenario_t *scenario, const char *name)
+{
+	if(apr_atomic_read32(&scenario->timer_misses) || !apr_atomic_read32(&scenario->timer_ticks)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"%s: Timers Out of Pace with Media [%u misses of %u]",
+			name,
+			apr_atomic_read32(&scenario->timer_misses),
+			apr_atomic_read32(&scenario->timer_ticks));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Process a minute of media in free-running mode, then check the scheduler yields once no data is produced */
+static apt_bool_t scheduler_free_running_test(apr_pool_t *pool)
+{
+	scheduler_scenario_t *scenario = scheduler_scenario_create(SCHEDULER_DATA_TICKS,pool);
+	apr_time_t start_time;
+	apr_time_t data_time;
+	apr_interval_time_t elapsed_time;
+	apr_uint32_t idle_ticks;
+	apr_uint32_t max_idle_ticks;
+	apt_bool_t status = TRUE;
+
+	if(mpf_scheduler_free_running_set(scenario->scheduler,TRUE) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Free-Running Mode is not Supported, Skip Test");
+		return TRUE;
+	}
+
+	start_time = apr_time_now();
+	mpf_scheduler_start(scenario->scheduler);
+	while(apr_atomic_read32(&scenario->ticks) < SCHEDULER_DATA_TICKS &&
+		apr_time_now() - start_time < apr_time_from_msec(SCHEDULER_MAX_WAIT_TIME)) {
+		apr_sleep(1000);
+	}
+	data_time = apr_time_now();
+	elapsed_time = data_time - start_time;
+
+	/* no data is produced from now on */
+	apr_sleep(apr_time_from_msec(SCHEDULER_RUN_TIME));
+	idle_ticks = apr_atomic_read32(&scenario->ticks) - SCHEDULER_DATA_TICKS;
+	mpf_scheduler_stop(scenario->scheduler);
+	mpf_scheduler_destroy(scenario->scheduler);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Free-Running: %u ticks (%u msec of media) in %"APR_TIME_T_FMT" msec, speedup %"APR_TIME_T_FMT"x, %u ticks while idle for %d msec",
+		SCHEDULER_DATA_TICKS,
+		SCHEDULER_DATA_TICKS * SCHEDULER_MEDIA_RESOLUTION,
+		apr_time_as_msec(elapsed_time),
+		elapsed_time ? apr_time_from_msec(SCHEDULER_DATA_TICKS * SCHEDULER_MEDIA_RESOLUTION) / elapsed_time : 0,
+		idle_ticks,
+		SCHEDULER_RUN_TIME);
+
+	if(elapsed_time * SCHEDULER_MIN_SPEEDUP > apr_time_from_msec(SCHEDULER_DATA_TICKS * SCHEDULER_MEDIA_RESOLUTION)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Free-Running: Speedup below %dx",SCHEDULER_MIN_SPEEDUP);
+		status = FALSE;
+	}
+
+	/* the scheduler sleeps for the period of a tick, rather than spins, while there is no data */
+	max_idle_ticks = 2 * SCHEDULER_RUN_TIME / SCHEDULER_MEDIA_RESOLUTION;
+	if(idle_ticks > max_idle_ticks) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Free-Running: Spinning while Idle [%u > %u ticks]",idle_ticks,max_idle_ticks);
+		status = FALSE;
+	}
+
+	if(scheduler_timers_check(scenario,"Free-Running") == FALSE) {
+		status = FALSE;
+	}
+	return status;
+}
+
+/** Run the scheduler faster than real time and check the timers keep the pace of media */
+static apt_bool_t scheduler_rate_test(apr_pool_t *pool)
+{
+	scheduler_scenario_t *scenario = scheduler_scenario_create(0,pool);
+	apr_uint32_t ticks;
+	apr_uint32_t min_ticks;
+
+	mpf_scheduler_rate_set(scenario->scheduler,SCHEDULER_RATE);
+	mpf_scheduler_start(scenario->scheduler);
+	apr_sleep(apr_time_from_msec(SCHEDULER_RUN_TIME));
+	mpf_scheduler_stop(scenario->scheduler);
+	mpf_scheduler_destroy(scenario->scheduler);
+
+	ticks = apr_atomic_read32(&scenario->ticks);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Rate %d: %u ticks, %u timer ticks in %d msec",
+		SCHEDULER_RATE,
+		ticks,
+		apr_atomic_read32(&scenario->timer_ticks),
+		SCHEDULER_RUN_TIME);
+
+	/* leave a margin for a loaded system */
+	min_ticks = SCHEDULER_RUN_TIME / SCHEDULER_MEDIA_RESOLUTION * SCHEDULER_RATE / 2;
+	if(ticks < min_ticks) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rate %d: Too Few Ticks [%u < %u]",SCHEDULER_RATE,ticks,min_ticks);
+		return FALSE;
+	}
+	return scheduler_timers_check(scenario,"Rate");
+}
+
+static apt_bool_t scheduler_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	if(scheduler_free_running_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Free-Running Test Failed");
+		return FALSE;
+	}
+	if(scheduler_rate_test(suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rate Test Failed");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* scheduler_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"scheduler",NULL,scheduler_test_run);
+	return suite;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_activity_detector.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Default number of frames processed by each kernel */
+#define VAD_BENCH_FRAME_COUNT    1000000
+/** Number of samples in a frame (20 msec of 8 kHz audio) */
+#define VAD_FRAME_SAMPLES        160
+/** Number of samples checked against the reference (not a multiple of vector width) */
+#define VAD_VERIFY_SAMPLES       4099
+/** Number of frames of noise preceding speech in the detection test */
+#define VAD_NOISE_FRAME_COUNT    100
+/** Number of frames of speech (tone) in the detection test */
+#define VAD_SPEECH_FRAME_COUNT   30
+
+/** Calculate reference level as the former per-frame loop did */
+static apr_size_t vad_level_reference(const apr_int16_t *samples, apr_size_t count)
+{
+	apr_size_t sum = 0;
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		sum += samples[i] < 0 ? -samples[i] : samples[i];
+	}
+	return sum / count;
+}
+
+/** Calculate reference band-limited energy sample by sample */
+static apr_uint32_t vad_energy_reference(const apr_int16_t *samples, apr_size_t count, const apr_int16_t history[2])
+{
+	apr_uint64_t sum = 0;
+	apr_int32_t prev;
+	apr_int32_t y;
+	apr_size_t i;
+	for(i=0; i<count; i++) {
+		prev = i >= 2 ? samples[i-2] : history[i];
+		y = (samples[i] >> 1) - (prev >> 1);
+		sum += (apr_uint32_t)(y * y);
+	}
+	return (apr_uint32_t)(sum / count);
+}
+
+static apt_bool_t vad_kernel_verify(const apr_int16_t *samples)
+{
+	apr_int16_t history[2] = {-32768, 32767};
+	apr_int16_t saved[2];
+	apr_size_t count;
+
+	for(count=1; count<=VAD_VERIFY_SAMPLES; count+=(count < 64 ? 1 : 97)) {
+		if(mpf_activity_level_calculate(samples,count) != vad_level_reference(samples,count)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Level Mismatch [%"APR_SIZE_T_FMT" samples]",count);
+			return FALSE;
+		}
+		saved[0] = history[0];
+		saved[1] = history[1];
+		if(mpf_activity_band_energy_calculate(samples,count,history) != vad_energy_reference(samples,count,saved)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Energy Mismatch [%"APR_SIZE_T_FMT" samples]",count);
+			return FALSE;
+		}
+		if(count > 1 && (history[0] != samples[count-2] || history[1] != samples[count-1])) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"History Mismatch [%"APR_SIZE_T_FMT" samples]",count);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Feed noise followed by a tone to the detector, return the number of the frame activity is detected at */
+static apr_size_t vad_detection_run(mpf_detector_mode_e mode, apr_pool_t *pool)
+{
+	mpf_activity_detector_t *detector = mpf_activity_detector_create(pool);
+	apr_int16_t samples[VAD_FRAME_SAMPLES];
+	mpf_frame_t frame;
+	apr_uint32_t seed = 7;
+	apr_size_t i;
+	apr_size_t n;
+
+	mpf_activity_detector_mode_set(detector,mode);
+	mpf_activity_frame_duration_set(detector,20);
+	mpf_activity_detector_noinput_timeout_set(detector,100000);
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.buffer = samples;
+	frame.codec_frame.size = sizeof(samples);
+	for(n=0; n<VAD_NOISE_FRAME_COUNT + VAD_SPEECH_FRAME_COUNT; n++) {
+		for(i=0; i<VAD_FRAME_SAMPLES; i++) {
+			/* white noise of a noisy line */
+			seed = seed * 1103515245 + 12345;
+			samples[i] = (apr_int16_t)(((apr_int32_t)(seed >> 16) & 0x7FF) - 1024);
+			if(n >= VAD_NOISE_FRAME_COUNT) {
+				/* 1 kHz tone 20 dB above the noise */
+				samples[i] += (apr_int16_t)(8000 * sin(2 * M_PI * 1000 * (n * VAD_FRAME_SAMPLES + i) / 8000));
+			}
+		}
+		if(mpf_activity_detector_process(detector,&frame) == MPF_DETECTOR_EVENT_ACTIVITY) {
+			return n;
+		}
+	}
+	return n;
+}
+
+static double vad_bench(apt_bool_t energy, const apr_int16_t *samples, apr_size_t frame_count)
+{
+	apr_int16_t history[2] = {0, 0};
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t sink = 0;
+	apr_size_t i;
+
+	start = apr_time_now();
+	for(i=0; i<frame_count; i++) {
+		const apr_int16_t *frame = samples + (i % 16) * VAD_FRAME_SAMPLES;
+		if(energy == TRUE) {
+			sink += mpf_activity_band_energy_calculate(frame,VAD_FRAME_SAMPLES,history);
+		}
+		else {
+			sink += mpf_activity_level_calculate(frame,VAD_FRAME_SAMPLES);
+		}
+	}
+	elapsed = apr_time_now() - start;
+	if(sink == 1) {
+		/* keep the result in use */
+		elapsed++;
+	}
+	return (double)elapsed * 1000 / frame_count;
+}
+
+static apt_bool_t vad_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_int16_t *samples;
+	apr_size_t frame_count = VAD_BENCH_FRAME_COUNT;
+	apr_size_t level_frame;
+	apr_size_t energy_frame;
+	apr_uint32_t seed = 1;
+	apr_size_t i;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		frame_count = atol(argv[0]);
+	}
+
+	samples = apr_palloc(suite->pool,VAD_VERIFY_SAMPLES * sizeof(apr_int16_t));
+	for(i=0; i<VAD_VERIFY_SAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		samples[i] = (apr_int16_t)((apr_int32_t)(seed >> 16) - 32768);
+	}
+	/* extremes */
+	samples[0] = -32768;
+	samples[5] = -32768;
+	samples[9] = 32767;
+
+	if(vad_kernel_verify(samples) == FALSE) {
+		return FALSE;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"VAD Kernels: %"APR_SIZE_T_FMT" frames, level %.1f ns/frame, band energy %.1f ns/frame",
+		frame_count,
+		vad_bench(FALSE,samples,frame_count),
+		vad_bench(TRUE,samples,frame_count));
+
+	level_frame = vad_detection_run(MPF_DETECTOR_MODE_LEVEL,suite->pool);
+	energy_frame = vad_detection_run(MPF_DETECTOR_MODE_ENERGY_RATIO,suite->pool);
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"VAD Activity on Noisy Line (speech at frame %d): level mode at frame %"APR_SIZE_T_FMT", energy ratio mode at frame %"APR_SIZE_T_FMT,
+		VAD_NOISE_FRAME_COUNT,
+		level_frame,
+		energy_frame);
+	if(energy_frame < VAD_NOISE_FRAME_COUNT || energy_frame >= VAD_NOISE_FRAME_COUNT + VAD_SPEECH_FRAME_COUNT) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Energy ratio mode failed to detect speech on noisy line");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* vad_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"vad",NULL,vad_test_run);
+	return suite;
+}
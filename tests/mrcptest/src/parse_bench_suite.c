@@ -0,0 +1,504 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mrcp_resource_loader.h"
+#include "mrcp_resource_factory.h"
+#include "mrcp_message.h"
+#include "mrcp_stream.h"
+
+/** Default number of times each message is parsed */
+#define PARSE_BENCH_MESSAGE_COUNT  100000
+/** Number of messages parsed before the pool of the parser is recycled */
+#define PARSE_BENCH_BATCH_SIZE     1000
+/** Number of lookups of each header name */
+#define PARSE_BENCH_LOOKUP_COUNT   100
+/** Size of the buffer messages are received into in segments */
+#define PARSE_BENCH_SEGMENT_BUFFER_SIZE   256
+/** Number of messages received in segments */
+#define PARSE_BENCH_SEGMENT_MESSAGE_COUNT 8
+
+/** Header section of RECOGNIZE request (the start line and the content length are composed at run time) */
+static const char recognize_headers[] =
+	"RECOGNIZE 543257\r\n"
+	"Channel-Identifier: 32AECB23433801@speechrecog\r\n"
+	"Content-Type: text/uri-list\r\n"
+	"Content-Id: request1@form-level.store\r\n"
+	"Cache-Control: max-age=30\r\n"
+	"Logging-Tag: session-1234\r\n"
+	"Vendor-Specific-Parameters: com.example.param1=value1;com.example.param2=value2\r\n"
+	"Accept-Charset: UTF-8\r\n"
+	"Fetch-Timeout: 5000\r\n"
+	"Confidence-Threshold: 0.5\r\n"
+	"Sensitivity-Level: 0.7\r\n"
+	"Speed-Vs-Accuracy: 0.5\r\n"
+	"N-Best-List-Length: 3\r\n"
+	"No-Input-Timeout: 5000\r\n"
+	"Recognition-Timeout: 15000\r\n"
+	"Start-Input-Timers: true\r\n"
+	"Speech-Complete-Timeout: 800\r\n"
+	"Speech-Incomplete-Timeout: 1500\r\n"
+	"DTMF-Interdigit-Timeout: 3000\r\n"
+	"DTMF-Term-Timeout: 5000\r\n"
+	"DTMF-Term-Char: #\r\n"
+	"Save-Waveform: false\r\n"
+	"Speech-Language: en-US\r\n"
+	"Media-Type: audio/x-wav\r\n"
+	"Recognition-Mode: normal\r\n"
+	"Cancel-If-Queue: false\r\n"
+	"Hotword-Max-Duration: 5000\r\n"
+	"Hotword-Min-Duration: 100\r\n"
+	"Early-No-Match: false\r\n";
+
+/** Body of RECOGNIZE request */
+static const char recognize_body[] = "builtin:grammar/digits?length=4\r\n";
+
+/** Header section of SPEAK request (the start line and the content length are composed at run time) */
+static const char speak_headers[] =
+	"SPEAK 543258\r\n"
+	"Channel-Identifier: 32AECB23433802@speechsynth\r\n"
+	"Content-Type: application/ssml+xml\r\n"
+	"Content-Id: prompt1@form-level.store\r\n"
+	"Cache-Control: max-age=30\r\n"
+	"Logging-Tag: session-1234\r\n"
+	"Vendor-Specific-Parameters: com.example.param1=value1;com.example.param2=value2\r\n"
+	"Accept-Charset: UTF-8\r\n"
+	"Fetch-Timeout: 5000\r\n"
+	"Kill-On-Barge-In: false\r\n"
+	"Speaker-Profile: http://www.example.com/profile\r\n"
+	"Voice-Gender: female\r\n"
+	"Voice-Age: 30\r\n"
+	"Voice-Variant: 1\r\n"
+	"Voice-Name: Alice\r\n"
+	"Prosody-Volume: medium\r\n"
+	"Prosody-Rate: fast\r\n"
+	"Speech-Language: en-US\r\n"
+	"Fetch-Hint: prefetch\r\n"
+	"Audio-Fetch-Hint: prefetch\r\n"
+	"Load-Lexicon: false\r\n"
+	"Speak-Length: +2 Sentence\r\n";
+
+/** Body of SPEAK request */
+static const char speak_body[] = "<?xml version=\"1.0\"?><speak>Hello world, benchmark.</speak>\r\n";
+
+/** Compose MRCPv2 message of a given header section and body */
+static void parse_bench_message_compose(apt_str_t *message, const char *headers, const char *body, apr_pool_t *pool)
+{
+	const char *rest = apr_psprintf(pool,"%sContent-Length: %"APR_SIZE_T_FMT"\r\n\r\n%s",headers,strlen(body),body);
+	apr_size_t message_length = strlen(rest);
+	apr_size_t prev_length;
+	const char *buf;
+	/* the length of the start line depends on the number of digits in the message length itself */
+	do {
+		prev_length = message_length;
+		buf = apr_psprintf(pool,"MRCP/2.0 %"APR_SIZE_T_FMT" %s",message_length,rest);
+		message_length = strlen(buf);
+	}
+	while(message_length != prev_length);
+
+	message->buf = (char*)buf;
+	message->length = message_length;
+}
+
+/** Parse a message once, returning the number of parsed header fields */
+static apr_size_t parse_bench_message_parse(mrcp_parser_t *parser, const apt_str_t *text, char *buffer, mrcp_message_t **message)
+{
+	apt_text_stream_t stream;
+	apt_header_field_t *header_field;
+	apr_size_t count = 0;
+
+	/* parser may modify the stream, so parse a fresh copy of the message */
+	memcpy(buffer,text->buf,text->length);
+	buffer[text->length] = '\0';
+	apt_text_stream_init(&stream,buffer,text->length);
+
+	*message = NULL;
+	if(mrcp_parser_run(parser,&stream,message) != APT_MESSAGE_STATUS_COMPLETE || !*message) {
+		return 0;
+	}
+
+	for(header_field = APR_RING_FIRST(&(*message)->header.header_section.ring);
+			header_field != APR_RING_SENTINEL(&(*message)->header.header_section.ring, apt_header_field_t, link);
+				header_field = APR_RING_NEXT(header_field, link)) {
+		count++;
+	}
+	return count;
+}
+
+/** Run the parser over a given message a number of times */
+static apt_bool_t parse_bench_run(mrcp_resource_factory_t *factory, const char *name, const apt_str_t *text, apr_size_t message_count, apt_bool_t zero_copy, apr_pool_t *pool)
+{
+	apr_pool_t *batch_pool = NULL;
+	mrcp_parser_t *parser = NULL;
+	mrcp_message_t *message;
+	apt_message_buffer_t *shared_buffer = NULL;
+	char *buffer;
+	apr_size_t header_count = 0;
+	apr_size_t count;
+	apr_size_t i;
+	apr_time_t start;
+	apr_time_t elapsed;
+
+	if(zero_copy == TRUE) {
+		shared_buffer = apt_message_buffer_create(text->length);
+		buffer = apt_message_buffer_data_get(shared_buffer);
+	}
+	else {
+		buffer = apr_palloc(pool,text->length + 1);
+	}
+
+	start = apr_time_now();
+	for(i=0; i<message_count; i++) {
+		if(i % PARSE_BENCH_BATCH_SIZE == 0) {
+			/* the parser allocates messages from its own pool, so recycle it every batch */
+			if(batch_pool) {
+				apr_pool_destroy(batch_pool);
+			}
+			apr_pool_create(&batch_pool,pool);
+			parser = mrcp_parser_create(factory,batch_pool);
+		}
+		if(shared_buffer) {
+			/* messages parsed so far refer to the buffer, so the data is received into a new one */
+			if(apt_message_buffer_is_shared(shared_buffer) == TRUE) {
+				apt_message_buffer_unref(shared_buffer);
+				shared_buffer = apt_message_buffer_create(text->length);
+				buffer = apt_message_buffer_data_get(shared_buffer);
+			}
+			mrcp_parser_buffer_set(parser,shared_buffer);
+		}
+		count = parse_bench_message_parse(parser,text,buffer,&message);
+		if(!count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Parse [%s] Message",name);
+			break;
+		}
+		header_count += count;
+	}
+	if(batch_pool) {
+		apr_pool_destroy(batch_pool);
+	}
+	if(shared_buffer) {
+		apt_message_buffer_unref(shared_buffer);
+	}
+	if(i < message_count) {
+		return FALSE;
+	}
+	elapsed = apr_time_now() - start;
+	if(elapsed <= 0) {
+		elapsed = 1;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Parse [%s] %s: %"APR_SIZE_T_FMT" messages in %"APR_TIME_T_FMT" usec, %.0f messages/sec, %.0f headers/sec",
+		name,
+		zero_copy == TRUE ? "zero-copy" : "copy",
+		message_count,
+		elapsed,
+		(double)message_count * 1000000 / elapsed,
+		(double)header_count * 1000000 / elapsed);
+	return TRUE;
+}
+
+/** Compare messages parsed in copy and zero-copy modes */
+static apt_bool_t parse_bench_message_compare(const mrcp_message_t *message, const mrcp_message_t *ref_message)
+{
+	const apt_header_field_t *header_field;
+	const apt_header_field_t *ref_header_field;
+
+	if(apt_string_compare(&message->body,&ref_message->body) == FALSE && 
+		(message->body.length || ref_message->body.length)) {
+		return FALSE;
+	}
+
+	ref_header_field = APR_RING_FIRST(&ref_message->header.header_section.ring);
+	for(header_field = APR_RING_FIRST(&message->header.header_section.ring);
+			header_field != APR_RING_SENTINEL(&message->header.header_section.ring, apt_header_field_t, link);
+				header_field = APR_RING_NEXT(header_field, link)) {
+		if(ref_header_field == APR_RING_SENTINEL(&ref_message->header.header_section.ring, apt_header_field_t, link)) {
+			return FALSE;
+		}
+		if(header_field->id != ref_header_field->id ||
+			apt_string_compare(&header_field->name,&ref_header_field->name) == FALSE ||
+			apt_string_compare(&header_field->value,&ref_header_field->value) == FALSE ||
+			header_field->name.buf[header_field->name.length] != '\0' ||
+			header_field->value.buf[header_field->value.length] != '\0') {
+			return FALSE;
+		}
+		ref_header_field = APR_RING_NEXT(ref_header_field, link);
+	}
+	return ref_header_field == APR_RING_SENTINEL(&ref_message->header.header_section.ring, apt_header_field_t, link) ? TRUE : FALSE;
+}
+
+/** Parse a sequence of messages received in small segments in zero-copy mode */
+static apt_bool_t zero_copy_segmentation_run(mrcp_resource_factory_t *factory, const apt_str_t *texts, apr_size_t text_count, apr_size_t segment_size, apr_pool_t *pool)
+{
+	mrcp_parser_t *parser = mrcp_parser_create(factory,pool);
+	mrcp_parser_t *ref_parser = mrcp_parser_create(factory,pool);
+	apt_message_buffer_t *shared_buffer = apt_message_buffer_create(PARSE_BENCH_SEGMENT_BUFFER_SIZE);
+	mrcp_message_t *messages[PARSE_BENCH_SEGMENT_MESSAGE_COUNT];
+	mrcp_message_t *ref_message;
+	mrcp_message_t *message;
+	apt_text_stream_t stream;
+	char *ref_buffer;
+	const char *data;
+	apr_size_t data_length = 0;
+	apr_size_t data_offset = 0;
+	apr_size_t message_count = 0;
+	apr_size_t offset;
+	apr_size_t length;
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+
+	/* concatenate the messages into a single stream */
+	for(i=0; i<PARSE_BENCH_SEGMENT_MESSAGE_COUNT; i++) {
+		data_length += texts[i % text_count].length;
+	}
+	data = ref_buffer = apr_palloc(pool,data_length);
+	for(i=0; i<PARSE_BENCH_SEGMENT_MESSAGE_COUNT; i++) {
+		memcpy(ref_buffer,texts[i % text_count].buf,texts[i % text_count].length);
+		ref_buffer += texts[i % text_count].length;
+	}
+
+	apt_text_stream_init(&stream,apt_message_buffer_data_get(shared_buffer),PARSE_BENCH_SEGMENT_BUFFER_SIZE);
+	mrcp_parser_buffer_set(parser,shared_buffer);
+	/* receive the stream the same way the connection agents do */
+	while(data_offset < data_length) {
+		offset = stream.pos - stream.text.buf;
+		length = PARSE_BENCH_SEGMENT_BUFFER_SIZE - offset;
+		if(length > segment_size) {
+			length = segment_size;
+		}
+		if(length > data_length - data_offset) {
+			length = data_length - data_offset;
+		}
+		memcpy(stream.pos,data + data_offset,length);
+		data_offset += length;
+		stream.text.length = offset + length;
+		stream.pos[length] = '\0';
+		apt_text_stream_reset(&stream);
+
+		do {
+			if(mrcp_parser_run(parser,&stream,&message) == APT_MESSAGE_STATUS_COMPLETE && 
+				message_count < PARSE_BENCH_SEGMENT_MESSAGE_COUNT) {
+				messages[message_count++] = message;
+			}
+		}
+		while(apt_text_is_eos(&stream) == FALSE);
+
+		apt_message_buffer_stream_scroll(&shared_buffer,&stream);
+		mrcp_parser_buffer_set(parser,shared_buffer);
+	}
+	apt_message_buffer_unref(shared_buffer);
+
+	if(message_count != PARSE_BENCH_SEGMENT_MESSAGE_COUNT) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Number of Messages Parsed in Zero-Copy Mode [%"APR_SIZE_T_FMT"]",message_count);
+		return FALSE;
+	}
+
+	/* the buffers, the messages refer to, must have been retained intact */
+	ref_buffer = apr_palloc(pool,data_length + 1);
+	for(i=0; i<message_count; i++) {
+		if(!parse_bench_message_parse(ref_parser,&texts[i % text_count],ref_buffer,&ref_message) ||
+			parse_bench_message_compare(messages[i],ref_message) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatched Message [%"APR_SIZE_T_FMT"] Parsed in Zero-Copy Mode",i);
+			status = FALSE;
+		}
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Parse Zero-Copy Segments [%"APR_SIZE_T_FMT" bytes]: %"APR_SIZE_T_FMT" messages %s",
+		segment_size,
+		message_count,
+		status == TRUE ? "match" : "mismatch");
+	return status;
+}
+
+/** Bind the buffer a message parsed in zero-copy mode refers to to another pool, and check it outlives the pool of the parser */
+static apt_bool_t zero_copy_bind_run(mrcp_resource_factory_t *factory, const apt_str_t *text, apr_pool_t *pool)
+{
+	apr_pool_t *parser_pool;
+	apr_pool_t *bind_pool;
+	mrcp_parser_t *parser;
+	mrcp_message_t *message;
+	apt_message_buffer_t *shared_buffer = apt_message_buffer_create(text->length);
+	apt_bool_t status = TRUE;
+
+	apr_pool_create(&parser_pool,pool);
+	apr_pool_create(&bind_pool,pool);
+	parser = mrcp_parser_create(factory,parser_pool);
+	mrcp_parser_buffer_set(parser,shared_buffer);
+	if(!parse_bench_message_parse(parser,text,apt_message_buffer_data_get(shared_buffer),&message)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Parse Message in Zero-Copy Mode");
+		apr_pool_destroy(parser_pool);
+		apr_pool_destroy(bind_pool);
+		apt_message_buffer_unref(shared_buffer);
+		return FALSE;
+	}
+
+	mrcp_message_buffers_bind(message,bind_pool);
+	/* the references the parser pool held have been transferred */
+	apr_pool_destroy(parser_pool);
+	if(apt_message_buffer_is_shared(shared_buffer) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Buffer Released with Pool of Parser");
+		status = FALSE;
+	}
+
+	apr_pool_destroy(bind_pool);
+	if(apt_message_buffer_is_shared(shared_buffer) == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Buffer Retained beyond Bound Pool");
+		status = FALSE;
+	}
+	apt_message_buffer_unref(shared_buffer);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Bind Zero-Copy Buffer: %s",status == TRUE ? "retained as long as bound pool" : "mismatch");
+	return status;
+}
+
+/** Look up every header name of the message by linear search and by perfect hash */
+static apt_bool_t lookup_bench_run(mrcp_resource_factory_t *factory, const char *name, const apt_str_t *text, apr_pool_t *pool)
+{
+	mrcp_parser_t *parser = mrcp_parser_create(factory,pool);
+	mrcp_message_t *message;
+	char *buffer = apr_palloc(pool,text->length + 1);
+	const mrcp_header_vtable_t *vtables[2];
+	apt_header_field_t *header_field;
+	apr_size_t linear_id, hash_id;
+	apr_size_t lookups = 0;
+	apr_size_t mismatches = 0;
+	apr_size_t i, j;
+	apr_time_t start;
+	apr_time_t linear_time = 0, hash_time = 0;
+
+	if(!parse_bench_message_parse(parser,text,buffer,&message)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Parse [%s] Message",name);
+		return FALSE;
+	}
+
+	/* the resource specific header is looked up first, the same way the parser does */
+	vtables[0] = message->header.resource_header_accessor.vtable;
+	vtables[1] = message->header.generic_header_accessor.vtable;
+
+	for(header_field = APR_RING_FIRST(&message->header.header_section.ring);
+			header_field != APR_RING_SENTINEL(&message->header.header_section.ring, apt_header_field_t, link);
+				header_field = APR_RING_NEXT(header_field, link)) {
+		for(j=0; j<2; j++) {
+			if(!vtables[j]) {
+				continue;
+			}
+
+			linear_id = hash_id = 0;
+			start = apr_time_now();
+			for(i=0; i<PARSE_BENCH_LOOKUP_COUNT; i++) {
+				linear_id = apt_string_table_id_find(vtables[j]->field_table,vtables[j]->field_count,&header_field->name);
+			}
+			linear_time += apr_time_now() - start;
+
+			start = apr_time_now();
+			for(i=0; i<PARSE_BENCH_LOOKUP_COUNT; i++) {
+				hash_id = apt_string_table_hash_id_find(vtables[j]->field_table,vtables[j]->field_count,vtables[j]->field_hash,&header_field->name);
+			}
+			hash_time += apr_time_now() - start;
+
+			lookups += PARSE_BENCH_LOOKUP_COUNT;
+			if(linear_id != hash_id) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatched Lookup of [%s]: %"APR_SIZE_T_FMT" != %"APR_SIZE_T_FMT,
+					header_field->name.buf,hash_id,linear_id);
+				mismatches++;
+			}
+			if(linear_id < vtables[j]->field_count) {
+				break;
+			}
+		}
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Lookup [%s]: %"APR_SIZE_T_FMT" lookups, linear search %"APR_TIME_T_FMT" usec, perfect hash %"APR_TIME_T_FMT" usec",
+		name,
+		lookups,
+		linear_time,
+		hash_time);
+	return mismatches ? FALSE : TRUE;
+}
+
+static apt_bool_t parse_bench_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mrcp_resource_factory_t *factory;
+	mrcp_resource_loader_t *resource_loader;
+	apr_size_t message_count = PARSE_BENCH_MESSAGE_COUNT;
+	static const apr_size_t segment_sizes[] = {7, 64, PARSE_BENCH_SEGMENT_BUFFER_SIZE};
+	apt_str_t recognize;
+	apt_str_t speak;
+	apt_str_t texts[2];
+	apr_size_t i;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0 && atol(argv[0]) > 0) {
+		message_count = atol(argv[0]);
+	}
+
+	resource_loader = mrcp_resource_loader_create(TRUE,suite->pool);
+	if(!resource_loader) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Loader");
+		return FALSE;
+	}
+
+	factory = mrcp_resource_factory_get(resource_loader);
+	if(!factory) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Factory");
+		return FALSE;
+	}
+
+	parse_bench_message_compose(&recognize,recognize_headers,recognize_body,suite->pool);
+	parse_bench_message_compose(&speak,speak_headers,speak_body,suite->pool);
+
+	if(lookup_bench_run(factory,"RECOGNIZE",&recognize,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(lookup_bench_run(factory,"SPEAK",&speak,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(parse_bench_run(factory,"RECOGNIZE",&recognize,message_count,FALSE,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(parse_bench_run(factory,"RECOGNIZE",&recognize,message_count,TRUE,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(parse_bench_run(factory,"SPEAK",&speak,message_count,FALSE,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+	if(parse_bench_run(factory,"SPEAK",&speak,message_count,TRUE,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+
+	texts[0] = recognize;
+	texts[1] = speak;
+	for(i=0; i<sizeof(segment_sizes)/sizeof(segment_sizes[0]); i++) {
+		if(zero_copy_segmentation_run(factory,texts,2,segment_sizes[i],suite->pool) == FALSE) {
+			status = FALSE;
+		}
+	}
+
+	if(zero_copy_bind_run(factory,&recognize,suite->pool) == FALSE) {
+		status = FALSE;
+	}
+
+	mrcp_resource_factory_destroy(factory);
+	return status;
+}
+
+apt_test_suite_t* parse_bench_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"parse-bench",NULL,parse_bench_test_run);
+	return suite;
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <apr_lib.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mrcp_resource_loader.h"
+#include "mrcp_resource_factory.h"
+#include "mrcp_resource.h"
+#include "mrcp_message.h"
+#include "mrcp_stream.h"
+#include "mrcp_generic_header.h"
+#include "mrcp_synth_header.h"
+
+/** Number of case variants each name is looked up in */
+#define STRING_CASE_VARIANT_COUNT 5
+
+/** Compose a case variant of a given string (as is, lower, upper and two alternating ones) */
+static void string_case_variant_make(apt_str_t *dest, const apt_str_t *src, int variant, apr_pool_t *pool)
+{
+	apr_size_t i;
+	char *buf = apr_palloc(pool,src->length + 1);
+	for(i=0; i<src->length; i++) {
+		switch(variant) {
+			case 1:  buf[i] = (char)apr_tolower(src->buf[i]); break;
+			case 2:  buf[i] = (char)apr_toupper(src->buf[i]); break;
+			case 3:  buf[i] = (char)(i % 2 ? apr_tolower(src->buf[i]) : apr_toupper(src->buf[i])); break;
+			case 4:  buf[i] = (char)(i % 2 ? apr_toupper(src->buf[i]) : apr_tolower(src->buf[i])); break;
+			default: buf[i] = src->buf[i]; break;
+		}
+	}
+	buf[src->length] = '\0';
+	dest->buf = buf;
+	dest->length = src->length;
+}
+
+/** Look up every entry of a table by name in mixed case, returning the number of mismatches */
+static apr_size_t string_table_lookup_test(const char *name, const apt_str_table_item_t table[], apr_size_t size, const apt_str_table_hash_t *hash, apr_pool_t *pool)
+{
+	apt_str_t str;
+	apr_size_t i;
+	apr_size_t id;
+	apr_size_t expected_id;
+	apr_size_t mismatches = 0;
+	int variant;
+
+	if(!table || !size) {
+		return 0;
+	}
+	if(!hash) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No Perfect Hash of [%s] Table",name);
+		return 1;
+	}
+
+	for(i=0; i<size; i++) {
+		for(variant=0; variant<STRING_CASE_VARIANT_COUNT; variant++) {
+			string_case_variant_make(&str,&table[i].value,variant,pool);
+			id = apt_string_table_hash_id_find(table,size,hash,&str);
+			if(id != i) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Id [%"APR_SIZE_T_FMT"] of [%s] in [%s] Table, Expected [%"APR_SIZE_T_FMT"]",
+					id,str.buf,name,i);
+				mismatches++;
+			}
+		}
+
+		/* a truncated name must resolve the same as by the linear scan, normally to none */
+		if(table[i].value.length > 1) {
+			string_case_variant_make(&str,&table[i].value,2,pool);
+			str.length--;
+			expected_id = apt_string_table_id_find(table,size,&str);
+			id = apt_string_table_hash_id_find(table,size,hash,&str);
+			if(id != expected_id) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Id [%"APR_SIZE_T_FMT"] of Truncated [%s] in [%s] Table",
+					id,table[i].value.buf,name);
+				mismatches++;
+			}
+		}
+	}
+
+	apt_string_set(&str,"X-Unknown-Name");
+	if(apt_string_table_hash_id_find(table,size,hash,&str) != size) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Match of Unknown Name in [%s] Table",name);
+		mismatches++;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Looked up [%s] Table of %"APR_SIZE_T_FMT" Entries",name,size);
+	return mismatches;
+}
+
+/** Look up the methods, events and header fields of every resource */
+static apr_size_t resource_tables_test(mrcp_resource_factory_t *factory, apr_pool_t *pool)
+{
+	mrcp_resource_t *resource;
+	const mrcp_header_vtable_t *vtable;
+	mrcp_version_e version;
+	apr_size_t mismatches = 0;
+	apr_size_t id;
+	char name[64];
+
+	for(version=MRCP_VERSION_1; version<=MRCP_VERSION_2; version++) {
+		vtable = mrcp_generic_header_vtable_get(version);
+		apr_snprintf(name,sizeof(name),"v%d generic-header",version);
+		mismatches += string_table_lookup_test(name,vtable->field_table,vtable->field_count,vtable->field_hash,pool);
+
+		for(id=0; id<MRCP_RESOURCE_TYPE_COUNT; id++) {
+			resource = mrcp_resource_get(factory,id);
+			if(!resource) {
+				continue;
+			}
+
+			apr_snprintf(name,sizeof(name),"v%d %s-method",version,resource->name.buf);
+			mismatches += string_table_lookup_test(name,
+				resource->get_method_str_table(version),
+				resource->method_count,
+				resource->get_method_str_hash ? resource->get_method_str_hash(version) : NULL,
+				pool);
+
+			apr_snprintf(name,sizeof(name),"v%d %s-event",version,resource->name.buf);
+			mismatches += string_table_lookup_test(name,
+				resource->get_event_str_table(version),
+				resource->event_count,
+				resource->get_event_str_hash ? resource->get_event_str_hash(version) : NULL,
+				pool);
+
+			vtable = resource->get_resource_header_vtable(version);
+			if(vtable) {
+				apr_snprintf(name,sizeof(name),"v%d %s-header",version,resource->name.buf);
+				mismatches += string_table_lookup_test(name,vtable->field_table,vtable->field_count,vtable->field_hash,pool);
+			}
+		}
+	}
+	return mismatches;
+}
+
+/** Generate a value of synthesizer header field, then parse it back in mixed case */
+static apr_size_t synth_value_roundtrip(mrcp_header_accessor_t *accessor, apr_size_t field_id, apr_pool_t *pool)
+{
+	const mrcp_header_vtable_t *vtable = accessor->vtable;
+	mrcp_header_accessor_t parsed;
+	apt_str_t value;
+	apt_str_t str;
+	apt_str_t regenerated;
+	apr_size_t mismatches = 0;
+	int variant;
+
+	apt_string_reset(&value);
+	if(vtable->generate_field(accessor,field_id,&value,pool) == FALSE || !value.length) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Generate [%s]",vtable->field_table[field_id].value.buf);
+		return 1;
+	}
+
+	for(variant=0; variant<STRING_CASE_VARIANT_COUNT; variant++) {
+		string_case_variant_make(&str,&value,variant,pool);
+		parsed.vtable = vtable;
+		vtable->allocate(&parsed,pool);
+		vtable->parse_field(&parsed,field_id,&str,pool);
+
+		/* the value parsed from any case must be generated in the original case */
+		apt_string_reset(&regenerated);
+		if(vtable->generate_field(&parsed,field_id,&regenerated,pool) == FALSE ||
+			regenerated.length != value.length ||
+			strncmp(regenerated.buf,value.buf,value.length) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Value of %s: %s",
+				vtable->field_table[field_id].value.buf,str.buf);
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+/** Look up every label of synthesizer header values via header parser */
+static apr_size_t synth_value_tables_test(mrcp_resource_factory_t *factory, apr_pool_t *pool)
+{
+	mrcp_header_accessor_t accessor;
+	mrcp_synth_header_t *synth_header;
+	apr_size_t mismatches = 0;
+	apr_size_t i;
+	mrcp_resource_t *resource = mrcp_resource_get(factory,MRCP_SYNTHESIZER_RESOURCE);
+	if(!resource) {
+		return 0;
+	}
+
+	accessor.vtable = resource->get_resource_header_vtable(MRCP_VERSION_2);
+	synth_header = accessor.vtable->allocate(&accessor,pool);
+
+	for(i=0; i<VOICE_GENDER_COUNT; i++) {
+		synth_header->voice_param.gender = i;
+		mismatches += synth_value_roundtrip(&accessor,SYNTHESIZER_HEADER_VOICE_GENDER,pool);
+	}
+	for(i=0; i<PROSODY_VOLUME_COUNT; i++) {
+		synth_header->prosody_param.volume.type = PROSODY_VOLUME_TYPE_LABEL;
+		synth_header->prosody_param.volume.value.label = i;
+		mismatches += synth_value_roundtrip(&accessor,SYNTHESIZER_HEADER_PROSODY_VOLUME,pool);
+	}
+	for(i=0; i<PROSODY_RATE_COUNT; i++) {
+		synth_header->prosody_param.rate.type = PROSODY_RATE_TYPE_LABEL;
+		synth_header->prosody_param.rate.value.label = i;
+		mismatches += synth_value_roundtrip(&accessor,SYNTHESIZER_HEADER_PROSODY_RATE,pool);
+	}
+	for(i=0; i<SPEECH_UNIT_COUNT; i++) {
+		synth_header->speak_length.type = SPEECH_LENGTH_TYPE_NUMERIC_POSITIVE;
+		synth_header->speak_length.value.numeric.length = 2;
+		synth_header->speak_length.value.numeric.unit = i;
+		mismatches += synth_value_roundtrip(&accessor,SYNTHESIZER_HEADER_SPEAK_LENGTH,pool);
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Looked up Synthesizer Header Values");
+	return mismatches;
+}
+
+/** Parse responses carrying every request-state in mixed case */
+static apr_size_t request_state_table_test(mrcp_resource_factory_t *factory, apr_pool_t *pool)
+{
+	static const char *request_states[MRCP_REQUEST_STATE_COUNT] = {"COMPLETE","IN-PROGRESS","PENDING"};
+	mrcp_parser_t *parser = mrcp_parser_create(factory,pool);
+	mrcp_message_t *message;
+	apt_text_stream_t stream;
+	apt_str_t state;
+	apt_str_t str;
+	const char *rest;
+	char *buf;
+	apr_size_t mismatches = 0;
+	apr_size_t i;
+	int variant;
+
+	for(i=0; i<MRCP_REQUEST_STATE_COUNT; i++) {
+		apt_string_set(&state,request_states[i]);
+		for(variant=0; variant<STRING_CASE_VARIANT_COUNT; variant++) {
+			string_case_variant_make(&str,&state,variant,pool);
+			/* the start line is 8 + 11 digits of message length long (the latter is padded with zeros) */
+			rest = apr_psprintf(pool," 543257 200 %s\r\nChannel-Identifier: 32AECB23433801@speechrecog\r\n\r\n",str.buf);
+			buf = apr_psprintf(pool,"MRCP/2.0 %06"APR_SIZE_T_FMT"%s",strlen(rest) + 15,rest);
+			apt_text_stream_init(&stream,buf,strlen(buf));
+
+			message = NULL;
+			if(mrcp_parser_run(parser,&stream,&message) != APT_MESSAGE_STATUS_COMPLETE || !message ||
+				message->start_line.request_state != (mrcp_request_state_e)i) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Request-State of [%s]",str.buf);
+				mismatches++;
+			}
+		}
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Looked up Request-States");
+	return mismatches;
+}
+
+static apt_bool_t string_table_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mrcp_resource_factory_t *factory;
+	mrcp_resource_loader_t *resource_loader;
+	apr_size_t mismatches = 0;
+
+	resource_loader = mrcp_resource_loader_create(TRUE,suite->pool);
+	if(!resource_loader) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Loader");
+		return FALSE;
+	}
+
+	factory = mrcp_resource_factory_get(resource_loader);
+	if(!factory) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Factory");
+		return FALSE;
+	}
+
+	mismatches += resource_tables_test(factory,suite->pool);
+	mismatches += synth_value_tables_test(factory,suite->pool);
+	mismatches += request_state_table_test(factory,suite->pool);
+
+	mrcp_resource_factory_destroy(factory);
+	if(mismatches) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"String Table Lookup Mismatches [%"APR_SIZE_T_FMT"]",mismatches);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* string_table_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"string-table",NULL,string_table_test_run);
+	return suite;
+}
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
 #include "apt_pool.h"
 #include "apt_string_table.h"
@@ -52,6 +53,48 @@ static apt_bool_t string_table_key_generate(apt_str_table_item_t table[], apr_si
 	return TRUE;
 }
 
+/** Max number of seeds to try for a given number of buckets */
+#define HASH_MAX_SEED_COUNT 1000000
+/** Max number of buckets */
+#define HASH_MAX_BUCKET_COUNT 4096
+
+/** Find the seed which hashes each string of the table to a bucket of its own */
+static apt_bool_t string_table_hash_generate(const apt_str_table_item_t table[], apr_size_t count, apr_byte_t buckets[], apr_uint32_t *seed, apr_uint32_t *mask)
+{
+	apr_uint32_t bucket_count;
+	apr_uint32_t i;
+	apr_uint32_t bucket;
+	apr_size_t id;
+
+	if(count >= 0xFF) {
+		/* ids must fit into buckets of a byte */
+		return FALSE;
+	}
+
+	/* start with the load factor of 1/2 at most, and double buckets until a seed is found */
+	for(bucket_count = 4; bucket_count < count * 2; bucket_count <<= 1);
+	for(; bucket_count <= HASH_MAX_BUCKET_COUNT; bucket_count <<= 1) {
+		for(i=0; i<HASH_MAX_SEED_COUNT; i++) {
+			memset(buckets,0,bucket_count);
+			for(id=0; id<count; id++) {
+				bucket = apt_string_table_hash(&table[id].value,i) & (bucket_count - 1);
+				if(buckets[bucket]) {
+					/* collision, try the next seed */
+					break;
+				}
+				buckets[bucket] = (apr_byte_t)(id + 1);
+			}
+
+			if(id == count) {
+				*seed = i;
+				*mask = bucket_count - 1;
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
 #define TEST_BUFFER_SIZE 2048
 static char parse_buffer[TEST_BUFFER_SIZE];
 
@@ -93,10 +136,26 @@ static apt_bool_t string_table_write(const apt_str_table_item_t table[], apr_siz
 	return TRUE;
 }
 
+static apt_bool_t string_table_hash_write(const char *name, const apr_byte_t buckets[], apr_uint32_t seed, apr_uint32_t mask, FILE *file)
+{
+	apr_uint32_t i;
+	fprintf(file,"\r\n/** Perfect hash of the string table above (generated by strtablegen) */\r\n");
+	fprintf(file,"static const apr_byte_t %s_buckets[%u] = {",name,mask + 1);
+	for(i=0; i<=mask; i++) {
+		fprintf(file,"%s%s%u",i ? "," : "",(i % 16) ? "" : "\r\n\t",buckets[i]);
+	}
+	fprintf(file,"\r\n};\r\n");
+	fprintf(file,"static const apt_str_table_hash_t %s = {%u,%u,%s_buckets};\r\n",name,seed,mask,name);
+	return TRUE;
+}
+
 int main(int argc, char *argv[])
 {
 	apr_pool_t *pool = NULL;
 	apt_str_table_item_t table[100];
+	apr_byte_t buckets[HASH_MAX_BUCKET_COUNT];
+	apr_uint32_t seed;
+	apr_uint32_t mask;
 	apr_size_t count;
 	FILE *file_in, *file_out;
 
@@ -107,7 +166,7 @@ int main(int argc, char *argv[])
 	pool = apt_pool_create();
 
 	if(argc < 2) {
-		printf("usage: stringtablegen stringtable.in [stringtable.out]\n");
+		printf("usage: stringtablegen stringtable.in [stringtable.out] [hash_name]\n");
 		return 0;
 	}
 	file_in = fopen(argv[1], "rb");
@@ -116,7 +175,7 @@ int main(int argc, char *argv[])
 		return 0;
 	}
 
-	if(argc > 2) {
+	if(argc > 2 && strcmp(argv[2],"-") != 0) {
 		file_out = fopen(argv[2], "wb");
 	}
 	else {
@@ -132,6 +191,16 @@ int main(int argc, char *argv[])
 	/* dump string table to the file */
 	string_table_write(table,count,file_out);
 
+	if(argc > 3) {
+		/* generate and dump perfect hash of the string table */
+		if(string_table_hash_generate(table,count,buckets,&seed,&mask) == TRUE) {
+			string_table_hash_write(argv[3],buckets,seed,mask,file_out);
+		}
+		else {
+			printf("cannot generate perfect hash %s\n", argv[3]);
+		}
+	}
+
 	fclose(file_in);
 	if(file_out != stdout) {
 		fclose(file_out);